@@ -0,0 +1,75 @@
+#ifndef CAMERA_IMAGES_H
+#define CAMERA_IMAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PythonEmbed.h"
+
+// One SensorView.camera_sensor_view: layout from its view configuration, pixels
+// in place in the SensorView buffer (rows top to bottom, channels interleaved,
+// little-endian, no padding)
+struct CameraFrame {
+    uint64_t sensorId = 0;
+    uint32_t width = 0;         // number_of_pixels_horizontal
+    uint32_t height = 0;        // number_of_pixels_vertical
+    uint32_t format = 0;        // CameraSensorViewConfiguration.ChannelFormat (first entry)
+    size_t channels = 0;        // 3 for RGB, 1 for mono and raw mosaics (Bayer, RCCC, RCCB)
+    size_t sampleBytes = 0;     // 1, 2 or 4
+    bool isFloat = false;
+    const char* data = nullptr; // image_data
+    size_t size = 0;
+    std::string error;          // Non-empty: the image cannot be interpreted
+};
+
+enum class CameraColorOrder { Rgb, Bgr, Gray };
+
+struct CameraTensorSettings {
+    size_t width = 224;
+    size_t height = 224;
+    CameraColorOrder order = CameraColorOrder::Rgb;
+    bool channelsFirst = true;  // (C, H, W), else (H, W, C)
+    float mean[3] = { 0.0f, 0.0f, 0.0f }; // Applied to samples / 255: (v / 255 - mean) / std
+    float std[3] = { 1.0f, 1.0f, 1.0f };
+};
+
+// Camera images of the current SensorView without copy. locate() records where
+// image_data lies in the input buffer; Python gets read-only views of it that are
+// released after update_control(), like the SensorView memoryview (OsiDecodeMode = 2).
+// tensor() resizes (bilinear, pixel centres aligned), converts the colour order
+// and normalizes 8-bit images into a float32 tensor in one pass; Bayer mosaics are
+// combined per 2x2 cell into RGB at half resolution first.
+class CameraImages {
+public:
+    // No GIL needed. The frames point into the buffer, which must stay valid until release().
+    bool locate(const char* sensorView, size_t size, std::string& error);
+
+    size_t count() const { return m_frames.size(); }
+    const CameraFrame& frame(size_t index) const { return m_frames[index]; }
+
+    // Read-only memoryview of the image bytes, released by release(). Requires the GIL.
+    py::object view(size_t index);
+
+    // out: settings.width * settings.height * output channels (1 for Gray, else 3)
+    bool tensor(size_t index, const CameraTensorSettings& settings, float* out, std::string& error);
+
+    // End of the step: views are released and the frames dropped. Requires the GIL.
+    void release();
+
+private:
+    const uint8_t* rgbSource(const CameraFrame& frame, size_t& width, size_t& height, size_t& channels,
+                             std::string& error);
+
+    std::vector<CameraFrame> m_frames;
+    std::vector<py::object> m_views;
+
+    // Scratch of tensor(), reused across calls
+    std::vector<uint8_t> m_demosaic;
+    std::vector<float> m_row;
+    std::vector<int32_t> m_x0;
+    std::vector<float> m_wx;
+    std::vector<float> m_planes;
+};
+
+#endif // CAMERA_IMAGES_H
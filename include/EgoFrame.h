@@ -0,0 +1,38 @@
+#ifndef EGO_FRAME_H
+#define EGO_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "MovingObjects.h"
+
+// Relative kinematics of all moving objects with respect to the host vehicle,
+// computed in one pass per step (Simd::egoFrame). Ego frame: origin at the
+// host's bounding box center, x along its heading, y to the left.
+// The host vehicle itself is not part of the result.
+class EgoFrame {
+public:
+    // Recompute from the objects of this step. Returns false (and an empty result)
+    // if the host vehicle is not among the objects.
+    bool compute(const MovingObjects& objects);
+
+    bool hostFound() const { return m_hostFound; }
+    size_t count() const { return id.size(); }
+    double hostSpeed() const { return m_hostSpeed; } // Along the host heading [m/s]
+
+    // One entry per object, in the order of the SensorView
+    std::vector<uint64_t> id;
+    std::vector<double> x;        // Position [m]
+    std::vector<double> y;
+    std::vector<double> vx;       // Relative velocity [m/s]
+    std::vector<double> vy;
+    std::vector<double> distance; // Gap between the footprints [m], 0: overlapping
+    std::vector<double> ttc;      // Time to collision [s], infinity if not closing
+    std::vector<double> headway;  // Time headway [s] of objects ahead in the host's path, else infinity
+
+private:
+    bool m_hostFound = false;
+    double m_hostSpeed = 0.0;
+};
+
+#endif // EGO_FRAME_H
@@ -0,0 +1,44 @@
+#ifndef FALLBACK_CONTROLLER_H
+#define FALLBACK_CONTROLLER_H
+
+#include "fmi2TypesPlatform.h"
+
+// Control command as produced by the Python controller or the fallback
+struct ControlCommand {
+    fmi2Real throttle = 0.0;
+    fmi2Real brake = 0.0;
+    fmi2Real steering = 0.0;
+    fmi2Integer driveMode = 1; // 1: Forward, 0: Neutral, -1: Reverse
+};
+
+// Fallback behaviour selected by the FallbackMode parameter
+enum class FallbackMode : int {
+    HoldSpeed  = 0, // Repeat the last Python throttle/brake command
+    Decelerate = 1  // Release throttle and ramp brake up to FallbackBrake
+};
+
+// Native safe-fallback controller used when Python misses the step deadline.
+// Steering is always held at the last command delivered by Python.
+class FallbackController {
+public:
+    void setMode(FallbackMode mode) { m_mode = mode; }
+    void setTargetBrake(fmi2Real brake) { m_targetBrake = brake; }
+
+    // Record the last command that Python delivered in time
+    void observe(const ControlCommand& cmd);
+
+    // Compute the command for one fallback step of length stepSize [s]
+    ControlCommand compute(fmi2Real stepSize);
+
+    FallbackMode mode() const { return m_mode; }
+
+private:
+    FallbackMode m_mode = FallbackMode::Decelerate;
+    fmi2Real m_targetBrake = 0.3;
+
+    ControlCommand m_lastGood;   // Last Python command
+    ControlCommand m_current;    // Last fallback command (ramp state)
+    bool m_active = false;       // True while consecutive steps are in fallback
+};
+
+#endif // FALLBACK_CONTROLLER_H
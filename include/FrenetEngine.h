@@ -0,0 +1,52 @@
+#ifndef FRENET_ENGINE_H
+#define FRENET_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "RoadGraph.h"
+
+constexpr uint32_t FRENET_NO_SEGMENT = 0xFFFFFFFF;
+
+// Frenet-frame projection onto the lane centerlines of a RoadGraph.
+//   s  arc length along the centerline from its first point [m]
+//   t  signed lateral offset, positive to the left of the centerline direction [m]
+// Queries are batched. Each position in a batch (slot) remembers the segment of
+// its previous result and starts from there on the next call, so keep the order
+// of the queries stable across steps (e.g. host vehicle first, then objects by id).
+class FrenetEngine {
+public:
+    // Use the given graph (null: no map). The segment tables are rebuilt and the
+    // warm starts reset only if it differs from the current one.
+    void setGraph(std::shared_ptr<const RoadGraph> graph);
+    bool hasMap() const { return m_graph && m_graph->pointCount() > 0; }
+    const RoadGraph* graph() const { return m_graph.get(); }
+
+    // (x, y) -> nearest centerline point of all lanes; beyond the ends of the lane
+    // s is extrapolated (s < 0, s > length). Without a map s and t are NaN and laneId is 0.
+    void toFrenet(const double* x, const double* y, size_t count, double* s, double* t, uint64_t* laneId);
+
+    // Single point as in toFrenet(), warm-started from segment (FRENET_NO_SEGMENT: cold),
+    // which is updated to the segment found. Returns false without a result.
+    bool project(double x, double y, uint32_t& segment, double& s, double& t, uint64_t& laneId) const;
+
+    // (s, t, laneId) -> position and centerline heading [rad]. s outside the lane
+    // is extrapolated along the first / last segment; unknown lanes give NaN.
+    void toCartesian(const double* s, const double* t, const uint64_t* laneId, size_t count,
+                     double* x, double* y, double* heading);
+
+private:
+    uint32_t nearestSegment(double x, double y, uint32_t warm) const;
+    void searchGrid(double x, double y, double radius, double& bestD2, uint32_t& best) const;
+    bool isSegment(uint32_t p) const;
+
+    std::shared_ptr<const RoadGraph> m_graph;
+    std::vector<double> m_dx;          // Segment p: point p -> p + 1 (0 for the last point of a lane)
+    std::vector<double> m_dy;
+    std::vector<double> m_invLength2;
+    std::vector<uint32_t> m_frenetWarm;    // Segment of the previous result per slot
+    std::vector<uint32_t> m_cartesianWarm;
+};
+
+#endif // FRENET_ENGINE_H
@@ -0,0 +1,112 @@
+#ifndef KPI_ENGINE_H
+#define KPI_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include "EgoFrame.h"
+#include "FallbackController.h"
+#include "FrenetEngine.h"
+#include "MovingObjects.h"
+
+struct KpiSettings {
+    double headwayThreshold = 1.0;           // [s] time headway below which following counts as a violation
+    double maxLongitudinalAcceleration = 3.0; // [m/s^2] comfort limits, acceleration and deceleration
+    double maxLateralAcceleration = 3.0;     // [m/s^2]
+    double maxJerk = 2.5;                    // [m/s^3] longitudinal
+};
+
+// Accumulated over the run (since the start or reset())
+struct KpiValues {
+    unsigned long long steps = 0;        // doStep calls
+    unsigned long long samples = 0;      // SensorViews with the host vehicle
+    double duration = 0.0;               // [s] simulation time with the host vehicle
+    double distance = 0.0;               // [m] travelled by the host
+    double minTtc = std::numeric_limits<double>::infinity();     // [s] infinity: never closing in on an object
+    double minTtcTime = std::numeric_limits<double>::quiet_NaN(); // [s] simulation time of minTtc
+    double minHeadway = std::numeric_limits<double>::infinity(); // [s] infinity: never following an object
+    double headwayViolationTime = 0.0;   // [s] with a headway below settings.headwayThreshold
+    double maxAcceleration = 0.0;        // [m/s^2] longitudinal, positive
+    double maxDeceleration = 0.0;        // [m/s^2] longitudinal, positive when braking
+    double maxLateralAcceleration = 0.0; // [m/s^2] absolute
+    double maxJerk = 0.0;                // [m/s^3] absolute, longitudinal
+    double jerkRms = 0.0;
+    double comfortViolationTime = 0.0;   // [s] with an acceleration or the jerk beyond the comfort limits
+    unsigned long long laneSamples = 0;  // Samples with a lane centerline (static map)
+    double laneDeviationRms = 0.0;       // [m] distance to the nearest lane centerline
+    double laneDeviationMax = 0.0;
+    double maxSteeringRate = 0.0;        // [1/s] of the Steering output
+    double brakeTime = 0.0;              // [s] with Brake > 0
+    double throttleBrakeOverlapTime = 0.0; // [s] with Throttle > 0 and Brake > 0
+};
+
+// Driving KPIs of the host vehicle, accumulated online so that a run needs no
+// logging for its evaluation. observe() takes the scene of each SensorView
+// (TTC and headway via EgoFrame, host kinematics, lateral offset on the static
+// map) on the thread of the step; step() integrates the latest scene and the
+// control outputs over each communication step on the FMU thread. Accelerations
+// are taken from the host's MovingObject, or differentiated from its velocity
+// if the SensorView has none; the jerk is their difference per sample.
+class KpiEngine {
+public:
+    KpiSettings settings;
+
+    // Scene of this step's moving objects. egoFrame: already computed for these
+    // objects (EgoFrame enabled), else null; frenet: null without a static map.
+    void observe(const MovingObjects& objects, const EgoFrame* egoFrame, const FrenetEngine* frenet);
+
+    // End of a doStep: the control outputs of the step starting at time, of length dt
+    void step(const ControlCommand& command, double time, double dt);
+
+    KpiValues values() const;
+    void reset();
+
+    // JSON file with the values and settings. Returns false with a message in error.
+    bool writeSummary(const std::string& path, std::string& error) const;
+
+private:
+    struct Scene {
+        bool hostFound = false;
+        double speed = 0.0;          // Along the host heading [m/s]
+        double yawRate = 0.0;
+        bool hasAcceleration = false;
+        double longitudinal = 0.0;   // Reported acceleration [m/s^2]
+        double lateral = 0.0;
+        double minTtc = 0.0;
+        double minHeadway = 0.0;
+        bool hasLane = false;
+        double laneOffset = 0.0;     // Signed, positive to the left [m]
+    };
+
+    void sample(const Scene& scene, double time);
+
+    mutable std::mutex m_mutex;      // observe() may run on the step worker
+    Scene m_pending;
+    bool m_hasPending = false;
+
+    // Only used by observe()
+    EgoFrame m_ego;
+    const RoadGraph* m_graph = nullptr; // Graph of m_segment
+    uint32_t m_segment = FRENET_NO_SEGMENT;
+
+    // State of the last sample
+    Scene m_scene;
+    bool m_hasScene = false;
+    double m_sceneTime = 0.0;
+    double m_previousSpeed = 0.0;
+    bool m_hasLongitudinal = false;
+    double m_longitudinal = 0.0;     // [m/s^2]
+    double m_lateral = 0.0;
+    double m_jerk = 0.0;
+    bool m_hasSteering = false;
+    double m_steering = 0.0;
+
+    KpiValues m_values;
+    double m_jerkSquares = 0.0;
+    unsigned long long m_jerkCount = 0;
+    double m_laneSquares = 0.0;
+};
+
+#endif // KPI_ENGINE_H
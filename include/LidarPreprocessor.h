@@ -0,0 +1,78 @@
+#ifndef LIDAR_PREPROCESSOR_H
+#define LIDAR_PREPROCESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct LidarSettings {
+    double voxelSize = 0.2;        // [m] edge of the downsampling voxels, 0: no downsampling
+    double minRange = 0.5;         // [m] from the sensor
+    double maxRange = 120.0;
+    bool removeGround = true;
+    double groundHeight = -0.3;    // [m] road surface in the vehicle frame (origin: rear axle centre)
+    double groundTolerance = 0.2;  // [m] points below groundHeight + groundTolerance are ground
+};
+
+// Statistics of the last process() call
+struct LidarStats {
+    size_t sensors = 0;            // lidar_sensor_view entries
+    size_t reflections = 0;        // Raw reflections
+    size_t cropped = 0;            // Outside [minRange, maxRange] or without a direction
+    size_t ground = 0;
+    size_t points = 0;             // Points of the reduced cloud
+    size_t bytesStripped = 0;      // Removed from the SensorView
+    double processTimeUs = 0.0;
+};
+
+// Point cloud stage for SensorView.lidar_sensor_view, applied at the wire level
+// before Python sees the input. The reflections of all lidar views are placed
+// along the ray directions of their view configuration (range = c * time of
+// flight / 2, one reflection per ray or max_number_of_interactions consecutive
+// ones), transformed into the vehicle frame with the mounting position,
+// cropped by range, cleared of ground points and downsampled to one centroid
+// per occupied voxel. The SensorView handed on keeps each lidar view with its
+// configuration, but without reflections, directions and timings.
+class LidarPreprocessor {
+public:
+    LidarSettings settings;
+
+    // Reduce the cloud and write the stripped SensorView to out (cleared first;
+    // capacity is reused). Returns false with a message in error if the input is
+    // malformed (the cloud is then empty).
+    bool process(const char* sensorView, size_t size, std::string& out, std::string& error);
+
+    // Reduced cloud in the vehicle frame, structure of arrays
+    size_t count() const { return m_count; }
+    const std::vector<float>& x() const { return m_outX; }
+    const std::vector<float>& y() const { return m_outY; }
+    const std::vector<float>& z() const { return m_outZ; }
+    const std::vector<float>& intensity() const { return m_outIntensity; } // Mean signal strength [dB]
+    const std::vector<uint32_t>& pointsPerVoxel() const { return m_outCount; }
+    const LidarStats& stats() const { return m_stats; }
+
+private:
+    bool parseView(const char* data, size_t size, std::string& stripped, std::string& error);
+    void downsample();
+
+    // Raw reflections of all views: direction (lidar frame), range, then the
+    // transformed points (vehicle frame) and whether they are kept
+    std::vector<float> m_dx, m_dy, m_dz, m_range, m_signal;
+    std::vector<float> m_x, m_y, m_z;
+    std::vector<uint8_t> m_keep;
+    std::vector<float> m_rayX, m_rayY, m_rayZ; // Directions of the current view
+
+    // Voxel hash (open addressing, keys of the occupied voxels)
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_slots;
+
+    size_t m_count = 0;
+    std::vector<float> m_outX, m_outY, m_outZ, m_outIntensity;
+    std::vector<uint32_t> m_outCount;
+    LidarStats m_stats;
+    std::string m_config; // Stripped view configuration, reused across steps
+    std::string m_view;
+};
+
+#endif // LIDAR_PREPROCESSOR_H
@@ -0,0 +1,62 @@
+#ifndef LINEAR_MPC_H
+#define LINEAR_MPC_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "QpSolver.h"
+
+// Linear time-invariant model x[k+1] = A x[k] + B u[k] and its quadratic cost
+//     sum_{k=1}^{N-1} (x[k] - r[k])' Q (x[k] - r[k]) + (x[N] - r[N])' P (x[N] - r[N])
+//   + sum_{k=0}^{N-1} u[k]' R u[k]
+// Matrices are row-major. Empty rate / state bounds mean "none"; infinite
+// entries leave single components unbounded.
+struct LinearMpcProblem {
+    size_t nx = 0;
+    size_t nu = 0;
+    size_t horizon = 0;
+    std::vector<double> A, B;       // nx * nx, nx * nu
+    std::vector<double> Q, R, P;    // nx * nx, nu * nu, nx * nx (empty P: Q)
+    std::vector<double> uMin, uMax; // nu
+    std::vector<double> duMax;      // nu, |u[k] - u[k-1]| (u[-1] = uPrev)
+    std::vector<double> xMin, xMax; // nx, for x[1] .. x[N]
+};
+
+// Condensed MPC: the states are eliminated (X = Sx x0 + Su U), leaving a dense
+// QP in the N * nu inputs. Everything independent of x0, the reference and
+// uPrev is built once by setup(); solve() only forms the vectors and runs the
+// warm-started QpSolver on the previous solution shifted by one step.
+class LinearMpc {
+public:
+    bool setup(const LinearMpcProblem& problem, const QpSettings& settings, std::string& error);
+
+    // x0: nx, reference: horizon * nx for x[1] .. x[N] (null: 0), uPrev: nu (null: no
+    // rate bound on u[0]). Inputs (horizon * nu) are available in inputs().
+    const QpInfo& solve(const double* x0, const double* reference, const double* uPrev);
+
+    size_t states() const { return m_problem.nx; }
+    size_t inputs() const { return m_problem.nu; }
+    size_t horizon() const { return m_problem.horizon; }
+    const double* solution() const { return m_qp.solution(); }
+    QpSolver& qp() { return m_qp; }
+
+private:
+    LinearMpcProblem m_problem;
+    QpSolver m_qp;
+    bool m_solved = false;
+
+    std::vector<double> m_Sx;   // (N nx) * nx
+    std::vector<double> m_Su;   // (N nx) * (N nu)
+    std::vector<double> m_W;    // (N nu) * (N nx) = Su' Qbar
+    std::vector<size_t> m_stateRows; // Index into X of each state constraint row
+    size_t m_rateRows = 0;
+
+    // Per-solve vectors
+    std::vector<double> m_free;  // Sx x0
+    std::vector<double> m_error; // Sx x0 - r
+    std::vector<double> m_g;
+    std::vector<double> m_lb, m_ub, m_lbA, m_ubA;
+    std::vector<double> m_shift;
+};
+
+#endif // LINEAR_MPC_H
@@ -0,0 +1,39 @@
+#ifndef MOVING_OBJECTS_H
+#define MOVING_OBJECTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Moving objects of global_ground_truth in structure-of-arrays form, extracted
+// from the serialized SensorView at the wire level (no protobuf decode).
+// Positions are the bounding box centers; yaw, velocity and acceleration in the
+// global frame (yaw rate from orientation_rate). Missing fields are 0. The arrays keep their capacity across steps.
+struct MovingObjects {
+    size_t count = 0;
+    std::vector<uint64_t> id;
+    std::vector<uint32_t> type;   // MovingObject.Type
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> yaw;
+    std::vector<double> cosYaw;
+    std::vector<double> sinYaw;
+    std::vector<double> length;
+    std::vector<double> width;
+    std::vector<double> vx;
+    std::vector<double> vy;
+    std::vector<double> ax;
+    std::vector<double> ay;
+    std::vector<double> yawRate;
+
+    uint64_t hostId = 0;          // SensorView.host_vehicle_id, else GroundTruth.host_vehicle_id
+    long long hostIndex = -1;     // Index of the host vehicle, -1 if not found
+
+    // Replace the content with the objects of the given SensorView. Objects without
+    // a finite position are skipped. Returns false with a message in error if the
+    // input is malformed (the content is then empty).
+    bool extract(const char* sensorView, size_t size, std::string& error);
+};
+
+#endif // MOVING_OBJECTS_H
@@ -0,0 +1,101 @@
+#ifndef MPPI_PLANNER_H
+#define MPPI_PLANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "WorkerPool.h"
+
+constexpr size_t MPPI_STATE_SIZE = 4;   // x, y, yaw [rad], speed [m/s]
+constexpr size_t MPPI_CONTROL_SIZE = 2; // acceleration [m/s^2], steering angle [rad]
+
+struct MppiSettings {
+    size_t samples = 1024;
+    size_t steps = 30;
+    double dt = 0.1;
+    int iterations = 1;           // Sampling rounds per plan()
+    double temperature = 10.0;    // lambda of the path-integral weights
+    double wheelbase = 2.8;       // Kinematic bicycle model
+    double accelerationSigma = 1.0;
+    double steeringSigma = 0.1;
+    double accelerationMin = -6.0;
+    double accelerationMax = 3.0;
+    double steeringMax = 0.5;
+    uint64_t seed = 1;
+
+    // Cost weights per step
+    double lateralWeight = 1.0;   // Squared distance to the reference path
+    double headingWeight = 0.5;   // Squared heading error to the path
+    double speedWeight = 0.5;     // Squared error to the reference speed
+    double accelerationWeight = 0.05;
+    double steeringWeight = 1.0;
+    double egoRadius = 1.5;       // [m], added to the obstacle radii
+    double safetyMargin = 1.0;    // [m], quadratic cost below this clearance
+    double proximityWeight = 10.0;
+    double collisionCost = 1e4;   // Per step in collision
+};
+
+struct MppiInfo {
+    double solveTimeUs = 0.0;
+    double minCost = 0.0;
+    double effectiveSamples = 0.0; // 1 / sum(w^2) of the last round
+    size_t collisionFree = 0;      // Samples of the last round without collision
+};
+
+// Sampling-based planner (model predictive path integral). Every round rolls
+// `samples` perturbations of the nominal control sequence through a kinematic
+// bicycle model on the worker pool, scores them against the reference path,
+// the predicted obstacles and the control effort, and moves the nominal
+// sequence by the exponentially weighted perturbations. Noise is drawn per
+// sample from a counter-based generator, so results do not depend on the
+// number of threads. The sequence is shifted by one step for the next plan().
+class MppiPlanner {
+public:
+    MppiSettings settings;
+
+    explicit MppiPlanner(std::shared_ptr<WorkerPool> pool);
+
+    // Polyline with a speed per point (at least 2 points)
+    bool setReference(const double* x, const double* y, const double* speed, size_t count, std::string& error);
+
+    // obstacles[object][step][MPPI_STATE_SIZE] at dt, 2 dt, ... (TrajectoryPredictor
+    // layout, at least settings.steps steps), radius per object
+    bool plan(const double* state, const double* obstacles, size_t obstacleCount, size_t obstacleSteps,
+              const double* radius, std::string& error);
+
+    void reset();
+
+    const std::vector<double>& controls() const { return m_nominal; }   // steps * MPPI_CONTROL_SIZE
+    const std::vector<double>& trajectory() const { return m_trajectory; } // steps * MPPI_STATE_SIZE
+    const MppiInfo& info() const { return m_info; }
+    size_t threads() const { return m_pool->threads(); }
+
+private:
+    bool validate(std::string& error) const;
+    void rollout(size_t sample, uint64_t round);
+    double pathCost(double x, double y, double yaw, double speed, size_t& segment) const;
+
+    std::shared_ptr<WorkerPool> m_pool;
+    std::vector<double> m_refX, m_refY, m_refSpeed, m_refHeading;
+
+    std::vector<double> m_nominal;    // steps * MPPI_CONTROL_SIZE
+    std::vector<double> m_noise;      // samples * steps * MPPI_CONTROL_SIZE, applied (clamped) perturbation
+    std::vector<double> m_cost;       // Per sample
+    std::vector<unsigned char> m_collided;
+    std::vector<double> m_trajectory; // Rollout of the nominal sequence
+    bool m_planned = false;
+    uint64_t m_round = 0;
+    MppiInfo m_info;
+
+    // Inputs of the current plan() for the rollouts
+    double m_state[MPPI_STATE_SIZE] = {};
+    const double* m_obstacles = nullptr;
+    const double* m_radius = nullptr;
+    size_t m_obstacleCount = 0;
+    size_t m_obstacleSteps = 0;
+    size_t m_startSegment = 0;
+};
+
+#endif // MPPI_PLANNER_H
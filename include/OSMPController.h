@@ -7,19 +7,33 @@
 #include <iostream>
 #include <fstream>
 
+#include "FallbackController.h"
+#include "OsiPatch.h"
+#include "PythonStepWorker.h"
+#include "RealtimeProfile.h"
+#include "OsiInputChannel.h"
+#include "TrafficUpdateBuilder.h"
+#include "SensorViewConfig.h"
+#include "SensorViewFilter.h"
+#include "StaticMapCache.h"
+#include "FrenetEngine.h"
+#include "ObjectIndex.h"
+#include "EgoFrame.h"
+#include "TrajectoryPredictor.h"
+#include "MppiPlanner.h"
+#include "OccupancyGrid.h"
+#include "LidarPreprocessor.h"
+#include "CameraImages.h"
+#include "ObjectTracker.h"
+#include "KpiEngine.h"
+#include "SignalLog.h"
+
 // FMI 2.0 Headers
 #include "fmi2FunctionTypes.h"
 #include "fmi2Functions.h"
 
-// Pybind11 Headers
-// WORKAROUND: Force Pybind11 to use Python 3.12 API (avoid missing 3.14 symbols in linker)
-// Python.h must be included first to define the original version
-#include <Python.h>
-#undef PY_VERSION_HEX
-#define PY_VERSION_HEX 0x030C0000 
-static_assert(PY_VERSION_HEX == 0x030C0000, "PY_VERSION_HEX spoof failed!"); 
-#include <pybind11/embed.h>
-namespace py = pybind11;
+// Pybind11 Headers (with Python 3.12 API workaround)
+#include "PythonEmbed.h"
 
 // Define Value References (must match modelDescription.xml)
 #define VR_OSI_BASELO 0
@@ -35,6 +49,117 @@ namespace py = pybind11;
 #define VR_DRIVEMODE      10
 #define VR_PYTHON_SCRIPT_PATH  11
 #define VR_PYTHON_DEP_PATH     12
+#define VR_STEP_DEADLINE_MS    13
+#define VR_FALLBACK_MODE       14
+#define VR_FALLBACK_BRAKE      15
+#define VR_DEADLINE_MISS_COUNT 16
+#define VR_RT_PROFILE          17
+#define VR_RT_CPU_AFFINITY     18
+#define VR_RT_THREAD_PRIORITY  19
+#define VR_RT_BUFFER_BYTES     20
+#define VR_RT_STEP_ALLOC_COUNT 21
+#define VR_PY_GC_FREEZE        22
+#define VR_PY_GC_MODE          23
+#define VR_PY_GC_INTERVAL      24
+#define VR_PY_ALLOCATOR        25
+#define VR_PY_GC_COLLECTIONS   26
+#define VR_PY_GC_PAUSE_MS      27
+#define VR_PY_GC_MAX_PAUSE_MS  28
+#define VR_PROTOBUF_BACKEND    29
+#define VR_OSI_DECODE_MODE     30
+#define VR_TU_OUT_BASELO       31
+#define VR_TU_OUT_BASEHI       32
+#define VR_TU_OUT_SIZE         33
+#define VR_SENSORVIEW_OUTPUT   34
+#define VR_TRAFFIC_UPDATE_OUTPUT 35
+#define VR_SD_IN_BASELO        36
+#define VR_SD_IN_BASEHI        37
+#define VR_SD_IN_SIZE          38
+#define VR_GT_IN_BASELO        39
+#define VR_GT_IN_BASEHI        40
+#define VR_GT_IN_SIZE          41
+#define VR_TC_IN_BASELO        42
+#define VR_TC_IN_BASEHI        43
+#define VR_TC_IN_SIZE          44
+#define VR_SD_DECODE_MODE      45
+#define VR_GT_DECODE_MODE      46
+#define VR_TC_DECODE_MODE      47
+#define VR_SVC_REQ_BASELO      48
+#define VR_SVC_REQ_BASEHI      49
+#define VR_SVC_REQ_SIZE        50
+#define VR_SVC_IN_BASELO       51
+#define VR_SVC_IN_BASEHI       52
+#define VR_SVC_IN_SIZE         53
+#define VR_SV_FOV_HORIZONTAL   54
+#define VR_SV_FOV_VERTICAL     55
+#define VR_SV_RANGE            56
+#define VR_SV_UPDATE_CYCLE     57
+#define VR_SV_SENSOR_VIEWS     58
+#define VR_SV_OMIT_STATIC      59
+#define VR_SV_MEAN_BYTES       60
+#define VR_PREFILTER_ENABLED   61
+#define VR_PREFILTER_RADIUS    62
+#define VR_PREFILTER_FRONT     63
+#define VR_PREFILTER_REAR      64
+#define VR_PREFILTER_LATERAL   65
+#define VR_PREFILTER_MOVING_MASK     66
+#define VR_PREFILTER_STATIONARY_MASK 67
+#define VR_PREFILTER_BYTES_REMOVED   68
+#define VR_PREFILTER_OBJECTS_REMOVED 69
+#define VR_PREFILTER_LANES_REMOVED   70
+#define VR_STATIC_MAP_CACHE          71
+#define VR_STATIC_MAP_VERSION        72
+#define VR_STATIC_MAP_BYTES_STRIPPED 73
+#define VR_ROAD_NETWORK_CACHE_DIR    74
+#define VR_OBJECT_INDEX              75
+#define VR_EGO_FRAME                 76
+#define VR_TRAJECTORY_PREDICTION     77
+#define VR_MPPI_PLANNER              78
+#define VR_PLANNER_THREADS           79
+#define VR_OCCUPANCY_GRID            80
+#define VR_OCCUPANCY_RESOLUTION      81
+#define VR_OCCUPANCY_SIZE            82
+#define VR_LIDAR_PREPROCESSING       83
+#define VR_LIDAR_VOXEL_SIZE          84
+#define VR_LIDAR_MAX_RANGE           85
+#define VR_LIDAR_REFLECTIONS         86
+#define VR_LIDAR_POINTS              87
+#define VR_CAMERA_IMAGES             88
+#define VR_OBJECT_TRACKING           89
+#define VR_TRACKED_OBJECTS           90
+#define VR_KPI_ENABLED               91
+#define VR_KPI_SUMMARY_PATH          92
+#define VR_KPI_HEADWAY_THRESHOLD     93
+#define VR_KPI_MIN_TTC               94
+#define VR_KPI_MAX_JERK              95
+#define VR_KPI_LANE_DEVIATION_RMS    96
+#define VR_KPI_HEADWAY_VIOLATION_TIME 97
+#define VR_KPI_COMFORT_VIOLATION_TIME 98
+#define VR_SIGNAL_LOG_PATH           99
+#define VR_SIGNAL_LOG_BLOCK_ROWS     100
+#define VR_TU_MAX_STEERING_WHEEL_ANGLE 101
+
+// Wall-clock time of the phases of one update_control() step [us]
+struct PhaseTimings {
+    double prepareUs = 0.0;    // Input decode and native preprocessing up to the Python call
+    double pythonUs = 0.0;     // update_control()
+    double outputUs = 0.0;     // Result parsing and OSI outputs
+};
+
+// Outputs of one update_control() call, kept apart from the FMI variables
+// so that a late answer from the step worker cannot overwrite them
+struct StepResult {
+    bool ok = false;
+    ControlCommand cmd;
+    bool hasOsiOut = false;
+    std::string osiOut;
+    bool hasOsiEdits = false;              // Delta output: osiOut is built from the input
+    std::vector<OsiPatch::Edit> osiEdits;
+    EgoStateOverride egoState;             // Optional 6th element, used for the TrafficUpdate
+    bool hasTrafficUpdate = false;
+    std::string trafficUpdate;
+    PhaseTimings timings;
+};
 
 class OSMPController {
 public:
@@ -43,12 +168,16 @@ public:
 
     // FMI 2.0 Implementation Methods
     fmi2Status doInit();
+    fmi2Status exitInit();
     fmi2Status doStep(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize);
     
     // Setters / Getters
     fmi2Status setInteger(const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]);
     fmi2Status getInteger(const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]);
     fmi2Status getReal(const fmi2ValueReference vr[], size_t nvr, fmi2Real value[]);
+    fmi2Status setReal(const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]);
+    fmi2Status getBoolean(const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]);
+    fmi2Status setBoolean(const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]);
     fmi2Status setString(const fmi2ValueReference vr[], size_t nvr, const fmi2String value[]);
     fmi2Status getString(const fmi2ValueReference vr[], size_t nvr, fmi2String value[]);
     
@@ -56,7 +185,7 @@ public:
     fmi2Status terminate();
     fmi2Status reset();
 
-    static void GlobalInitializePython(const std::wstring& pythonHome);
+    static void GlobalInitializePython(const std::wstring& pythonHome, int allocatorMode = 0);
     static void GlobalFinalizePython();
 
 private:
@@ -79,6 +208,24 @@ private:
     fmi2Integer m_osi_out_size = 0;
     std::string m_osi_out_buffer[2]; // Double buffering for stability
     int m_osi_out_idx = 0;
+    OsiPatch::Patcher m_osiPatcher;  // Delta output, buffers reused across steps
+
+    // TrafficUpdate Output
+    fmi2Integer m_tu_out_baseLo = 0;
+    fmi2Integer m_tu_out_baseHi = 0;
+    fmi2Integer m_tu_out_size = 0;
+    std::string m_tu_out_buffer[2];
+    int m_tu_out_idx = 0;
+    TrafficUpdateBuilder m_trafficUpdateBuilder;
+
+    // SensorViewConfiguration Request (Output) / accepted Configuration (Input)
+    fmi2Integer m_svc_req_baseLo = 0;
+    fmi2Integer m_svc_req_baseHi = 0;
+    fmi2Integer m_svc_req_size = 0;
+    std::string m_svc_req_buffer;
+    OsmpPointer m_svc_in;
+    SensorViewRequest m_svcAccepted;    // Valid after exitInit() if m_svcNegotiated
+    bool m_svcNegotiated = false;
 
     // Control Output
     fmi2Integer m_driveMode = 1; // Default: Forward
@@ -86,11 +233,188 @@ private:
     // Parameters
     std::string m_pythonScriptPath = "logic.py";
     std::string m_pythonDependencyPath = "";
+    fmi2Real m_stepDeadlineMs = 0.0;   // <= 0: no deadline, Python runs synchronously
+    fmi2Integer m_fallbackMode = (fmi2Integer)FallbackMode::Decelerate;
+    fmi2Real m_fallbackBrake = 0.3;
+    fmi2Boolean m_rtProfile = fmi2False;
+    std::string m_rtCpuAffinity = "";  // e.g. "2,3": stepping thread on 2, workers on 3
+    fmi2Integer m_rtThreadPriority = 0; // SCHED_FIFO priority, 0: keep scheduler policy
+    fmi2Integer m_rtBufferBytes = 8 * 1024 * 1024;
+    fmi2Boolean m_gcFreeze = fmi2False;
+    fmi2Integer m_gcMode = 0;          // PythonMemory::GcMode
+    fmi2Integer m_gcInterval = 100;    // Steps between scheduled collections (Manual mode)
+    fmi2Integer m_pythonAllocator = 0; // PythonMemory::AllocatorMode
+    std::string m_protobufBackend = "auto"; // "auto", "upb", "cpp" or "python"
+    fmi2Boolean m_sensorViewOutput = fmi2True;     // OSI_SensorView_Out_*
+    fmi2Boolean m_trafficUpdateOutput = fmi2False; // OSI_TrafficUpdate_Out_*
+    fmi2Integer m_osiDecodeMode = 0;   // OsiDecodeMode of the SensorView
+    fmi2Real m_svFovHorizontal = 0.0;  // SensorViewConfiguration request, 0: not specified
+    fmi2Real m_svFovVertical = 0.0;
+    fmi2Real m_svRange = 0.0;
+    fmi2Real m_svUpdateCycle = 0.0;
+    std::string m_svSensorViews = "";  // e.g. "generic,radar"
+    fmi2Boolean m_svOmitStatic = fmi2False;
+
+    // Ego-centric SensorView pre-filter (settings are FMI parameters)
+    fmi2Boolean m_prefilterEnabled = fmi2False;
+    SensorViewFilter m_sensorViewFilter;
+    fmi2Integer m_prefilterBytesRemoved = 0;   // Last step
+    fmi2Integer m_prefilterObjectsRemoved = 0;
+    fmi2Integer m_prefilterLanesRemoved = 0;
+    unsigned long long m_prefilterTotalBytesIn = 0;
+    unsigned long long m_prefilterTotalBytesOut = 0;
+    bool m_prefilterWarned = false;
+
+    // Static map cache: static GroundTruth content is split off the SensorView
+    fmi2Boolean m_staticMapEnabled = fmi2False;
+    StaticMapCache m_staticMap;
+    std::string m_staticMapBuffer;     // SensorView without static content (before the pre-filter)
+    fmi2Integer m_staticMapBytesStripped = 0;
+    bool m_staticMapWarned = false;
+    std::string m_osi_in_filtered;     // Reduced input handed to Python (staged for the worker in deadline mode)
+    std::shared_ptr<FrenetEngine> m_frenet; // Python: self.frenet, follows the map (StaticMapCache only)
+
+    // Lidar point cloud: reflections reduced natively and stripped off the SensorView
+    fmi2Boolean m_lidarEnabled = fmi2False;
+    std::shared_ptr<LidarPreprocessor> m_lidar = std::make_shared<LidarPreprocessor>(); // Python: self.lidar
+    std::string m_lidarBuffer;         // SensorView without reflections (before the static map split)
+    fmi2Integer m_lidarReflections = 0; // Last step
+    fmi2Integer m_lidarPoints = 0;
+    unsigned long long m_lidarTotalReflections = 0;
+    unsigned long long m_lidarTotalPoints = 0;
+    bool m_lidarWarned = false;
+
+    // Camera images: views of image_data in the input buffer, valid during update_control()
+    fmi2Boolean m_cameraEnabled = fmi2False;
+    std::shared_ptr<CameraImages> m_camera; // Python: self.camera
+    bool m_cameraWarned = false;
+
+    // Multi-object tracker on the detected objects of the SensorData input
+    fmi2Boolean m_trackingEnabled = fmi2False;
+    std::shared_ptr<ObjectTracker> m_tracker; // Python: self.tracker
+    fmi2Integer m_trackedObjects = 0;         // Confirmed tracks after the last SensorData
+    bool m_trackerWarned = false;
+    fmi2Real m_stepTime = 0.0;                // currentCommunicationPoint of the running step
+
+    // Driving KPIs, accumulated each step and written to KpiSummaryPath at terminate
+    fmi2Boolean m_kpiEnabled = fmi2False;
+    std::string m_kpiSummaryPath = "";        // Empty: no summary file
+    fmi2Real m_kpiHeadwayThreshold = 1.0;     // [s]
+    std::shared_ptr<KpiEngine> m_kpi;         // Python: self.kpi
+    KpiValues m_kpiValues;                    // After the last step, for the outputs
+
+    // Columnar signal log of the outputs, phase timings and Python signals
+    std::string m_signalLogPath = "";         // Empty: no log
+    fmi2Integer m_signalLogBlockRows = 4096;
+    std::shared_ptr<SignalLog> m_signalLog;   // Python: self.signal_log
+    PhaseTimings m_phaseTimings;              // Of the running step, zero without a Python result
+
+    // Native views of the moving objects, extracted once per step
+    MovingObjects m_movingObjects;
+    bool m_movingObjectsWarned = false;
+    fmi2Boolean m_objectIndexEnabled = fmi2False;
+    std::shared_ptr<ObjectIndex> m_objectIndex; // Python: self.object_index
+    fmi2Boolean m_egoFrameEnabled = fmi2False;
+    std::shared_ptr<EgoFrame> m_egoFrame;       // Python: self.ego_frame
+    bool m_egoFrameWarned = false;
+    fmi2Boolean m_predictionEnabled = fmi2False;
+    std::shared_ptr<TrajectoryPredictor> m_predictor; // Python: self.predictor
+
+    // Sampling-based planner, rollouts on its own worker pool
+    fmi2Boolean m_plannerEnabled = fmi2False;
+    fmi2Integer m_plannerThreads = 0;  // Including the calling thread, 0: one per hardware thread
+    std::shared_ptr<MppiPlanner> m_planner; // Python: self.planner
+
+    // Bird's-eye occupancy grid around the host (static layers from the static map cache)
+    fmi2Boolean m_occupancyEnabled = fmi2False;
+    fmi2Real m_occupancyResolution = 0.2; // [m] per cell
+    fmi2Real m_occupancySize = 80.0;      // [m] side length
+    std::shared_ptr<OccupancyGrid> m_occupancyGrid; // Python: self.occupancy_grid
+    bool m_occupancyWarned = false;
+
+    // SensorView input size statistics
+    unsigned long long m_svInputSteps = 0;
+    unsigned long long m_svInputBytes = 0;
+    size_t m_svInputMaxBytes = 0;
+    fmi2Real m_svMeanBytes = 0.0;
+
+    // Step Deadline Watchdog
+    std::unique_ptr<PythonStepWorker> m_stepWorker;
+    std::string m_osi_in_staging;      // Copy of the host input owned by the worker job, base of the outputs
+    StepResult m_asyncResult;          // Written by the worker job only
+    StepResult m_syncResult;           // Reused by the synchronous path
+    FallbackController m_fallback;
+    fmi2Integer m_deadlineMissCount = 0;
+    bool m_inFallback = false;
+
+    // Real-time Profile
+    std::vector<int> m_rtCores;
+    bool m_rtApplied = false;
+    unsigned long long m_stepCount = 0;
+    fmi2Integer m_rtStepAllocCount = 0; // C++ heap allocations in steady-state doStep
+
+    // Python GC Statistics
+    unsigned long long m_gcStepCounter = 0;
+    unsigned long long m_gcScheduledCount = 0;
+    bool m_gcCollectionPending = false;  // Submitted to the step worker after the last step
+    bool m_gcOverrunWarned = false;
+    unsigned long long m_gcLastCollections = 0;
+    long long m_gcLastPauseNs = 0;
+    fmi2Integer m_gcStepCollections = 0; // Collections since the previous doStep
+    fmi2Real m_gcStepPauseMs = 0.0;      // GC pause since the previous doStep
+    fmi2Real m_gcMaxStepPauseMs = 0.0;
+
+    // Native OSI decode (OsiDecodeMode = 1); null when Python receives bytes
+    std::unique_ptr<SharedOsiMessage> m_sharedSensorView;
+    py::object m_sensorViewMemory;     // OsiDecodeMode = 2, released after update_control
+
+    // Additional OSMP inputs, passed to update_control() in the channels dict
+    enum { CH_SENSOR_DATA = 0, CH_GROUND_TRUTH, CH_TRAFFIC_COMMAND, CH_COUNT };
+    OsiInputChannel m_inputChannels[CH_COUNT] = {
+        { "sensor_data", "osi3.SensorData" },
+        { "ground_truth", "osi3.GroundTruth" },
+        { "traffic_command", "osi3.TrafficCommand" }
+    };
+    bool m_multiInput = false;         // Set once any channel is connected
 
     // Python Objects
     py::object m_pyController;
     bool m_pythonInitialized = false;
 
+    // Step helpers
+    fmi2Status doStepRealtime(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize);
+    fmi2Status doStepImpl(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize);
+    fmi2Status doStepWithDeadline(const void* rawPtr, fmi2Real communicationStepSize);
+    void runAsyncPythonStep();
+    void initializeOsiDecode();
+    void buildSensorViewConfigRequest();
+    void reduceSensorView(const char* data, size_t size, std::string& out);
+    void preprocessLidar(const char* data, size_t size, std::string& out);
+    void splitStaticMap(const char* data, size_t size, std::string& out);
+    void prefilterSensorView(const char* data, size_t size, std::string& out);
+    void updateNativeObjects(const char* data, size_t size);
+    void locateCameraImages(const char* data, size_t size);
+    void updateTracker();
+    void updateKpis(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize);
+    void openSignalLog();
+    void logSignals(fmi2Real currentCommunicationPoint, double stepUs);
+    py::object makePythonInput(const char* data, size_t size);
+    void prepareInputChannels(bool stage);
+    void decodeInputChannels();
+    py::object callUpdateControl(const py::object& data);
+    void releaseInputViews();
+    void parseControlResult(const py::object& result, StepResult& out);
+    void buildOsiOutputs(const char* input, size_t size, StepResult& result);
+    void applyStepResult(StepResult& result);
+    void applyRealtimeProfile();
+    void applyRealtimeWorkerThread();
+    void applyRealtimePlannerThread(size_t worker);
+    void applyMemoryPolicy();
+    bool gcCollectionDue();
+    void updateGcStepStats();
+    void applyFallback(fmi2Real communicationStepSize);
+    ControlCommand currentCommand() const;
+
     // Helper functions
     void* decodePointer(fmi2Integer hi, fmi2Integer lo);
     void encodePointer(const void* ptr, fmi2Integer& hi, fmi2Integer& lo);
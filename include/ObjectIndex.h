@@ -0,0 +1,106 @@
+#ifndef OBJECT_INDEX_H
+#define OBJECT_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "FrenetEngine.h"
+#include "MovingObjects.h"
+
+// Spatial index over the moving objects of the current step: a uniform grid
+// keyed by the cell of each object's center, updated incrementally (an object
+// only changes cells when it crosses a cell border). Footprints are the
+// oriented bounding boxes; queries widen their search by the largest footprint.
+// Results are object ids and refer to the objects of the last update().
+class ObjectIndex {
+public:
+    struct Neighbours {            // Result of nearest(), k entries per query point
+        std::vector<uint64_t> id;  // 0: fewer than k objects
+        std::vector<double> distance; // Footprint distance [m], infinity if no object
+    };
+
+    struct Selection {             // Result of inLane() / inCorridor(), sorted by longitudinal position
+        std::vector<uint64_t> id;
+        std::vector<double> longitudinal; // Lane: s relative to the query; corridor: x in the corridor frame
+        std::vector<double> lateral;      // Lane: t of the object; corridor: y in the corridor frame
+        void clear() { id.clear(); longitudinal.clear(); lateral.clear(); }
+    };
+
+    explicit ObjectIndex(std::shared_ptr<FrenetEngine> frenet = nullptr);
+
+    // Take over the objects of this step (called before Python runs)
+    void update(const MovingObjects& objects);
+
+    size_t count() const { return m_count; }
+    uint64_t hostId() const { return m_hostId; }
+    size_t lastMoves() const { return m_lastMoves; } // Objects that changed cells in the last update
+
+    // k nearest objects to each query point by footprint distance
+    void nearest(const double* x, const double* y, size_t count, size_t k, bool excludeHost, Neighbours& out);
+
+    // Objects whose center projects onto the lane (or its successors ahead / predecessors
+    // behind in the lane graph) within [s - behind, s + ahead]. Requires the map.
+    void inLane(uint64_t laneId, double s, double ahead, double behind, bool excludeHost, Selection& out);
+
+    // Objects whose footprint overlaps the oriented rectangle from rear behind to front
+    // ahead of (x, y) along heading, half width halfWidth
+    void inCorridor(double x, double y, double heading, double front, double rear, double halfWidth,
+                    bool excludeHost, Selection& out);
+
+private:
+    struct Slot {
+        uint64_t id = 0;
+        bool active = false;
+        unsigned long long seen = 0;      // Step of the last update
+        uint64_t cell = 0;
+        uint32_t posInCell = 0;
+        double x = 0.0, y = 0.0;
+        double cosYaw = 1.0, sinYaw = 0.0;
+        double halfLength = 0.0, halfWidth = 0.0;
+        unsigned long long frenetStep = 0; // Step of the cached projection
+        uint32_t segment = FRENET_NO_SEGMENT;
+        double s = 0.0, t = 0.0;
+        uint32_t lane = ROAD_GRAPH_NO_LANE;
+    };
+
+    struct Hit {
+        double longitudinal;
+        double lateral;
+        uint64_t id;
+        bool operator<(const Hit& other) const {
+            return longitudinal < other.longitudinal || (longitudinal == other.longitudinal && id < other.id);
+        }
+    };
+
+    void insert(uint32_t slot);
+    void remove(uint32_t slot);
+    // Slots of all objects whose center lies in the cells overlapping the box
+    void gather(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>& out) const;
+    bool excluded(const Slot& slot, bool excludeHost) const { return excludeHost && m_hostId != 0 && slot.id == m_hostId; }
+    const Slot& projected(uint32_t slot);
+    void output(Selection& out);
+
+    std::shared_ptr<FrenetEngine> m_frenet;
+    const RoadGraph* m_frenetGraph = nullptr; // Graph of the cached projections
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    std::unordered_map<uint64_t, uint32_t> m_slotById;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+    unsigned long long m_step = 0;
+    size_t m_count = 0;
+    size_t m_lastMoves = 0;
+    uint64_t m_hostId = 0;
+    double m_maxExtent = 0.0;        // Largest half diagonal of a footprint
+    double m_minX = 0.0, m_minY = 0.0, m_maxX = 0.0, m_maxY = 0.0; // Bounds of the centers
+
+    // Scratch buffers reused across queries
+    std::vector<uint32_t> m_candidates;
+    std::vector<Hit> m_hits;
+    std::vector<std::pair<uint32_t, double>> m_lanes; // Lane index and s offset of its start for inLane()
+};
+
+#endif // OBJECT_INDEX_H
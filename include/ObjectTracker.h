@@ -0,0 +1,125 @@
+#ifndef OBJECT_TRACKER_H
+#define OBJECT_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SimdKernels.h"
+
+struct TrackerSettings {
+    double accelerationStd = 2.0;    // [m/s^2] process noise (white acceleration)
+    double measurementStd = 0.5;     // [m] position noise of the detections
+    double velocityStd = 5.0;        // [m/s] initial velocity uncertainty of new tracks
+    double gate = 9.21;              // Squared Mahalanobis distance (chi-square, 2 DOF, 99 %)
+    size_t confirmHits = 3;          // Associated detections until a track is confirmed
+    size_t maxMisses = 5;            // Consecutive steps without a detection until a track is deleted
+    bool greedy = false;             // Greedy assignment by distance instead of the Hungarian method
+};
+
+// Statistics of the last update() call
+struct TrackerStats {
+    size_t detections = 0;
+    size_t assigned = 0;
+    size_t created = 0;
+    size_t deleted = 0;
+    double updateTimeUs = 0.0;
+};
+
+// Multi-object tracker for SensorData.moving_object, read at the wire level.
+// One constant-velocity Kalman filter per track in structure-of-arrays form:
+// all tracks are predicted and updated by the batched Simd::kalman* kernels,
+// detections are gated by Mahalanobis distance and assigned with the
+// Hungarian method (or greedily). With SensorData.host_vehicle_location the
+// detections are moved from the host vehicle frame to the global frame, so
+// that the tracks do not follow the host's own motion; otherwise they stay in
+// the frame of the detections. Tentative tracks are deleted on their first
+// miss, confirmed ones after maxMisses.
+class ObjectTracker {
+public:
+    TrackerSettings settings;
+
+    // Associate the detections of one SensorData message. time: timestamp of the
+    // message, or fallbackTime [s] if it has none. Returns false with a message in
+    // error if the input is malformed (the tracks are then unchanged).
+    bool update(const char* sensorData, size_t size, double fallbackTime, std::string& error);
+    void reset();
+
+    size_t count() const { return m_id.size(); }
+    double time() const { return m_time; }
+    bool global() const { return m_global; } // Last detections were moved to the global frame
+    const TrackerStats& stats() const { return m_stats; }
+    unsigned long long created() const { return m_nextId - 1; }
+
+    // Tracks, structure of arrays (in creation order)
+    const std::vector<uint64_t>& id() const { return m_id; }
+    const std::vector<double>& x() const { return m_x; }
+    const std::vector<double>& y() const { return m_y; }
+    const std::vector<double>& vx() const { return m_vx; }
+    const std::vector<double>& vy() const { return m_vy; }
+    const std::vector<double>& covariance(size_t k) const { return m_p[k]; } // See Simd::KalmanArrays
+    const std::vector<double>& yaw() const { return m_yaw; }       // Last associated detection
+    const std::vector<double>& length() const { return m_length; }
+    const std::vector<double>& width() const { return m_width; }
+    const std::vector<double>& existence() const { return m_existence; }
+    const std::vector<uint64_t>& sensorId() const { return m_sensorId; } // header.tracking_id
+    const std::vector<uint32_t>& age() const { return m_age; }    // Steps since creation
+    const std::vector<uint32_t>& hits() const { return m_hits; }
+    const std::vector<uint32_t>& misses() const { return m_misses; }
+    const std::vector<uint8_t>& confirmed() const { return m_confirmed; }
+    const std::vector<int32_t>& detection() const { return m_detection; } // Index in this step's message, -1: none
+
+private:
+    struct Detections {
+        std::vector<double> x, y, vx, vy, yaw, length, width, existence;
+        std::vector<uint64_t> sensorId;
+        std::vector<uint8_t> hasVelocity;
+    };
+
+    bool parse(const char* sensorData, size_t size, double fallbackTime, std::string& error);
+    Simd::KalmanArrays arrays();
+    void gate();
+    void assignHungarian();
+    void solveCluster();
+    void assignGreedy();
+    void createTrack(size_t j);
+    void removeTracks();
+
+    // Tracks
+    std::vector<uint64_t> m_id;
+    std::vector<double> m_x, m_y, m_vx, m_vy;
+    std::vector<double> m_p[Simd::KALMAN_COVARIANCE_SIZE];
+    std::vector<double> m_yaw, m_length, m_width, m_existence;
+    std::vector<uint64_t> m_sensorId;
+    std::vector<uint32_t> m_age, m_hits, m_misses;
+    std::vector<uint8_t> m_confirmed;
+    std::vector<int32_t> m_detection;
+    uint64_t m_nextId = 1;
+    double m_time = 0.0;
+    bool m_hasTime = false;
+    bool m_global = false;
+
+    // Per update: detections, gated costs (tracks x detections), assignment
+    Detections m_det;
+    double m_stepTime = 0.0;
+    std::vector<double> m_cost;
+    std::vector<int32_t> m_trackOf;      // Per detection, -1: unassigned
+    std::vector<double> m_zx, m_zy;      // Per track: associated measurement
+    std::vector<uint8_t> m_has;
+    std::vector<uint8_t> m_remove;
+
+    // Hungarian method scratch: clusters of the gate graph, cluster costs, potentials,
+    // matching and augmenting path
+    std::vector<uint8_t> m_trackCluster, m_detCluster;
+    std::vector<uint32_t> m_clusterTracks, m_clusterDets;
+    std::vector<double> m_sub;
+    std::vector<double> m_u, m_v, m_minv;
+    std::vector<int32_t> m_match, m_way;
+    std::vector<uint8_t> m_used;
+    std::vector<std::pair<double, uint32_t>> m_pairs; // Greedy: cost, track * detections + detection
+
+    TrackerStats m_stats;
+};
+
+#endif // OBJECT_TRACKER_H
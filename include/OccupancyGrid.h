@@ -0,0 +1,87 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MovingObjects.h"
+
+enum OccupancyChannel : size_t {
+    OCCUPANCY_MOVING = 0,        // Moving objects except the host: 1 inside the footprint
+    OCCUPANCY_VELOCITY_X = 1,    // Their velocity relative to the host [m/s], global axes
+    OCCUPANCY_VELOCITY_Y = 2,
+    OCCUPANCY_STATIONARY = 3,    // Stationary objects of the static map
+    OCCUPANCY_LANE_BOUNDARY = 4, // Lane boundary lines of the static map
+    OCCUPANCY_DRIVABLE = 5,      // Driving / intersection lanes between their boundaries
+    OCCUPANCY_CHANNELS = 6
+};
+
+const char* occupancyChannelName(size_t channel); // "moving", "velocity_x", ...
+
+// Multi-channel bird's-eye grid around the host vehicle, float32 [channel][row][column].
+// The grid is aligned with the global axes (row: +y, column: +x) and snapped to
+// whole cells, so that following the host only scrolls it: the static channels
+// are moved in place and drawn only in the uncovered strips, the object channels
+// are redrawn in the cells they covered. The buffer is allocated once and keeps
+// its address, so Python can view it without copying.
+class OccupancyGrid {
+public:
+    OccupancyGrid(double resolution, double size);
+
+    // Static layers from the static GroundTruth content (serialized GroundTruth)
+    // of the given map version; redrawn at the next update()
+    void setMap(unsigned long long version, const std::string& groundTruth);
+    unsigned long long mapVersion() const { return m_mapVersion; }
+
+    // Centre on the host and draw the objects. Without host the static layers
+    // stay where they are and the object channels are empty; returns false.
+    bool update(const MovingObjects& objects);
+
+    const float* data() const { return m_data.data(); }
+    size_t cells() const { return m_cells; }    // Rows = columns
+    double resolution() const { return m_resolution; }
+    double originX() const { return (double)m_originColumn * m_resolution; } // Lower left corner of cell (0, 0)
+    double originY() const { return (double)m_originRow * m_resolution; }
+    bool hostFound() const { return m_hostFound; }
+
+private:
+    // Cell rectangle [c0, c1) x [r0, r1)
+    struct Clip {
+        long long c0, c1, r0, r1;
+    };
+    struct Shapes { // Polygons or polylines with their bounding boxes
+        std::vector<double> x, y;
+        std::vector<size_t> start; // Element i: points [start[i], start[i + 1])
+        std::vector<double> minX, minY, maxX, maxY;
+        void clear();
+        void add(const double* px, const double* py, size_t count);
+    };
+
+    float* channel(size_t c) { return m_data.data() + c * m_cells * m_cells; }
+    void scroll(long long dc, long long dr);
+    void drawStatic(const Clip& clip);
+    void clearRect(size_t c, const Clip& clip);
+    // Even-odd fill of the polygon, cells whose centre is inside
+    void fillPolygon(const double* px, const double* py, size_t count, const Clip& clip, const size_t* channels,
+                     const float* values, size_t channelCount);
+    void drawPolyline(const double* px, const double* py, size_t count, const Clip& clip, size_t c);
+    bool overlaps(const Shapes& shapes, size_t i, const Clip& clip) const;
+
+    double m_resolution;
+    size_t m_cells;
+    std::vector<float> m_data;
+    long long m_originColumn = 0; // Global cell index of column 0 / row 0
+    long long m_originRow = 0;
+    bool m_placed = false;        // Static channels drawn for the current origin
+    bool m_hostFound = false;
+
+    unsigned long long m_mapVersion = 0;
+    bool m_mapChanged = false;
+    Shapes m_stationary, m_boundaries, m_drivable;
+
+    std::vector<Clip> m_dirty;    // Cells of the objects drawn at the last update
+    std::vector<double> m_crossings;
+};
+
+#endif // OCCUPANCY_GRID_H
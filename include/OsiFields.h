@@ -0,0 +1,205 @@
+#ifndef OSI_FIELDS_H
+#define OSI_FIELDS_H
+
+#include <cstdint>
+
+// Field numbers of the OSI 3.5.0 messages handled at the wire level
+// (see thirdparty/open-simulation-interface-3.5.0/*.proto)
+namespace OsiFields {
+
+namespace SensorView {
+constexpr uint32_t Version = 1;
+constexpr uint32_t Timestamp = 2;
+constexpr uint32_t GlobalGroundTruth = 7;
+constexpr uint32_t HostVehicleId = 8;
+constexpr uint32_t LidarSensorView = 1002;
+constexpr uint32_t CameraSensorView = 1003;
+}
+
+namespace GroundTruth {
+constexpr uint32_t HostVehicleId = 3;
+constexpr uint32_t StationaryObject = 4;
+constexpr uint32_t MovingObject = 5;
+constexpr uint32_t TrafficSign = 6;
+constexpr uint32_t TrafficLight = 7;
+constexpr uint32_t RoadMarking = 8;
+constexpr uint32_t LaneBoundary = 9;
+constexpr uint32_t Lane = 10;
+constexpr uint32_t CountryCode = 13;
+constexpr uint32_t ProjString = 14;
+constexpr uint32_t MapReference = 15;
+constexpr uint32_t ModelReference = 16;
+constexpr uint32_t ReferenceLine = 17;
+constexpr uint32_t LogicalLaneBoundary = 18;
+constexpr uint32_t LogicalLane = 19;
+}
+
+namespace SensorData {
+constexpr uint32_t Timestamp = 2;
+constexpr uint32_t HostVehicleLocation = 3;   // BaseMoving in the global frame
+constexpr uint32_t MovingObject = 13;
+}
+
+namespace DetectedMovingObject {
+constexpr uint32_t Header = 1;
+constexpr uint32_t Base = 2;                  // Relative to the host vehicle frame
+}
+
+namespace DetectedItemHeader {
+constexpr uint32_t TrackingId = 1;
+constexpr uint32_t ExistenceProbability = 3;
+}
+
+namespace MovingObject {
+constexpr uint32_t Id = 1;
+constexpr uint32_t Base = 2;
+constexpr uint32_t Type = 3;
+}
+
+namespace StationaryObject {
+constexpr uint32_t Id = 1;
+constexpr uint32_t Base = 2;
+constexpr uint32_t Classification = 3;
+}
+
+namespace StationaryObjectClassification {
+constexpr uint32_t Type = 1;
+}
+
+namespace TrafficSign {
+constexpr uint32_t MainSign = 2;
+}
+
+namespace MainSign {
+constexpr uint32_t Base = 1;
+}
+
+namespace TrafficLight {                // also RoadMarking
+constexpr uint32_t Base = 2;
+}
+
+namespace LaneBoundary {
+constexpr uint32_t Id = 1;
+constexpr uint32_t BoundaryLine = 2;
+}
+
+namespace BoundaryPoint {
+constexpr uint32_t Position = 1;
+}
+
+namespace Lane {
+constexpr uint32_t Id = 1;
+constexpr uint32_t Classification = 2;
+}
+
+namespace LaneClassification {
+constexpr uint32_t Type = 1;                 // TYPE_DRIVING = 2, TYPE_INTERSECTION = 4
+constexpr uint32_t Centerline = 3;
+constexpr uint32_t LeftAdjacentLaneId = 5;
+constexpr uint32_t RightAdjacentLaneId = 6;
+constexpr uint32_t LanePairing = 7;
+constexpr uint32_t RightLaneBoundaryId = 8;
+constexpr uint32_t LeftLaneBoundaryId = 9;
+constexpr uint32_t FreeLaneBoundaryId = 10;
+}
+
+namespace LanePairing {
+constexpr uint32_t AntecessorLaneId = 1;
+constexpr uint32_t SuccessorLaneId = 2;
+}
+
+namespace BaseMoving {                  // BaseStationary: dimension = 1, position = 2, orientation = 3
+constexpr uint32_t Dimension = 1;
+constexpr uint32_t Position = 2;
+constexpr uint32_t Orientation = 3;
+constexpr uint32_t Velocity = 4;
+constexpr uint32_t Acceleration = 5;
+constexpr uint32_t OrientationRate = 6;
+}
+
+namespace Vector3d {                    // also Dimension3d (length, width, height), Orientation3d (roll, pitch, yaw)
+constexpr uint32_t X = 1;
+constexpr uint32_t Y = 2;
+constexpr uint32_t Z = 3;
+}
+
+namespace Identifier {
+constexpr uint32_t Value = 1;
+}
+
+namespace TrafficUpdate {
+constexpr uint32_t Version = 1;
+constexpr uint32_t Timestamp = 2;
+constexpr uint32_t Update = 3;
+constexpr uint32_t InternalState = 4;
+}
+
+namespace HostVehicleData {
+constexpr uint32_t VehiclePowertrain = 4;   // pedal_position_acceleration = 1, gear_transmission = 3
+constexpr uint32_t VehicleBrakeSystem = 5;  // pedal_position_brake = 1
+constexpr uint32_t VehicleSteering = 6;     // vehicle_steering_wheel = 1 { angle = 1 }
+constexpr uint32_t HostVehicleId = 11;
+}
+
+namespace SensorViewConfiguration {
+constexpr uint32_t Version = 1;
+constexpr uint32_t FieldOfViewHorizontal = 5;
+constexpr uint32_t FieldOfViewVertical = 6;
+constexpr uint32_t Range = 7;
+constexpr uint32_t UpdateCycleTime = 8;
+constexpr uint32_t OmitStaticInformation = 11;
+constexpr uint32_t GenericSensorViewConfiguration = 1000; // radar 1001, lidar 1002, camera 1003, ultrasonic 1004
+}
+
+namespace SensorTypeViewConfiguration {  // Generic/Radar/Lidar/Camera/UltrasonicSensorViewConfiguration
+constexpr uint32_t FieldOfViewHorizontal = 4;
+constexpr uint32_t FieldOfViewVertical = 5;
+}
+
+namespace LidarSensorView {
+constexpr uint32_t ViewConfiguration = 1;
+constexpr uint32_t Reflection = 2;
+}
+
+namespace LidarReflection {
+constexpr uint32_t SignalStrength = 1;
+constexpr uint32_t TimeOfFlight = 2;
+}
+
+namespace LidarSensorViewConfiguration {
+constexpr uint32_t MountingPosition = 2;
+constexpr uint32_t Directions = 11;
+constexpr uint32_t Timings = 12;
+}
+
+namespace CameraSensorView {
+constexpr uint32_t ViewConfiguration = 1;
+constexpr uint32_t ImageData = 2;
+}
+
+namespace CameraSensorViewConfiguration {
+constexpr uint32_t SensorId = 1;
+constexpr uint32_t NumberOfPixelsHorizontal = 6;
+constexpr uint32_t NumberOfPixelsVertical = 7;
+constexpr uint32_t ChannelFormat = 8;        // repeated enum, packed or not
+}
+
+namespace MountingPosition {
+constexpr uint32_t Position = 1;
+constexpr uint32_t Orientation = 2;
+}
+
+namespace InterfaceVersion {
+constexpr uint32_t VersionMajor = 1;
+constexpr uint32_t VersionMinor = 2;
+constexpr uint32_t VersionPatch = 3;
+}
+
+namespace Timestamp {
+constexpr uint32_t Seconds = 1;
+constexpr uint32_t Nanos = 2;
+}
+
+} // namespace OsiFields
+
+#endif // OSI_FIELDS_H
@@ -0,0 +1,10 @@
+#ifndef OSI_FINGERPRINT_H
+#define OSI_FINGERPRINT_H
+
+#include <cstddef>
+
+// 64-bit content fingerprint of serialized OSI bytes, used for change detection
+// and to validate cached data against its source
+unsigned long long osiFingerprint(const void* data, size_t size);
+
+#endif // OSI_FINGERPRINT_H
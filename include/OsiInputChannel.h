@@ -0,0 +1,77 @@
+#ifndef OSI_INPUT_CHANNEL_H
+#define OSI_INPUT_CHANNEL_H
+
+#include <memory>
+#include <string>
+#include "fmi2TypesPlatform.h"
+#include "SharedOsiMessage.h"
+
+// How an OSI input is handed to update_control(); selected per channel
+// (OsiDecodeMode for the SensorView, *DecodeMode for the other channels)
+enum class OsiDecodeMode : int {
+    Raw    = 0, // bytes (one copy)
+    Native = 1, // parsed once in C++ and shared with Python (SharedOsiMessage)
+    View   = 2  // read-only memoryview over the input buffer (no copy), released after the call
+};
+
+// OSMP pointer triple of one input
+struct OsmpPointer {
+    fmi2Integer baseLo = 0;
+    fmi2Integer baseHi = 0;
+    fmi2Integer size = 0;
+
+    bool connected() const { return size > 0 && baseLo != 0; }
+};
+
+// Additional OSMP input (SensorData, GroundTruth, TrafficCommand) passed to
+// update_control() in the channels dict. Unchanged inputs are detected by size
+// and content fingerprint and passed as None, without copy or decode.
+class OsiInputChannel {
+public:
+    OsiInputChannel(const char* key, const char* messageType);
+
+    OsmpPointer pointer;
+    fmi2Integer decodeMode = (fmi2Integer)OsiDecodeMode::Raw;
+
+    const char* key() const { return m_key; }
+
+    // Set up native decode if selected; falls back to Raw (requires the GIL)
+    void initialize();
+
+    // Change detection for this step. data is the decoded host pointer or null if
+    // not connected. stage: copy changed input, as the host buffer is only valid
+    // during doStep (deadline mode). Returns true if the input changed.
+    bool prepare(const void* data, bool stage);
+
+    // Native decode of a changed input (no GIL needed)
+    bool decode();
+
+    // Value for the channels dict: None if unchanged or not connected (requires the GIL)
+    py::object pythonValue();
+
+    // Invalidate a memoryview handed out by pythonValue() (requires the GIL)
+    void releaseView();
+
+    // Input of this step if it changed (staged copy in deadline mode), for native consumers
+    bool changed() const { return m_changed; }
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const char* m_key;
+    std::string m_messageType;
+    std::unique_ptr<SharedOsiMessage> m_shared;
+
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_changed = false;
+    long long m_lastSize = -1;
+    unsigned long long m_lastFingerprint = 0;
+    std::string m_staging;
+    py::object m_view;
+};
+
+// Release a memoryview over a step-local buffer and reset view (requires the GIL)
+void releaseMemoryView(py::object& view, const char* name);
+
+#endif // OSI_INPUT_CHANNEL_H
@@ -0,0 +1,66 @@
+#ifndef OSI_PATCH_H
+#define OSI_PATCH_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "OsiWire.h"
+
+// Wire-level edits of a serialized OSI message (delta output of update_control).
+// Only the messages on an edit path are rewritten; all other byte ranges of the
+// input are copied unchanged.
+namespace OsiPatch {
+
+// One step of an edit path: field number and occurrence of that field in the
+// parent message (index -1: singular field / all occurrences)
+struct PathElement {
+    uint32_t field = 0;
+    int index = -1;
+};
+
+enum class Op {
+    Set,    // Replace the field at path (added at the end of its parent if missing)
+    Remove, // Drop the element at path (index -1: all occurrences)
+    Append  // Add an element to the repeated field at path
+};
+
+struct Edit {
+    Op op = Op::Set;
+    std::vector<PathElement> path;
+    OsiWire::WireType type = OsiWire::WireType::Varint;
+    uint64_t scalar = 0; // Varint, Fixed64 and Fixed32 values
+    std::string bytes;   // LengthDelimited value (string, bytes or serialized sub-message)
+};
+
+// Applies edit lists. The buffers for each nesting level are kept between calls,
+// so that patching allocates nothing once the first steps have sized them.
+class Patcher {
+public:
+    // Apply edits to input and write the result to out (cleared first; capacity is reused).
+    // Returns false with a message in error if the input is malformed or a path does not exist.
+    bool apply(const char* input, size_t size, const std::vector<Edit>& edits,
+               std::string& out, std::string& error);
+
+private:
+    // State of the message being rewritten at one nesting level
+    struct Level {
+        std::string sub;                                  // Rewritten sub-message
+        std::vector<char> handled;                        // Per edit of the level
+        std::vector<std::pair<uint32_t, int>> occurrences; // Field number, last occurrence
+        std::vector<const Edit*> nested;                  // Edits passed to the next level
+    };
+
+    bool patchMessage(const char* data, size_t size, const std::vector<const Edit*>& edits,
+                      size_t depth, std::string& out, std::string& error);
+
+    std::vector<const Edit*> m_topLevel;
+    std::vector<Level> m_levels; // Grows to the deepest edit path seen
+};
+
+// Single call with a temporary Patcher
+bool apply(const char* input, size_t size, const std::vector<Edit>& edits,
+           std::string& out, std::string& error);
+
+} // namespace OsiPatch
+
+#endif // OSI_PATCH_H
@@ -0,0 +1,73 @@
+#ifndef OSI_WIRE_H
+#define OSI_WIRE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Minimal protobuf wire-format reader/writer for working on serialized OSI
+// messages without generated code (no decode of untouched fields)
+namespace OsiWire {
+
+enum class WireType : int {
+    Varint          = 0,
+    Fixed64         = 1,
+    LengthDelimited = 2,
+    StartGroup      = 3, // Not used by OSI, rejected by Reader
+    EndGroup        = 4,
+    Fixed32         = 5
+};
+
+// One field of a message. [begin, end) covers tag and value, so unmodified
+// fields can be copied verbatim.
+struct Field {
+    uint32_t number = 0;
+    WireType type = WireType::Varint;
+    uint64_t varint = 0;        // Varint, Fixed64 and Fixed32 values
+    const char* data = nullptr; // LengthDelimited payload
+    size_t size = 0;
+    const char* begin = nullptr;
+    const char* end = nullptr;
+};
+
+// Iterates over the top-level fields of one serialized message
+class Reader {
+public:
+    Reader(const char* data, size_t size);
+
+    // Returns false at the end of the message or on malformed input (see ok())
+    bool next(Field& field);
+    bool ok() const { return m_ok; }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+    bool m_ok = true;
+};
+
+bool readVarint(const char*& pos, const char* end, uint64_t& value);
+
+size_t varintSize(uint64_t value);
+void writeVarint(std::string& out, uint64_t value);
+void writeTag(std::string& out, uint32_t number, WireType type);
+void writeVarintField(std::string& out, uint32_t number, uint64_t value);
+void writeFixed64Field(std::string& out, uint32_t number, uint64_t value);
+void writeFixed32Field(std::string& out, uint32_t number, uint32_t value);
+void writeDoubleField(std::string& out, uint32_t number, double value);
+void writeLengthDelimited(std::string& out, uint32_t number, const char* data, size_t size);
+
+// Value of a double field; 0.0 unless the wire type is Fixed64
+double readDouble(const Field& field);
+
+// osi3.Identifier: value is 0 if unset. Returns false, with value 0, if the field
+// is not a well-formed message.
+bool readIdentifier(const Field& field, uint64_t& value);
+
+// osi3.Vector3d, Dimension3d and Orientation3d: three doubles with field numbers 1..3,
+// 0.0 where unset. Returns false, with all zero, if the field is not a well-formed
+// message. The values are not checked for finiteness.
+bool readVector3d(const Field& field, double v[3]);
+
+} // namespace OsiWire
+
+#endif // OSI_WIRE_H
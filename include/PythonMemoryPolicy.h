@@ -0,0 +1,66 @@
+#ifndef PYTHON_MEMORY_POLICY_H
+#define PYTHON_MEMORY_POLICY_H
+
+#include <atomic>
+#include <chrono>
+
+// Memory policies for the embedded interpreter: allocator selection and
+// cyclic GC control. GC state is process-wide, like the interpreter itself.
+namespace PythonMemory {
+
+// Selected by the PythonAllocator parameter
+enum class AllocatorMode : int {
+    Default  = 0, // pymalloc
+    Malloc   = 1, // System malloc (PYMEM_ALLOCATOR_MALLOC)
+    Mimalloc = 2  // mimalloc, requires a build with GTDC_WITH_MIMALLOC
+};
+
+// Selected by the PythonGcMode parameter
+enum class GcMode : int {
+    Automatic = 0, // CPython default thresholds
+    Manual    = 1  // Automatic GC disabled, collections scheduled by the controller
+};
+
+// Pre-initialize Python with the requested allocator.
+// Must be called before the interpreter is created; returns false if the
+// mode is not available in this build (the default allocator is kept).
+bool configureAllocator(AllocatorMode mode);
+
+// Collects GC pause statistics through gc.callbacks
+class GcMonitor {
+public:
+    static GcMonitor& instance();
+
+    // Register the gc.callbacks hook (requires the GIL, idempotent)
+    void install();
+
+    unsigned long long collections() const { return m_collections.load(std::memory_order_relaxed); }
+    long long pauseNs() const { return m_pauseNs.load(std::memory_order_relaxed); }
+
+    // Called from the gc.callbacks hook with the GIL held
+    void onStart();
+    void onStop();
+
+private:
+    GcMonitor() = default;
+
+    bool m_installed = false;
+    std::chrono::steady_clock::time_point m_start;
+    std::atomic<unsigned long long> m_collections{0};
+    std::atomic<long long> m_pauseNs{0};
+};
+
+// Collect garbage and move all surviving objects to the permanent generation (requires the GIL)
+void freeze();
+
+// Enable or disable automatic collection (requires the GIL)
+void setAutomaticGc(bool enabled);
+
+// Run one scheduled collection (requires the GIL). Escalates to older
+// generations like the default thresholds: every 10th call collects
+// generation 1, every 100th generation 2.
+void collectScheduled(unsigned long long& scheduledCount);
+
+} // namespace PythonMemory
+
+#endif // PYTHON_MEMORY_POLICY_H
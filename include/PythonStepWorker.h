@@ -0,0 +1,50 @@
+#ifndef PYTHON_STEP_WORKER_H
+#define PYTHON_STEP_WORKER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Single background thread that runs one Python step job at a time.
+// doStep() submits a job and waits for it with a deadline; a job that
+// overruns keeps running and the worker stays busy until it returns.
+class PythonStepWorker {
+public:
+    // threadInit runs once on the worker thread before the first job
+    // (used to apply CPU affinity and priority of the real-time profile)
+    explicit PythonStepWorker(std::function<void()> threadInit = nullptr);
+    ~PythonStepWorker();
+
+    PythonStepWorker(const PythonStepWorker&) = delete;
+    PythonStepWorker& operator=(const PythonStepWorker&) = delete;
+
+    // Queue a job. Returns false if the previous job is still running.
+    bool submit(std::function<void()> job);
+
+    // Wait until the current job has finished. Returns false on timeout.
+    bool waitFor(std::chrono::microseconds timeout);
+
+    // Block until the current job has finished
+    void waitIdle();
+
+    bool busy() const;
+
+    // Stop the thread after the current job. Caller must not hold the GIL.
+    void stop();
+
+private:
+    void run();
+
+    std::function<void()> m_threadInit;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cvJob;
+    std::condition_variable m_cvDone;
+    std::function<void()> m_job;
+    bool m_busy = false;
+    bool m_stop = false;
+};
+
+#endif // PYTHON_STEP_WORKER_H
@@ -0,0 +1,92 @@
+#ifndef QP_SOLVER_H
+#define QP_SOLVER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class QpStatus {
+    Solved = 0,
+    MaxIterations = 1, // Not converged; the solution is the last iterate
+    InvalidInput = 2,  // Bounds crossed, NaN in the input, or no setup
+    NotConvex = 3      // Factorization failed: P clearly not positive semidefinite
+};
+
+const char* qpStatusName(QpStatus status); // "solved", "max_iterations", ...
+
+struct QpSettings {
+    double rho = 0.1;           // Initial ADMM step size (adapted during the solve)
+    double sigma = 1e-6;
+    double alpha = 1.6;         // Over-relaxation
+    double epsAbs = 1e-4;
+    double epsRel = 1e-4;
+    int maxIterations = 4000;
+    int scalingIterations = 10; // Ruiz equilibration of P and A (0: none)
+    bool adaptiveRho = true;
+};
+
+struct QpInfo {
+    QpStatus status = QpStatus::InvalidInput;
+    int iterations = 0;
+    int factorizations = 0;     // Of this call (0 if the cached factor was reused)
+    double solveTimeUs = 0.0;
+    double primalResidual = 0.0;
+    double dualResidual = 0.0;
+    double objective = 0.0;     // 0.5 x'Px + q'x
+};
+
+// Dense convex QP
+//     minimize 0.5 x'Px + q'x   subject to  lb <= x <= ub,  lbA <= Ax <= ubA
+// solved with ADMM (the OSQP iteration on a dense Cholesky factor). Sizes and
+// matrices are given once by setup(); solve() changes only the vectors, reuses
+// the factorization and starts from the previous solution. After setup() no
+// memory is allocated. Matrices are row-major; infinite bounds are allowed.
+// The iteration runs on the equilibrated problem (D, E, cost scale c), the
+// termination criteria and all results refer to the original one.
+class QpSolver {
+public:
+    QpSettings settings;
+
+    bool setup(size_t n, size_t m, const double* P, const double* A, std::string& error);
+    // Same sizes, new matrices (e.g. a changed linearization)
+    bool updateMatrices(const double* P, const double* A, std::string& error);
+
+    // Null vectors: q = 0, no bounds
+    const QpInfo& solve(const double* q, const double* lb, const double* ub, const double* lbA, const double* ubA);
+    void resetWarmStart();
+    // Start the next solve from x (duals are kept)
+    void warmStart(const double* x);
+
+    size_t variables() const { return m_n; }
+    size_t constraints() const { return m_m; }
+    const double* solution() const { return m_solution.data(); }
+    const double* dual() const { return m_dual.data(); } // Box rows first, then A rows
+    const QpInfo& info() const { return m_info; }
+
+private:
+    void equilibrate();
+    bool factorize();
+    void solveFactor(double* x) const;
+    void updateRho();
+    void residuals(double& primal, double& dual, double& primalScale, double& dualScale);
+
+    size_t m_n = 0;
+    size_t m_m = 0;
+    std::vector<double> m_P, m_A;     // Scaled: c D P D, E A D
+    std::vector<double> m_D, m_E;     // Variable and constraint row scaling
+    double m_cost = 1.0;
+    std::vector<double> m_K;          // Cholesky factor (lower) of P + sigma I + C' diag(rho) C, C = [I; A]
+    bool m_factorValid = false;
+    bool m_warm = false;
+    double m_rhoBase = 0.0;
+    std::vector<double> m_rho;        // Per row of C
+    std::vector<double> m_rhoFactored;
+    std::vector<double> m_q;          // Scaled linear cost
+    std::vector<double> m_l, m_u;     // Scaled bounds per row of C
+    std::vector<double> m_x, m_z, m_y; // Iterates of the scaled problem
+    std::vector<double> m_solution, m_dual;
+    std::vector<double> m_xt, m_zt, m_rhs, m_Cx, m_Px, m_Cty;
+    QpInfo m_info;
+};
+
+#endif // QP_SOLVER_H
@@ -0,0 +1,48 @@
+#ifndef REALTIME_PROFILE_H
+#define REALTIME_PROFILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Platform helpers for the real-time execution profile
+namespace Realtime {
+
+// Parse a core list such as "2,3" or "4-7". Invalid entries are skipped.
+std::vector<int> parseCoreList(const std::string& spec);
+
+// Pin the calling thread to a single core
+bool pinCurrentThread(int core);
+
+// Raise the calling thread to real-time priority.
+// POSIX: SCHED_FIFO with the given priority. Windows: THREAD_PRIORITY_TIME_CRITICAL.
+bool setRealtimePriority(int priority);
+
+// Touch every page of [ptr, ptr + size) and lock it into physical memory
+bool prefaultAndLock(void* ptr, size_t size);
+
+// Counts C++ heap allocations made by threads with an active AllocationProbe.
+// The global operator new of the Core library is replaced in AllocationCounter.cpp.
+class AllocationProbe {
+public:
+    AllocationProbe();
+    ~AllocationProbe();
+
+    AllocationProbe(const AllocationProbe&) = delete;
+    AllocationProbe& operator=(const AllocationProbe&) = delete;
+
+    static size_t count() { return s_count.load(std::memory_order_relaxed); }
+    static void resetCount() { s_count.store(0, std::memory_order_relaxed); }
+
+    // Called by the replaced operator new
+    static void onAllocation();
+
+private:
+    bool m_wasArmed;
+    static std::atomic<size_t> s_count;
+};
+
+} // namespace Realtime
+
+#endif // REALTIME_PROFILE_H
@@ -0,0 +1,126 @@
+#ifndef ROAD_GRAPH_H
+#define ROAD_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Preprocessed road network: lane graph, centerline arc-length tables and a
+// uniform grid over the centerline segments. Stored as one flat, relocatable
+// image (offsets, no pointers), so that the same bytes are used whether the
+// graph was built in memory or mapped from the on-disk cache.
+//
+// Image layout (little-endian, every array 8-byte aligned):
+//   RoadGraphHeader
+//   RoadGraphLane[laneCount]       sorted by id
+//   uint32_t links[linkCount]      successor / predecessor lane indices
+//   double   pointX[pointCount]    centerline points of all lanes (lane by lane)
+//   double   pointY[pointCount]
+//   double   pointS[pointCount]    arc length from the first point of the lane
+//   uint32_t pointLane[pointCount] lane index of each point
+//   uint32_t cellStart[cellCount + 1], cellSegments[cellEntryCount]
+//                                  grid cell -> segments (index of the first point)
+constexpr char ROAD_GRAPH_MAGIC[8] = { 'G', 'T', 'D', 'C', 'R', 'N', 'G', '\0' };
+constexpr uint32_t ROAD_GRAPH_FORMAT_VERSION = 1; // Incremented on any layout change
+constexpr uint32_t ROAD_GRAPH_NO_LANE = 0xFFFFFFFF;
+
+struct RoadGraphHeader {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t headerSize;
+    uint64_t contentHash;      // RoadNetwork::hash()
+    uint64_t contentSize;      // Size of the static GroundTruth bytes
+    uint64_t contentCheck;     // osiFingerprint() of the static GroundTruth bytes
+    uint64_t imageSize;
+    uint32_t laneCount;
+    uint32_t linkCount;
+    uint32_t pointCount;
+    uint32_t cellEntryCount;
+    uint32_t gridColumns;
+    uint32_t gridRows;
+    double gridMinX;
+    double gridMinY;
+    double cellSize;
+    uint64_t lanesOffset;
+    uint64_t linksOffset;
+    uint64_t pointXOffset;
+    uint64_t pointYOffset;
+    uint64_t pointSOffset;
+    uint64_t pointLaneOffset;
+    uint64_t cellStartOffset;
+    uint64_t cellSegmentsOffset;
+};
+
+struct RoadGraphLane {
+    uint64_t id;
+    uint32_t firstPoint;       // Centerline in pointX/pointY/pointS
+    uint32_t pointCount;
+    uint32_t firstSuccessor;   // links[firstSuccessor .. + successorCount)
+    uint32_t successorCount;
+    uint32_t firstPredecessor;
+    uint32_t predecessorCount;
+    uint32_t left;             // First left / right adjacent lane, ROAD_GRAPH_NO_LANE: none
+    uint32_t right;
+    uint32_t type;             // Lane.Classification.Type
+    uint32_t drivingDirection; // 1: centerline_is_driving_direction
+    double length;             // Centerline arc length [m]
+};
+
+class RoadGraph {
+public:
+    ~RoadGraph();
+
+    RoadGraph(const RoadGraph&) = delete;
+    RoadGraph& operator=(const RoadGraph&) = delete;
+
+    // Preprocess the static GroundTruth content (serialized GroundTruth).
+    // Lanes without an id are skipped; links to unknown lanes are dropped.
+    static std::shared_ptr<const RoadGraph> build(const std::string& groundTruth, unsigned long long hash);
+
+    // Graph of the given content from the cache directory, or built and stored there.
+    // An empty directory disables the cache. fromCache is set if the graph was mapped.
+    static std::shared_ptr<const RoadGraph> open(const std::string& cacheDirectory, const std::string& groundTruth,
+                                                 unsigned long long hash, bool& fromCache);
+
+    // Cache file of the given content: <directory>/<hash>.v<format>.gtrn
+    static std::string cachePath(const std::string& cacheDirectory, unsigned long long hash);
+
+    const RoadGraphHeader& header() const { return *reinterpret_cast<const RoadGraphHeader*>(m_data); }
+    bool mapped() const { return m_mapping != nullptr; }
+
+    uint32_t laneCount() const { return header().laneCount; }
+    uint32_t pointCount() const { return header().pointCount; }
+    const RoadGraphLane* lanes() const { return array<RoadGraphLane>(header().lanesOffset); }
+    const uint32_t* links() const { return array<uint32_t>(header().linksOffset); }
+    const double* pointX() const { return array<double>(header().pointXOffset); }
+    const double* pointY() const { return array<double>(header().pointYOffset); }
+    const double* pointS() const { return array<double>(header().pointSOffset); }
+    const uint32_t* pointLane() const { return array<uint32_t>(header().pointLaneOffset); }
+    const uint32_t* cellStart() const { return array<uint32_t>(header().cellStartOffset); }
+    const uint32_t* cellSegments() const { return array<uint32_t>(header().cellSegmentsOffset); }
+
+    // Index of the lane with the given id, ROAD_GRAPH_NO_LANE if not found
+    uint32_t findLane(uint64_t id) const;
+
+private:
+    struct Mapping;
+
+    RoadGraph() = default;
+
+    template <typename T>
+    const T* array(uint64_t offset) const { return reinterpret_cast<const T*>(m_data + offset); }
+
+    // Map a cache file; null if it is missing or does not match the content
+    static std::shared_ptr<const RoadGraph> load(const std::string& path, const std::string& groundTruth,
+                                                 unsigned long long hash);
+    bool store(const std::string& path) const;
+
+    std::vector<uint64_t> m_image;  // Built in memory (8-byte aligned)
+    Mapping* m_mapping = nullptr;   // Mapped from the cache (read-only)
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+#endif // ROAD_GRAPH_H
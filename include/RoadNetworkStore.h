@@ -0,0 +1,62 @@
+#ifndef ROAD_NETWORK_STORE_H
+#define ROAD_NETWORK_STORE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "PythonEmbed.h"
+#include "RoadGraph.h"
+
+// Immutable static GroundTruth content (road network), shared read-only by all
+// controller instances of the process that receive the same map
+class RoadNetwork {
+public:
+    RoadNetwork(unsigned long long hash, std::vector<uint64_t> ids, std::string bytes);
+    ~RoadNetwork(); // Releases the Python view under the GIL
+
+    RoadNetwork(const RoadNetwork&) = delete;
+    RoadNetwork& operator=(const RoadNetwork&) = delete;
+
+    unsigned long long hash() const { return m_hash; }
+    const std::vector<uint64_t>& ids() const { return m_ids; }
+    const std::string& bytes() const { return m_bytes; }
+
+    // Decoded and indexed Python view (see StaticMapCache), set by the first instance
+    // that needs it. Requires the GIL, which also guards the lazy initialization.
+    py::object view() const { return m_view; }
+    void setView(py::object view) { m_view = std::move(view); }
+
+    // Preprocessed lane graph, built or mapped from the cache directory on first use.
+    // The directory of the first caller applies; empty: no on-disk cache.
+    std::shared_ptr<const RoadGraph> graph(const std::string& cacheDirectory);
+
+private:
+    const unsigned long long m_hash;
+    const std::vector<uint64_t> m_ids; // Field number and id of each static element
+    const std::string m_bytes;         // Static fields as a serialized GroundTruth
+    py::object m_view;
+    std::mutex m_graphMutex;
+    std::shared_ptr<const RoadGraph> m_graph;
+};
+
+// Process-wide store of road networks keyed by content hash. Entries are
+// reference-counted by the instances using them and dropped with the last one.
+class RoadNetworkStore {
+public:
+    static RoadNetworkStore& instance();
+
+    // Network with the given content: shared if another instance already holds it,
+    // created from the static element byte ranges otherwise
+    std::shared_ptr<RoadNetwork> acquire(unsigned long long hash, const std::vector<uint64_t>& ids,
+                                         const std::vector<std::pair<const char*, const char*>>& ranges);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<unsigned long long, std::weak_ptr<RoadNetwork>> m_networks;
+};
+
+#endif // ROAD_NETWORK_STORE_H
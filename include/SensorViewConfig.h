@@ -0,0 +1,35 @@
+#ifndef SENSOR_VIEW_CONFIG_H
+#define SENSOR_VIEW_CONFIG_H
+
+#include <string>
+#include <vector>
+
+// OSMP SensorViewConfiguration negotiation (osi_sensorviewconfiguration.proto).
+// The controller requests only the SensorView content it reads, so that
+// cooperating hosts can send smaller messages.
+struct SensorViewRequest {
+    double fieldOfViewHorizontal = 0.0; // [rad], 0: not specified
+    double fieldOfViewVertical = 0.0;   // [rad], 0: not specified
+    double range = 0.0;                 // [m], 0: not specified
+    double updateCycleTime = 0.0;       // [s], 0: not specified
+    bool omitStaticInformation = false;
+    std::vector<std::string> sensorViews; // "generic", "radar", "lidar", "camera", "ultrasonic"
+};
+
+namespace SensorViewConfig {
+
+// Parse a list such as "generic,radar". Unknown names are skipped with a warning.
+std::vector<std::string> parseSensorViewList(const std::string& spec);
+
+// Serialize the request as osi3::SensorViewConfiguration
+void buildRequest(const SensorViewRequest& request, std::string& out);
+
+// Read the configuration accepted by the host
+bool parseResponse(const char* data, size_t size, SensorViewRequest& accepted);
+
+// One-line summary for the log
+std::string describe(const SensorViewRequest& config);
+
+} // namespace SensorViewConfig
+
+#endif // SENSOR_VIEW_CONFIG_H
@@ -0,0 +1,73 @@
+#ifndef SENSOR_VIEW_FILTER_H
+#define SENSOR_VIEW_FILTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Area around the host vehicle kept by the pre-filter. Distances are in the
+// host vehicle frame (x: longitudinal, y: lateral), measured from the host position.
+struct SensorViewFilterSettings {
+    double radius = 0.0;          // [m], 0: no radius limit
+    double corridorFront = 200.0; // [m] ahead of the host vehicle
+    double corridorRear = 50.0;   // [m] behind the host vehicle
+    double corridorLateral = 0.0; // [m] half width, 0: no corridor
+    uint32_t movingTypeMask = 0xFFFFFFFF;     // Bit n: keep MovingObject.Type n
+    uint32_t stationaryTypeMask = 0xFFFFFFFF; // Bit n: keep StationaryObject.Classification.Type n
+};
+
+// Statistics of the last apply() call
+struct SensorViewFilterStats {
+    size_t bytesIn = 0;
+    size_t bytesOut = 0;
+    uint32_t objectsRemoved = 0; // Moving/stationary objects, traffic signs, traffic lights, road markings
+    uint32_t lanesRemoved = 0;   // Lanes and lane boundaries
+    uint32_t referencesRemoved = 0; // Ids of removed lanes dropped from the kept lanes
+    bool hostFound = false;      // false: SensorView passed through unchanged
+};
+
+// Ego-centric pre-filter of the SensorView, applied at the wire level before
+// Python sees the input. Removes global_ground_truth elements outside the
+// area around the host vehicle or with a masked type; everything else is
+// copied verbatim.
+//   objects, signs, lights, markings  kept if the position (plus half the
+//                                     larger of length and width) is inside
+//   lanes, lane boundaries            kept if a centerline / boundary segment
+//                                     crosses the area
+// The host vehicle and elements without geometry are always kept. Lane
+// boundaries referenced by a kept lane are kept with it, and the adjacent lane
+// and lane pairing ids of removed lanes are dropped from the kept lanes, so the
+// filtered ground truth has no dangling lane ids.
+class SensorViewFilter {
+public:
+    SensorViewFilterSettings settings;
+
+    // Write the filtered SensorView to out (cleared first; capacity is reused).
+    // Returns false with a message in error if the input is malformed.
+    bool apply(const char* sensorView, size_t size, std::string& out, std::string& error);
+
+    const SensorViewFilterStats& stats() const { return m_stats; }
+
+    // Index in the input of the last apply() call of the global_ground_truth element
+    // with the given field number and index in the output. Used to address output
+    // edits made against the filtered SensorView to the unfiltered one.
+    int originalIndex(uint32_t field, int index) const;
+
+private:
+    struct Removed {
+        uint32_t field;
+        int index;
+    };
+
+    SensorViewFilterStats m_stats;
+    std::string m_groundTruth;            // Filtered global_ground_truth, reused across steps
+    std::vector<uint8_t> m_keep;          // Decision per global_ground_truth field
+    std::vector<Removed> m_removed;       // Removed elements in input order
+    std::vector<uint64_t> m_removedLanes; // Ids of the removed lanes, sorted
+    std::vector<uint64_t> m_boundaryRefs; // Lane boundary ids referenced by kept lanes, sorted
+    std::string m_lane;                   // Scratch for kept lanes without dangling ids
+    std::string m_classification;
+    std::string m_pairing;
+};
+
+#endif // SENSOR_VIEW_FILTER_H
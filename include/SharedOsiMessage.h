@@ -0,0 +1,44 @@
+#ifndef SHARED_OSI_MESSAGE_H
+#define SHARED_OSI_MESSAGE_H
+
+#include <memory>
+#include <string>
+#include "PythonEmbed.h"
+
+// OSI message parsed once by the C++ protobuf library and handed to Python as a
+// message object that wraps the C++ message (decode mode Native).
+//
+// Requires a build with GTDC_WITH_OSI_CPP and the 'cpp' Python protobuf backend
+// linked against the same libprotobuf; otherwise initialize() fails.
+// The Python object is only valid during update_control(); controllers that keep
+// data across steps must copy it (CopyFrom).
+class SharedOsiMessage {
+public:
+    // typeName: full protobuf name, e.g. "osi3.SensorView"
+    explicit SharedOsiMessage(const std::string& typeName);
+    ~SharedOsiMessage();
+
+    // Bind to the Python protobuf C++ API (requires the GIL)
+    bool initialize(std::string& error);
+
+    // Parse the host buffer into the C++ message (no GIL needed)
+    bool parse(const void* data, size_t size);
+
+    // New Python message object over the C++ message (requires the GIL)
+    py::object pythonMessage();
+
+    // True if obj wraps the shared C++ message (requires the GIL)
+    bool isSharedMessage(const py::handle& obj) const;
+
+    // Serialize a C++-backed Python message (requires the GIL)
+    bool serialize(const py::handle& obj, std::string& out) const;
+
+    const std::string& typeName() const { return m_typeName; }
+
+private:
+    struct Impl;
+    std::string m_typeName;
+    std::unique_ptr<Impl> m_impl;
+};
+
+#endif // SHARED_OSI_MESSAGE_H
@@ -0,0 +1,159 @@
+#ifndef SIGNAL_LOG_H
+#define SIGNAL_LOG_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Append-only columnar signal log: one row per step, fixed-width typed columns,
+// written in blocks of rows so that a reader can map the file and take every
+// column of a block as one array.
+//
+// File layout (little-endian, every array 8-byte aligned):
+//   SignalLogHeader
+//   SignalLogColumn[columnCount]
+//   blocks: SignalLogBlockHeader, then per column rows * width bytes (padded to 8)
+//   SignalLogFooter
+//   SignalLogBlock[blockCount]     index of the blocks
+//   SignalLogTrailer               at the end of the file: where the footer starts
+// A file without a trailer (process killed) can still be read block by block
+// from the header on.
+constexpr char SIGNAL_LOG_MAGIC[8] = { 'G', 'T', 'D', 'C', 'S', 'L', 'G', '\0' };
+constexpr char SIGNAL_LOG_FOOTER_MAGIC[8] = { 'G', 'T', 'D', 'C', 'S', 'L', 'F', '\0' };
+constexpr char SIGNAL_LOG_BLOCK_MAGIC[4] = { 'S', 'L', 'B', '\0' };
+constexpr uint32_t SIGNAL_LOG_FORMAT_VERSION = 1; // Incremented on any layout change
+constexpr size_t SIGNAL_LOG_NAME_SIZE = 48;       // Column name, NUL-terminated
+
+enum class SignalType : uint32_t { Float64 = 1, Float32 = 2, Int32 = 3, UInt8 = 4 };
+
+struct SignalLogHeader {
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t headerSize;       // Including the column table
+    uint32_t columnCount;
+    uint32_t blockRows;        // Rows of a full block
+};
+
+struct SignalLogColumn {
+    char name[SIGNAL_LOG_NAME_SIZE];
+    uint32_t type;             // SignalType
+    uint32_t width;            // Bytes per value
+};
+
+struct SignalLogBlockHeader {
+    char magic[4];
+    uint32_t rows;
+    uint64_t firstRow;
+};
+
+struct SignalLogFooter {
+    char magic[8];
+    uint64_t rowCount;
+    uint64_t blockCount;
+};
+
+struct SignalLogBlock {
+    uint64_t offset;           // Of the SignalLogBlockHeader
+    uint64_t firstRow;
+    uint32_t rows;
+    uint32_t reserved;
+    double firstTime;          // Column 0 (time) of the first and last row
+    double lastTime;
+};
+
+struct SignalLogTrailer {
+    uint64_t footerOffset;
+    char magic[8];             // SIGNAL_LOG_MAGIC
+};
+
+// Writer. Columns are added until the first row is appended; the values of a
+// row are set one by one and keep their value until set again. Full blocks are
+// written by a background thread, so append() only copies the row into the
+// current block. If the writer falls behind by more than the block pool, rows
+// are dropped (and counted) rather than blocking the step.
+// Column 0 is the time, given to append().
+class SignalLog {
+public:
+    SignalLog();
+    ~SignalLog();
+
+    SignalLog(const SignalLog&) = delete;
+    SignalLog& operator=(const SignalLog&) = delete;
+
+    // Returns the column index, or -1 with a message in error if the columns are
+    // frozen, the name is empty, too long or taken
+    int addColumn(const std::string& name, SignalType type, std::string& error);
+    int findColumn(const std::string& name) const;
+    std::vector<std::string> columnNames() const;
+    size_t columnCount() const;
+    bool frozen() const;
+
+    // Create the file and start the writer thread
+    bool open(const std::string& path, size_t blockRows, std::string& error);
+    bool isOpen() const { return m_file != nullptr; }
+    const std::string& path() const { return m_path; }
+
+    // Values of the current row; any thread
+    void set(size_t column, double value);
+    void set(size_t firstColumn, const double* values, size_t count);
+
+    // Commit the current row. The first call freezes the columns and writes the header.
+    void append(double time);
+
+    // Write the last block and the footer, stop the thread. Returns false with a
+    // message in error if a write failed.
+    bool close(std::string& error);
+
+    unsigned long long rows() const { return m_rows; }
+    unsigned long long droppedRows() const { return m_dropped; }
+    unsigned long long blocks() const;
+
+private:
+    struct Block {
+        std::vector<uint8_t> data;  // Column c at m_columnOffset[c], blockRows values
+        size_t rows = 0;
+        uint64_t firstRow = 0;
+        double firstTime = 0.0;
+        double lastTime = 0.0;
+    };
+
+    void freeze();
+    void writeBlock(const Block& block);
+    void run();
+
+    std::string m_path;
+    FILE* m_file = nullptr;
+    size_t m_blockRows = 0;
+
+    // Columns and the current row
+    mutable std::mutex m_rowMutex;
+    std::vector<SignalLogColumn> m_columns;
+    std::vector<double> m_row;
+    bool m_frozen = false;
+    std::vector<size_t> m_columnOffset;  // In a block buffer
+    size_t m_blockBytes = 0;
+
+    // Block pool: the current block is filled by append(), full ones wait for the writer
+    std::vector<Block> m_pool;
+    Block* m_current = nullptr;
+    std::vector<Block*> m_free;
+    std::vector<Block*> m_full;        // Oldest first
+    unsigned long long m_rows = 0;
+    unsigned long long m_dropped = 0;
+
+    // Writer thread; owns the file position and the block index
+    std::thread m_thread;
+    mutable std::mutex m_queueMutex;
+    std::condition_variable m_cvFull;
+    bool m_stop = false;
+    std::vector<SignalLogBlock> m_index;
+    uint64_t m_offset = 0;
+    bool m_writeFailed = false;
+};
+
+#endif // SIGNAL_LOG_H
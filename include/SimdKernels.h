@@ -0,0 +1,117 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized kernels with runtime dispatch: AVX2 if it was compiled in
+// (GTDC_WITH_AVX2) and the CPU supports it, a scalar fallback otherwise.
+// Both paths return identical results.
+namespace Simd {
+
+bool avx2Enabled();
+const char* name(); // "avx2" or "scalar"
+
+// Segments in structure-of-arrays form: segment i starts at (x[i], y[i]) with
+// direction (dx[i], dy[i]); invLength2[i] = 1 / (dx^2 + dy^2), 0 for a zero-length segment
+struct SegmentTable {
+    const double* x;
+    const double* y;
+    const double* dx;
+    const double* dy;
+    const double* invLength2;
+};
+
+// Nearest of the segments index[0..count) to (px, py). bestD2 / bestIndex are
+// updated if a segment is closer than bestD2 (ties: lower segment index).
+void nearestSegment(const SegmentTable& table, const uint32_t* index, size_t count,
+                    double px, double py, double& bestD2, uint32_t& bestIndex);
+
+// Pose of the host vehicle for egoFrame(): position, heading as cos / sin, velocity
+// in the global frame, half footprint and speed along the heading
+struct EgoPose {
+    double x, y;
+    double cosYaw, sinYaw;
+    double vx, vy;
+    double halfLength, halfWidth;
+    double speed;
+};
+
+// Objects in structure-of-arrays form (global frame, full length / width)
+struct ObjectArrays {
+    const double* x;
+    const double* y;
+    const double* cosYaw;
+    const double* sinYaw;
+    const double* vx;
+    const double* vy;
+    const double* length;
+    const double* width;
+};
+
+struct EgoFrameArrays {
+    double* x;        // Position in the ego frame (x forward, y left)
+    double* y;
+    double* vx;       // Velocity relative to the host vehicle, ego frame
+    double* vy;
+    double* distance; // Gap between the footprints (0: overlapping)
+    double* ttc;      // distance / closing speed, infinity if not closing
+    double* headway;  // Objects ahead in the host's path: gap / host speed, else infinity
+};
+
+// Relative kinematics of objects [0..count) in one pass. The object footprint is
+// bounded by its box aligned with the ego frame, so distance is exact for objects
+// parallel to the host vehicle and a lower bound otherwise.
+void egoFrame(const EgoPose& ego, const ObjectArrays& objects, size_t count, const EgoFrameArrays& out);
+
+// Rigid transform of the lidar frame into the vehicle frame: p' = R p + t (R row-major)
+struct LidarTransform {
+    float r[9];
+    float t[3];
+};
+
+// Reflections at range[i] along the unit directions (dx, dy, dz)[i], transformed into
+// the vehicle frame and written to x, y, z. keep[i] = 1 if minRange <= range <= maxRange
+// and z >= minZ (NaN ranges are dropped). Returns the number of kept points.
+size_t lidarPoints(const LidarTransform& transform, const float* dx, const float* dy, const float* dz,
+                   const float* range, size_t count, float minRange, float maxRange, float minZ,
+                   float* x, float* y, float* z, uint8_t* keep);
+
+// out[i] = a[i] + w * (b[i] - a[i]) for two rows of bytes (vertical step of a bilinear resize)
+void lerpRowsU8(const uint8_t* a, const uint8_t* b, float w, size_t count, float* out);
+
+// Horizontal step of a bilinear resize with an affine colour transform. Output pixel i
+// interpolates the pixel starting at row[x0[i]] and the next one (channels interleaved,
+// at most 3) with weight w[i]; output channel o (at most 3) is
+// bias[o] + sum_c matrix[o * channels + c] * v_c, written to out[o][i].
+void resampleRow(const float* row, size_t channels, const int32_t* x0, const float* w, size_t count,
+                 const float* matrix, const float* bias, size_t outChannels, float* const* out);
+
+// Constant-velocity Kalman filters in structure-of-arrays form: state (x, y, vx, vy)
+// and the upper triangle of its covariance row by row (p[0] = xx, xy, xvx, xvy, yy,
+// yvx, yvy, vxvx, vxvy, p[9] = vyvy)
+constexpr size_t KALMAN_COVARIANCE_SIZE = 10;
+
+struct KalmanArrays {
+    double* x;
+    double* y;
+    double* vx;
+    double* vy;
+    double* p[KALMAN_COVARIANCE_SIZE];
+};
+
+// Predict filters [0..count) by dt with white acceleration noise of variance q
+void kalmanPredict(const KalmanArrays& filters, size_t count, double dt, double q);
+
+// Update the filters with has[i] != 0 by the position measurement (zx, zy)[i] of variance r
+void kalmanUpdate(const KalmanArrays& filters, size_t count, const double* zx, const double* zy, const uint8_t* has,
+                  double r);
+
+// Squared Mahalanobis distance of the positions (zx, zy)[0..count) to (px, py) for the
+// inverse innovation covariance [[i00, i01], [i01, i11]]
+void mahalanobis2(double px, double py, double i00, double i01, double i11, const double* zx, const double* zy,
+                  size_t count, double* out);
+
+} // namespace Simd
+
+#endif // SIMD_KERNELS_H
@@ -0,0 +1,70 @@
+#ifndef STATIC_MAP_CACHE_H
+#define STATIC_MAP_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "PythonEmbed.h"
+#include "RoadNetworkStore.h"
+
+// Static GroundTruth content (map) cached across steps. The static fields of
+// global_ground_truth are split off the SensorView at the wire level; Python
+// only decodes the dynamic remainder each step and reads the map through a
+// persistent handle that is decoded and indexed once per change.
+//   static   stationary_object, traffic_sign, road_marking, lane_boundary, lane,
+//            country_code, proj_string, map_reference, model_reference,
+//            reference_line, logical_lane_boundary, logical_lane
+//   dynamic  everything else (host_vehicle_id, moving_object, traffic_light, ...)
+// The map itself is a RoadNetwork shared with all instances on the same map, so
+// it is stored and decoded once per process. Its preprocessed lane graph
+// (RoadGraph) is built on each change, or mapped from graphCacheDirectory.
+class StaticMapCache {
+public:
+    std::string graphCacheDirectory; // On-disk RoadGraph cache, empty: built in memory only
+
+    // Write the SensorView with only the dynamic GroundTruth fields to out (cleared
+    // first; capacity is reused). The static content is compared with the cache by
+    // id set and hash; on a change the RoadNetwork is taken from the process-wide
+    // store, or created from a copy if no instance has it. A SensorView without static
+    // content (omit_static_information) keeps the cached map.
+    // Returns false with a message in error if the input is malformed.
+    bool split(const char* sensorView, size_t size, std::string& out, std::string& error);
+
+    unsigned long long version() const { return m_version; } // 0: no map yet
+    const std::shared_ptr<const RoadGraph>& graph() const { return m_graph; } // Null before the first map
+    const std::shared_ptr<RoadNetwork>& network() const { return m_network; }   // Null before the first map
+    size_t strippedBytes() const { return m_strippedBytes; } // Static bytes of the last SensorView
+
+    // Persistent Python handle (types.SimpleNamespace), created on first use:
+    //   version        incremented when the static content changes
+    //   ground_truth   osi3.GroundTruth with the static fields only (None before the first map)
+    //   lanes, lane_boundaries, stationary_objects, traffic_signs, road_markings,
+    //   reference_lines, logical_lanes, logical_lane_boundaries   read-only mappings id -> message
+    //   lane_graph     read-only mapping lane id -> (length, type, successors, predecessors, left, right)
+    // ground_truth and the mappings are shared with other instances and must not be modified.
+    // Requires the GIL.
+    py::object handle();
+
+    // Point the handle at the current map if it changed since the last call; the map
+    // is decoded and indexed only if no other instance has done so (requires the GIL)
+    void updateHandle();
+
+    // Drop the handle and this instance's reference to the shared map (requires the GIL)
+    void release();
+
+private:
+    std::shared_ptr<RoadNetwork> m_network; // Null before the first map
+    std::shared_ptr<const RoadGraph> m_graph;
+    unsigned long long m_version = 0;
+    size_t m_strippedBytes = 0;
+
+    std::vector<uint64_t> m_stepIds;      // Scratch buffers reused across steps
+    std::string m_dynamic;
+    std::vector<std::pair<const char*, const char*>> m_staticRanges;
+
+    py::object m_handle;
+    unsigned long long m_handleVersion = 0;
+};
+
+#endif // STATIC_MAP_CACHE_H
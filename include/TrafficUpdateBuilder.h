@@ -0,0 +1,48 @@
+#ifndef TRAFFIC_UPDATE_BUILDER_H
+#define TRAFFIC_UPDATE_BUILDER_H
+
+#include <string>
+#include <vector>
+#include "FallbackController.h"
+#include "OsiPatch.h"
+
+// Ego state returned by Python as the optional 6th element of update_control():
+// {"position": (x, y, z), "orientation": (roll, pitch, yaw), "velocity": ..., "acceleration": ...}
+struct EgoStateOverride {
+    enum Field { Position = 0, Orientation, Velocity, Acceleration, Count };
+    bool has[Count] = {};
+    double value[Count][3] = {};
+
+    void clear() {
+        for (bool& h : has) {
+            h = false;
+        }
+    }
+};
+
+// Builds osi3::TrafficUpdate (osi_trafficupdate.proto) natively from the input
+// SensorView and the control command:
+//   version, timestamp  copied from the SensorView
+//   update[0]           host vehicle MovingObject from global_ground_truth, with the
+//                       EgoStateOverride fields replaced
+//   internal_state[0]   HostVehicleData with pedal positions, gear and steering wheel angle
+//                       (Steering in [-1, 1] scaled by maxSteeringWheelAngle)
+// Only the host vehicle is decoded; all other SensorView content is skipped.
+class TrafficUpdateBuilder {
+public:
+    double maxSteeringWheelAngle = 7.853981634; // [rad] at Steering = 1 (450 deg)
+
+    // sensorView may be empty (no input this step): only internal_state is written
+    bool build(const char* sensorView, size_t size, const ControlCommand& cmd,
+               const EgoStateOverride& ego, std::string& out, std::string& error);
+
+private:
+    // Edit lists and buffers reused across steps
+    std::vector<OsiPatch::Edit> m_egoEdits;
+    std::vector<OsiPatch::Edit> m_edits;
+    OsiPatch::Patcher m_patcher;
+    std::string m_ego;
+    std::string m_internalState;
+};
+
+#endif // TRAFFIC_UPDATE_BUILDER_H
@@ -0,0 +1,63 @@
+#ifndef TRAJECTORY_PREDICTOR_H
+#define TRAJECTORY_PREDICTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "FrenetEngine.h"
+#include "MovingObjects.h"
+
+enum class PredictionModel {
+    ConstantVelocity = 0,     // Straight line at the current velocity
+    ConstantAcceleration = 1, // Straight line, speed changed by the acceleration along the motion (stops at 0)
+    Ctrv = 2                  // Constant turn rate (orientation_rate) and velocity
+};
+
+constexpr size_t PREDICTION_STATE_SIZE = 4; // x, y, yaw [rad], speed [m/s]
+
+// Rollout of the moving objects of the current step over a fixed horizon.
+// With lane following, objects close to a lane centerline and moving along it
+// keep their lateral offset and travel along the lane (first successor /
+// predecessor at the lane ends) with the speed profile of the model; other
+// objects use the model itself.
+class TrajectoryPredictor {
+public:
+    explicit TrajectoryPredictor(std::shared_ptr<FrenetEngine> frenet = nullptr);
+
+    // Take over the objects of this step (called before Python runs)
+    void update(const MovingObjects& objects);
+
+    size_t count(bool excludeHost) const;
+    void ids(bool excludeHost, uint64_t* out) const;
+
+    // states[object][step][PREDICTION_STATE_SIZE] at times dt, 2 dt, ... steps * dt,
+    // objects in the order of ids()
+    void predict(PredictionModel model, double dt, size_t steps, bool followLanes, bool excludeHost, double* states);
+
+private:
+    // Speed and distance travelled at each step (m_times) for object i
+    void speedProfile(PredictionModel model, size_t i, size_t steps);
+    void rollout(PredictionModel model, size_t i, size_t steps, double* out) const;
+    bool followLane(size_t i, size_t steps, uint32_t& warm, double* out) const;
+
+    std::shared_ptr<FrenetEngine> m_frenet;
+    const RoadGraph* m_warmGraph = nullptr;
+    std::unordered_map<uint64_t, uint32_t> m_warm; // Segment of the last projection per object id
+    std::vector<uint32_t> m_segment;               // The same per object of this step
+
+    // Object state, direction of motion as cos / sin
+    std::vector<uint64_t> m_id;
+    std::vector<double> m_x, m_y, m_yaw, m_yawRate;
+    std::vector<double> m_speed, m_acceleration; // Along the direction of motion
+    std::vector<double> m_cosDirection, m_sinDirection;
+    long long m_hostIndex = -1;
+
+    // Scratch buffers per rollout
+    std::vector<double> m_times;
+    std::vector<double> m_profileSpeed;
+    std::vector<double> m_profileDistance;
+};
+
+#endif // TRAJECTORY_PREDICTOR_H
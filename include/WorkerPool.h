@@ -0,0 +1,59 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads for data-parallel loops of the native engines.
+// parallelFor() splits [0, count) into chunks of `grain` items, gives every
+// thread an equal contiguous range of chunks and lets threads that run out
+// steal chunks from the ranges of the others. The calling thread takes part
+// as worker 0, so a pool of n threads starts n - 1 of its own.
+class WorkerPool {
+public:
+    // threadInit(worker) runs once on each pool thread before its first job
+    explicit WorkerPool(size_t threads, std::function<void(size_t)> threadInit = nullptr);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t threads() const { return m_ranges.size(); }
+
+    // body(begin, end, worker) for disjoint [begin, end) covering [0, count);
+    // returns when all have finished. Not reentrant; body must not throw.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t, size_t)>& body);
+
+private:
+    // Chunks [next, end) not yet taken from this worker's range
+    struct alignas(64) Range {
+        std::atomic<size_t> next{ 0 };
+        size_t end = 0;
+    };
+
+    void run(size_t worker);
+    void work(size_t worker);
+
+    std::vector<Range> m_ranges;
+    std::vector<std::thread> m_threads;
+    std::function<void(size_t)> m_threadInit;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cvJob;
+    std::condition_variable m_cvDone;
+    unsigned long long m_generation = 0; // Incremented per job
+    size_t m_running = 0;                // Pool threads still working on the job
+    bool m_stop = false;
+
+    // Current job
+    const std::function<void(size_t, size_t, size_t)>* m_body = nullptr;
+    size_t m_count = 0;
+    size_t m_grain = 1;
+};
+
+#endif // WORKER_POOL_H
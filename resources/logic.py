@@ -23,9 +23,25 @@ class Controller:
     def __init__(self):
         print("[GT-DriveController] Initialized Python Controller")
 
-    def update_control(self, binary_data):
+    def update_control(self, binary_data, channels=None):
         """
-        Processes OSI SensorView data and returns control outputs.
+        Computes the control outputs of one step.
+
+        binary_data: SensorView of this step, serialized (bytes, or a memoryview
+            with OsiDecodeMode = 2) or parsed by the Core (osi3 SensorView with
+            OsiDecodeMode = 1). Only valid during this call; copy what you keep.
+        channels: additional OSMP inputs {"sensor_data": ..., "ground_truth": ...,
+            "traffic_command": ...} (None per input if not connected or unchanged),
+            or None if no additional input is connected.
+
+        Returns [throttle, brake, steering, drive_mode, osi_output]: throttle and
+        brake in [0, 1], steering in [-1, 1], drive_mode 1 / 0 / -1 (forward,
+        neutral, reverse), and the OSI output as serialized bytes or a list of
+        wire-level edits applied to the input SensorView by the Core.
+
+        Native helpers set on the controller by the Core (self.static_map,
+        self.frenet, self.tracker, ...) are described in docs/implementation.md
+        (section 3, "Pythonコントローラー").
         """
         # Default outputs
         throttle = 0.5
@@ -38,12 +54,13 @@ class Controller:
             return [throttle, brake, steering, drive_mode, osi_output_bytes]
 
         try:
-            # Deserialize OSI
-            sv = osi_sv.SensorView()
-            sv.ParseFromString(binary_data)
-            
-            # TODO: Implement actual logic based on sv content
-            
+            # Deserialize OSI (already parsed in native decode mode)
+            if isinstance(binary_data, (bytes, bytearray, memoryview)):
+                sv = osi_sv.SensorView()
+                sv.ParseFromString(binary_data)
+            else:
+                sv = binary_data
+
             return [throttle, brake, steering, drive_mode, osi_output_bytes]
 
         except Exception as e:
@@ -0,0 +1,77 @@
+# Setup Native Protobuf Backend (upb)
+# Places the upb extension (google/_upb/_message.pyd) next to the vendored
+# pure-Python protobuf runtime in python/google, so that create_fmu.ps1
+# bundles it into resources/google and api_implementation selects 'upb'.
+#
+# The extension must match the vendored runtime version exactly; it is taken
+# from the official abi3 wheel of the same version (built from upb by bazel).
+# To build it yourself instead, run in a protobuf checkout of the same tag:
+#   bazel build //python/dist:binary_wheel
+# and pass the resulting wheel with -Wheel.
+
+param(
+    [string]$Wheel = ""
+)
+
+$ErrorActionPreference = "Stop"
+
+$PROJECT_ROOT = "e:\Repository\GT-karny\GT-DriveController"
+$PYTHON_EXE = "$PROJECT_ROOT\thirdparty\cpython\PCbuild\amd64\python.exe"
+$VENDOR_DIR = "$PROJECT_ROOT\python"
+$DEST_DIR = "$VENDOR_DIR\google\_upb"
+$TEMP_DIR = "$PROJECT_ROOT\build\protobuf_upb"
+
+Write-Host "Setting up native protobuf backend (upb)..." -ForegroundColor Green
+
+# 1. Determine vendored runtime version
+Write-Host "`n[1/4] Detecting vendored protobuf version..."
+$distInfo = Get-ChildItem -Path $VENDOR_DIR -Directory -Filter "protobuf-*.dist-info" | Select-Object -First 1
+if (-not $distInfo) {
+    throw "Vendored protobuf runtime not found in $VENDOR_DIR"
+}
+$version = $distInfo.Name -replace '^protobuf-', '' -replace '\.dist-info$', ''
+Write-Host "  - Vendored protobuf: $version"
+
+# 2. Obtain the wheel
+Write-Host "[2/4] Obtaining protobuf $version wheel (win_amd64, abi3)..."
+if (Test-Path $TEMP_DIR) {
+    Remove-Item -Path $TEMP_DIR -Recurse -Force
+}
+New-Item -ItemType Directory -Path $TEMP_DIR | Out-Null
+
+if ($Wheel -eq "") {
+    & $PYTHON_EXE -m pip download "protobuf==$version" --no-deps --only-binary=:all: `
+        --platform win_amd64 --python-version 3.12 --implementation cp -d $TEMP_DIR
+    if ($LASTEXITCODE -ne 0) {
+        throw "pip download failed"
+    }
+    $Wheel = (Get-ChildItem -Path $TEMP_DIR -Filter "protobuf-$version-*.whl" | Select-Object -First 1).FullName
+}
+Write-Host "  - Wheel: $Wheel"
+
+# 3. Extract the extension module
+Write-Host "[3/4] Extracting google/_upb/_message.pyd..."
+Add-Type -AssemblyName System.IO.Compression.FileSystem
+$zip = [System.IO.Compression.ZipFile]::OpenRead($Wheel)
+try {
+    $entry = $zip.Entries | Where-Object { $_.FullName -eq "google/_upb/_message.pyd" }
+    if (-not $entry) {
+        throw "google/_upb/_message.pyd not found in $Wheel"
+    }
+    New-Item -ItemType Directory -Force -Path $DEST_DIR | Out-Null
+    [System.IO.Compression.ZipFileExtensions]::ExtractToFile($entry, "$DEST_DIR\_message.pyd", $true)
+} finally {
+    $zip.Dispose()
+}
+
+# 4. Verify that the embedded runtime selects it
+Write-Host "[4/4] Verifying backend selection..."
+$check = "import sys; sys.path.insert(0, r'$VENDOR_DIR'); from google.protobuf.internal import api_implementation; print(api_implementation.Type())"
+$backend = & $PYTHON_EXE -c $check
+Write-Host "  - api_implementation.Type() = $backend"
+if ($backend -ne "upb") {
+    Write-Warning "upb backend was not selected; the pure-Python backend will be used"
+}
+
+Write-Host "`nSUCCESS: $DEST_DIR\_message.pyd" -ForegroundColor Green
+Write-Host "Run create_fmu.ps1 to bundle it, and tests\bench_protobuf_backend.py to compare backends."
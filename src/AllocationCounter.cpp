@@ -0,0 +1,73 @@
+// Replacement of the global allocation functions for the Core library.
+// Every allocation is reported to Realtime::AllocationProbe, which only
+// counts it while a probe is active on the allocating thread.
+#include "RealtimeProfile.h"
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+static void* countedAlloc(size_t size) {
+    Realtime::AllocationProbe::onAllocation();
+    return std::malloc(size ? size : 1);
+}
+
+static void* countedAlignedAlloc(size_t size, std::align_val_t align) {
+    Realtime::AllocationProbe::onAllocation();
+    size = size ? size : 1;
+#ifdef _WIN32
+    return _aligned_malloc(size, (size_t)align);
+#else
+    size_t a = (size_t)align;
+    return std::aligned_alloc(a, (size + a - 1) / a * a);
+#endif
+}
+
+static void countedAlignedFree(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    if (void* p = countedAlignedAlloc(size, align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    if (void* p = countedAlignedAlloc(size, align)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { countedAlignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { countedAlignedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { countedAlignedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { countedAlignedFree(ptr); }
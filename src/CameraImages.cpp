@@ -0,0 +1,257 @@
+#include "CameraImages.h"
+#include "OsiFields.h"
+#include "OsiInputChannel.h"
+#include "OsiWire.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using OsiWire::Field;
+using OsiWire::WireType;
+
+// ChannelFormat 2..25: MONO, RGB, BAYER_BGGR, BAYER_RGGB, RCCC, RCCB, each as U8, U16, U32, F32
+constexpr uint32_t FORMAT_FIRST = 2;
+constexpr uint32_t FORMAT_LAST = 25;
+constexpr uint32_t FORMAT_MONO_U8 = 2;
+constexpr uint32_t FORMAT_RGB_U8 = 6;
+constexpr uint32_t FORMAT_BAYER_BGGR_U8 = 10;
+constexpr uint32_t FORMAT_BAYER_RGGB_U8 = 14;
+constexpr size_t MAX_TENSOR_SIDE = 8192;
+
+const float GRAY_WEIGHTS[3] = { 0.299f, 0.587f, 0.114f }; // ITU-R BT.601
+
+// First value of a repeated enum, packed or not
+bool firstEnum(const Field& field, uint32_t& value) {
+    if (field.type == WireType::Varint) {
+        value = (uint32_t)field.varint;
+        return true;
+    }
+    if (field.type == WireType::LengthDelimited && field.size > 0) {
+        const char* pos = field.data;
+        uint64_t v = 0;
+        if (OsiWire::readVarint(pos, field.data + field.size, v)) {
+            value = (uint32_t)v;
+            return true;
+        }
+    }
+    return false;
+}
+
+void describeLayout(CameraFrame& frame) {
+    if (frame.format < FORMAT_FIRST || frame.format > FORMAT_LAST) {
+        frame.error = "unsupported channel_format " + std::to_string(frame.format);
+        return;
+    }
+    uint32_t group = (frame.format - FORMAT_FIRST) / 4;
+    uint32_t type = (frame.format - FORMAT_FIRST) % 4;
+    frame.channels = group == 1 ? 3 : 1;
+    frame.sampleBytes = type == 0 ? 1 : (type == 1 ? 2 : 4);
+    frame.isFloat = type == 3;
+    if (frame.width == 0 || frame.height == 0) {
+        frame.error = "number of pixels missing in the view configuration";
+        return;
+    }
+    if (!frame.data) {
+        frame.error = "no image_data";
+        return;
+    }
+    size_t expected = (size_t)frame.width * frame.height * frame.channels * frame.sampleBytes;
+    if (frame.size != expected) {
+        frame.error = "image_data has " + std::to_string(frame.size) + " bytes, expected " + std::to_string(expected);
+    }
+}
+
+} // namespace
+
+bool CameraImages::locate(const char* sensorView, size_t size, std::string& error) {
+    using namespace OsiFields;
+    m_frames.clear();
+    OsiWire::Reader reader(sensorView, size);
+    Field field;
+    while (reader.next(field)) {
+        if (field.number != SensorView::CameraSensorView || field.type != WireType::LengthDelimited) {
+            continue;
+        }
+        CameraFrame frame;
+        OsiWire::Reader view(field.data, field.size);
+        Field f;
+        while (view.next(f)) {
+            if (f.type != WireType::LengthDelimited) {
+                continue;
+            }
+            if (f.number == CameraSensorView::ImageData) {
+                frame.data = f.data;
+                frame.size = f.size;
+            } else if (f.number == CameraSensorView::ViewConfiguration) {
+                OsiWire::Reader config(f.data, f.size);
+                Field c;
+                bool hasFormat = false;
+                while (config.next(c)) {
+                    switch (c.number) {
+                        case CameraSensorViewConfiguration::SensorId: OsiWire::readIdentifier(c, frame.sensorId); break;
+                        case CameraSensorViewConfiguration::NumberOfPixelsHorizontal: frame.width = (uint32_t)c.varint; break;
+                        case CameraSensorViewConfiguration::NumberOfPixelsVertical: frame.height = (uint32_t)c.varint; break;
+                        case CameraSensorViewConfiguration::ChannelFormat:
+                            if (!hasFormat) {
+                                hasFormat = firstEnum(c, frame.format);
+                            }
+                            break;
+                        default: break;
+                    }
+                }
+            }
+        }
+        if (!view.ok()) {
+            error = "malformed CameraSensorView";
+            m_frames.clear();
+            return false;
+        }
+        describeLayout(frame);
+        m_frames.push_back(std::move(frame));
+    }
+    if (!reader.ok()) {
+        error = "malformed SensorView";
+        m_frames.clear();
+        return false;
+    }
+    return true;
+}
+
+py::object CameraImages::view(size_t index) {
+    const CameraFrame& frame = m_frames[index];
+    py::object view = py::memoryview::from_memory(frame.data, (py::ssize_t)frame.size, true);
+    m_views.push_back(view);
+    return view;
+}
+
+void CameraImages::release() {
+    for (py::object& view : m_views) {
+        releaseMemoryView(view, "camera image");
+    }
+    m_views.clear();
+    m_frames.clear();
+}
+
+// 8-bit pixels for tensor(): the image itself, or the RGB combination of each 2x2 Bayer cell
+const uint8_t* CameraImages::rgbSource(const CameraFrame& frame, size_t& width, size_t& height, size_t& channels,
+                                       std::string& error) {
+    const uint8_t* pixels = reinterpret_cast<const uint8_t*>(frame.data);
+    width = frame.width;
+    height = frame.height;
+    channels = frame.channels;
+    if (frame.format == FORMAT_MONO_U8 || frame.format == FORMAT_RGB_U8) {
+        return pixels;
+    }
+    if (frame.format != FORMAT_BAYER_BGGR_U8 && frame.format != FORMAT_BAYER_RGGB_U8) {
+        error = "tensor() supports MONO_U8, RGB_U8, BAYER_BGGR_U8 and BAYER_RGGB_U8";
+        return nullptr;
+    }
+    if (frame.width < 2 || frame.height < 2) {
+        error = "Bayer image smaller than 2x2";
+        return nullptr;
+    }
+    width = frame.width / 2;
+    height = frame.height / 2;
+    channels = 3;
+    m_demosaic.resize(width * height * 3);
+    bool bggr = frame.format == FORMAT_BAYER_BGGR_U8;
+    for (size_t y = 0; y < height; ++y) {
+        const uint8_t* top = pixels + (2 * y) * frame.width;
+        const uint8_t* bottom = top + frame.width;
+        uint8_t* out = &m_demosaic[y * width * 3];
+        for (size_t x = 0; x < width; ++x) {
+            uint8_t first = top[2 * x];      // B (BGGR) or R (RGGB)
+            uint8_t last = bottom[2 * x + 1]; // R (BGGR) or B (RGGB)
+            out[3 * x] = bggr ? last : first;
+            out[3 * x + 1] = (uint8_t)(((unsigned)top[2 * x + 1] + bottom[2 * x] + 1) / 2);
+            out[3 * x + 2] = bggr ? first : last;
+        }
+    }
+    return m_demosaic.data();
+}
+
+bool CameraImages::tensor(size_t index, const CameraTensorSettings& settings, float* out, std::string& error) {
+    if (index >= m_frames.size()) {
+        error = "no camera image " + std::to_string(index);
+        return false;
+    }
+    const CameraFrame& frame = m_frames[index];
+    if (!frame.error.empty()) {
+        error = frame.error;
+        return false;
+    }
+    if (settings.width == 0 || settings.height == 0 || settings.width > MAX_TENSOR_SIDE || settings.height > MAX_TENSOR_SIDE) {
+        error = "tensor size out of range";
+        return false;
+    }
+    size_t srcWidth = 0, srcHeight = 0, channels = 0;
+    const uint8_t* src = rgbSource(frame, srcWidth, srcHeight, channels, error);
+    if (!src) {
+        return false;
+    }
+
+    // Colour order and normalization as one affine map of the interpolated samples
+    size_t outChannels = settings.order == CameraColorOrder::Gray ? 1 : 3;
+    float matrix[9] = {};
+    float bias[3] = {};
+    for (size_t o = 0; o < outChannels; ++o) {
+        float scale = 1.0f / (255.0f * settings.std[o]);
+        for (size_t c = 0; c < channels; ++c) {
+            float weight;
+            if (settings.order == CameraColorOrder::Gray) {
+                weight = channels == 3 ? GRAY_WEIGHTS[c] : 1.0f;
+            } else if (channels == 1) {
+                weight = 1.0f;
+            } else {
+                size_t source = settings.order == CameraColorOrder::Bgr ? 2 - o : o;
+                weight = c == source ? 1.0f : 0.0f;
+            }
+            matrix[o * channels + c] = weight * scale;
+        }
+        bias[o] = -settings.mean[o] / settings.std[o];
+    }
+
+    // Source columns of the output pixels (pixel centres aligned, clamped at the edges);
+    // the row buffer repeats the last pixel, so that the right neighbour always exists
+    size_t width = settings.width;
+    size_t height = settings.height;
+    m_x0.resize(width);
+    m_wx.resize(width);
+    double scaleX = (double)srcWidth / (double)width;
+    for (size_t x = 0; x < width; ++x) {
+        double sx = std::min((double)(srcWidth - 1), std::max(0.0, ((double)x + 0.5) * scaleX - 0.5));
+        size_t x0 = (size_t)sx;
+        m_x0[x] = (int32_t)(x0 * channels);
+        m_wx[x] = (float)(sx - (double)x0);
+    }
+    size_t rowSize = srcWidth * channels;
+    m_row.resize(rowSize + channels);
+
+    float* planes[3];
+    if (!settings.channelsFirst) {
+        m_planes.resize(outChannels * width);
+    }
+    double scaleY = (double)srcHeight / (double)height;
+    for (size_t y = 0; y < height; ++y) {
+        double sy = std::min((double)(srcHeight - 1), std::max(0.0, ((double)y + 0.5) * scaleY - 0.5));
+        size_t y0 = (size_t)sy;
+        size_t y1 = std::min(y0 + 1, srcHeight - 1);
+        Simd::lerpRowsU8(src + y0 * rowSize, src + y1 * rowSize, (float)(sy - (double)y0), rowSize, m_row.data());
+        std::copy(m_row.begin() + (rowSize - channels), m_row.begin() + rowSize, m_row.begin() + rowSize);
+        for (size_t o = 0; o < outChannels; ++o) {
+            planes[o] = settings.channelsFirst ? out + (o * height + y) * width : &m_planes[o * width];
+        }
+        Simd::resampleRow(m_row.data(), channels, m_x0.data(), m_wx.data(), width, matrix, bias, outChannels, planes);
+        if (!settings.channelsFirst) {
+            float* row = out + y * width * outChannels;
+            for (size_t x = 0; x < width; ++x) {
+                for (size_t o = 0; o < outChannels; ++o) {
+                    row[x * outChannels + o] = planes[o][x];
+                }
+            }
+        }
+    }
+    return true;
+}
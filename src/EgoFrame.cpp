@@ -0,0 +1,58 @@
+#include "EgoFrame.h"
+#include "SimdKernels.h"
+#include <algorithm>
+
+bool EgoFrame::compute(const MovingObjects& objects) {
+    m_hostFound = objects.hostIndex >= 0;
+    size_t count = m_hostFound ? objects.count - 1 : 0;
+    id.resize(count);
+    x.resize(count);
+    y.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    distance.resize(count);
+    ttc.resize(count);
+    headway.resize(count);
+    if (!m_hostFound) {
+        m_hostSpeed = 0.0;
+        return false;
+    }
+
+    size_t h = (size_t)objects.hostIndex;
+    Simd::EgoPose ego;
+    ego.x = objects.x[h];
+    ego.y = objects.y[h];
+    ego.cosYaw = objects.cosYaw[h];
+    ego.sinYaw = objects.sinYaw[h];
+    ego.vx = objects.vx[h];
+    ego.vy = objects.vy[h];
+    ego.halfLength = 0.5 * objects.length[h];
+    ego.halfWidth = 0.5 * objects.width[h];
+    ego.speed = ego.cosYaw * ego.vx + ego.sinYaw * ego.vy;
+    m_hostSpeed = ego.speed;
+
+    // Objects before and after the host, each in one pass
+    size_t ranges[2][2] = { { 0, h }, { h + 1, objects.count } };
+    size_t offset = 0;
+    for (const auto& range : ranges) {
+        size_t n = range[1] - range[0];
+        if (n == 0) {
+            continue;
+        }
+        size_t first = range[0];
+        Simd::ObjectArrays in = {
+            objects.x.data() + first, objects.y.data() + first,
+            objects.cosYaw.data() + first, objects.sinYaw.data() + first,
+            objects.vx.data() + first, objects.vy.data() + first,
+            objects.length.data() + first, objects.width.data() + first
+        };
+        Simd::EgoFrameArrays out = {
+            x.data() + offset, y.data() + offset, vx.data() + offset, vy.data() + offset,
+            distance.data() + offset, ttc.data() + offset, headway.data() + offset
+        };
+        Simd::egoFrame(ego, in, n, out);
+        std::copy(objects.id.begin() + first, objects.id.begin() + range[1], id.begin() + offset);
+        offset += n;
+    }
+    return true;
+}
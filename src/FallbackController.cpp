@@ -0,0 +1,42 @@
+#include "FallbackController.h"
+#include <algorithm>
+
+// Ramp rates used while decelerating [1/s]
+static const fmi2Real THROTTLE_RELEASE_RATE = 2.0;
+static const fmi2Real BRAKE_APPLY_RATE = 1.0;
+
+void FallbackController::observe(const ControlCommand& cmd) {
+    m_lastGood = cmd;
+    m_active = false;
+}
+
+ControlCommand FallbackController::compute(fmi2Real stepSize) {
+    if (!m_active) {
+        // Start ramping from the last command Python delivered
+        m_current = m_lastGood;
+        m_active = true;
+    }
+
+    ControlCommand cmd = m_current;
+    cmd.steering = m_lastGood.steering;
+    cmd.driveMode = m_lastGood.driveMode;
+
+    switch (m_mode) {
+        case FallbackMode::HoldSpeed:
+            cmd.throttle = m_lastGood.throttle;
+            cmd.brake = m_lastGood.brake;
+            break;
+        case FallbackMode::Decelerate:
+        default: {
+            fmi2Real dt = std::max(stepSize, 0.0);
+            cmd.throttle = std::max(0.0, m_current.throttle - THROTTLE_RELEASE_RATE * dt);
+            // Never release a brake that Python already applied harder than the target
+            fmi2Real target = std::max(m_targetBrake, m_lastGood.brake);
+            cmd.brake = std::min(target, m_current.brake + BRAKE_APPLY_RATE * dt);
+            break;
+        }
+    }
+
+    m_current = cmd;
+    return cmd;
+}
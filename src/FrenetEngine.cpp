@@ -0,0 +1,202 @@
+#include "FrenetEngine.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t NO_SEGMENT = FRENET_NO_SEGMENT;
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+} // namespace
+
+void FrenetEngine::setGraph(std::shared_ptr<const RoadGraph> graph) {
+    if (graph == m_graph) {
+        return;
+    }
+    m_graph = std::move(graph);
+    m_frenetWarm.clear();
+    m_cartesianWarm.clear();
+    m_dx.clear();
+    m_dy.clear();
+    m_invLength2.clear();
+    if (!m_graph) {
+        return;
+    }
+
+    uint32_t points = m_graph->pointCount();
+    const double* px = m_graph->pointX();
+    const double* py = m_graph->pointY();
+    m_dx.assign(points, 0.0);
+    m_dy.assign(points, 0.0);
+    m_invLength2.assign(points, 0.0);
+    const RoadGraphLane* lanes = m_graph->lanes();
+    for (uint32_t l = 0; l < m_graph->laneCount(); ++l) {
+        for (uint32_t p = lanes[l].firstPoint; p + 1 < lanes[l].firstPoint + lanes[l].pointCount; ++p) {
+            m_dx[p] = px[p + 1] - px[p];
+            m_dy[p] = py[p + 1] - py[p];
+            double length2 = m_dx[p] * m_dx[p] + m_dy[p] * m_dy[p];
+            m_invLength2[p] = length2 > 0.0 ? 1.0 / length2 : 0.0;
+        }
+    }
+}
+
+bool FrenetEngine::isSegment(uint32_t p) const {
+    if (p >= m_graph->pointCount()) {
+        return false;
+    }
+    const RoadGraphLane& lane = m_graph->lanes()[m_graph->pointLane()[p]];
+    return p + 1 < lane.firstPoint + lane.pointCount;
+}
+
+// All segments in the grid cells overlapping the square of the given half size
+void FrenetEngine::searchGrid(double x, double y, double radius, double& bestD2, uint32_t& best) const {
+    const RoadGraphHeader& h = m_graph->header();
+    double c0 = std::floor((x - radius - h.gridMinX) / h.cellSize);
+    double c1 = std::floor((x + radius - h.gridMinX) / h.cellSize);
+    double r0 = std::floor((y - radius - h.gridMinY) / h.cellSize);
+    double r1 = std::floor((y + radius - h.gridMinY) / h.cellSize);
+    if (c1 < 0.0 || r1 < 0.0 || c0 >= h.gridColumns || r0 >= h.gridRows) {
+        return;
+    }
+    uint32_t cBegin = (uint32_t)std::max(0.0, c0);
+    uint32_t cEnd = (uint32_t)std::min((double)h.gridColumns - 1, c1);
+    uint32_t rBegin = (uint32_t)std::max(0.0, r0);
+    uint32_t rEnd = (uint32_t)std::min((double)h.gridRows - 1, r1);
+
+    const Simd::SegmentTable table = { m_graph->pointX(), m_graph->pointY(), m_dx.data(), m_dy.data(), m_invLength2.data() };
+    const uint32_t* cellStart = m_graph->cellStart();
+    const uint32_t* cellSegments = m_graph->cellSegments();
+    for (uint32_t r = rBegin; r <= rEnd; ++r) {
+        uint64_t row = (uint64_t)r * h.gridColumns;
+        for (uint32_t c = cBegin; c <= cEnd; ++c) {
+            uint32_t begin = cellStart[row + c];
+            uint32_t end = cellStart[row + c + 1];
+            Simd::nearestSegment(table, cellSegments + begin, end - begin, x, y, bestD2, best);
+        }
+    }
+}
+
+uint32_t FrenetEngine::nearestSegment(double x, double y, uint32_t warm) const {
+    const Simd::SegmentTable table = { m_graph->pointX(), m_graph->pointY(), m_dx.data(), m_dy.data(), m_invLength2.data() };
+    double bestD2 = std::numeric_limits<double>::infinity();
+    uint32_t best = NO_SEGMENT;
+
+    // 1. Warm start: descend along the lane of the previous segment. The distance
+    //    found bounds the grid search below, which then covers only a few cells.
+    if (warm != NO_SEGMENT && isSegment(warm)) {
+        Simd::nearestSegment(table, &warm, 1, x, y, bestD2, best);
+        for (int step : { -1, 1 }) {
+            uint32_t p = warm;
+            for (;;) {
+                uint32_t next = p + step;
+                if ((step < 0 && p == 0) || !isSegment(next) || m_graph->pointLane()[next] != m_graph->pointLane()[warm]) {
+                    break;
+                }
+                double d2 = bestD2;
+                uint32_t index = best;
+                Simd::nearestSegment(table, &next, 1, x, y, d2, index);
+                if (index != next) {
+                    break;
+                }
+                bestD2 = d2;
+                best = next;
+                p = next;
+            }
+        }
+        searchGrid(x, y, std::sqrt(bestD2), bestD2, best);
+        return best;
+    }
+
+    // 2. Cold start: growing squares until the nearest segment found lies within
+    //    the square (anything closer would be inside it), or the grid is covered
+    const RoadGraphHeader& h = m_graph->header();
+    double extent = std::max(h.gridColumns, h.gridRows) * h.cellSize +
+                    std::max(std::fabs(x - h.gridMinX), std::fabs(y - h.gridMinY));
+    for (double radius = h.cellSize;; radius *= 2.0) {
+        searchGrid(x, y, radius, bestD2, best);
+        if (bestD2 <= radius * radius || radius > extent) {
+            return best;
+        }
+    }
+}
+
+bool FrenetEngine::project(double x, double y, uint32_t& segment, double& s, double& t, uint64_t& laneId) const {
+    uint32_t p = hasMap() && std::isfinite(x) && std::isfinite(y) ? nearestSegment(x, y, segment) : NO_SEGMENT;
+    segment = p;
+    if (p == NO_SEGMENT) {
+        s = t = NaN;
+        laneId = 0;
+        return false;
+    }
+    const RoadGraphLane& lane = m_graph->lanes()[m_graph->pointLane()[p]];
+    double rx = x - m_graph->pointX()[p];
+    double ry = y - m_graph->pointY()[p];
+    double u = (rx * m_dx[p] + ry * m_dy[p]) * m_invLength2[p];
+    double length = m_invLength2[p] > 0.0 ? std::sqrt(1.0 / m_invLength2[p]) : 0.0;
+    double cross = m_dx[p] * ry - m_dy[p] * rx;
+    // Beyond the ends of the lane s is extrapolated, as in toCartesian()
+    bool before = u < 0.0 && p == lane.firstPoint;
+    bool after = u > 1.0 && p + 2 == lane.firstPoint + lane.pointCount;
+    if (length > 0.0 && (before || after)) {
+        s = m_graph->pointS()[p] + u * length;
+        t = cross / length;
+    } else {
+        u = std::min(1.0, std::max(0.0, u));
+        s = m_graph->pointS()[p] + u * length;
+        t = std::copysign(std::hypot(rx - u * m_dx[p], ry - u * m_dy[p]), cross);
+    }
+    laneId = lane.id;
+    return true;
+}
+
+void FrenetEngine::toFrenet(const double* x, const double* y, size_t count, double* s, double* t, uint64_t* laneId) {
+    if (m_frenetWarm.size() < count) {
+        m_frenetWarm.resize(count, NO_SEGMENT);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        project(x[i], y[i], m_frenetWarm[i], s[i], t[i], laneId[i]);
+    }
+}
+
+void FrenetEngine::toCartesian(const double* s, const double* t, const uint64_t* laneId, size_t count,
+                               double* x, double* y, double* heading) {
+    if (m_cartesianWarm.size() < count) {
+        m_cartesianWarm.resize(count, NO_SEGMENT);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = y[i] = heading[i] = NaN;
+        if (!m_graph) {
+            continue;
+        }
+        uint32_t l = m_graph->findLane(laneId[i]);
+        if (l == ROAD_GRAPH_NO_LANE || m_graph->lanes()[l].pointCount < 2 || !std::isfinite(s[i])) {
+            continue;
+        }
+        const RoadGraphLane& lane = m_graph->lanes()[l];
+        const double* ps = m_graph->pointS();
+        uint32_t first = lane.firstPoint;
+        uint32_t last = lane.firstPoint + lane.pointCount - 2; // Last segment
+
+        // Previous segment of this slot if it still contains s, binary search otherwise
+        uint32_t p = m_cartesianWarm[i];
+        if (p < first || p > last || (s[i] < ps[p] && p > first) || (s[i] > ps[p + 1] && p < last)) {
+            p = (uint32_t)(std::upper_bound(ps + first + 1, ps + last + 1, s[i]) - ps) - 1;
+        }
+        m_cartesianWarm[i] = p;
+
+        double length = m_invLength2[p] > 0.0 ? std::sqrt(1.0 / m_invLength2[p]) : 0.0;
+        if (length == 0.0) {
+            x[i] = m_graph->pointX()[p];
+            y[i] = m_graph->pointY()[p];
+            continue;
+        }
+        double u = (s[i] - ps[p]) / length;
+        double nx = -m_dy[p] / length; // Left normal
+        double ny = m_dx[p] / length;
+        x[i] = m_graph->pointX()[p] + u * m_dx[p] + t[i] * nx;
+        y[i] = m_graph->pointY()[p] + u * m_dy[p] + t[i] * ny;
+        heading[i] = std::atan2(m_dy[p], m_dx[p]);
+    }
+}
@@ -0,0 +1,220 @@
+#include "KpiEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+// JSON has no infinity or NaN: null
+void writeField(std::ostream& out, const char* name, double value, bool last = false) {
+    out << "    \"" << name << "\": ";
+    if (std::isfinite(value)) {
+        out << value;
+    } else {
+        out << "null";
+    }
+    out << (last ? "\n" : ",\n");
+}
+
+void writeField(std::ostream& out, const char* name, unsigned long long value, bool last = false) {
+    out << "    \"" << name << "\": " << value << (last ? "\n" : ",\n");
+}
+
+} // namespace
+
+void KpiEngine::observe(const MovingObjects& objects, const EgoFrame* egoFrame, const FrenetEngine* frenet) {
+    Scene scene;
+    if (objects.hostIndex >= 0) {
+        if (!egoFrame || !egoFrame->hostFound()) {
+            m_ego.compute(objects);
+            egoFrame = &m_ego;
+        }
+        size_t h = (size_t)objects.hostIndex;
+        double c = objects.cosYaw[h];
+        double s = objects.sinYaw[h];
+        scene.hostFound = true;
+        scene.speed = c * objects.vx[h] + s * objects.vy[h];
+        scene.yawRate = objects.yawRate[h];
+        scene.hasAcceleration = objects.ax[h] != 0.0 || objects.ay[h] != 0.0;
+        scene.longitudinal = c * objects.ax[h] + s * objects.ay[h];
+        scene.lateral = c * objects.ay[h] - s * objects.ax[h];
+        scene.minTtc = std::numeric_limits<double>::infinity();
+        scene.minHeadway = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < egoFrame->count(); ++i) {
+            scene.minTtc = std::min(scene.minTtc, egoFrame->ttc[i]);
+            scene.minHeadway = std::min(scene.minHeadway, egoFrame->headway[i]);
+        }
+        if (frenet && frenet->graph() != m_graph) {
+            // The warm segment refers to the previous map
+            m_graph = frenet->graph();
+            m_segment = FRENET_NO_SEGMENT;
+        }
+        double laneS = 0.0;
+        uint64_t laneId = 0;
+        if (frenet && frenet->project(objects.x[h], objects.y[h], m_segment, laneS, scene.laneOffset, laneId)) {
+            scene.hasLane = true;
+        }
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending = scene;
+    m_hasPending = true;
+}
+
+// A new scene: accelerations, jerk and the per-sample extrema
+void KpiEngine::sample(const Scene& scene, double time) {
+    double interval = time - m_sceneTime;
+    bool previous = m_hasScene && m_scene.hostFound && interval > 0.0;
+    m_scene = scene;
+    m_hasScene = true;
+    m_sceneTime = time;
+    if (!scene.hostFound) {
+        m_hasLongitudinal = false;
+        m_longitudinal = m_lateral = m_jerk = 0.0;
+        return;
+    }
+    ++m_values.samples;
+
+    double longitudinal = scene.longitudinal;
+    bool hasLongitudinal = scene.hasAcceleration;
+    double lateral = scene.lateral;
+    if (!scene.hasAcceleration) {
+        hasLongitudinal = previous;
+        longitudinal = previous ? (scene.speed - m_previousSpeed) / interval : 0.0;
+        lateral = scene.speed * scene.yawRate;
+    }
+    m_previousSpeed = scene.speed;
+    m_jerk = 0.0;
+    if (hasLongitudinal) {
+        if (m_hasLongitudinal && previous) {
+            m_jerk = (longitudinal - m_longitudinal) / interval;
+            m_values.maxJerk = std::max(m_values.maxJerk, std::fabs(m_jerk));
+            m_jerkSquares += m_jerk * m_jerk;
+            ++m_jerkCount;
+            m_values.jerkRms = std::sqrt(m_jerkSquares / (double)m_jerkCount);
+        }
+        m_values.maxAcceleration = std::max(m_values.maxAcceleration, longitudinal);
+        m_values.maxDeceleration = std::max(m_values.maxDeceleration, -longitudinal);
+    }
+    m_hasLongitudinal = hasLongitudinal;
+    m_longitudinal = longitudinal;
+    m_lateral = lateral;
+    m_values.maxLateralAcceleration = std::max(m_values.maxLateralAcceleration, std::fabs(lateral));
+
+    if (scene.minTtc < m_values.minTtc) {
+        m_values.minTtc = scene.minTtc;
+        m_values.minTtcTime = time;
+    }
+    m_values.minHeadway = std::min(m_values.minHeadway, scene.minHeadway);
+    if (scene.hasLane) {
+        double deviation = std::fabs(scene.laneOffset);
+        ++m_values.laneSamples;
+        m_laneSquares += deviation * deviation;
+        m_values.laneDeviationRms = std::sqrt(m_laneSquares / (double)m_values.laneSamples);
+        m_values.laneDeviationMax = std::max(m_values.laneDeviationMax, deviation);
+    }
+}
+
+void KpiEngine::step(const ControlCommand& command, double time, double dt) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_hasPending) {
+        sample(m_pending, time);
+        m_hasPending = false;
+    }
+    ++m_values.steps;
+    if (!(dt > 0.0)) {
+        return;
+    }
+
+    // Control outputs
+    if (m_hasSteering) {
+        m_values.maxSteeringRate = std::max(m_values.maxSteeringRate, std::fabs(command.steering - m_steering) / dt);
+    }
+    m_hasSteering = true;
+    m_steering = command.steering;
+    if (command.brake > 0.0) {
+        m_values.brakeTime += dt;
+        if (command.throttle > 0.0) {
+            m_values.throttleBrakeOverlapTime += dt;
+        }
+    }
+
+    // The last scene holds until the next SensorView
+    if (!m_hasScene || !m_scene.hostFound) {
+        return;
+    }
+    m_values.duration += dt;
+    m_values.distance += std::fabs(m_scene.speed) * dt;
+    if (m_scene.minHeadway < settings.headwayThreshold) {
+        m_values.headwayViolationTime += dt;
+    }
+    if (std::fabs(m_longitudinal) > settings.maxLongitudinalAcceleration
+        || std::fabs(m_lateral) > settings.maxLateralAcceleration
+        || std::fabs(m_jerk) > settings.maxJerk) {
+        m_values.comfortViolationTime += dt;
+    }
+}
+
+KpiValues KpiEngine::values() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_values;
+}
+
+void KpiEngine::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hasPending = false;
+    m_segment = FRENET_NO_SEGMENT;
+    m_hasScene = false;
+    m_sceneTime = 0.0;
+    m_previousSpeed = 0.0;
+    m_hasLongitudinal = false;
+    m_longitudinal = m_lateral = m_jerk = 0.0;
+    m_hasSteering = false;
+    m_steering = 0.0;
+    m_values = KpiValues();
+    m_jerkSquares = 0.0;
+    m_jerkCount = 0;
+    m_laneSquares = 0.0;
+}
+
+bool KpiEngine::writeSummary(const std::string& path, std::string& error) const {
+    KpiValues v = values();
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        error = "cannot open " + path;
+        return false;
+    }
+    out.precision(10);
+    out << "{\n  \"kpi\": {\n";
+    writeField(out, "steps", v.steps);
+    writeField(out, "samples", v.samples);
+    writeField(out, "duration_s", v.duration);
+    writeField(out, "distance_m", v.distance);
+    writeField(out, "min_ttc_s", v.minTtc);
+    writeField(out, "min_ttc_time_s", v.minTtcTime);
+    writeField(out, "min_headway_s", v.minHeadway);
+    writeField(out, "headway_violation_time_s", v.headwayViolationTime);
+    writeField(out, "max_acceleration_mps2", v.maxAcceleration);
+    writeField(out, "max_deceleration_mps2", v.maxDeceleration);
+    writeField(out, "max_lateral_acceleration_mps2", v.maxLateralAcceleration);
+    writeField(out, "max_jerk_mps3", v.maxJerk);
+    writeField(out, "jerk_rms_mps3", v.jerkRms);
+    writeField(out, "comfort_violation_time_s", v.comfortViolationTime);
+    writeField(out, "lane_samples", v.laneSamples);
+    writeField(out, "lane_deviation_rms_m", v.laneSamples > 0 ? v.laneDeviationRms : std::nan(""));
+    writeField(out, "lane_deviation_max_m", v.laneSamples > 0 ? v.laneDeviationMax : std::nan(""));
+    writeField(out, "max_steering_rate_per_s", v.maxSteeringRate);
+    writeField(out, "brake_time_s", v.brakeTime);
+    writeField(out, "throttle_brake_overlap_time_s", v.throttleBrakeOverlapTime, true);
+    out << "  },\n  \"settings\": {\n";
+    writeField(out, "headway_threshold_s", settings.headwayThreshold);
+    writeField(out, "max_longitudinal_acceleration_mps2", settings.maxLongitudinalAcceleration);
+    writeField(out, "max_lateral_acceleration_mps2", settings.maxLateralAcceleration);
+    writeField(out, "max_jerk_mps3", settings.maxJerk, true);
+    out << "  }\n}\n";
+    out.close();
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,302 @@
+#include "LidarPreprocessor.h"
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include "SimdKernels.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+using OsiWire::Field;
+using OsiWire::WireType;
+
+constexpr double SPEED_OF_LIGHT = 299792458.0; // [m/s]
+constexpr uint64_t EMPTY_KEY = ~0ull;          // Voxel keys use 63 bits
+constexpr int64_t VOXEL_INDEX_MASK = 0x1FFFFF; // 21 bits per axis
+
+// Tag byte of a double field 1..15
+constexpr char doubleTag(uint32_t number) {
+    return (char)((number << 3) | (uint32_t)WireType::Fixed64);
+}
+
+// MountingPosition: lidar frame in the vehicle frame, R = Rz(yaw) Ry(pitch) Rx(roll)
+Simd::LidarTransform mountingTransform(const double position[3], const double orientation[3]) {
+    double cr = std::cos(orientation[0]), sr = std::sin(orientation[0]);
+    double cp = std::cos(orientation[1]), sp = std::sin(orientation[1]);
+    double cy = std::cos(orientation[2]), sy = std::sin(orientation[2]);
+    const double r[9] = {
+        cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr,
+        sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr,
+        -sp,     cp * sr,                cp * cr
+    };
+    Simd::LidarTransform transform;
+    for (int k = 0; k < 9; ++k) {
+        transform.r[k] = (float)r[k];
+    }
+    for (int k = 0; k < 3; ++k) {
+        transform.t[k] = (float)position[k];
+    }
+    return transform;
+}
+
+} // namespace
+
+bool LidarPreprocessor::process(const char* sensorView, size_t size, std::string& out, std::string& error) {
+    using namespace OsiFields;
+    auto start = std::chrono::steady_clock::now();
+    m_stats = LidarStats();
+    m_count = 0;
+    m_dx.clear();
+    m_dy.clear();
+    m_dz.clear();
+    m_range.clear();
+    m_signal.clear();
+    m_outX.clear();
+    m_outY.clear();
+    m_outZ.clear();
+    m_outIntensity.clear();
+    m_outCount.clear();
+    out.clear();
+
+    OsiWire::Reader reader(sensorView, size);
+    Field field;
+    while (reader.next(field)) {
+        if (field.number != SensorView::LidarSensorView || field.type != WireType::LengthDelimited) {
+            out.append(field.begin, (size_t)(field.end - field.begin));
+            continue;
+        }
+        ++m_stats.sensors;
+        if (!parseView(field.data, field.size, m_view, error)) {
+            out.clear();
+            return false;
+        }
+        size_t before = out.size();
+        OsiWire::writeLengthDelimited(out, SensorView::LidarSensorView, m_view.data(), m_view.size());
+        m_stats.bytesStripped += (size_t)(field.end - field.begin) - (out.size() - before);
+    }
+    if (!reader.ok()) {
+        error = "malformed SensorView";
+        out.clear();
+        return false;
+    }
+
+    downsample();
+    m_stats.processTimeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// Appends the reflections of one LidarSensorView to the raw arrays, places and
+// classifies them, and writes the view without ray data to stripped
+bool LidarPreprocessor::parseView(const char* data, size_t size, std::string& stripped, std::string& error) {
+    using namespace OsiFields;
+    size_t first = m_range.size();
+    double position[3] = {}, orientation[3] = {};
+    bool hasConfig = false;
+    m_rayX.clear();
+    m_rayY.clear();
+    m_rayZ.clear();
+    m_config.clear();
+
+    OsiWire::Reader view(data, size);
+    Field f;
+    while (view.next(f)) {
+        if (f.type != WireType::LengthDelimited) {
+            continue;
+        }
+        if (f.number == LidarSensorView::ViewConfiguration) {
+            hasConfig = true;
+            OsiWire::Reader config(f.data, f.size);
+            Field c;
+            while (config.next(c)) {
+                if (c.number == LidarSensorViewConfiguration::Directions) {
+                    double v[3];
+                    OsiWire::readVector3d(c, v);
+                    double norm = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+                    double inv = norm > 0.0 ? 1.0 / norm : 0.0;
+                    m_rayX.push_back((float)(v[0] * inv));
+                    m_rayY.push_back((float)(v[1] * inv));
+                    m_rayZ.push_back((float)(v[2] * inv));
+                    continue;
+                }
+                if (c.number == LidarSensorViewConfiguration::Timings) {
+                    continue;
+                }
+                if (c.number == LidarSensorViewConfiguration::MountingPosition && c.type == WireType::LengthDelimited) {
+                    OsiWire::Reader mounting(c.data, c.size);
+                    Field m;
+                    while (mounting.next(m)) {
+                        if (m.number == MountingPosition::Position) {
+                            OsiWire::readVector3d(m, position);
+                        } else if (m.number == MountingPosition::Orientation) {
+                            OsiWire::readVector3d(m, orientation);
+                        }
+                    }
+                }
+                m_config.append(c.begin, (size_t)(c.end - c.begin));
+            }
+            if (!config.ok()) {
+                error = "malformed lidar view configuration";
+                return false;
+            }
+        } else if (f.number == LidarSensorView::Reflection) {
+            double signal = 0.0;
+            double timeOfFlight = std::numeric_limits<double>::quiet_NaN();
+            // Usual encoding: signal_strength and time_of_flight first, in order;
+            // the rest is read as usual (a repeated field would override them)
+            size_t skip = 0;
+            if (f.size >= 18 && f.data[0] == doubleTag(LidarReflection::SignalStrength) &&
+                f.data[9] == doubleTag(LidarReflection::TimeOfFlight)) {
+                std::memcpy(&signal, f.data + 1, 8);
+                std::memcpy(&timeOfFlight, f.data + 10, 8);
+                skip = 18;
+            }
+            OsiWire::Reader reflection(f.data + skip, f.size - skip);
+            Field r;
+            while (reflection.next(r)) {
+                if (r.type != WireType::Fixed64) {
+                    continue;
+                }
+                if (r.number == LidarReflection::SignalStrength) {
+                    signal = OsiWire::readDouble(r);
+                } else if (r.number == LidarReflection::TimeOfFlight) {
+                    timeOfFlight = OsiWire::readDouble(r);
+                }
+            }
+            m_range.push_back((float)(0.5 * SPEED_OF_LIGHT * timeOfFlight));
+            m_signal.push_back((float)signal);
+        }
+    }
+    if (!view.ok()) {
+        error = "malformed LidarSensorView";
+        return false;
+    }
+
+    // Ray of each reflection: one per ray, or the interactions of a ray one after
+    // another. Reflections that cannot be placed get no range and are cropped.
+    size_t count = m_range.size() - first;
+    size_t rays = m_rayX.size();
+    size_t perRay = 0;
+    if (rays > 0 && count <= rays) {
+        perRay = 1;
+    } else if (rays > 0 && count % rays == 0) {
+        perRay = count / rays;
+    }
+    m_dx.resize(first + count);
+    m_dy.resize(first + count);
+    m_dz.resize(first + count);
+    for (size_t i = 0; i < count; ++i) {
+        if (perRay == 0) {
+            m_dx[first + i] = m_dy[first + i] = m_dz[first + i] = 0.0f;
+            m_range[first + i] = std::numeric_limits<float>::quiet_NaN();
+            continue;
+        }
+        size_t ray = i / perRay;
+        m_dx[first + i] = m_rayX[ray];
+        m_dy[first + i] = m_rayY[ray];
+        m_dz[first + i] = m_rayZ[ray];
+    }
+
+    m_x.resize(first + count);
+    m_y.resize(first + count);
+    m_z.resize(first + count);
+    m_keep.resize(first + count);
+    float minZ = settings.removeGround ? (float)(settings.groundHeight + settings.groundTolerance)
+                                       : -std::numeric_limits<float>::infinity();
+    if (count > 0) {
+        Simd::lidarPoints(mountingTransform(position, orientation), &m_dx[first], &m_dy[first], &m_dz[first],
+                          &m_range[first], count, (float)settings.minRange, (float)settings.maxRange, minZ,
+                          &m_x[first], &m_y[first], &m_z[first], &m_keep[first]);
+    }
+
+    stripped.clear();
+    if (hasConfig) {
+        OsiWire::writeLengthDelimited(stripped, LidarSensorView::ViewConfiguration, m_config.data(), m_config.size());
+    }
+    return true;
+}
+
+// One point per occupied voxel at the centroid of its points, in the order the
+// voxels are first hit
+void LidarPreprocessor::downsample() {
+    size_t n = m_range.size();
+    m_stats.reflections = n;
+
+    size_t kept = 0;
+    float minRange = (float)settings.minRange;
+    float maxRange = (float)settings.maxRange;
+    for (size_t i = 0; i < n; ++i) {
+        if (m_keep[i]) {
+            ++kept;
+        } else if (m_range[i] >= minRange && m_range[i] <= maxRange) {
+            ++m_stats.ground;
+        } else {
+            ++m_stats.cropped;
+        }
+    }
+
+    double voxel = settings.voxelSize;
+    if (!(voxel > 0.0)) {
+        for (size_t i = 0; i < n; ++i) {
+            if (m_keep[i]) {
+                m_outX.push_back(m_x[i]);
+                m_outY.push_back(m_y[i]);
+                m_outZ.push_back(m_z[i]);
+                m_outIntensity.push_back(m_signal[i]);
+                m_outCount.push_back(1);
+            }
+        }
+        m_count = m_outX.size();
+        m_stats.points = m_count;
+        return;
+    }
+
+    size_t capacity = 16;
+    int bits = 4;
+    while (capacity < 2 * kept) {
+        capacity <<= 1;
+        ++bits;
+    }
+    m_keys.assign(capacity, EMPTY_KEY);
+    m_slots.resize(capacity);
+    float inv = (float)(1.0 / voxel);
+    for (size_t i = 0; i < n; ++i) {
+        if (!m_keep[i]) {
+            continue;
+        }
+        int64_t ix = (int64_t)std::floor(m_x[i] * inv);
+        int64_t iy = (int64_t)std::floor(m_y[i] * inv);
+        int64_t iz = (int64_t)std::floor(m_z[i] * inv);
+        uint64_t key = ((uint64_t)(ix & VOXEL_INDEX_MASK) << 42) | ((uint64_t)(iy & VOXEL_INDEX_MASK) << 21) |
+                       (uint64_t)(iz & VOXEL_INDEX_MASK);
+        size_t h = (size_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+        while (m_keys[h] != EMPTY_KEY && m_keys[h] != key) {
+            h = (h + 1) & (capacity - 1);
+        }
+        if (m_keys[h] == EMPTY_KEY) {
+            m_keys[h] = key;
+            m_slots[h] = (uint32_t)m_outX.size();
+            m_outX.push_back(0.0f);
+            m_outY.push_back(0.0f);
+            m_outZ.push_back(0.0f);
+            m_outIntensity.push_back(0.0f);
+            m_outCount.push_back(0);
+        }
+        uint32_t slot = m_slots[h];
+        m_outX[slot] += m_x[i];
+        m_outY[slot] += m_y[i];
+        m_outZ[slot] += m_z[i];
+        m_outIntensity[slot] += m_signal[i];
+        ++m_outCount[slot];
+    }
+    m_count = m_outX.size();
+    for (size_t v = 0; v < m_count; ++v) {
+        float scale = 1.0f / (float)m_outCount[v];
+        m_outX[v] *= scale;
+        m_outY[v] *= scale;
+        m_outZ[v] *= scale;
+        m_outIntensity[v] *= scale;
+    }
+    m_stats.points = m_count;
+}
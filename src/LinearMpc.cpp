@@ -0,0 +1,217 @@
+#include "LinearMpc.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr size_t MAX_VARIABLES = 1000; // Dense factor: n^2 doubles
+
+// out (r * c) = a (r * k) * b (k * c)
+void multiply(const double* a, const double* b, size_t r, size_t k, size_t c, double* out) {
+    for (size_t i = 0; i < r; ++i) {
+        for (size_t j = 0; j < c; ++j) {
+            double sum = 0.0;
+            for (size_t l = 0; l < k; ++l) {
+                sum += a[i * k + l] * b[l * c + j];
+            }
+            out[i * c + j] = sum;
+        }
+    }
+}
+
+bool checkSize(const std::vector<double>& v, size_t size, bool optional, const char* name, std::string& error) {
+    if ((optional && v.empty()) || v.size() == size) {
+        for (double value : v) {
+            if (std::isnan(value)) {
+                error = std::string(name) + " contains NaN";
+                return false;
+            }
+        }
+        return true;
+    }
+    error = std::string(name) + ": expected " + std::to_string(size) + " values, got " + std::to_string(v.size());
+    return false;
+}
+
+} // namespace
+
+bool LinearMpc::setup(const LinearMpcProblem& problem, const QpSettings& settings, std::string& error) {
+    size_t nx = problem.nx;
+    size_t nu = problem.nu;
+    size_t N = problem.horizon;
+    if (nx == 0 || nu == 0 || N == 0) {
+        error = "MPC needs states, inputs and a horizon";
+        return false;
+    }
+    if (N * nu > MAX_VARIABLES) {
+        error = "MPC with " + std::to_string(N * nu) + " inputs (at most " + std::to_string(MAX_VARIABLES) + ")";
+        return false;
+    }
+    if (!checkSize(problem.A, nx * nx, false, "A", error) || !checkSize(problem.B, nx * nu, false, "B", error) ||
+        !checkSize(problem.Q, nx * nx, false, "Q", error) || !checkSize(problem.R, nu * nu, false, "R", error) ||
+        !checkSize(problem.P, nx * nx, true, "P", error) || !checkSize(problem.uMin, nu, true, "u_min", error) ||
+        !checkSize(problem.uMax, nu, true, "u_max", error) || !checkSize(problem.duMax, nu, true, "du_max", error) ||
+        !checkSize(problem.xMin, nx, true, "x_min", error) || !checkSize(problem.xMax, nx, true, "x_max", error)) {
+        return false;
+    }
+    m_problem = problem;
+    if (m_problem.P.empty()) {
+        m_problem.P = m_problem.Q;
+    }
+
+    // Prediction matrices: Sx block k = A^(k+1), Su block (k, j) = A^(k-j) B for j <= k
+    size_t rowsX = N * nx;
+    size_t n = N * nu;
+    m_Sx.assign(rowsX * nx, 0.0);
+    m_Su.assign(rowsX * n, 0.0);
+    std::vector<double> powerB(N * nx * nu);   // A^d B, d = 0 .. N-1
+    std::copy(problem.B.begin(), problem.B.end(), powerB.begin());
+    for (size_t d = 1; d < N; ++d) {
+        multiply(problem.A.data(), &powerB[(d - 1) * nx * nu], nx, nx, nu, &powerB[d * nx * nu]);
+    }
+    std::copy(problem.A.begin(), problem.A.end(), m_Sx.begin());
+    for (size_t k = 1; k < N; ++k) {
+        multiply(problem.A.data(), &m_Sx[(k - 1) * nx * nx], nx, nx, nx, &m_Sx[k * nx * nx]);
+    }
+    for (size_t k = 0; k < N; ++k) {
+        for (size_t j = 0; j <= k; ++j) {
+            const double* block = &powerB[(k - j) * nx * nu];
+            for (size_t r = 0; r < nx; ++r) {
+                std::copy(block + r * nu, block + (r + 1) * nu, &m_Su[(k * nx + r) * n + j * nu]);
+            }
+        }
+    }
+
+    // W = Su' Qbar, H = W Su + Rbar
+    m_W.assign(n * rowsX, 0.0);
+    for (size_t c = 0; c < n; ++c) {
+        for (size_t k = 0; k < N; ++k) {
+            const double* weight = k + 1 == N ? m_problem.P.data() : m_problem.Q.data();
+            for (size_t i = 0; i < nx; ++i) {
+                double sum = 0.0;
+                for (size_t j = 0; j < nx; ++j) {
+                    sum += m_Su[(k * nx + j) * n + c] * weight[j * nx + i];
+                }
+                m_W[c * rowsX + k * nx + i] = sum;
+            }
+        }
+    }
+    std::vector<double> H(n * n);
+    multiply(m_W.data(), m_Su.data(), n, rowsX, n, H.data());
+    for (size_t k = 0; k < N; ++k) {
+        for (size_t r = 0; r < nu; ++r) {
+            for (size_t c = 0; c < nu; ++c) {
+                H[(k * nu + r) * n + k * nu + c] += m_problem.R[r * nu + c];
+            }
+        }
+    }
+
+    // Constraint rows: input rates, then the bounded state components
+    m_rateRows = m_problem.duMax.empty() ? 0 : n;
+    m_stateRows.clear();
+    if (!m_problem.xMin.empty() || !m_problem.xMax.empty()) {
+        for (size_t k = 0; k < N; ++k) {
+            for (size_t i = 0; i < nx; ++i) {
+                bool lower = !m_problem.xMin.empty() && m_problem.xMin[i] > -INF;
+                bool upper = !m_problem.xMax.empty() && m_problem.xMax[i] < INF;
+                if (lower || upper) {
+                    m_stateRows.push_back(k * nx + i);
+                }
+            }
+        }
+    }
+    size_t m = m_rateRows + m_stateRows.size();
+    std::vector<double> constraints(m * n, 0.0);
+    for (size_t r = 0; r < m_rateRows; ++r) {
+        constraints[r * n + r] = 1.0;
+        if (r >= nu) {
+            constraints[r * n + r - nu] = -1.0;
+        }
+    }
+    for (size_t r = 0; r < m_stateRows.size(); ++r) {
+        const double* row = &m_Su[m_stateRows[r] * n];
+        std::copy(row, row + n, &constraints[(m_rateRows + r) * n]);
+    }
+
+    m_qp.settings = settings;
+    if (!m_qp.setup(n, m, H.data(), constraints.data(), error)) {
+        return false;
+    }
+    m_free.assign(rowsX, 0.0);
+    m_error.assign(rowsX, 0.0);
+    m_g.assign(n, 0.0);
+    m_lb.assign(n, -INF);
+    m_ub.assign(n, INF);
+    m_lbA.assign(m, -INF);
+    m_ubA.assign(m, INF);
+    m_shift.assign(n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        if (!m_problem.uMin.empty()) {
+            m_lb[i] = m_problem.uMin[i % nu];
+        }
+        if (!m_problem.uMax.empty()) {
+            m_ub[i] = m_problem.uMax[i % nu];
+        }
+    }
+    m_solved = false;
+    return true;
+}
+
+const QpInfo& LinearMpc::solve(const double* x0, const double* reference, const double* uPrev) {
+    size_t nx = m_problem.nx;
+    size_t nu = m_problem.nu;
+    size_t rowsX = m_Sx.size() / (nx ? nx : 1);
+    size_t n = m_g.size();
+
+    // Free response and tracking error
+    for (size_t r = 0; r < rowsX; ++r) {
+        double sum = 0.0;
+        for (size_t c = 0; c < nx; ++c) {
+            sum += m_Sx[r * nx + c] * x0[c];
+        }
+        m_free[r] = sum;
+        m_error[r] = sum - (reference ? reference[r] : 0.0);
+    }
+    for (size_t c = 0; c < n; ++c) {
+        const double* row = &m_W[c * rowsX];
+        double sum = 0.0;
+        for (size_t r = 0; r < rowsX; ++r) {
+            sum += row[r] * m_error[r];
+        }
+        m_g[c] = sum;
+    }
+
+    // Rate rows: u[0] - uPrev within +-duMax, u[k] - u[k-1] within +-duMax
+    for (size_t r = 0; r < m_rateRows; ++r) {
+        double limit = m_problem.duMax[r % nu];
+        if (r < nu) {
+            m_lbA[r] = uPrev ? uPrev[r] - limit : -INF;
+            m_ubA[r] = uPrev ? uPrev[r] + limit : INF;
+        } else {
+            m_lbA[r] = -limit;
+            m_ubA[r] = limit;
+        }
+    }
+    for (size_t r = 0; r < m_stateRows.size(); ++r) {
+        size_t row = m_stateRows[r];
+        size_t i = row % nx;
+        m_lbA[m_rateRows + r] = m_problem.xMin.empty() ? -INF : m_problem.xMin[i] - m_free[row];
+        m_ubA[m_rateRows + r] = m_problem.xMax.empty() ? INF : m_problem.xMax[i] - m_free[row];
+    }
+
+    // Receding horizon: start from the previous inputs shifted by one step
+    if (m_solved) {
+        const double* previous = m_qp.solution();
+        std::copy(previous + nu, previous + n, m_shift.begin());
+        std::copy(previous + n - nu, previous + n, m_shift.begin() + (n - nu));
+        m_qp.warmStart(m_shift.data());
+    }
+    const QpInfo& info = m_qp.solve(m_g.data(), m_lb.data(), m_ub.data(), m_lbA.data(), m_ubA.data());
+    m_solved = info.status == QpStatus::Solved || info.status == QpStatus::MaxIterations;
+    if (!m_solved) {
+        m_qp.resetWarmStart();
+    }
+    return info;
+}
@@ -0,0 +1,146 @@
+#include "MovingObjects.h"
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include <cmath>
+
+namespace {
+
+using OsiWire::Field;
+using OsiWire::WireType;
+
+struct ObjectState {
+    uint64_t id = 0;
+    uint32_t type = 0;
+    bool hasPosition = false;
+    double position[3] = {};
+    double dimension[3] = {};
+    double orientation[3] = {};
+    double velocity[3] = {};
+    double acceleration[3] = {};
+    double orientationRate[3] = {};
+};
+
+bool readObject(const Field& object, ObjectState& state) {
+    using namespace OsiFields;
+    OsiWire::Reader reader(object.data, object.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.number == MovingObject::Id) {
+            OsiWire::readIdentifier(f, state.id);
+        } else if (f.number == MovingObject::Type && f.type == WireType::Varint) {
+            state.type = (uint32_t)f.varint;
+        } else if (f.number == MovingObject::Base && f.type == WireType::LengthDelimited) {
+            OsiWire::Reader base(f.data, f.size);
+            Field b;
+            while (base.next(b)) {
+                switch (b.number) {
+                    case BaseMoving::Dimension:    OsiWire::readVector3d(b, state.dimension); break;
+                    case BaseMoving::Position:     OsiWire::readVector3d(b, state.position); state.hasPosition = true; break;
+                    case BaseMoving::Orientation:  OsiWire::readVector3d(b, state.orientation); break;
+                    case BaseMoving::Velocity:     OsiWire::readVector3d(b, state.velocity); break;
+                    case BaseMoving::Acceleration: OsiWire::readVector3d(b, state.acceleration); break;
+                    case BaseMoving::OrientationRate: OsiWire::readVector3d(b, state.orientationRate); break;
+                    default: break;
+                }
+            }
+            if (!base.ok()) {
+                return false;
+            }
+        }
+    }
+    return reader.ok();
+}
+
+} // namespace
+
+bool MovingObjects::extract(const char* sensorView, size_t size, std::string& error) {
+    using namespace OsiFields;
+    count = 0;
+    hostId = 0;
+    hostIndex = -1;
+    id.clear();
+    type.clear();
+    x.clear();
+    y.clear();
+    yaw.clear();
+    cosYaw.clear();
+    sinYaw.clear();
+    length.clear();
+    width.clear();
+    vx.clear();
+    vy.clear();
+    ax.clear();
+    ay.clear();
+    yawRate.clear();
+
+    OsiWire::Reader reader(sensorView, size);
+    Field field;
+    Field gt;
+    bool hasGt = false;
+    while (reader.next(field)) {
+        if (field.number == SensorView::HostVehicleId) {
+            OsiWire::readIdentifier(field, hostId);
+        } else if (field.number == SensorView::GlobalGroundTruth && field.type == WireType::LengthDelimited && !hasGt) {
+            gt = field;
+            hasGt = true;
+        }
+    }
+    if (!reader.ok()) {
+        error = "malformed SensorView";
+        return false;
+    }
+    if (!hasGt) {
+        return true;
+    }
+
+    uint64_t gtHostId = 0;
+    bool malformed = false;
+    OsiWire::Reader elements(gt.data, gt.size);
+    while (elements.next(field)) {
+        if (field.number == GroundTruth::HostVehicleId) {
+            OsiWire::readIdentifier(field, gtHostId);
+            continue;
+        }
+        if (field.number != GroundTruth::MovingObject || field.type != WireType::LengthDelimited) {
+            continue;
+        }
+        ObjectState state;
+        if (!readObject(field, state)) {
+            malformed = true;
+            break;
+        }
+        if (!state.hasPosition || !std::isfinite(state.position[0]) || !std::isfinite(state.position[1])) {
+            continue;
+        }
+        id.push_back(state.id);
+        type.push_back(state.type);
+        x.push_back(state.position[0]);
+        y.push_back(state.position[1]);
+        yaw.push_back(state.orientation[2]);
+        cosYaw.push_back(std::cos(state.orientation[2]));
+        sinYaw.push_back(std::sin(state.orientation[2]));
+        length.push_back(state.dimension[0]);
+        width.push_back(state.dimension[1]);
+        vx.push_back(state.velocity[0]);
+        vy.push_back(state.velocity[1]);
+        ax.push_back(state.acceleration[0]);
+        ay.push_back(state.acceleration[1]);
+        yawRate.push_back(state.orientationRate[2]);
+    }
+    if (malformed || !elements.ok()) {
+        error = "malformed GroundTruth";
+        return false;
+    }
+    count = id.size();
+
+    if (hostId == 0) {
+        hostId = gtHostId;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (id[i] == hostId) {
+            hostIndex = (long long)i;
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,299 @@
+#include "MppiPlanner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr size_t ROLLOUT_GRAIN = 8;    // Samples per chunk of the worker pool
+constexpr size_t MAX_PATH_ADVANCE = 16; // Segments searched ahead per step
+
+uint64_t splitMix(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Two standard normal values (Box-Muller)
+void normalPair(uint64_t& state, double& n0, double& n1) {
+    double u0 = ((double)(splitMix(state) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+    double u1 = (double)(splitMix(state) >> 11) * (1.0 / 9007199254740992.0);
+    double r = std::sqrt(-2.0 * std::log(u0));
+    n0 = r * std::cos(2.0 * PI * u1);
+    n1 = r * std::sin(2.0 * PI * u1);
+}
+
+double wrapAngle(double a) {
+    return std::remainder(a, 2.0 * PI);
+}
+
+double clamp(double v, double lo, double hi) {
+    return std::min(hi, std::max(lo, v));
+}
+
+// Squared distance from (x, y) to the segment a-b and the parameter along it
+double segmentDistance(double x, double y, double ax, double ay, double bx, double by, double& u) {
+    double dx = bx - ax;
+    double dy = by - ay;
+    double lengthSq = dx * dx + dy * dy;
+    u = lengthSq > 0.0 ? clamp(((x - ax) * dx + (y - ay) * dy) / lengthSq, 0.0, 1.0) : 0.0;
+    double ex = ax + u * dx - x;
+    double ey = ay + u * dy - y;
+    return ex * ex + ey * ey;
+}
+
+} // namespace
+
+MppiPlanner::MppiPlanner(std::shared_ptr<WorkerPool> pool)
+    : m_pool(std::move(pool)) {
+}
+
+bool MppiPlanner::setReference(const double* x, const double* y, const double* speed, size_t count, std::string& error) {
+    if (count < 2) {
+        error = "reference path needs at least 2 points";
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!std::isfinite(x[i]) || !std::isfinite(y[i]) || !std::isfinite(speed[i])) {
+            error = "reference path contains NaN or infinity";
+            return false;
+        }
+    }
+    m_refX.assign(x, x + count);
+    m_refY.assign(y, y + count);
+    m_refSpeed.assign(speed, speed + count);
+    m_refHeading.resize(count - 1);
+    for (size_t i = 0; i + 1 < count; ++i) {
+        m_refHeading[i] = std::atan2(y[i + 1] - y[i], x[i + 1] - x[i]);
+    }
+    return true;
+}
+
+void MppiPlanner::reset() {
+    m_planned = false;
+    std::fill(m_nominal.begin(), m_nominal.end(), 0.0);
+}
+
+bool MppiPlanner::validate(std::string& error) const {
+    const MppiSettings& s = settings;
+    if (s.samples == 0 || s.steps == 0 || s.samples * s.steps > 50000000 || s.iterations < 1) {
+        error = "need samples >= 1, steps >= 1, iterations >= 1 and samples * steps <= 5e7";
+        return false;
+    }
+    if (!(s.dt > 0.0) || !(s.temperature > 0.0) || !(s.wheelbase > 0.0) || !(s.accelerationSigma > 0.0) ||
+        !(s.steeringSigma > 0.0) || !(s.steeringMax > 0.0) || !(s.accelerationMin <= s.accelerationMax)) {
+        error = "need dt, temperature, wheelbase, sigmas and steering_max > 0 and acceleration_min <= acceleration_max";
+        return false;
+    }
+    return true;
+}
+
+// Squared lateral, heading and speed error to the reference path. segment is
+// advanced along the path (rollouts move forward, a few segments per step).
+double MppiPlanner::pathCost(double x, double y, double yaw, double speed, size_t& segment) const {
+    if (m_refX.empty()) {
+        return 0.0;
+    }
+    size_t last = m_refX.size() - 2;
+    double u;
+    double best = segmentDistance(x, y, m_refX[segment], m_refY[segment], m_refX[segment + 1], m_refY[segment + 1], u);
+    for (size_t k = 0; k < MAX_PATH_ADVANCE && segment < last; ++k) {
+        double uNext;
+        double next = segmentDistance(x, y, m_refX[segment + 1], m_refY[segment + 1], m_refX[segment + 2],
+                                      m_refY[segment + 2], uNext);
+        if (next > best) {
+            break;
+        }
+        best = next;
+        u = uNext;
+        ++segment;
+    }
+    double referenceSpeed = m_refSpeed[segment] + u * (m_refSpeed[segment + 1] - m_refSpeed[segment]);
+    double heading = wrapAngle(yaw - m_refHeading[segment]);
+    double speedError = speed - referenceSpeed;
+    return settings.lateralWeight * best + settings.headingWeight * heading * heading +
+           settings.speedWeight * speedError * speedError;
+}
+
+void MppiPlanner::rollout(size_t sample, uint64_t round) {
+    const MppiSettings& s = settings;
+    double* noise = &m_noise[sample * s.steps * MPPI_CONTROL_SIZE];
+    uint64_t rng = s.seed ^ (round * 0xD1B54A32D192ED03ull) ^ (sample * 0x9E3779B97F4A7C15ull);
+    double x = m_state[0];
+    double y = m_state[1];
+    double yaw = m_state[2];
+    double v = m_state[3];
+    size_t segment = m_startSegment;
+    double invVarA = 1.0 / (s.accelerationSigma * s.accelerationSigma);
+    double invVarS = 1.0 / (s.steeringSigma * s.steeringSigma);
+    double clearance = s.egoRadius + s.safetyMargin;
+    double cost = 0.0;
+    bool collided = false;
+
+    for (size_t t = 0; t < s.steps; ++t) {
+        double n0 = 0.0, n1 = 0.0;
+        if (sample != 0) { // Sample 0 keeps the nominal sequence
+            normalPair(rng, n0, n1);
+        }
+        double ua = m_nominal[t * MPPI_CONTROL_SIZE];
+        double us = m_nominal[t * MPPI_CONTROL_SIZE + 1];
+        double a = clamp(ua + s.accelerationSigma * n0, s.accelerationMin, s.accelerationMax);
+        double delta = clamp(us + s.steeringSigma * n1, -s.steeringMax, s.steeringMax);
+        double ea = a - ua;
+        double es = delta - us;
+        noise[t * MPPI_CONTROL_SIZE] = ea;
+        noise[t * MPPI_CONTROL_SIZE + 1] = es;
+        cost += s.temperature * (ua * ea * invVarA + us * es * invVarS);
+        cost += s.accelerationWeight * a * a + s.steeringWeight * delta * delta;
+
+        // Kinematic bicycle (rear axle), explicit Euler, no reversing
+        x += v * std::cos(yaw) * s.dt;
+        y += v * std::sin(yaw) * s.dt;
+        yaw += v / s.wheelbase * std::tan(delta) * s.dt;
+        v = std::max(0.0, v + a * s.dt);
+
+        cost += pathCost(x, y, yaw, v, segment);
+
+        if (t < m_obstacleSteps) {
+            for (size_t o = 0; o < m_obstacleCount; ++o) {
+                const double* obstacle = &m_obstacles[(o * m_obstacleSteps + t) * MPPI_STATE_SIZE];
+                double dx = obstacle[0] - x;
+                double dy = obstacle[1] - y;
+                double reach = m_radius[o] + clearance;
+                double distanceSq = dx * dx + dy * dy;
+                if (distanceSq >= reach * reach) {
+                    continue;
+                }
+                double gap = std::sqrt(distanceSq) - m_radius[o] - s.egoRadius;
+                if (gap < 0.0) {
+                    cost += s.collisionCost;
+                    collided = true;
+                } else {
+                    double depth = s.safetyMargin - gap;
+                    cost += s.proximityWeight * depth * depth;
+                }
+            }
+        }
+    }
+    m_cost[sample] = cost;
+    m_collided[sample] = collided ? 1 : 0;
+}
+
+bool MppiPlanner::plan(const double* state, const double* obstacles, size_t obstacleCount, size_t obstacleSteps,
+                       const double* radius, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    if (!validate(error)) {
+        return false;
+    }
+    for (size_t i = 0; i < MPPI_STATE_SIZE; ++i) {
+        if (!std::isfinite(state[i])) {
+            error = "state contains NaN or infinity";
+            return false;
+        }
+    }
+    const MppiSettings& s = settings;
+    if (obstacleCount > 0 && obstacleSteps < s.steps) {
+        error = "obstacle predictions need at least " + std::to_string(s.steps) + " steps";
+        return false;
+    }
+
+    // Buffers follow the settings; the sequence restarts when the horizon changes
+    size_t controlSize = s.steps * MPPI_CONTROL_SIZE;
+    if (m_nominal.size() != controlSize) {
+        m_nominal.assign(controlSize, 0.0);
+        m_planned = false;
+    }
+    m_noise.resize(s.samples * controlSize);
+    m_cost.resize(s.samples);
+    m_collided.resize(s.samples);
+    m_trajectory.resize(s.steps * MPPI_STATE_SIZE);
+
+    // Receding horizon: drop the applied first control, repeat the last one
+    if (m_planned) {
+        std::copy(m_nominal.begin() + MPPI_CONTROL_SIZE, m_nominal.end(), m_nominal.begin());
+    }
+
+    std::copy(state, state + MPPI_STATE_SIZE, m_state);
+    m_obstacles = obstacles;
+    m_obstacleCount = obstacleCount;
+    m_obstacleSteps = obstacleCount > 0 ? obstacleSteps : 0;
+    m_radius = radius;
+    m_startSegment = 0;
+    if (!m_refX.empty()) {
+        double best = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i + 1 < m_refX.size(); ++i) {
+            double u;
+            double d = segmentDistance(state[0], state[1], m_refX[i], m_refY[i], m_refX[i + 1], m_refY[i + 1], u);
+            if (d < best) {
+                best = d;
+                m_startSegment = i;
+            }
+        }
+    }
+
+    std::function<void(size_t, size_t, size_t)> body = [this](size_t begin, size_t end, size_t) {
+        for (size_t k = begin; k < end; ++k) {
+            rollout(k, m_round);
+        }
+    };
+    for (int iteration = 0; iteration < s.iterations; ++iteration) {
+        ++m_round;
+        m_pool->parallelFor(s.samples, ROLLOUT_GRAIN, body);
+
+        // Path-integral weights relative to the best sample
+        double minCost = *std::min_element(m_cost.begin(), m_cost.end());
+        double sum = 0.0;
+        double sumSq = 0.0;
+        size_t collisionFree = 0;
+        for (size_t k = 0; k < s.samples; ++k) {
+            double w = std::exp(-(m_cost[k] - minCost) / s.temperature);
+            m_cost[k] = w;
+            sum += w;
+            sumSq += w * w;
+            collisionFree += m_collided[k] ? 0 : 1;
+        }
+        for (size_t k = 0; k < s.samples; ++k) {
+            double w = m_cost[k] / sum;
+            if (w < 1e-12) {
+                continue;
+            }
+            const double* noise = &m_noise[k * controlSize];
+            for (size_t i = 0; i < controlSize; ++i) {
+                m_nominal[i] += w * noise[i];
+            }
+        }
+        for (size_t t = 0; t < s.steps; ++t) {
+            double& a = m_nominal[t * MPPI_CONTROL_SIZE];
+            double& delta = m_nominal[t * MPPI_CONTROL_SIZE + 1];
+            a = clamp(a, s.accelerationMin, s.accelerationMax);
+            delta = clamp(delta, -s.steeringMax, s.steeringMax);
+        }
+        m_info.minCost = minCost;
+        m_info.effectiveSamples = sum * sum / sumSq;
+        m_info.collisionFree = collisionFree;
+    }
+    m_planned = true;
+
+    // States along the resulting sequence
+    double x = state[0], y = state[1], yaw = state[2], v = state[3];
+    for (size_t t = 0; t < s.steps; ++t) {
+        double a = m_nominal[t * MPPI_CONTROL_SIZE];
+        double delta = m_nominal[t * MPPI_CONTROL_SIZE + 1];
+        x += v * std::cos(yaw) * s.dt;
+        y += v * std::sin(yaw) * s.dt;
+        yaw += v / s.wheelbase * std::tan(delta) * s.dt;
+        v = std::max(0.0, v + a * s.dt);
+        double* out = &m_trajectory[t * MPPI_STATE_SIZE];
+        out[0] = x;
+        out[1] = y;
+        out[2] = wrapAngle(yaw);
+        out[3] = v;
+    }
+    m_obstacles = nullptr;
+    m_radius = nullptr;
+    m_info.solveTimeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
@@ -1,7 +1,12 @@
 #include "OSMPController.h"
+#include "OsiFields.h"
+#include "PythonMemoryPolicy.h"
 #include <Windows.h>
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <optional>
 #include <sstream>
 
 namespace fs = std::filesystem;
@@ -9,12 +14,55 @@ namespace fs = std::filesystem;
 // Global Python Interpreter Guard
 static std::unique_ptr<py::scoped_interpreter> g_interpreter;
 
+// Thread state of the host thread while it runs without the GIL (step deadline mode)
+static PyThreadState* g_hostThreadState = nullptr;
+
+// Signal log columns written by the Core, in this order after the time column
+static const std::pair<const char*, SignalType> CORE_SIGNALS[] = {
+    { "throttle", SignalType::Float64 },
+    { "brake", SignalType::Float64 },
+    { "steering", SignalType::Float64 },
+    { "drive_mode", SignalType::Int32 },
+    { "valid", SignalType::UInt8 },
+    { "step_us", SignalType::Float32 },
+    { "prepare_us", SignalType::Float32 },
+    { "python_us", SignalType::Float32 },
+    { "output_us", SignalType::Float32 },
+};
+constexpr size_t CORE_SIGNAL_COUNT = sizeof(CORE_SIGNALS) / sizeof(CORE_SIGNALS[0]);
+
+// Native OSI decode needs the protobuf 'cpp' backend: the Core built with the C++ OSI
+// bindings and google/protobuf/pyext/_message bundled (the upb wheels do not ship it).
+// Looked up without importing it, so that the backend can still be selected. Requires the GIL.
+static bool cppProtobufBackendAvailable() {
+#ifdef GTDC_WITH_OSI_CPP
+    try {
+        return !py::module::import("importlib.util").attr("find_spec")("google.protobuf.pyext._message").is_none();
+    }
+    catch (py::error_already_set&) {
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+static double elapsedUs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
 // initializePython - When using python312._pth file, do NOT call Py_SetPythonHome
 // The _pth file will automatically configure sys.path if it's in the same directory as python312.dll
-void OSMPController::GlobalInitializePython(const std::wstring& pythonHome) {
+void OSMPController::GlobalInitializePython(const std::wstring& pythonHome, int allocatorMode) {
     if (!g_interpreter) {
         // DO NOT set Python Home when using _pth file
         // Py_SetPythonHome(const_cast<wchar_t*>(pythonHome.c_str()));
+
+        // The allocator is process-wide: the first instance to initialize Python selects it
+        if (!PythonMemory::configureAllocator((PythonMemory::AllocatorMode)allocatorMode)) {
+            std::cerr << "[GT-DriveController] Warning: PythonAllocator " << allocatorMode
+                      << " not available in this build, using default allocator" << std::endl;
+        }
         
         // Initialize Interpreter
         g_interpreter = std::make_unique<py::scoped_interpreter>();
@@ -22,6 +70,10 @@ void OSMPController::GlobalInitializePython(const std::wstring& pythonHome) {
 }
 
 void OSMPController::GlobalFinalizePython() {
+    if (g_hostThreadState) {
+        PyEval_RestoreThread(g_hostThreadState);
+        g_hostThreadState = nullptr;
+    }
     g_interpreter.reset();
 }
 
@@ -33,12 +85,23 @@ OSMPController::OSMPController(fmi2String instanceName, fmi2String fmuResourceLo
 }
 
 OSMPController::~OSMPController() {
+    // Stop the step worker first; it may need the GIL to finish a late job
+    if (m_stepWorker) {
+        std::optional<py::gil_scoped_release> release;
+        if (PyGILState_Check()) {
+            release.emplace();
+        }
+        m_stepWorker.reset();
+    }
+
     // Properly release Python object by assigning None
     // (release() would leak by not decrementing refcount)
     if (m_pythonInitialized) {
         // Acquire GIL before touching Python objects
         py::gil_scoped_acquire acquire;
+        releaseInputViews();
         m_pyController = py::none();
+        m_staticMap.release();
     }
 }
 
@@ -51,6 +114,9 @@ fmi2Status OSMPController::doInit() {
 
     std::cout << "[GT-DriveController] Enter doInit..." << std::endl;
 
+    // The host reads the request during initialization mode
+    buildSensorViewConfigRequest();
+
     try {
         // Construct absolute path to resources
         fs::path resDir(m_resourcePath);
@@ -61,9 +127,12 @@ fmi2Status OSMPController::doInit() {
         
         // Ensure Interpreter is running
         std::cout << "[GT-DriveController] Initializing Python Interpreter..." << std::endl;
-        GlobalInitializePython(pythonHome.wstring());
+        GlobalInitializePython(pythonHome.wstring(), m_pythonAllocator);
         std::cout << "[GT-DriveController] Python Interpreter Initialized." << std::endl;
 
+        // Another instance in deadline mode may have released the GIL on this thread
+        py::gil_scoped_acquire acquire;
+
         std::cout << "[GT-DriveController] Importing sys module..." << std::endl;
         py::module sys = py::module::import("sys");
         std::cout << "[GT-DriveController] sys module imported." << std::endl;
@@ -123,6 +192,37 @@ fmi2Status OSMPController::doInit() {
             std::cerr << "[GT-DriveController] Error: Failed to update sys.path" << std::endl;
         }
 
+        // Select the protobuf backend before google.protobuf is imported for the first time.
+        // "auto" lets api_implementation pick upb when google/_upb/_message.pyd is bundled.
+        // Native OSI decode shares C++ messages with Python, which only the 'cpp' backend can wrap.
+        // Without it, requesting 'cpp' would make the first google.protobuf import fail: the
+        // inputs are passed as bytes instead.
+        std::string requestedBackend = m_protobufBackend;
+        bool nativeDecode = (OsiDecodeMode)m_osiDecodeMode == OsiDecodeMode::Native;
+        for (const OsiInputChannel& channel : m_inputChannels) {
+            nativeDecode |= (OsiDecodeMode)channel.decodeMode == OsiDecodeMode::Native;
+        }
+        if (nativeDecode && (requestedBackend == "auto" || requestedBackend.empty())) {
+            if (cppProtobufBackendAvailable()) {
+                requestedBackend = "cpp";
+            } else {
+                std::cerr << "[GT-DriveController] Warning: Native OSI decode needs the protobuf 'cpp' backend "
+                          << "(GTDC_WITH_OSI_CPP build and google.protobuf.pyext._message), passing bytes to Python" << std::endl;
+                if ((OsiDecodeMode)m_osiDecodeMode == OsiDecodeMode::Native) {
+                    m_osiDecodeMode = (fmi2Integer)OsiDecodeMode::Raw;
+                }
+                for (OsiInputChannel& channel : m_inputChannels) {
+                    if ((OsiDecodeMode)channel.decodeMode == OsiDecodeMode::Native) {
+                        channel.decodeMode = (fmi2Integer)OsiDecodeMode::Raw;
+                    }
+                }
+            }
+        }
+        if (requestedBackend != "auto" && !requestedBackend.empty()) {
+            std::cout << "[GT-DriveController] Requesting protobuf backend: " << requestedBackend << std::endl;
+            py::module::import("os").attr("environ")["PROTOCOL_BUFFERS_PYTHON_IMPLEMENTATION"] = requestedBackend;
+        }
+
         // Import module (filename without .py)
         std::string moduleName = scriptPath.stem().string();
         std::cout << "[GT-DriveController] Importing module: " << moduleName << std::endl;
@@ -133,21 +233,124 @@ fmi2Status OSMPController::doInit() {
         // Import using module name, NOT path
         py::module logic = py::module::import(moduleName.c_str());
         std::cout << "[GT-DriveController] Module imported successfully." << std::endl;
+
+        // Report the protobuf backend in use; api_implementation falls back to the
+        // pure-Python implementation when the upb extension is missing or fails to load
+        try {
+            std::string backend = py::module::import("google.protobuf.internal.api_implementation")
+                                      .attr("Type")().cast<std::string>();
+            std::cout << "[GT-DriveController] Protobuf backend: " << backend << std::endl;
+            if (backend == "python") {
+                std::cout << "[GT-DriveController] Note: upb extension not available, OSI parsing uses the pure-Python decoder" << std::endl;
+            }
+        }
+        catch (py::error_already_set&) {
+            std::cout << "[GT-DriveController] Protobuf backend: not loaded" << std::endl;
+        }
+
+        initializeOsiDecode();
         
         // Instantiate Controller
         std::cout << "[GT-DriveController] Instantiating Python Controller class..." << std::endl;
         m_pyController = logic.attr("Controller")();
         std::cout << "[GT-DriveController] Python Controller instantiated." << std::endl;
+
+        // Persistent map handle; its content is updated when the static GroundTruth changes
+        if (m_staticMapEnabled) {
+            m_pyController.attr("static_map") = m_staticMap.handle();
+
+            // Frenet projection on the lane centerlines of the static map (gt_drive_native)
+            py::module::import("gt_drive_native");
+            m_frenet = std::make_shared<FrenetEngine>();
+            m_pyController.attr("frenet") = py::cast(m_frenet);
+        }
+
+        // Spatial index over the moving objects, rebuilt incrementally before each update_control()
+        if (m_objectIndexEnabled) {
+            py::module::import("gt_drive_native");
+            m_objectIndex = std::make_shared<ObjectIndex>(m_frenet);
+            m_pyController.attr("object_index") = py::cast(m_objectIndex);
+        }
+
+        // Ego-frame positions, relative velocities, TTC and headway of all objects
+        if (m_egoFrameEnabled) {
+            py::module::import("gt_drive_native");
+            m_egoFrame = std::make_shared<EgoFrame>();
+            m_pyController.attr("ego_frame") = py::cast(m_egoFrame);
+        }
+
+        // Trajectory prediction of the moving objects (lane following needs the static map)
+        if (m_predictionEnabled) {
+            py::module::import("gt_drive_native");
+            m_predictor = std::make_shared<TrajectoryPredictor>(m_frenet);
+            m_pyController.attr("predictor") = py::cast(m_predictor);
+        }
+
+        // Sampling-based planner; its pool threads start here and sleep between plan() calls
+        if (m_plannerEnabled) {
+            py::module::import("gt_drive_native");
+            size_t threads = m_plannerThreads > 0 ? (size_t)m_plannerThreads : (size_t)std::thread::hardware_concurrency();
+            auto pool = std::make_shared<WorkerPool>(threads, [this](size_t worker) { applyRealtimePlannerThread(worker); });
+            m_planner = std::make_shared<MppiPlanner>(pool);
+            m_pyController.attr("planner") = py::cast(m_planner);
+            std::cout << "[GT-DriveController] MPPI planner: " << pool->threads() << " thread(s)" << std::endl;
+        }
+
+        // Occupancy grid; lane boundaries, drivable area and stationary objects need the static map
+        if (m_occupancyEnabled) {
+            py::module::import("gt_drive_native");
+            m_occupancyGrid = std::make_shared<OccupancyGrid>(m_occupancyResolution, m_occupancySize);
+            m_pyController.attr("occupancy_grid") = py::cast(m_occupancyGrid);
+            std::cout << "[GT-DriveController] Occupancy grid: " << m_occupancyGrid->cells() << " x "
+                      << m_occupancyGrid->cells() << " cells of " << m_occupancyGrid->resolution() << " m" << std::endl;
+        }
+
+        // Reduced lidar point cloud of the current step (reflections are not in binary_data)
+        if (m_lidarEnabled) {
+            py::module::import("gt_drive_native");
+            m_pyController.attr("lidar") = py::cast(m_lidar);
+        }
+
+        // Camera images of the current step, read in place in the input buffer
+        if (m_cameraEnabled) {
+            py::module::import("gt_drive_native");
+            m_camera = std::make_shared<CameraImages>();
+            m_pyController.attr("camera") = py::cast(m_camera);
+        }
+
+        // Tracks of the detected objects in the SensorData input, kept across steps
+        if (m_trackingEnabled) {
+            py::module::import("gt_drive_native");
+            m_tracker = std::make_shared<ObjectTracker>();
+            m_pyController.attr("tracker") = py::cast(m_tracker);
+        }
+
+        // Driving KPIs of the run, updated at the end of each step
+        if (m_kpiEnabled) {
+            py::module::import("gt_drive_native");
+            m_kpi = std::make_shared<KpiEngine>();
+            m_kpi->settings.headwayThreshold = m_kpiHeadwayThreshold;
+            m_pyController.attr("kpi") = py::cast(m_kpi);
+        }
+
+        // Columnar signal log, Python may add its own signals until the first step has ended
+        if (!m_signalLogPath.empty()) {
+            openSignalLog();
+        }
         
         m_pythonInitialized = true;
         std::cout << "[GT-DriveController] Python controller initialized successfully" << std::endl;
 
+        // GC policies apply to everything created so far, including the controller instance
+        applyMemoryPolicy();
+
         return fmi2OK;
     }
     catch (py::error_already_set& e) {
         std::cerr << "[GT-DriveController] Python error in doInit: " << e.what() << std::endl;
         // Print sys.path for debugging
         try {
+             py::gil_scoped_acquire acquire;
              py::module sys = py::module::import("sys");
              py::print("Current sys.path:", sys.attr("path"));
         } catch(...) {}
@@ -163,7 +366,293 @@ fmi2Status OSMPController::doInit() {
     }
 }
 
+void OSMPController::buildSensorViewConfigRequest() {
+    SensorViewRequest request;
+    request.fieldOfViewHorizontal = m_svFovHorizontal;
+    request.fieldOfViewVertical = m_svFovVertical;
+    request.range = m_svRange;
+    request.updateCycleTime = m_svUpdateCycle;
+    request.omitStaticInformation = m_svOmitStatic == fmi2True;
+    request.sensorViews = SensorViewConfig::parseSensorViewList(m_svSensorViews);
+
+    SensorViewConfig::buildRequest(request, m_svc_req_buffer);
+    encodePointer(m_svc_req_buffer.data(), m_svc_req_baseHi, m_svc_req_baseLo);
+    m_svc_req_size = (fmi2Integer)m_svc_req_buffer.size();
+    std::cout << "[GT-DriveController] SensorViewConfiguration request: "
+              << SensorViewConfig::describe(request) << std::endl;
+}
+
+fmi2Status OSMPController::exitInit() {
+    // OSMP: the host sets OSI_SensorViewIn_Config_* to the configuration it will
+    // actually provide before leaving initialization mode
+    m_svcNegotiated = false;
+    if (!m_svc_in.connected()) {
+        std::cout << "[GT-DriveController] No SensorViewConfiguration from host, SensorView content is host default" << std::endl;
+        return fmi2OK;
+    }
+
+    const char* data = static_cast<const char*>(decodePointer(m_svc_in.baseHi, m_svc_in.baseLo));
+    if (!data || !SensorViewConfig::parseResponse(data, (size_t)m_svc_in.size, m_svcAccepted)) {
+        std::cerr << "[GT-DriveController] Warning: Invalid SensorViewConfiguration from host, ignored" << std::endl;
+        return fmi2Warning;
+    }
+    m_svcNegotiated = true;
+    std::cout << "[GT-DriveController] SensorViewConfiguration accepted by host: "
+              << SensorViewConfig::describe(m_svcAccepted) << std::endl;
+
+    // Optional hook: Controller.on_sensor_view_config(config_bytes)
+    if (m_pythonInitialized) {
+        try {
+            py::gil_scoped_acquire acquire;
+            if (py::hasattr(m_pyController, "on_sensor_view_config")) {
+                m_pyController.attr("on_sensor_view_config")(py::bytes(data, (size_t)m_svc_in.size));
+            }
+        }
+        catch (py::error_already_set& e) {
+            std::cerr << "[GT-DriveController] Python error in on_sensor_view_config: " << e.what() << std::endl;
+            return fmi2Warning;
+        }
+    }
+    return fmi2OK;
+}
+
+// Reduce the SensorView before it is staged or handed to Python: lidar reflections
+// are removed first, then the static map is split off, so that the pre-filter does
+// not invalidate it as the host vehicle moves
+void OSMPController::reduceSensorView(const char* data, size_t size, std::string& out) {
+    if (m_lidarEnabled) {
+        if (!m_staticMapEnabled && !m_prefilterEnabled) {
+            preprocessLidar(data, size, out);
+            return;
+        }
+        preprocessLidar(data, size, m_lidarBuffer);
+        data = m_lidarBuffer.data();
+        size = m_lidarBuffer.size();
+    }
+    if (!m_prefilterEnabled) {
+        splitStaticMap(data, size, out);
+        return;
+    }
+    if (m_staticMapEnabled) {
+        splitStaticMap(data, size, m_staticMapBuffer);
+        data = m_staticMapBuffer.data();
+        size = m_staticMapBuffer.size();
+    }
+    prefilterSensorView(data, size, out);
+}
+
+// Lidar point cloud (LidarPreprocessing). On malformed input the SensorView is passed
+// through unchanged and the cloud is empty.
+void OSMPController::preprocessLidar(const char* data, size_t size, std::string& out) {
+    std::string error;
+    if (!m_lidar->process(data, size, out, error)) {
+        if (!m_lidarWarned) {
+            std::cerr << "[GT-DriveController] Warning: Lidar preprocessing skipped: " << error << std::endl;
+            m_lidarWarned = true;
+        }
+        out.assign(data, size);
+    }
+    const LidarStats& stats = m_lidar->stats();
+    m_lidarReflections = (fmi2Integer)stats.reflections;
+    m_lidarPoints = (fmi2Integer)m_lidar->count();
+    m_lidarTotalReflections += stats.reflections;
+    m_lidarTotalPoints += m_lidar->count();
+}
+
+// Static map cache (StaticMapCache). On malformed input the SensorView is passed through unchanged.
+void OSMPController::splitStaticMap(const char* data, size_t size, std::string& out) {
+    std::string error;
+    if (!m_staticMap.split(data, size, out, error)) {
+        if (!m_staticMapWarned) {
+            std::cerr << "[GT-DriveController] Warning: Static map split skipped: " << error << std::endl;
+            m_staticMapWarned = true;
+        }
+        out.assign(data, size);
+    }
+    m_staticMapBytesStripped = (fmi2Integer)m_staticMap.strippedBytes();
+}
+
+// Object index (ObjectIndex), ego frame (EgoFrame), predictor (TrajectoryPrediction) and
+// KPIs (KpiEnabled): moving objects of the SensorView Python sees, extracted once without
+// the GIL. On malformed input all keep the objects of the previous step.
+void OSMPController::updateNativeObjects(const char* data, size_t size) {
+    if (!m_objectIndex && !m_egoFrame && !m_predictor && !m_occupancyGrid && !m_kpi) {
+        return;
+    }
+    std::string error;
+    if (!m_movingObjects.extract(data, size, error)) {
+        if (!m_movingObjectsWarned) {
+            std::cerr << "[GT-DriveController] Warning: Moving objects not updated: " << error << std::endl;
+            m_movingObjectsWarned = true;
+        }
+        return;
+    }
+    if (m_objectIndex) {
+        m_objectIndex->update(m_movingObjects);
+    }
+    if (m_egoFrame && !m_egoFrame->compute(m_movingObjects) && !m_egoFrameWarned) {
+        std::cerr << "[GT-DriveController] Warning: Ego frame empty: host vehicle not found" << std::endl;
+        m_egoFrameWarned = true;
+    }
+    if (m_predictor) {
+        m_predictor->update(m_movingObjects);
+    }
+    if (m_occupancyGrid) {
+        const std::shared_ptr<RoadNetwork>& network = m_staticMap.network();
+        if (m_staticMapEnabled && network && m_staticMap.version() != m_occupancyGrid->mapVersion()) {
+            m_occupancyGrid->setMap(m_staticMap.version(), network->bytes());
+        }
+        if (!m_occupancyGrid->update(m_movingObjects) && !m_occupancyWarned) {
+            std::cerr << "[GT-DriveController] Warning: Occupancy grid not moved: host vehicle not found" << std::endl;
+            m_occupancyWarned = true;
+        }
+    }
+    if (m_kpi) {
+        m_kpi->observe(m_movingObjects, m_egoFrame.get(), m_frenet.get());
+    }
+}
+
+// Camera images (CameraImages): only the positions of image_data are recorded, the
+// pixels stay in the input buffer. Called with the GIL after the views of the previous
+// step have been released, since release() also drops the frames.
+void OSMPController::locateCameraImages(const char* data, size_t size) {
+    if (!m_camera) {
+        return;
+    }
+    std::string error;
+    if (!m_camera->locate(data, size, error) && !m_cameraWarned) {
+        std::cerr << "[GT-DriveController] Warning: Camera images not available: " << error << std::endl;
+        m_cameraWarned = true;
+    }
+}
+
+// Object tracker (ObjectTracking): associates the detections of each new SensorData
+// message; steps where the input is unchanged or not connected leave the tracks as they are
+void OSMPController::updateTracker() {
+    OsiInputChannel& channel = m_inputChannels[CH_SENSOR_DATA];
+    if (!m_tracker || !channel.changed()) {
+        return;
+    }
+    std::string error;
+    if (!m_tracker->update(channel.data(), channel.size(), m_stepTime, error)) {
+        if (!m_trackerWarned) {
+            std::cerr << "[GT-DriveController] Warning: Object tracks not updated: " << error << std::endl;
+            m_trackerWarned = true;
+        }
+        return;
+    }
+    fmi2Integer confirmed = 0;
+    for (uint8_t c : m_tracker->confirmed()) {
+        confirmed += c;
+    }
+    m_trackedObjects = confirmed;
+}
+
+// KPIs (KpiEnabled): the outputs of this step, fallback commands included, over the
+// latest scene. Runs on the FMU thread, also when the step had no SensorView.
+void OSMPController::updateKpis(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize) {
+    if (!m_kpi) {
+        return;
+    }
+    m_kpi->step(currentCommand(), currentCommunicationPoint, communicationStepSize);
+    m_kpiValues = m_kpi->values();
+}
+
+// Signal log (SignalLogPath): the Core columns, then Python's own signals
+void OSMPController::openSignalLog() {
+    py::module::import("gt_drive_native");
+    auto log = std::make_shared<SignalLog>();
+    std::string error;
+    for (const auto& signal : CORE_SIGNALS) {
+        log->addColumn(signal.first, signal.second, error);
+    }
+    if (m_signalLogBlockRows <= 0 || !log->open(m_signalLogPath, (size_t)m_signalLogBlockRows, error)) {
+        std::cerr << "[GT-DriveController] Warning: Signal log disabled: "
+                  << (m_signalLogBlockRows <= 0 ? "SignalLogBlockRows must be positive" : error) << std::endl;
+        return;
+    }
+    std::cout << "[GT-DriveController] Signal log: " << m_signalLogPath << std::endl;
+    m_signalLog = log;
+    m_pyController.attr("signal_log") = py::cast(m_signalLog);
+}
+
+// One row per doStep; the row is copied into the current block, the file is
+// written on the log's own thread
+void OSMPController::logSignals(fmi2Real currentCommunicationPoint, double stepUs) {
+    if (!m_signalLog) {
+        return;
+    }
+    const double values[CORE_SIGNAL_COUNT] = {
+        m_throttle, m_brake, m_steering, (double)m_driveMode, (double)m_valid,
+        stepUs, m_phaseTimings.prepareUs, m_phaseTimings.pythonUs, m_phaseTimings.outputUs
+    };
+    m_signalLog->set(1, values, CORE_SIGNAL_COUNT);
+    m_signalLog->append(currentCommunicationPoint);
+}
+
+// Ego-centric pre-filter (PrefilterEnabled). On malformed input the SensorView is
+// passed through unchanged, so that Python still sees and reports it.
+void OSMPController::prefilterSensorView(const char* data, size_t size, std::string& out) {
+    std::string error;
+    if (!m_sensorViewFilter.apply(data, size, out, error)) {
+        if (!m_prefilterWarned) {
+            std::cerr << "[GT-DriveController] Warning: SensorView pre-filter skipped: " << error << std::endl;
+            m_prefilterWarned = true;
+        }
+        out.assign(data, size);
+    } else if (!m_sensorViewFilter.stats().hostFound && !m_prefilterWarned) {
+        std::cerr << "[GT-DriveController] Warning: SensorView pre-filter skipped: host vehicle not found" << std::endl;
+        m_prefilterWarned = true;
+    }
+
+    const SensorViewFilterStats& stats = m_sensorViewFilter.stats();
+    m_prefilterBytesRemoved = (fmi2Integer)(size - out.size());
+    m_prefilterObjectsRemoved = (fmi2Integer)stats.objectsRemoved;
+    m_prefilterLanesRemoved = (fmi2Integer)stats.lanesRemoved;
+    m_prefilterTotalBytesIn += size;
+    m_prefilterTotalBytesOut += out.size();
+}
+
 fmi2Status OSMPController::doStep(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize) {
+    auto start = std::chrono::steady_clock::now();
+    m_phaseTimings = PhaseTimings();
+    fmi2Status status = m_rtProfile
+        ? doStepRealtime(currentCommunicationPoint, communicationStepSize)
+        : doStepImpl(currentCommunicationPoint, communicationStepSize);
+    updateGcStepStats();
+    updateKpis(currentCommunicationPoint, communicationStepSize);
+    logSignals(currentCommunicationPoint, elapsedUs(start, std::chrono::steady_clock::now()));
+    return status;
+}
+
+fmi2Status OSMPController::doStepRealtime(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize) {
+    // Real-time profile: thread setup on the first step, then watch for heap allocations.
+    // The first steps are warm-up (lazy initialization in Python and pybind11).
+    const unsigned long long RT_WARMUP_STEPS = 10;
+    if (!m_rtApplied) {
+        applyRealtimeProfile();
+    }
+    bool steadyState = ++m_stepCount > RT_WARMUP_STEPS;
+
+    size_t allocsBefore = Realtime::AllocationProbe::count();
+    fmi2Status status;
+    {
+        Realtime::AllocationProbe probe;
+        status = doStepImpl(currentCommunicationPoint, communicationStepSize);
+    }
+    size_t allocs = Realtime::AllocationProbe::count() - allocsBefore;
+
+    if (steadyState && allocs > 0) {
+        if (m_rtStepAllocCount == 0) {
+            std::cerr << "[GT-DriveController] Warning: heap allocation in steady-state doStep ("
+                      << allocs << " at step " << m_stepCount << ")" << std::endl;
+        }
+        m_rtStepAllocCount += (fmi2Integer)allocs;
+    }
+    return status;
+}
+
+fmi2Status OSMPController::doStepImpl(fmi2Real currentCommunicationPoint, fmi2Real communicationStepSize) {
     // Fallback: Initialize if not done yet
     if (!m_pythonInitialized) {
         std::cerr << "[GT-DriveController] Warning: doStep called before initialization, initializing now" << std::endl;
@@ -173,6 +662,8 @@ fmi2Status OSMPController::doStep(fmi2Real currentCommunicationPoint, fmi2Real c
     }
 
     if (m_osi_size > 0 && m_osi_baseLo != 0) {
+        m_stepTime = currentCommunicationPoint;
+        auto phaseStart = std::chrono::steady_clock::now();
         try {
             // 1. Decode Pointer
             void* rawPtr = decodePointer(m_osi_baseHi, m_osi_baseLo);
@@ -190,17 +681,58 @@ fmi2Status OSMPController::doStep(fmi2Real currentCommunicationPoint, fmi2Real c
                           << " bytes), using default values" << std::endl;
                 return fmi2Warning;
             }
+
+            // SensorView bytes per step, to measure the effect of the SensorViewConfiguration
+            ++m_svInputSteps;
+            m_svInputBytes += (size_t)m_osi_size;
+            m_svInputMaxBytes = std::max(m_svInputMaxBytes, (size_t)m_osi_size);
+            m_svMeanBytes = (fmi2Real)m_svInputBytes / (fmi2Real)m_svInputSteps;
             
-            // 3. Acquire GIL for Python calls (Risk #2: thread safety)
+            // 3. Deadline mode: run Python on the step worker and fall back on overrun
+            if (m_stepDeadlineMs > 0.0) {
+                return doStepWithDeadline(rawPtr, communicationStepSize);
+            }
+
+            // 4. Lidar reduction, static map split and pre-filter: Python sees the reduced SensorView,
+            //    the output edits and the TrafficUpdate are built against the host's input
+            const char* input = reinterpret_cast<const char*>(rawPtr);
+            size_t inputSize = (size_t)m_osi_size;
+            if (m_staticMapEnabled || m_prefilterEnabled || m_lidarEnabled) {
+                reduceSensorView(input, inputSize, m_osi_in_filtered);
+                input = m_osi_in_filtered.data();
+                inputSize = m_osi_in_filtered.size();
+            }
+
+            // 5. Native decode: parse the SensorView once in C++ before taking the GIL.
+            //    Additional inputs are only decoded if they changed since the previous step.
+            if (m_sharedSensorView && !m_sharedSensorView->parse(input, inputSize)) {
+                std::cerr << "[GT-DriveController] Warning: Failed to parse OSI SensorView, using default values" << std::endl;
+                m_valid = fmi2False;
+                return fmi2Warning;
+            }
+            prepareInputChannels(false);
+            decodeInputChannels();
+            if (m_staticMapEnabled) {
+                m_frenet->setGraph(m_staticMap.graph());
+            }
+            updateNativeObjects(input, inputSize);
+            updateTracker();
+
+            // 6. Acquire GIL for Python calls (Risk #2: thread safety)
             // Note: For single-threaded host, this is defensive programming
             py::gil_scoped_acquire acquire;
             
-            // 4. Read Bytes
-            // Create a python bytes object from raw memory (copy)
+            // 7. Read Bytes
+            // Create a python bytes object from raw memory (copy), or wrap the parsed message
             // Note: This can throw if the pointer is invalid
-            py::bytes data;
+            releaseInputViews(); // Left over if the previous step raised
+            locateCameraImages(input, inputSize);
+            if (m_staticMapEnabled) {
+                m_staticMap.updateHandle();
+            }
+            py::object data;
             try {
-                data = py::bytes(reinterpret_cast<const char*>(rawPtr), m_osi_size);
+                data = makePythonInput(input, inputSize);
             }
             catch (...) {
                 // Catch all exceptions including access violations
@@ -208,58 +740,656 @@ fmi2Status OSMPController::doStep(fmi2Real currentCommunicationPoint, fmi2Real c
                 return fmi2Warning;
             }
             
-            // 5. Call Python Update
-            py::object result = m_pyController.attr("update_control")(data);
+            // 8. Call Python Update
+            auto pythonStart = std::chrono::steady_clock::now();
+            py::object result = callUpdateControl(data);
+            auto outputStart = std::chrono::steady_clock::now();
             
-            // 6. Parse Result [throttle, brake, steering, drive_mode, osi_bytes]
-            if (py::isinstance<py::list>(result)) {
-                py::list resList = result.cast<py::list>();
-                size_t size = resList.size();
-                
-                if (size >= 3) {
-                    m_throttle = resList[0].cast<float>();
-                    m_brake = resList[1].cast<float>();
-                    m_steering = resList[2].cast<float>();
-                }
-                
-                if (size >= 4) {
-                    m_driveMode = resList[3].cast<int>();
-                }
+            // 9. Parse Result [throttle, brake, steering, drive_mode, osi_bytes]
+            m_syncResult.cmd = currentCommand();
+            parseControlResult(result, m_syncResult);
+            releaseInputViews();
+            buildOsiOutputs(reinterpret_cast<const char*>(rawPtr), (size_t)m_osi_size, m_syncResult);
+            m_syncResult.timings.prepareUs = elapsedUs(phaseStart, pythonStart);
+            m_syncResult.timings.pythonUs = elapsedUs(pythonStart, outputStart);
+            m_syncResult.timings.outputUs = elapsedUs(outputStart, std::chrono::steady_clock::now());
+            applyStepResult(m_syncResult);
 
-                if (size >= 5 && py::isinstance<py::bytes>(resList[4])) {
-                    // Double buffering: write to the other buffer
-                    int next_idx = 1 - m_osi_out_idx;
-                    m_osi_out_buffer[next_idx] = resList[4].cast<std::string>();
-                    m_osi_out_idx = next_idx;
-                    
-                    encodePointer(m_osi_out_buffer[m_osi_out_idx].data(), m_osi_out_baseHi, m_osi_out_baseLo);
-                    m_osi_out_size = (fmi2Integer)m_osi_out_buffer[m_osi_out_idx].size();
-                } else {
-                    m_osi_out_baseHi = 0;
-                    m_osi_out_baseLo = 0;
-                    m_osi_out_size = 0;
-                }
+            // 10. Scheduled GC collection at the end of the step (no idle time without the step worker)
+            if (gcCollectionDue()) {
+                PythonMemory::collectScheduled(m_gcScheduledCount);
             }
         }
         catch (py::error_already_set& e) {
             // Enhanced Python error reporting (Risk #7)
             std::cerr << "[GT-DriveController] Python error in doStep: " << e.what() << std::endl;
+            m_valid = fmi2False;
             return fmi2Warning;
         }
         catch (std::exception& e) {
             std::cerr << "[GT-DriveController] Error in doStep: " << e.what() << std::endl;
+            m_valid = fmi2False;
             return fmi2Warning;
         }
     }
     return fmi2OK;
 }
 
+fmi2Status OSMPController::doStepWithDeadline(const void* rawPtr, fmi2Real communicationStepSize) {
+    if (!m_stepWorker) {
+        std::cout << "[GT-DriveController] Step deadline enabled: " << m_stepDeadlineMs << " ms" << std::endl;
+        m_fallback.setMode((FallbackMode)m_fallbackMode);
+        m_fallback.setTargetBrake(m_fallbackBrake);
+        m_fallback.observe(currentCommand());
+        std::function<void()> threadInit;
+        if (m_rtProfile) {
+            threadInit = [this] { applyRealtimeWorkerThread(); };
+        }
+        m_stepWorker = std::make_unique<PythonStepWorker>(threadInit);
+    }
+
+    // The host thread keeps the GIL released from now on and only takes it for its own
+    // Python work (gil_scoped_acquire). A job that overran the deadline can then go on
+    // running Python on the worker while this step returns with the fallback output.
+    if (!g_hostThreadState && PyGILState_Check()) {
+        g_hostThreadState = PyEval_SaveThread();
+    }
+
+    bool inTime = false;
+    // The worker may still be running a job that overran the previous deadline or a
+    // scheduled GC collection; the wait for it is taken from this step's budget.
+    // Stage the input, since the host buffer is only valid during this call: the host's
+    // SensorView for the outputs, and the reduced one for Python.
+    auto start = std::chrono::steady_clock::now();
+    auto budget = std::chrono::microseconds((long long)(m_stepDeadlineMs * 1000.0));
+    bool workerFree = m_stepWorker->waitFor(budget);
+    if (m_gcCollectionPending) {
+        m_gcCollectionPending = !workerFree;
+        if (!workerFree && !m_gcOverrunWarned) {
+            std::cerr << "[GT-DriveController] Warning: Scheduled GC collection still running at the next step, "
+                      << "its time counts against StepDeadlineMs" << std::endl;
+            m_gcOverrunWarned = true;
+        }
+    }
+    if (workerFree) {
+        m_osi_in_staging.assign(reinterpret_cast<const char*>(rawPtr), m_osi_size);
+        if (m_staticMapEnabled || m_prefilterEnabled || m_lidarEnabled) {
+            reduceSensorView(m_osi_in_staging.data(), m_osi_in_staging.size(), m_osi_in_filtered);
+        }
+        prepareInputChannels(true);
+        m_asyncResult.ok = false;
+        m_asyncResult.cmd = currentCommand();
+        if (m_stepWorker->submit([this] { runAsyncPythonStep(); })) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+            auto remaining = budget > elapsed ? budget - elapsed : std::chrono::microseconds(0);
+            inTime = m_stepWorker->waitFor(remaining);
+        }
+    }
+
+    if (inTime && m_asyncResult.ok) {
+        applyStepResult(m_asyncResult);
+        if (m_inFallback) {
+            std::cout << "[GT-DriveController] Python results back in time, leaving fallback" << std::endl;
+            m_inFallback = false;
+        }
+        // Scheduled collections run on the worker after this step returns. The host thread
+        // does not hold the GIL between steps, so the collection runs in the host's idle time.
+        if (gcCollectionDue()) {
+            m_gcCollectionPending = m_stepWorker->submit([this] {
+                py::gil_scoped_acquire acquire;
+                PythonMemory::collectScheduled(m_gcScheduledCount);
+            });
+        }
+        return fmi2OK;
+    }
+
+    if (!inTime) {
+        ++m_deadlineMissCount;
+    }
+    if (!m_inFallback) {
+        std::cerr << "[GT-DriveController] Warning: " << (inTime ? "Python step failed" : "Python missed step deadline")
+                  << ", using fallback controller (misses: " << m_deadlineMissCount << ")" << std::endl;
+        m_inFallback = true;
+    }
+    applyFallback(communicationStepSize);
+    return inTime ? fmi2Warning : fmi2OK;
+}
+
+// Runs on the step worker thread
+void OSMPController::runAsyncPythonStep() {
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point outputStart;
+    std::optional<Realtime::AllocationProbe> probe;
+    if (m_rtProfile) {
+        probe.emplace();
+    }
+    const std::string& input = (m_staticMapEnabled || m_prefilterEnabled || m_lidarEnabled) ? m_osi_in_filtered
+                                                                                             : m_osi_in_staging;
+    if (m_sharedSensorView && !m_sharedSensorView->parse(input.data(), input.size())) {
+        std::cerr << "[GT-DriveController] Warning: Failed to parse OSI SensorView" << std::endl;
+        m_asyncResult.ok = false;
+        return;
+    }
+    decodeInputChannels();
+    if (m_staticMapEnabled) {
+        m_frenet->setGraph(m_staticMap.graph());
+    }
+    updateNativeObjects(input.data(), input.size());
+    updateTracker();
+    bool ok = false;
+    {
+        py::gil_scoped_acquire acquire;
+        try {
+            releaseInputViews(); // Left over if the previous step raised
+            locateCameraImages(input.data(), input.size());
+            if (m_staticMapEnabled) {
+                m_staticMap.updateHandle();
+            }
+            py::object data = makePythonInput(input.data(), input.size());
+            auto pythonStart = std::chrono::steady_clock::now();
+            py::object result = callUpdateControl(data);
+            outputStart = std::chrono::steady_clock::now();
+            m_asyncResult.timings.prepareUs = elapsedUs(start, pythonStart);
+            m_asyncResult.timings.pythonUs = elapsedUs(pythonStart, outputStart);
+            parseControlResult(result, m_asyncResult);
+            releaseInputViews();
+            ok = true;
+        }
+        catch (py::error_already_set& e) {
+            std::cerr << "[GT-DriveController] Python error in doStep: " << e.what() << std::endl;
+        }
+        catch (std::exception& e) {
+            std::cerr << "[GT-DriveController] Error in doStep: " << e.what() << std::endl;
+        }
+    }
+    // Output edits and the TrafficUpdate are built after the GIL is released
+    if (ok) {
+        buildOsiOutputs(m_osi_in_staging.data(), m_osi_in_staging.size(), m_asyncResult);
+        m_asyncResult.timings.outputUs = elapsedUs(outputStart, std::chrono::steady_clock::now());
+    }
+    m_asyncResult.ok = ok;
+}
+
+// Native decode: bind to the Python protobuf C++ API, or stay on bytes if unavailable.
+// Requires the GIL.
+void OSMPController::initializeOsiDecode() {
+    for (OsiInputChannel& channel : m_inputChannels) {
+        channel.initialize();
+    }
+
+    if ((OsiDecodeMode)m_osiDecodeMode != OsiDecodeMode::Native) {
+        return;
+    }
+    auto shared = std::make_unique<SharedOsiMessage>("osi3.SensorView");
+    std::string error;
+    if (!shared->initialize(error)) {
+        std::cerr << "[GT-DriveController] Warning: Native OSI decode not available (" << error
+                  << "), passing SensorView bytes to Python" << std::endl;
+        m_osiDecodeMode = (fmi2Integer)OsiDecodeMode::Raw;
+        return;
+    }
+    m_sharedSensorView = std::move(shared);
+    std::cout << "[GT-DriveController] Native OSI decode: SensorView parsed in C++ and shared with Python" << std::endl;
+}
+
+// Argument of update_control() for the SensorView (OsiDecodeMode): bytes, the message
+// parsed by m_sharedSensorView, or a read-only memoryview. Requires the GIL.
+py::object OSMPController::makePythonInput(const char* data, size_t size) {
+    switch ((OsiDecodeMode)m_osiDecodeMode) {
+        case OsiDecodeMode::Native:
+            if (m_sharedSensorView) {
+                return m_sharedSensorView->pythonMessage();
+            }
+            break;
+        case OsiDecodeMode::View:
+            m_sensorViewMemory = py::memoryview::from_memory(data, (py::ssize_t)size, true);
+            return m_sensorViewMemory;
+        default:
+            break;
+    }
+    return py::bytes(data, size);
+}
+
+// Change detection of the additional inputs (no GIL needed).
+// stage: copy changed inputs for the step worker.
+void OSMPController::prepareInputChannels(bool stage) {
+    for (OsiInputChannel& channel : m_inputChannels) {
+        const void* ptr = channel.pointer.connected()
+            ? decodePointer(channel.pointer.baseHi, channel.pointer.baseLo)
+            : nullptr;
+        if (ptr && !m_multiInput) {
+            std::cout << "[GT-DriveController] Input channel connected: " << channel.key()
+                      << ", calling update_control(sensor_view, channels)" << std::endl;
+            m_multiInput = true;
+        }
+        channel.prepare(ptr, stage);
+    }
+}
+
+// Native decode of changed additional inputs (no GIL needed)
+void OSMPController::decodeInputChannels() {
+    for (OsiInputChannel& channel : m_inputChannels) {
+        channel.decode();
+    }
+}
+
+// One Python call per step with all inputs. Once any additional input is connected the
+// signature is update_control(sensor_view, channels); unchanged channels are None.
+// Memoryviews stay valid until the caller has parsed the result (releaseInputViews).
+// Requires the GIL.
+py::object OSMPController::callUpdateControl(const py::object& data) {
+    if (!m_multiInput) {
+        return m_pyController.attr("update_control")(data);
+    }
+    py::dict channels;
+    for (OsiInputChannel& channel : m_inputChannels) {
+        channels[channel.key()] = channel.pythonValue();
+    }
+    return m_pyController.attr("update_control")(data, channels);
+}
+
+// Memoryviews point into buffers that are only valid during this step
+void OSMPController::releaseInputViews() {
+    releaseMemoryView(m_sensorViewMemory, "sensor_view");
+    for (OsiInputChannel& channel : m_inputChannels) {
+        channel.releaseView();
+    }
+    if (m_camera) {
+        m_camera->release();
+    }
+}
+
+// Convert the edit list returned in place of osi_bytes:
+//   ("set", path, value[, "float"]), ("remove", path), ("append", path, value)
+// path elements are field numbers or (field number, index) pairs; indices refer to the
+// input message. Values: bool/int -> varint, float -> double (fixed32 float with "float"),
+// bytes/str/message -> length-delimited. Requires the GIL.
+static void parseOsiEdits(const py::handle& list, std::vector<OsiPatch::Edit>& edits) {
+    py::sequence seq = py::reinterpret_borrow<py::sequence>(list);
+    edits.resize(seq.size()); // Keeps the buffers of existing entries
+    for (size_t i = 0; i < edits.size(); ++i) {
+        py::sequence item = py::reinterpret_borrow<py::sequence>(seq[i]);
+        OsiPatch::Edit& edit = edits[i];
+        if (item.size() < 2) {
+            throw std::runtime_error("OSI edit " + std::to_string(i) + ": expected (op, path[, value])");
+        }
+
+        std::string op = item[0].cast<std::string>();
+        if (op == "set") {
+            edit.op = OsiPatch::Op::Set;
+        } else if (op == "remove") {
+            edit.op = OsiPatch::Op::Remove;
+        } else if (op == "append") {
+            edit.op = OsiPatch::Op::Append;
+        } else {
+            throw std::runtime_error("OSI edit " + std::to_string(i) + ": unknown op '" + op + "'");
+        }
+
+        py::sequence path = py::reinterpret_borrow<py::sequence>(item[1]);
+        edit.path.resize(path.size());
+        for (size_t j = 0; j < edit.path.size(); ++j) {
+            py::object element = path[j];
+            if (py::isinstance<py::int_>(element)) {
+                edit.path[j].field = element.cast<uint32_t>();
+                edit.path[j].index = -1;
+            } else {
+                py::sequence pair = py::reinterpret_borrow<py::sequence>(element);
+                edit.path[j].field = pair[0].cast<uint32_t>();
+                edit.path[j].index = pair[1].cast<int>();
+            }
+        }
+
+        if (edit.op == OsiPatch::Op::Remove) {
+            continue;
+        }
+        if (item.size() < 3) {
+            throw std::runtime_error("OSI edit " + std::to_string(i) + ": missing value");
+        }
+        py::object value = item[2];
+        edit.bytes.clear();
+        if (py::isinstance<py::bool_>(value) || py::isinstance<py::int_>(value)) {
+            edit.type = OsiWire::WireType::Varint;
+            edit.scalar = (uint64_t)value.cast<long long>(); // Negative int32/int64: 10-byte varint
+        } else if (py::isinstance<py::float_>(value)) {
+            double d = value.cast<double>();
+            if (item.size() >= 4 && item[3].cast<std::string>() == "float") {
+                float f = (float)d;
+                uint32_t bits = 0;
+                std::memcpy(&bits, &f, 4);
+                edit.type = OsiWire::WireType::Fixed32;
+                edit.scalar = bits;
+            } else {
+                edit.type = OsiWire::WireType::Fixed64;
+                std::memcpy(&edit.scalar, &d, 8);
+            }
+        } else {
+            edit.type = OsiWire::WireType::LengthDelimited;
+            py::object raw = py::hasattr(value, "SerializeToString") ? value.attr("SerializeToString")() : value;
+            if (py::isinstance<py::str>(raw)) {
+                edit.bytes = raw.cast<std::string>();
+            } else {
+                py::buffer_info info = py::reinterpret_borrow<py::buffer>(raw).request();
+                edit.bytes.assign(static_cast<const char*>(info.ptr), (size_t)(info.size * info.itemsize));
+            }
+        }
+    }
+}
+
+// Parse [throttle, brake, steering, drive_mode, osi_bytes]; fields missing in the
+// result keep the values already present in out.cmd. Requires the GIL.
+void OSMPController::parseControlResult(const py::object& result, StepResult& out) {
+    out.hasOsiOut = false;
+    out.hasOsiEdits = false;
+    out.hasTrafficUpdate = false;
+    out.egoState.clear();
+    if (!py::isinstance<py::list>(result)) {
+        return;
+    }
+
+    py::list resList = result.cast<py::list>();
+    size_t size = resList.size();
+
+    if (size >= 3) {
+        out.cmd.throttle = resList[0].cast<float>();
+        out.cmd.brake = resList[1].cast<float>();
+        out.cmd.steering = resList[2].cast<float>();
+    }
+
+    if (size >= 4) {
+        out.cmd.driveMode = resList[3].cast<int>();
+    }
+
+    if (size >= 6 && m_trafficUpdateOutput && py::isinstance<py::dict>(resList[5])) {
+        // Ego state for the TrafficUpdate: {"position": (x, y, z), "velocity": ..., ...}
+        static const char* const keys[EgoStateOverride::Count] = { "position", "orientation", "velocity", "acceleration" };
+        py::dict ego = resList[5].cast<py::dict>();
+        for (int i = 0; i < EgoStateOverride::Count; ++i) {
+            if (!ego.contains(keys[i])) {
+                continue;
+            }
+            py::sequence vec = py::reinterpret_borrow<py::sequence>(ego[keys[i]]);
+            for (size_t axis = 0; axis < 3 && axis < vec.size(); ++axis) {
+                out.egoState.value[i][axis] = vec[axis].cast<double>();
+            }
+            out.egoState.has[i] = true;
+        }
+    }
+
+    if (!m_sensorViewOutput) {
+        // SensorView output disabled: ignore osi_bytes, nothing is copied or patched
+    } else if (size >= 5 && py::isinstance<py::bytes>(resList[4])) {
+        // Copy into the existing buffer so that its capacity is reused across steps
+        py::object osiBytes = resList[4];
+        char* buf = nullptr;
+        Py_ssize_t len = 0;
+        if (PyBytes_AsStringAndSize(osiBytes.ptr(), &buf, &len) == 0) {
+            out.osiOut.assign(buf, (size_t)len);
+            out.hasOsiOut = true;
+        }
+    } else if (size >= 5 && (py::isinstance<py::memoryview>(resList[4]) || py::isinstance<py::bytearray>(resList[4]))) {
+        // e.g. the input memoryview returned as passthrough (OsiDecodeMode = 2)
+        py::buffer_info info = py::reinterpret_borrow<py::buffer>(resList[4]).request();
+        out.osiOut.assign(static_cast<const char*>(info.ptr), (size_t)(info.size * info.itemsize));
+        out.hasOsiOut = true;
+    } else if (size >= 5 && (py::isinstance<py::list>(resList[4]) || py::isinstance<py::tuple>(resList[4]))) {
+        // Delta output: edits are applied to the input SensorView by applyOsiEdits()
+        parseOsiEdits(resList[4], out.osiEdits);
+        out.hasOsiEdits = true;
+    } else if (size >= 5 && m_sharedSensorView) {
+        // Native decode: a message object (e.g. the input SensorView) is serialized by
+        // the C++ library directly, without creating a Python bytes object
+        out.hasOsiOut = m_sharedSensorView->serialize(resList[4], out.osiOut);
+    }
+}
+
+// Native OSI outputs built from the host's SensorView after Python returned. No GIL needed.
+//  - Delta output: patch the input at the wire level into result.osiOut. Only messages on
+//    an edit path are rewritten, everything else is copied as is. Edits address the
+//    SensorView Python saw; indices of global_ground_truth elements are mapped past the
+//    elements the pre-filter removed.
+//  - TrafficUpdate: host vehicle and control command (TrafficUpdateBuilder)
+void OSMPController::buildOsiOutputs(const char* input, size_t size, StepResult& result) {
+    std::string error;
+    if (result.hasOsiEdits) {
+        if (m_prefilterEnabled) {
+            for (OsiPatch::Edit& edit : result.osiEdits) {
+                if (edit.path.size() >= 2 && edit.path[0].field == OsiFields::SensorView::GlobalGroundTruth &&
+                    edit.path[1].index >= 0) {
+                    edit.path[1].index = m_sensorViewFilter.originalIndex(edit.path[1].field, edit.path[1].index);
+                }
+            }
+        }
+        result.hasOsiOut = m_osiPatcher.apply(input, size, result.osiEdits, result.osiOut, error);
+        if (!result.hasOsiOut) {
+            std::cerr << "[GT-DriveController] Warning: Failed to apply OSI output edits: " << error << std::endl;
+        }
+    }
+    if (m_trafficUpdateOutput) {
+        result.hasTrafficUpdate = m_trafficUpdateBuilder.build(input, size, result.cmd, result.egoState,
+                                                               result.trafficUpdate, error);
+        if (!result.hasTrafficUpdate) {
+            std::cerr << "[GT-DriveController] Warning: Failed to build TrafficUpdate: " << error << std::endl;
+        }
+    }
+}
+
+void OSMPController::applyStepResult(StepResult& result) {
+    m_throttle = result.cmd.throttle;
+    m_brake = result.cmd.brake;
+    m_steering = result.cmd.steering;
+    m_driveMode = result.cmd.driveMode;
+    m_valid = fmi2True;
+    m_fallback.observe(result.cmd);
+    m_phaseTimings = result.timings;
+
+    if (result.hasOsiOut) {
+        // Double buffering: swap the result into the other buffer (no copy, no allocation)
+        int next_idx = 1 - m_osi_out_idx;
+        m_osi_out_buffer[next_idx].swap(result.osiOut);
+        m_osi_out_idx = next_idx;
+
+        encodePointer(m_osi_out_buffer[m_osi_out_idx].data(), m_osi_out_baseHi, m_osi_out_baseLo);
+        m_osi_out_size = (fmi2Integer)m_osi_out_buffer[m_osi_out_idx].size();
+    } else {
+        m_osi_out_baseHi = 0;
+        m_osi_out_baseLo = 0;
+        m_osi_out_size = 0;
+    }
+
+    if (result.hasTrafficUpdate) {
+        int next_idx = 1 - m_tu_out_idx;
+        m_tu_out_buffer[next_idx].swap(result.trafficUpdate);
+        m_tu_out_idx = next_idx;
+
+        encodePointer(m_tu_out_buffer[m_tu_out_idx].data(), m_tu_out_baseHi, m_tu_out_baseLo);
+        m_tu_out_size = (fmi2Integer)m_tu_out_buffer[m_tu_out_idx].size();
+    } else {
+        m_tu_out_baseHi = 0;
+        m_tu_out_baseLo = 0;
+        m_tu_out_size = 0;
+    }
+}
+
+void OSMPController::applyFallback(fmi2Real communicationStepSize) {
+    ControlCommand cmd = m_fallback.compute(communicationStepSize);
+    m_throttle = cmd.throttle;
+    m_brake = cmd.brake;
+    m_steering = cmd.steering;
+    m_driveMode = cmd.driveMode;
+    m_valid = fmi2False;
+
+    // No Python output for this step: do not hand out a stale SensorView. The last
+    // TrafficUpdate is held, so that the host vehicle neither jumps nor disappears
+    // downstream; its buffer is only replaced by the next valid step.
+    m_osi_out_baseHi = 0;
+    m_osi_out_baseLo = 0;
+    m_osi_out_size = 0;
+}
+
+void OSMPController::applyRealtimeProfile() {
+    m_rtApplied = true;
+    m_rtCores = Realtime::parseCoreList(m_rtCpuAffinity);
+
+    std::cout << "[GT-DriveController] Applying real-time profile" << std::endl;
+
+    if (!m_rtCores.empty()) {
+        bool ok = Realtime::pinCurrentThread(m_rtCores[0]);
+        std::cout << "[GT-DriveController]   - Stepping thread pinned to core " << m_rtCores[0]
+                  << (ok ? "" : " (FAILED)") << std::endl;
+    }
+
+    if (m_rtThreadPriority > 0) {
+        bool ok = Realtime::setRealtimePriority(m_rtThreadPriority);
+        std::cout << "[GT-DriveController]   - Real-time priority " << m_rtThreadPriority
+                  << (ok ? "" : " (FAILED, insufficient privileges?)") << std::endl;
+    }
+
+    // Preallocate, pre-fault and lock the output buffers and staging areas.
+    // Buffers are only swapped between these strings afterwards, so they stay locked
+    // unless a message exceeds RealtimeBufferBytes.
+    if (m_rtBufferBytes > 0) {
+        std::vector<std::string*> buffers = {
+            &m_osi_out_buffer[0], &m_osi_out_buffer[1],
+            &m_syncResult.osiOut, &m_asyncResult.osiOut,
+            &m_osi_in_staging
+        };
+        if (m_staticMapEnabled || m_prefilterEnabled || m_lidarEnabled) {
+            buffers.push_back(&m_osi_in_filtered);
+        }
+        if (m_staticMapEnabled && m_prefilterEnabled) {
+            buffers.push_back(&m_staticMapBuffer);
+        }
+        if (m_lidarEnabled && (m_staticMapEnabled || m_prefilterEnabled)) {
+            buffers.push_back(&m_lidarBuffer);
+        }
+        bool allLocked = true;
+        for (std::string* buffer : buffers) {
+            buffer->resize((size_t)m_rtBufferBytes);
+            allLocked &= Realtime::prefaultAndLock(&(*buffer)[0], buffer->size());
+            buffer->clear(); // Keeps capacity
+        }
+        std::cout << "[GT-DriveController]   - Locked " << buffers.size()
+                  << " buffers of " << m_rtBufferBytes << " bytes"
+                  << (allLocked ? "" : " (mlock FAILED for some)") << std::endl;
+    }
+}
+
+// Runs on the step worker thread before its first job
+void OSMPController::applyRealtimeWorkerThread() {
+    if (!m_rtCores.empty()) {
+        // Worker threads use the cores after the stepping thread's core, if any
+        int core = m_rtCores.size() > 1 ? m_rtCores[1] : m_rtCores[0];
+        if (!Realtime::pinCurrentThread(core)) {
+            std::cerr << "[GT-DriveController] Warning: Failed to pin step worker to core " << core << std::endl;
+        }
+    }
+    if (m_rtThreadPriority > 0) {
+        Realtime::setRealtimePriority(m_rtThreadPriority);
+    }
+}
+
+// Runs on each planner pool thread (worker >= 1) before its first job. The pool
+// is created in doInit, before the profile is applied, so the cores are parsed here.
+void OSMPController::applyRealtimePlannerThread(size_t worker) {
+    if (!m_rtProfile) {
+        return;
+    }
+    // Planner threads share the cores after the stepping thread and the step worker
+    std::vector<int> cores = Realtime::parseCoreList(m_rtCpuAffinity);
+    if (cores.size() > 2) {
+        int core = cores[2 + (worker - 1) % (cores.size() - 2)];
+        if (!Realtime::pinCurrentThread(core)) {
+            std::cerr << "[GT-DriveController] Warning: Failed to pin planner thread to core " << core << std::endl;
+        }
+    }
+    if (m_rtThreadPriority > 0) {
+        Realtime::setRealtimePriority(m_rtThreadPriority);
+    }
+}
+
+void OSMPController::applyMemoryPolicy() {
+    PythonMemory::GcMonitor::instance().install();
+
+    if (m_gcFreeze) {
+        // Module imports and OSI descriptors created during doInit never become garbage
+        PythonMemory::freeze();
+        std::cout << "[GT-DriveController] Python GC: froze objects created during initialization" << std::endl;
+    }
+
+    if ((PythonMemory::GcMode)m_gcMode == PythonMemory::GcMode::Manual) {
+        PythonMemory::setAutomaticGc(false);
+        std::cout << "[GT-DriveController] Python GC: automatic collection disabled, collecting every "
+                  << m_gcInterval << " steps" << std::endl;
+    }
+
+    m_gcLastCollections = PythonMemory::GcMonitor::instance().collections();
+    m_gcLastPauseNs = PythonMemory::GcMonitor::instance().pauseNs();
+}
+
+bool OSMPController::gcCollectionDue() {
+    if ((PythonMemory::GcMode)m_gcMode != PythonMemory::GcMode::Manual || m_gcInterval <= 0) {
+        return false;
+    }
+    return ++m_gcStepCounter % (unsigned long long)m_gcInterval == 0;
+}
+
+// Collections since the previous doStep, including idle-time collections in between
+void OSMPController::updateGcStepStats() {
+    const PythonMemory::GcMonitor& monitor = PythonMemory::GcMonitor::instance();
+    unsigned long long collections = monitor.collections();
+    long long pauseNs = monitor.pauseNs();
+
+    m_gcStepCollections = (fmi2Integer)(collections - m_gcLastCollections);
+    m_gcStepPauseMs = (pauseNs - m_gcLastPauseNs) * 1e-6;
+    if (m_gcStepPauseMs > m_gcMaxStepPauseMs) {
+        m_gcMaxStepPauseMs = m_gcStepPauseMs;
+    }
+
+    m_gcLastCollections = collections;
+    m_gcLastPauseNs = pauseNs;
+}
+
+ControlCommand OSMPController::currentCommand() const {
+    ControlCommand cmd;
+    cmd.throttle = m_throttle;
+    cmd.brake = m_brake;
+    cmd.steering = m_steering;
+    cmd.driveMode = m_driveMode;
+    return cmd;
+}
+
 fmi2Status OSMPController::setInteger(const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]) {
     for (size_t i = 0; i < nvr; ++i) {
         switch (vr[i]) {
             case VR_OSI_BASELO: m_osi_baseLo = value[i]; break;
             case VR_OSI_BASEHI: m_osi_baseHi = value[i]; break;
             case VR_OSI_SIZE:   m_osi_size = value[i]; break;
+            case VR_FALLBACK_MODE: m_fallbackMode = value[i]; break;
+            case VR_RT_THREAD_PRIORITY: m_rtThreadPriority = value[i]; break;
+            case VR_PLANNER_THREADS:    m_plannerThreads = value[i]; break;
+            case VR_SIGNAL_LOG_BLOCK_ROWS: m_signalLogBlockRows = value[i]; break;
+            case VR_RT_BUFFER_BYTES:    m_rtBufferBytes = value[i]; break;
+            case VR_PY_GC_MODE:         m_gcMode = value[i]; break;
+            case VR_PY_GC_INTERVAL:     m_gcInterval = value[i]; break;
+            case VR_PY_ALLOCATOR:       m_pythonAllocator = value[i]; break;
+            case VR_OSI_DECODE_MODE:    m_osiDecodeMode = value[i]; break;
+            case VR_PREFILTER_MOVING_MASK:     m_sensorViewFilter.settings.movingTypeMask = (uint32_t)value[i]; break;
+            case VR_PREFILTER_STATIONARY_MASK: m_sensorViewFilter.settings.stationaryTypeMask = (uint32_t)value[i]; break;
+            case VR_SD_IN_BASELO: m_inputChannels[CH_SENSOR_DATA].pointer.baseLo = value[i]; break;
+            case VR_SD_IN_BASEHI: m_inputChannels[CH_SENSOR_DATA].pointer.baseHi = value[i]; break;
+            case VR_SD_IN_SIZE:   m_inputChannels[CH_SENSOR_DATA].pointer.size = value[i]; break;
+            case VR_GT_IN_BASELO: m_inputChannels[CH_GROUND_TRUTH].pointer.baseLo = value[i]; break;
+            case VR_GT_IN_BASEHI: m_inputChannels[CH_GROUND_TRUTH].pointer.baseHi = value[i]; break;
+            case VR_GT_IN_SIZE:   m_inputChannels[CH_GROUND_TRUTH].pointer.size = value[i]; break;
+            case VR_TC_IN_BASELO: m_inputChannels[CH_TRAFFIC_COMMAND].pointer.baseLo = value[i]; break;
+            case VR_TC_IN_BASEHI: m_inputChannels[CH_TRAFFIC_COMMAND].pointer.baseHi = value[i]; break;
+            case VR_TC_IN_SIZE:   m_inputChannels[CH_TRAFFIC_COMMAND].pointer.size = value[i]; break;
+            case VR_SVC_IN_BASELO: m_svc_in.baseLo = value[i]; break;
+            case VR_SVC_IN_BASEHI: m_svc_in.baseHi = value[i]; break;
+            case VR_SVC_IN_SIZE:   m_svc_in.size = value[i]; break;
+            case VR_SD_DECODE_MODE: m_inputChannels[CH_SENSOR_DATA].decodeMode = value[i]; break;
+            case VR_GT_DECODE_MODE: m_inputChannels[CH_GROUND_TRUTH].decodeMode = value[i]; break;
+            case VR_TC_DECODE_MODE: m_inputChannels[CH_TRAFFIC_COMMAND].decodeMode = value[i]; break;
             default: break;
         }
     }
@@ -272,7 +1402,38 @@ fmi2Status OSMPController::getInteger(const fmi2ValueReference vr[], size_t nvr,
             case VR_OSI_OUT_BASELO: value[i] = m_osi_out_baseLo; break;
             case VR_OSI_OUT_BASEHI: value[i] = m_osi_out_baseHi; break;
             case VR_OSI_OUT_SIZE:   value[i] = m_osi_out_size; break;
+            case VR_TU_OUT_BASELO:  value[i] = m_tu_out_baseLo; break;
+            case VR_TU_OUT_BASEHI:  value[i] = m_tu_out_baseHi; break;
+            case VR_TU_OUT_SIZE:    value[i] = m_tu_out_size; break;
+            case VR_SVC_REQ_BASELO: value[i] = m_svc_req_baseLo; break;
+            case VR_SVC_REQ_BASEHI: value[i] = m_svc_req_baseHi; break;
+            case VR_SVC_REQ_SIZE:   value[i] = m_svc_req_size; break;
             case VR_DRIVEMODE:      value[i] = m_driveMode; break;
+            case VR_FALLBACK_MODE:  value[i] = m_fallbackMode; break;
+            case VR_DEADLINE_MISS_COUNT: value[i] = m_deadlineMissCount; break;
+            case VR_RT_THREAD_PRIORITY:  value[i] = m_rtThreadPriority; break;
+            case VR_PLANNER_THREADS:     value[i] = m_plannerThreads; break;
+            case VR_RT_BUFFER_BYTES:     value[i] = m_rtBufferBytes; break;
+            case VR_RT_STEP_ALLOC_COUNT: value[i] = m_rtStepAllocCount; break;
+            case VR_PY_GC_MODE:          value[i] = m_gcMode; break;
+            case VR_PY_GC_INTERVAL:      value[i] = m_gcInterval; break;
+            case VR_PY_ALLOCATOR:        value[i] = m_pythonAllocator; break;
+            case VR_PY_GC_COLLECTIONS:   value[i] = m_gcStepCollections; break;
+            case VR_OSI_DECODE_MODE:     value[i] = m_osiDecodeMode; break;
+            case VR_SD_DECODE_MODE:      value[i] = m_inputChannels[CH_SENSOR_DATA].decodeMode; break;
+            case VR_GT_DECODE_MODE:      value[i] = m_inputChannels[CH_GROUND_TRUTH].decodeMode; break;
+            case VR_TC_DECODE_MODE:      value[i] = m_inputChannels[CH_TRAFFIC_COMMAND].decodeMode; break;
+            case VR_PREFILTER_MOVING_MASK:     value[i] = (fmi2Integer)m_sensorViewFilter.settings.movingTypeMask; break;
+            case VR_PREFILTER_STATIONARY_MASK: value[i] = (fmi2Integer)m_sensorViewFilter.settings.stationaryTypeMask; break;
+            case VR_PREFILTER_BYTES_REMOVED:   value[i] = m_prefilterBytesRemoved; break;
+            case VR_PREFILTER_OBJECTS_REMOVED: value[i] = m_prefilterObjectsRemoved; break;
+            case VR_PREFILTER_LANES_REMOVED:   value[i] = m_prefilterLanesRemoved; break;
+            case VR_STATIC_MAP_VERSION:        value[i] = (fmi2Integer)m_staticMap.version(); break;
+            case VR_STATIC_MAP_BYTES_STRIPPED: value[i] = m_staticMapBytesStripped; break;
+            case VR_LIDAR_REFLECTIONS:         value[i] = m_lidarReflections; break;
+            case VR_LIDAR_POINTS:              value[i] = m_lidarPoints; break;
+            case VR_TRACKED_OBJECTS:           value[i] = m_trackedObjects; break;
+            case VR_SIGNAL_LOG_BLOCK_ROWS:     value[i] = m_signalLogBlockRows; break;
             default:                value[i] = 0; break;
         }
     }
@@ -285,12 +1446,112 @@ fmi2Status OSMPController::getReal(const fmi2ValueReference vr[], size_t nvr, fm
             case VR_THROTTLE: value[i] = m_throttle; break;
             case VR_BRAKE:    value[i] = m_brake; break;
             case VR_STEERING: value[i] = m_steering; break;
+            case VR_STEP_DEADLINE_MS: value[i] = m_stepDeadlineMs; break;
+            case VR_FALLBACK_BRAKE:   value[i] = m_fallbackBrake; break;
+            case VR_PY_GC_PAUSE_MS:     value[i] = m_gcStepPauseMs; break;
+            case VR_PY_GC_MAX_PAUSE_MS: value[i] = m_gcMaxStepPauseMs; break;
+            case VR_SV_FOV_HORIZONTAL:  value[i] = m_svFovHorizontal; break;
+            case VR_SV_FOV_VERTICAL:    value[i] = m_svFovVertical; break;
+            case VR_SV_RANGE:           value[i] = m_svRange; break;
+            case VR_SV_UPDATE_CYCLE:    value[i] = m_svUpdateCycle; break;
+            case VR_SV_MEAN_BYTES:      value[i] = m_svMeanBytes; break;
+            case VR_PREFILTER_RADIUS:   value[i] = m_sensorViewFilter.settings.radius; break;
+            case VR_PREFILTER_FRONT:    value[i] = m_sensorViewFilter.settings.corridorFront; break;
+            case VR_PREFILTER_REAR:     value[i] = m_sensorViewFilter.settings.corridorRear; break;
+            case VR_PREFILTER_LATERAL:  value[i] = m_sensorViewFilter.settings.corridorLateral; break;
+            case VR_OCCUPANCY_RESOLUTION: value[i] = m_occupancyResolution; break;
+            case VR_OCCUPANCY_SIZE:     value[i] = m_occupancySize; break;
+            case VR_LIDAR_VOXEL_SIZE:   value[i] = m_lidar->settings.voxelSize; break;
+            case VR_LIDAR_MAX_RANGE:    value[i] = m_lidar->settings.maxRange; break;
+            case VR_KPI_HEADWAY_THRESHOLD: value[i] = m_kpiHeadwayThreshold; break;
+            case VR_TU_MAX_STEERING_WHEEL_ANGLE: value[i] = m_trafficUpdateBuilder.maxSteeringWheelAngle; break;
+            case VR_KPI_MIN_TTC:        value[i] = m_kpiValues.minTtc; break;
+            case VR_KPI_MAX_JERK:       value[i] = m_kpiValues.maxJerk; break;
+            case VR_KPI_LANE_DEVIATION_RMS:     value[i] = m_kpiValues.laneDeviationRms; break;
+            case VR_KPI_HEADWAY_VIOLATION_TIME: value[i] = m_kpiValues.headwayViolationTime; break;
+            case VR_KPI_COMFORT_VIOLATION_TIME: value[i] = m_kpiValues.comfortViolationTime; break;
             default:          value[i] = 0.0; break;
         }
     }
     return fmi2OK;
 }
 
+fmi2Status OSMPController::setReal(const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]) {
+    for (size_t i = 0; i < nvr; ++i) {
+        switch (vr[i]) {
+            case VR_STEP_DEADLINE_MS: m_stepDeadlineMs = value[i]; break;
+            case VR_FALLBACK_BRAKE:   m_fallbackBrake = value[i]; break;
+            case VR_SV_FOV_HORIZONTAL: m_svFovHorizontal = value[i]; break;
+            case VR_SV_FOV_VERTICAL:   m_svFovVertical = value[i]; break;
+            case VR_SV_RANGE:          m_svRange = value[i]; break;
+            case VR_SV_UPDATE_CYCLE:   m_svUpdateCycle = value[i]; break;
+            case VR_PREFILTER_RADIUS:  m_sensorViewFilter.settings.radius = value[i]; break;
+            case VR_PREFILTER_FRONT:   m_sensorViewFilter.settings.corridorFront = value[i]; break;
+            case VR_PREFILTER_REAR:    m_sensorViewFilter.settings.corridorRear = value[i]; break;
+            case VR_PREFILTER_LATERAL: m_sensorViewFilter.settings.corridorLateral = value[i]; break;
+            case VR_OCCUPANCY_RESOLUTION: m_occupancyResolution = value[i]; break;
+            case VR_OCCUPANCY_SIZE:    m_occupancySize = value[i]; break;
+            case VR_LIDAR_VOXEL_SIZE:  m_lidar->settings.voxelSize = value[i]; break;
+            case VR_LIDAR_MAX_RANGE:   m_lidar->settings.maxRange = value[i]; break;
+            case VR_KPI_HEADWAY_THRESHOLD: m_kpiHeadwayThreshold = value[i]; break;
+            case VR_TU_MAX_STEERING_WHEEL_ANGLE: m_trafficUpdateBuilder.maxSteeringWheelAngle = value[i]; break;
+            default: break;
+        }
+    }
+    return fmi2OK;
+}
+
+fmi2Status OSMPController::getBoolean(const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]) {
+    for (size_t i = 0; i < nvr; ++i) {
+        switch (vr[i]) {
+            case VR_VALID: value[i] = m_valid; break;
+            case VR_RT_PROFILE: value[i] = m_rtProfile; break;
+            case VR_PY_GC_FREEZE: value[i] = m_gcFreeze; break;
+            case VR_SENSORVIEW_OUTPUT: value[i] = m_sensorViewOutput; break;
+            case VR_TRAFFIC_UPDATE_OUTPUT: value[i] = m_trafficUpdateOutput; break;
+            case VR_SV_OMIT_STATIC: value[i] = m_svOmitStatic; break;
+            case VR_PREFILTER_ENABLED: value[i] = m_prefilterEnabled; break;
+            case VR_STATIC_MAP_CACHE: value[i] = m_staticMapEnabled; break;
+            case VR_OBJECT_INDEX: value[i] = m_objectIndexEnabled; break;
+            case VR_EGO_FRAME: value[i] = m_egoFrameEnabled; break;
+            case VR_TRAJECTORY_PREDICTION: value[i] = m_predictionEnabled; break;
+            case VR_MPPI_PLANNER: value[i] = m_plannerEnabled; break;
+            case VR_OCCUPANCY_GRID: value[i] = m_occupancyEnabled; break;
+            case VR_LIDAR_PREPROCESSING: value[i] = m_lidarEnabled; break;
+            case VR_CAMERA_IMAGES: value[i] = m_cameraEnabled; break;
+            case VR_OBJECT_TRACKING: value[i] = m_trackingEnabled; break;
+            case VR_KPI_ENABLED: value[i] = m_kpiEnabled; break;
+            default:       value[i] = fmi2False; break;
+        }
+    }
+    return fmi2OK;
+}
+
+fmi2Status OSMPController::setBoolean(const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]) {
+    for (size_t i = 0; i < nvr; ++i) {
+        switch (vr[i]) {
+            case VR_RT_PROFILE: m_rtProfile = value[i]; break;
+            case VR_PY_GC_FREEZE: m_gcFreeze = value[i]; break;
+            case VR_SENSORVIEW_OUTPUT: m_sensorViewOutput = value[i]; break;
+            case VR_TRAFFIC_UPDATE_OUTPUT: m_trafficUpdateOutput = value[i]; break;
+            case VR_SV_OMIT_STATIC: m_svOmitStatic = value[i]; break;
+            case VR_PREFILTER_ENABLED: m_prefilterEnabled = value[i]; break;
+            case VR_STATIC_MAP_CACHE: m_staticMapEnabled = value[i]; break;
+            case VR_OBJECT_INDEX: m_objectIndexEnabled = value[i]; break;
+            case VR_EGO_FRAME: m_egoFrameEnabled = value[i]; break;
+            case VR_TRAJECTORY_PREDICTION: m_predictionEnabled = value[i]; break;
+            case VR_MPPI_PLANNER: m_plannerEnabled = value[i]; break;
+            case VR_OCCUPANCY_GRID: m_occupancyEnabled = value[i]; break;
+            case VR_LIDAR_PREPROCESSING: m_lidarEnabled = value[i]; break;
+            case VR_CAMERA_IMAGES: m_cameraEnabled = value[i]; break;
+            case VR_OBJECT_TRACKING: m_trackingEnabled = value[i]; break;
+            case VR_KPI_ENABLED: m_kpiEnabled = value[i]; break;
+            default: break;
+        }
+    }
+    return fmi2OK;
+}
+
 fmi2Status OSMPController::setString(const fmi2ValueReference vr[], size_t nvr, const fmi2String value[]) {
     for (size_t i = 0; i < nvr; ++i) {
         switch (vr[i]) {
@@ -302,6 +1563,24 @@ fmi2Status OSMPController::setString(const fmi2ValueReference vr[], size_t nvr,
                 std::cout << "[GT-DriveController] setString: PythonDependencyPath overridden to: " << value[i] << std::endl;
                 m_pythonDependencyPath = value[i]; 
                 break;
+            case VR_RT_CPU_AFFINITY:
+                m_rtCpuAffinity = value[i];
+                break;
+            case VR_PROTOBUF_BACKEND:
+                m_protobufBackend = value[i];
+                break;
+            case VR_SV_SENSOR_VIEWS:
+                m_svSensorViews = value[i];
+                break;
+            case VR_ROAD_NETWORK_CACHE_DIR:
+                m_staticMap.graphCacheDirectory = value[i];
+                break;
+            case VR_KPI_SUMMARY_PATH:
+                m_kpiSummaryPath = value[i];
+                break;
+            case VR_SIGNAL_LOG_PATH:
+                m_signalLogPath = value[i];
+                break;
             default: break;
         }
     }
@@ -313,6 +1592,12 @@ fmi2Status OSMPController::getString(const fmi2ValueReference vr[], size_t nvr,
         switch (vr[i]) {
             case VR_PYTHON_SCRIPT_PATH: value[i] = m_pythonScriptPath.c_str(); break;
             case VR_PYTHON_DEP_PATH:    value[i] = m_pythonDependencyPath.c_str(); break;
+            case VR_RT_CPU_AFFINITY:    value[i] = m_rtCpuAffinity.c_str(); break;
+            case VR_PROTOBUF_BACKEND:   value[i] = m_protobufBackend.c_str(); break;
+            case VR_SV_SENSOR_VIEWS:    value[i] = m_svSensorViews.c_str(); break;
+            case VR_ROAD_NETWORK_CACHE_DIR: value[i] = m_staticMap.graphCacheDirectory.c_str(); break;
+            case VR_KPI_SUMMARY_PATH:   value[i] = m_kpiSummaryPath.c_str(); break;
+            case VR_SIGNAL_LOG_PATH:    value[i] = m_signalLogPath.c_str(); break;
             default:                    value[i] = ""; break;
         }
     }
@@ -320,10 +1605,82 @@ fmi2Status OSMPController::getString(const fmi2ValueReference vr[], size_t nvr,
 }
 
 fmi2Status OSMPController::terminate() {
+    if (m_svInputSteps > 0) {
+        std::cout << "[GT-DriveController] SensorView input: " << m_svInputSteps << " steps, mean "
+                  << (unsigned long long)m_svMeanBytes << " bytes, max " << m_svInputMaxBytes << " bytes"
+                  << (m_svcNegotiated ? " (SensorViewConfiguration negotiated)" : "") << std::endl;
+    }
+    if (m_staticMapEnabled) {
+        std::cout << "[GT-DriveController] Static map: " << m_staticMap.version() << " version(s) decoded" << std::endl;
+    }
+    if (m_prefilterTotalBytesIn > 0) {
+        std::cout << "[GT-DriveController] SensorView pre-filter: " << m_prefilterTotalBytesIn << " bytes in, "
+                  << m_prefilterTotalBytesOut << " bytes to Python ("
+                  << (100.0 * (double)(m_prefilterTotalBytesIn - m_prefilterTotalBytesOut) / (double)m_prefilterTotalBytesIn)
+                  << "% removed)" << std::endl;
+    }
+    if (m_lidarTotalReflections > 0) {
+        std::cout << "[GT-DriveController] Lidar: " << m_lidarTotalReflections << " reflections reduced to "
+                  << m_lidarTotalPoints << " points" << std::endl;
+    }
+    if (m_tracker && m_tracker->created() > 0) {
+        std::cout << "[GT-DriveController] Object tracker: " << m_tracker->created() << " tracks created" << std::endl;
+    }
+    if (m_kpi) {
+        std::cout << "[GT-DriveController] KPIs: min TTC " << m_kpiValues.minTtc << " s, max jerk "
+                  << m_kpiValues.maxJerk << " m/s^3, headway violation " << m_kpiValues.headwayViolationTime
+                  << " s, comfort violation " << m_kpiValues.comfortViolationTime << " s" << std::endl;
+        std::string error;
+        if (!m_kpiSummaryPath.empty() && !m_kpi->writeSummary(m_kpiSummaryPath, error)) {
+            std::cerr << "[GT-DriveController] Warning: KPI summary not written: " << error << std::endl;
+        }
+    }
+    if (m_signalLog && m_signalLog->isOpen()) {
+        std::string error;
+        if (!m_signalLog->close(error)) {
+            std::cerr << "[GT-DriveController] Warning: Signal log incomplete: " << error << std::endl;
+        }
+        std::cout << "[GT-DriveController] Signal log: " << m_signalLog->rows() << " rows in "
+                  << m_signalLog->blocks() << " blocks" << std::endl;
+        if (m_signalLog->droppedRows() > 0) {
+            std::cerr << "[GT-DriveController] Warning: Signal log dropped " << m_signalLog->droppedRows()
+                      << " rows (writer behind)" << std::endl;
+        }
+    }
     return fmi2OK;
 }
 
 fmi2Status OSMPController::reset() {
+    m_deadlineMissCount = 0;
+    m_inFallback = false;
+    m_stepCount = 0;
+    m_rtStepAllocCount = 0;
+    m_gcStepCollections = 0;
+    m_gcStepPauseMs = 0.0;
+    m_gcMaxStepPauseMs = 0.0;
+    m_svInputSteps = 0;
+    m_svInputBytes = 0;
+    m_svInputMaxBytes = 0;
+    m_svMeanBytes = 0.0;
+    m_prefilterBytesRemoved = 0;
+    m_prefilterObjectsRemoved = 0;
+    m_prefilterLanesRemoved = 0;
+    m_prefilterTotalBytesIn = 0;
+    m_prefilterTotalBytesOut = 0;
+    m_lidarReflections = 0;
+    m_lidarPoints = 0;
+    m_lidarTotalReflections = 0;
+    m_lidarTotalPoints = 0;
+    if (m_tracker) {
+        m_tracker->reset();
+    }
+    m_trackedObjects = 0;
+    if (m_kpi) {
+        m_kpi->reset();
+    }
+    m_kpiValues = KpiValues();
+    m_staticMapBytesStripped = 0;
+    m_valid = fmi2True;
     return fmi2OK;
 }
 
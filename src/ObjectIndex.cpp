@@ -0,0 +1,373 @@
+#include "ObjectIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double CELL_SIZE = 20.0;     // [m], about the spacing of vehicles in dense traffic
+constexpr double LANE_MARGIN = 10.0;   // Objects farther beside the centerline are not in the lane [m]
+constexpr size_t MAX_LANE_WALK = 64;   // Lanes visited by inLane()
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+int32_t cellCoordinate(double v) {
+    double c = std::floor(v / CELL_SIZE);
+    return (int32_t)std::max(-2147483647.0, std::min(2147483647.0, c));
+}
+
+uint64_t makeKey(int32_t column, int32_t row) {
+    return ((uint64_t)(uint32_t)column << 32) | (uint32_t)row;
+}
+
+// Distance from (x, y) to the oriented footprint, 0 inside
+double footprintDistance(double cx, double cy, double cosYaw, double sinYaw, double halfLength, double halfWidth,
+                         double x, double y) {
+    double rx = x - cx;
+    double ry = y - cy;
+    double lx = std::fabs(rx * cosYaw + ry * sinYaw) - halfLength;
+    double ly = std::fabs(-rx * sinYaw + ry * cosYaw) - halfWidth;
+    return std::hypot(std::max(lx, 0.0), std::max(ly, 0.0));
+}
+
+// Separating axis test of two oriented rectangles given by center, unit axis and half sizes
+bool overlaps(double ax, double ay, double ac, double as, double al, double aw,
+              double bx, double by, double bc, double bs, double bl, double bw) {
+    double dx = bx - ax;
+    double dy = by - ay;
+    const double axes[4][2] = { { ac, as }, { -as, ac }, { bc, bs }, { -bs, bc } };
+    for (const auto& n : axes) {
+        double ra = al * std::fabs(ac * n[0] + as * n[1]) + aw * std::fabs(-as * n[0] + ac * n[1]);
+        double rb = bl * std::fabs(bc * n[0] + bs * n[1]) + bw * std::fabs(-bs * n[0] + bc * n[1]);
+        if (std::fabs(dx * n[0] + dy * n[1]) > ra + rb) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ObjectIndex::ObjectIndex(std::shared_ptr<FrenetEngine> frenet)
+    : m_frenet(std::move(frenet)) {
+}
+
+void ObjectIndex::insert(uint32_t slot) {
+    Slot& o = m_slots[slot];
+    std::vector<uint32_t>& cell = m_cells[o.cell];
+    o.posInCell = (uint32_t)cell.size();
+    cell.push_back(slot);
+}
+
+void ObjectIndex::remove(uint32_t slot) {
+    Slot& o = m_slots[slot];
+    auto it = m_cells.find(o.cell);
+    std::vector<uint32_t>& cell = it->second;
+    uint32_t moved = cell.back();
+    cell[o.posInCell] = moved;
+    m_slots[moved].posInCell = o.posInCell;
+    cell.pop_back();
+    if (cell.empty()) {
+        m_cells.erase(it);
+    }
+}
+
+void ObjectIndex::update(const MovingObjects& objects) {
+    ++m_step;
+    m_hostId = objects.hostId;
+    m_lastMoves = 0;
+    m_maxExtent = 0.0;
+    if (objects.count > 0) {
+        m_minX = m_maxX = objects.x[0];
+        m_minY = m_maxY = objects.y[0];
+    }
+
+    for (size_t i = 0; i < objects.count; ++i) {
+        auto found = m_slotById.find(objects.id[i]);
+        uint32_t slot;
+        bool added = found == m_slotById.end();
+        if (added) {
+            if (!m_freeSlots.empty()) {
+                slot = m_freeSlots.back();
+                m_freeSlots.pop_back();
+            } else {
+                slot = (uint32_t)m_slots.size();
+                m_slots.emplace_back();
+            }
+            m_slotById.emplace(objects.id[i], slot);
+        } else {
+            slot = found->second;
+        }
+
+        Slot& o = m_slots[slot];
+        if (added) {
+            o = Slot();
+            o.id = objects.id[i];
+            o.active = true;
+        }
+        o.seen = m_step;
+        o.x = objects.x[i];
+        o.y = objects.y[i];
+        o.cosYaw = objects.cosYaw[i];
+        o.sinYaw = objects.sinYaw[i];
+        o.halfLength = 0.5 * std::fabs(objects.length[i]);
+        o.halfWidth = 0.5 * std::fabs(objects.width[i]);
+        m_maxExtent = std::max(m_maxExtent, std::hypot(o.halfLength, o.halfWidth));
+        m_minX = std::min(m_minX, o.x);
+        m_maxX = std::max(m_maxX, o.x);
+        m_minY = std::min(m_minY, o.y);
+        m_maxY = std::max(m_maxY, o.y);
+
+        // Only objects crossing a cell border touch the grid
+        uint64_t cell = makeKey(cellCoordinate(o.x), cellCoordinate(o.y));
+        if (added) {
+            o.cell = cell;
+            insert(slot);
+        } else if (cell != o.cell) {
+            remove(slot);
+            m_slots[slot].cell = cell;
+            insert(slot);
+            ++m_lastMoves;
+        }
+    }
+
+    // Objects that disappeared
+    for (uint32_t slot = 0; slot < m_slots.size(); ++slot) {
+        Slot& o = m_slots[slot];
+        if (o.active && o.seen != m_step) {
+            remove(slot);
+            m_slotById.erase(o.id);
+            o.active = false;
+            m_freeSlots.push_back(slot);
+        }
+    }
+    m_count = m_slotById.size();
+}
+
+void ObjectIndex::gather(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>& out) const {
+    out.clear();
+    minX = std::max(minX, m_minX);
+    minY = std::max(minY, m_minY);
+    maxX = std::min(maxX, m_maxX);
+    maxY = std::min(maxY, m_maxY);
+    if (m_count == 0 || minX > maxX || minY > maxY) {
+        return;
+    }
+    int32_t c0 = cellCoordinate(minX), c1 = cellCoordinate(maxX);
+    int32_t r0 = cellCoordinate(minY), r1 = cellCoordinate(maxY);
+    double cells = ((double)c1 - c0 + 1.0) * ((double)r1 - r0 + 1.0);
+    if (cells > (double)m_cells.size()) {
+        // Fewer occupied cells than cells in the box: visit the occupied ones
+        for (const auto& cell : m_cells) {
+            int32_t c = (int32_t)(uint32_t)(cell.first >> 32);
+            int32_t r = (int32_t)(uint32_t)cell.first;
+            if (c >= c0 && c <= c1 && r >= r0 && r <= r1) {
+                out.insert(out.end(), cell.second.begin(), cell.second.end());
+            }
+        }
+        return;
+    }
+    for (int32_t r = r0; r <= r1; ++r) {
+        for (int32_t c = c0; c <= c1; ++c) {
+            auto it = m_cells.find(makeKey(c, r));
+            if (it != m_cells.end()) {
+                out.insert(out.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+}
+
+void ObjectIndex::nearest(const double* x, const double* y, size_t count, size_t k, bool excludeHost, Neighbours& out) {
+    out.id.assign(count * k, 0);
+    out.distance.assign(count * k, INF);
+    if (k == 0 || m_count == 0) {
+        return;
+    }
+    for (size_t q = 0; q < count; ++q) {
+        if (!std::isfinite(x[q]) || !std::isfinite(y[q])) {
+            continue;
+        }
+        // Growing squares: an object within footprint distance radius has its center
+        // within radius + maxExtent. Done when k such objects are found or the
+        // square holds all centers.
+        for (double radius = CELL_SIZE;; radius *= 2.0) {
+            double reach = radius + m_maxExtent;
+            gather(x[q] - reach, y[q] - reach, x[q] + reach, y[q] + reach, m_candidates);
+            bool all = x[q] - reach <= m_minX && x[q] + reach >= m_maxX && y[q] - reach <= m_minY && y[q] + reach >= m_maxY;
+            m_hits.clear();
+            for (uint32_t slot : m_candidates) {
+                const Slot& o = m_slots[slot];
+                if (excluded(o, excludeHost)) {
+                    continue;
+                }
+                double d = footprintDistance(o.x, o.y, o.cosYaw, o.sinYaw, o.halfLength, o.halfWidth, x[q], y[q]);
+                if (all || d <= radius) {
+                    m_hits.push_back({ d, 0.0, o.id });
+                }
+            }
+            if (m_hits.size() < k && !all) {
+                continue;
+            }
+            size_t n = std::min(k, m_hits.size());
+            std::partial_sort(m_hits.begin(), m_hits.begin() + n, m_hits.end());
+            for (size_t j = 0; j < n; ++j) {
+                out.id[q * k + j] = m_hits[j].id;
+                out.distance[q * k + j] = m_hits[j].longitudinal;
+            }
+            break;
+        }
+    }
+}
+
+const ObjectIndex::Slot& ObjectIndex::projected(uint32_t slot) {
+    Slot& o = m_slots[slot];
+    if (o.frenetStep != m_step) {
+        uint64_t laneId = 0;
+        o.frenetStep = m_step;
+        o.lane = m_frenet->project(o.x, o.y, o.segment, o.s, o.t, laneId)
+            ? m_frenet->graph()->pointLane()[o.segment] : ROAD_GRAPH_NO_LANE;
+    }
+    return o;
+}
+
+void ObjectIndex::output(Selection& out) {
+    std::sort(m_hits.begin(), m_hits.end());
+    out.clear();
+    for (const Hit& hit : m_hits) {
+        out.id.push_back(hit.id);
+        out.longitudinal.push_back(hit.longitudinal);
+        out.lateral.push_back(hit.lateral);
+    }
+}
+
+void ObjectIndex::inLane(uint64_t laneId, double s, double ahead, double behind, bool excludeHost, Selection& out) {
+    out.clear();
+    if (!m_frenet || !m_frenet->hasMap() || m_count == 0 || !std::isfinite(s)) {
+        return;
+    }
+    const RoadGraph* graph = m_frenet->graph();
+    if (graph != m_frenetGraph) {
+        // Cached projections refer to the segments of the previous map
+        m_frenetGraph = graph;
+        for (Slot& o : m_slots) {
+            o.frenetStep = 0;
+            o.segment = FRENET_NO_SEGMENT;
+        }
+    }
+    uint32_t start = graph->findLane(laneId);
+    if (start == ROAD_GRAPH_NO_LANE) {
+        return;
+    }
+
+    // Lanes reachable within the window: successors ahead, predecessors behind,
+    // each with the s of its first point relative to the start lane
+    const RoadGraphLane* lanes = graph->lanes();
+    const uint32_t* links = graph->links();
+    auto visited = [this](uint32_t lane) {
+        for (const auto& entry : m_lanes) {
+            if (entry.first == lane) {
+                return true;
+            }
+        }
+        return false;
+    };
+    m_lanes.clear();
+    m_lanes.emplace_back(start, 0.0);
+    for (size_t i = 0; i < m_lanes.size() && m_lanes.size() < MAX_LANE_WALK; ++i) {
+        const RoadGraphLane& lane = lanes[m_lanes[i].first];
+        double offset = m_lanes[i].second;
+        if (offset >= 0.0 && offset + lane.length < s + ahead) {
+            for (uint32_t j = 0; j < lane.successorCount && m_lanes.size() < MAX_LANE_WALK; ++j) {
+                uint32_t next = links[lane.firstSuccessor + j];
+                if (!visited(next)) {
+                    m_lanes.emplace_back(next, offset + lane.length);
+                }
+            }
+        }
+        if (offset <= 0.0 && offset > s - behind) {
+            for (uint32_t j = 0; j < lane.predecessorCount && m_lanes.size() < MAX_LANE_WALK; ++j) {
+                uint32_t previous = links[lane.firstPredecessor + j];
+                if (!visited(previous)) {
+                    m_lanes.emplace_back(previous, offset - lanes[previous].length);
+                }
+            }
+        }
+    }
+
+    // Candidates: objects near the centerline parts inside the window
+    double minX = INF, minY = INF, maxX = -INF, maxY = -INF;
+    const double* px = graph->pointX();
+    const double* py = graph->pointY();
+    const double* ps = graph->pointS();
+    for (const auto& entry : m_lanes) {
+        const RoadGraphLane& lane = lanes[entry.first];
+        uint32_t end = lane.firstPoint + lane.pointCount;
+        for (uint32_t p = lane.firstPoint; p < end; ++p) {
+            // A point counts if it or a neighbour lies inside, so that segments crossing the window are covered
+            double ds = entry.second + ps[p] - s;
+            double dsPrevious = p > lane.firstPoint ? entry.second + ps[p - 1] - s : ds;
+            double dsNext = p + 1 < end ? entry.second + ps[p + 1] - s : ds;
+            if (dsNext < -behind || dsPrevious > ahead) {
+                continue;
+            }
+            minX = std::min(minX, px[p]);
+            maxX = std::max(maxX, px[p]);
+            minY = std::min(minY, py[p]);
+            maxY = std::max(maxY, py[p]);
+        }
+    }
+    if (minX > maxX) {
+        return;
+    }
+    gather(minX - LANE_MARGIN, minY - LANE_MARGIN, maxX + LANE_MARGIN, maxY + LANE_MARGIN, m_candidates);
+
+    m_hits.clear();
+    for (uint32_t slot : m_candidates) {
+        if (excluded(m_slots[slot], excludeHost)) {
+            continue;
+        }
+        const Slot& o = projected(slot);
+        if (o.lane == ROAD_GRAPH_NO_LANE || std::fabs(o.t) > LANE_MARGIN) {
+            continue;
+        }
+        for (const auto& entry : m_lanes) {
+            if (entry.first == o.lane) {
+                double ds = entry.second + o.s - s;
+                if (ds >= -behind && ds <= ahead) {
+                    m_hits.push_back({ ds, o.t, o.id });
+                }
+                break;
+            }
+        }
+    }
+    output(out);
+}
+
+void ObjectIndex::inCorridor(double x, double y, double heading, double front, double rear, double halfWidth,
+                             bool excludeHost, Selection& out) {
+    out.clear();
+    if (m_count == 0 || !std::isfinite(x) || !std::isfinite(y) || !std::isfinite(heading) ||
+        !(front + rear >= 0.0) || !(halfWidth >= 0.0)) {
+        return;
+    }
+    double c = std::cos(heading);
+    double sn = std::sin(heading);
+    double halfLength = 0.5 * (front + rear);
+    double cx = x + c * 0.5 * (front - rear);
+    double cy = y + sn * 0.5 * (front - rear);
+    double extentX = halfLength * std::fabs(c) + halfWidth * std::fabs(sn) + m_maxExtent;
+    double extentY = halfLength * std::fabs(sn) + halfWidth * std::fabs(c) + m_maxExtent;
+    gather(cx - extentX, cy - extentY, cx + extentX, cy + extentY, m_candidates);
+
+    m_hits.clear();
+    for (uint32_t slot : m_candidates) {
+        const Slot& o = m_slots[slot];
+        if (excluded(o, excludeHost) ||
+            !overlaps(cx, cy, c, sn, halfLength, halfWidth, o.x, o.y, o.cosYaw, o.sinYaw, o.halfLength, o.halfWidth)) {
+            continue;
+        }
+        double rx = o.x - x;
+        double ry = o.y - y;
+        m_hits.push_back({ rx * c + ry * sn, -rx * sn + ry * c, o.id });
+    }
+    output(out);
+}
@@ -0,0 +1,522 @@
+#include "ObjectTracker.h"
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+using OsiWire::Field;
+using OsiWire::WireType;
+
+constexpr double NO_MATCH = 1e9; // Cost of pairs outside the gate in the Hungarian method
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+struct BaseState {
+    bool hasPosition = false;
+    bool hasVelocity = false;
+    double dimension[3] = {};
+    double position[3] = {};
+    double orientation[3] = {};
+    double velocity[3] = {};
+};
+
+bool readBase(const Field& field, BaseState& state) {
+    using namespace OsiFields;
+    if (field.type != WireType::LengthDelimited) {
+        return true;
+    }
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        switch (f.number) {
+            case BaseMoving::Dimension:   OsiWire::readVector3d(f, state.dimension); break;
+            case BaseMoving::Position:    OsiWire::readVector3d(f, state.position); state.hasPosition = true; break;
+            case BaseMoving::Orientation: OsiWire::readVector3d(f, state.orientation); break;
+            case BaseMoving::Velocity:    OsiWire::readVector3d(f, state.velocity); state.hasVelocity = true; break;
+            default: break;
+        }
+    }
+    return reader.ok();
+}
+
+bool readTimestamp(const Field& field, double& time) {
+    if (field.type != WireType::LengthDelimited) {
+        return false;
+    }
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    int64_t seconds = 0;
+    uint64_t nanos = 0;
+    while (reader.next(f)) {
+        if (f.type != WireType::Varint) {
+            continue;
+        }
+        if (f.number == OsiFields::Timestamp::Seconds) {
+            seconds = (int64_t)f.varint;
+        } else if (f.number == OsiFields::Timestamp::Nanos) {
+            nanos = f.varint;
+        }
+    }
+    time = (double)seconds + (double)nanos * 1e-9;
+    return true;
+}
+
+// Keep the elements without remove[i], in order
+template <typename T>
+void compact(std::vector<T>& values, const std::vector<uint8_t>& remove) {
+    size_t out = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!remove[i]) {
+            values[out++] = values[i];
+        }
+    }
+    values.resize(out);
+}
+
+} // namespace
+
+// Detections of the message, in the global frame if the host vehicle location is known
+bool ObjectTracker::parse(const char* sensorData, size_t size, double fallbackTime, std::string& error) {
+    using namespace OsiFields;
+    Detections& d = m_det;
+    d.x.clear();
+    d.y.clear();
+    d.vx.clear();
+    d.vy.clear();
+    d.yaw.clear();
+    d.length.clear();
+    d.width.clear();
+    d.existence.clear();
+    d.sensorId.clear();
+    d.hasVelocity.clear();
+
+    m_stepTime = fallbackTime;
+    BaseState host;
+    OsiWire::Reader reader(sensorData, size);
+    Field field;
+    while (reader.next(field)) {
+        if (field.number == SensorData::Timestamp) {
+            readTimestamp(field, m_stepTime);
+        } else if (field.number == SensorData::HostVehicleLocation) {
+            if (!readBase(field, host)) {
+                error = "malformed host_vehicle_location";
+                return false;
+            }
+        }
+    }
+    if (!reader.ok()) {
+        error = "malformed SensorData";
+        return false;
+    }
+    bool global = host.hasPosition;
+    double c = global ? std::cos(host.orientation[2]) : 1.0;
+    double s = global ? std::sin(host.orientation[2]) : 0.0;
+
+    OsiWire::Reader objects(sensorData, size);
+    while (objects.next(field)) {
+        if (field.number != SensorData::MovingObject || field.type != WireType::LengthDelimited) {
+            continue;
+        }
+        BaseState base;
+        uint64_t sensorId = 0;
+        double existence = 1.0;
+        OsiWire::Reader object(field.data, field.size);
+        Field f;
+        while (object.next(f)) {
+            if (f.number == DetectedMovingObject::Base) {
+                if (!readBase(f, base)) {
+                    error = "malformed DetectedMovingObject.base";
+                    return false;
+                }
+            } else if (f.number == DetectedMovingObject::Header && f.type == WireType::LengthDelimited) {
+                OsiWire::Reader header(f.data, f.size);
+                Field h;
+                while (header.next(h)) {
+                    if (h.number == DetectedItemHeader::TrackingId) {
+                        OsiWire::readIdentifier(h, sensorId);
+                    } else if (h.number == DetectedItemHeader::ExistenceProbability && h.type == WireType::Fixed64) {
+                        existence = OsiWire::readDouble(h);
+                    }
+                }
+            }
+        }
+        if (!object.ok()) {
+            error = "malformed DetectedMovingObject";
+            return false;
+        }
+        double px = base.position[0];
+        double py = base.position[1];
+        if (!base.hasPosition || !std::isfinite(px) || !std::isfinite(py)) {
+            continue;
+        }
+        double vx = base.velocity[0];
+        double vy = base.velocity[1];
+        double yaw = base.orientation[2];
+        if (global) {
+            // Host vehicle frame -> global; velocities are relative to the host vehicle
+            double gx = host.position[0] + (c * px - s * py);
+            double gy = host.position[1] + (s * px + c * py);
+            px = gx;
+            py = gy;
+            double gvx = host.velocity[0] + (c * vx - s * vy);
+            double gvy = host.velocity[1] + (s * vx + c * vy);
+            vx = gvx;
+            vy = gvy;
+            yaw += host.orientation[2];
+        }
+        d.x.push_back(px);
+        d.y.push_back(py);
+        d.vx.push_back(vx);
+        d.vy.push_back(vy);
+        d.yaw.push_back(yaw);
+        d.length.push_back(base.dimension[0]);
+        d.width.push_back(base.dimension[1]);
+        d.existence.push_back(existence);
+        d.sensorId.push_back(sensorId);
+        d.hasVelocity.push_back(base.hasVelocity && std::isfinite(vx) && std::isfinite(vy) ? 1 : 0);
+    }
+    if (!objects.ok()) {
+        error = "malformed SensorData";
+        return false;
+    }
+    m_global = global;
+    return true;
+}
+
+Simd::KalmanArrays ObjectTracker::arrays() {
+    Simd::KalmanArrays a;
+    a.x = m_x.data();
+    a.y = m_y.data();
+    a.vx = m_vx.data();
+    a.vy = m_vy.data();
+    for (size_t k = 0; k < Simd::KALMAN_COVARIANCE_SIZE; ++k) {
+        a.p[k] = m_p[k].data();
+    }
+    return a;
+}
+
+// Squared Mahalanobis distances of all detections to each predicted track, INF outside the gate
+void ObjectTracker::gate() {
+    size_t n = count();
+    size_t m = m_det.x.size();
+    m_cost.resize(n * m);
+    double r = settings.measurementStd * settings.measurementStd;
+    for (size_t i = 0; i < n; ++i) {
+        double s00 = m_p[0][i] + r;
+        double s01 = m_p[1][i];
+        double s11 = m_p[4][i] + r;
+        double inv = 1.0 / (s00 * s11 - s01 * s01);
+        double* row = &m_cost[i * m];
+        Simd::mahalanobis2(m_x[i], m_y[i], s11 * inv, -s01 * inv, s00 * inv, m_det.x.data(), m_det.y.data(), m, row);
+        for (size_t j = 0; j < m; ++j) {
+            if (!(row[j] <= settings.gate)) {
+                row[j] = INF;
+            }
+        }
+    }
+}
+
+// Minimum cost assignment per cluster of tracks and detections connected through the gate
+void ObjectTracker::assignHungarian() {
+    size_t tracks = count();
+    size_t dets = m_det.x.size();
+    m_trackCluster.assign(tracks, 0);
+    m_detCluster.assign(dets, 0);
+    for (size_t seed = 0; seed < tracks; ++seed) {
+        if (m_trackCluster[seed]) {
+            continue;
+        }
+        // Breadth-first over the gate graph; nodes are tracks (< tracks) and detections (tracks + j)
+        m_clusterTracks.clear();
+        m_clusterDets.clear();
+        m_trackCluster[seed] = 1;
+        m_clusterTracks.push_back((uint32_t)seed);
+        size_t nextTrack = 0;
+        size_t nextDet = 0;
+        while (nextTrack < m_clusterTracks.size() || nextDet < m_clusterDets.size()) {
+            if (nextTrack < m_clusterTracks.size()) {
+                const double* row = &m_cost[(size_t)m_clusterTracks[nextTrack++] * dets];
+                for (size_t j = 0; j < dets; ++j) {
+                    if (row[j] != INF && !m_detCluster[j]) {
+                        m_detCluster[j] = 1;
+                        m_clusterDets.push_back((uint32_t)j);
+                    }
+                }
+            } else {
+                size_t j = m_clusterDets[nextDet++];
+                for (size_t i = 0; i < tracks; ++i) {
+                    if (m_cost[i * dets + j] != INF && !m_trackCluster[i]) {
+                        m_trackCluster[i] = 1;
+                        m_clusterTracks.push_back((uint32_t)i);
+                    }
+                }
+            }
+        }
+        if (m_clusterDets.size() == 1 && m_clusterTracks.size() == 1) {
+            m_trackOf[m_clusterDets[0]] = (int32_t)seed;
+        } else if (!m_clusterDets.empty()) {
+            solveCluster();
+        }
+    }
+}
+
+// Hungarian method (shortest augmenting paths with potentials, O(n^2 m)) on the cluster.
+// Rows are the smaller side; pairs outside the gate cost NO_MATCH and are dropped.
+void ObjectTracker::solveCluster() {
+    size_t dets = m_det.x.size();
+    bool transposed = m_clusterTracks.size() > m_clusterDets.size();
+    const std::vector<uint32_t>& rows = transposed ? m_clusterDets : m_clusterTracks;
+    const std::vector<uint32_t>& cols = transposed ? m_clusterTracks : m_clusterDets;
+    size_t n = rows.size();
+    size_t m = cols.size();
+    m_sub.resize(n * m);
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t c = 0; c < m; ++c) {
+            double cost = transposed ? m_cost[(size_t)cols[c] * dets + rows[r]] : m_cost[(size_t)rows[r] * dets + cols[c]];
+            m_sub[r * m + c] = cost == INF ? NO_MATCH : cost;
+        }
+    }
+
+    // 1-based as in the textbook formulation; column 0 is the virtual start
+    m_u.assign(n + 1, 0.0);
+    m_v.assign(m + 1, 0.0);
+    m_match.assign(m + 1, 0);
+    m_way.assign(m + 1, 0);
+    for (size_t i = 1; i <= n; ++i) {
+        m_match[0] = (int32_t)i;
+        size_t j0 = 0;
+        m_minv.assign(m + 1, INF);
+        m_used.assign(m + 1, 0);
+        do {
+            m_used[j0] = 1;
+            size_t i0 = (size_t)m_match[j0];
+            const double* row = &m_sub[(i0 - 1) * m];
+            double delta = INF;
+            size_t j1 = 0;
+            for (size_t j = 1; j <= m; ++j) {
+                if (m_used[j]) {
+                    continue;
+                }
+                double current = row[j - 1] - m_u[i0] - m_v[j];
+                if (current < m_minv[j]) {
+                    m_minv[j] = current;
+                    m_way[j] = (int32_t)j0;
+                }
+                if (m_minv[j] < delta) {
+                    delta = m_minv[j];
+                    j1 = j;
+                }
+            }
+            for (size_t j = 0; j <= m; ++j) {
+                if (m_used[j]) {
+                    m_u[(size_t)m_match[j]] += delta;
+                    m_v[j] -= delta;
+                } else {
+                    m_minv[j] -= delta;
+                }
+            }
+            j0 = j1;
+        } while (m_match[j0] != 0);
+        do {
+            size_t j1 = (size_t)m_way[j0];
+            m_match[j0] = m_match[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    for (size_t j = 1; j <= m; ++j) {
+        if (m_match[j] == 0 || m_sub[(size_t)(m_match[j] - 1) * m + (j - 1)] >= NO_MATCH) {
+            continue;
+        }
+        size_t row = (size_t)m_match[j] - 1;
+        size_t track = transposed ? cols[j - 1] : rows[row];
+        size_t det = transposed ? rows[row] : cols[j - 1];
+        m_trackOf[det] = (int32_t)track;
+    }
+}
+
+// Closest pairs first; each track and detection is used once
+void ObjectTracker::assignGreedy() {
+    size_t dets = m_det.x.size();
+    m_pairs.clear();
+    for (size_t k = 0; k < m_cost.size(); ++k) {
+        if (m_cost[k] != INF) {
+            m_pairs.emplace_back(m_cost[k], (uint32_t)k);
+        }
+    }
+    std::sort(m_pairs.begin(), m_pairs.end());
+    m_used.assign(count(), 0);
+    for (const auto& pair : m_pairs) {
+        size_t track = pair.second / dets;
+        size_t det = pair.second % dets;
+        if (!m_used[track] && m_trackOf[det] < 0) {
+            m_used[track] = 1;
+            m_trackOf[det] = (int32_t)track;
+        }
+    }
+}
+
+void ObjectTracker::createTrack(size_t j) {
+    double r = settings.measurementStd * settings.measurementStd;
+    double v = settings.velocityStd * settings.velocityStd;
+    bool hasVelocity = m_det.hasVelocity[j] != 0;
+    m_id.push_back(m_nextId++);
+    m_x.push_back(m_det.x[j]);
+    m_y.push_back(m_det.y[j]);
+    m_vx.push_back(hasVelocity ? m_det.vx[j] : 0.0);
+    m_vy.push_back(hasVelocity ? m_det.vy[j] : 0.0);
+    const double p[Simd::KALMAN_COVARIANCE_SIZE] = { r, 0.0, 0.0, 0.0, r, 0.0, 0.0, v, 0.0, v };
+    for (size_t k = 0; k < Simd::KALMAN_COVARIANCE_SIZE; ++k) {
+        m_p[k].push_back(p[k]);
+    }
+    m_yaw.push_back(m_det.yaw[j]);
+    m_length.push_back(m_det.length[j]);
+    m_width.push_back(m_det.width[j]);
+    m_existence.push_back(m_det.existence[j]);
+    m_sensorId.push_back(m_det.sensorId[j]);
+    m_age.push_back(0);
+    m_hits.push_back(1);
+    m_misses.push_back(0);
+    m_confirmed.push_back(settings.confirmHits <= 1 ? 1 : 0);
+    m_detection.push_back((int32_t)j);
+}
+
+void ObjectTracker::removeTracks() {
+    compact(m_id, m_remove);
+    compact(m_x, m_remove);
+    compact(m_y, m_remove);
+    compact(m_vx, m_remove);
+    compact(m_vy, m_remove);
+    for (std::vector<double>& p : m_p) {
+        compact(p, m_remove);
+    }
+    compact(m_yaw, m_remove);
+    compact(m_length, m_remove);
+    compact(m_width, m_remove);
+    compact(m_existence, m_remove);
+    compact(m_sensorId, m_remove);
+    compact(m_age, m_remove);
+    compact(m_hits, m_remove);
+    compact(m_misses, m_remove);
+    compact(m_confirmed, m_remove);
+    compact(m_detection, m_remove);
+}
+
+bool ObjectTracker::update(const char* sensorData, size_t size, double fallbackTime, std::string& error) {
+    auto start = std::chrono::steady_clock::now();
+    if (!parse(sensorData, size, fallbackTime, error)) {
+        return false;
+    }
+    m_stats = TrackerStats();
+    size_t n = count();
+    size_t m = m_det.x.size();
+    m_stats.detections = m;
+
+    // 1. Predict all tracks to the time of the message (no step back in time)
+    double dt = m_hasTime ? m_stepTime - m_time : 0.0;
+    if (dt > 0.0 && n > 0) {
+        Simd::kalmanPredict(arrays(), n, dt, settings.accelerationStd * settings.accelerationStd);
+    }
+    if (!m_hasTime || dt > 0.0) {
+        m_time = m_stepTime;
+        m_hasTime = true;
+    }
+
+    // 2. Gate and assign
+    m_trackOf.assign(m, -1);
+    if (n > 0 && m > 0) {
+        gate();
+        if (settings.greedy) {
+            assignGreedy();
+        } else {
+            assignHungarian();
+        }
+    }
+
+    // 3. Batched update of the associated tracks
+    m_zx.assign(n, 0.0);
+    m_zy.assign(n, 0.0);
+    m_has.assign(n, 0);
+    std::fill(m_detection.begin(), m_detection.end(), -1);
+    for (size_t j = 0; j < m; ++j) {
+        int32_t i = m_trackOf[j];
+        if (i < 0) {
+            continue;
+        }
+        m_zx[(size_t)i] = m_det.x[j];
+        m_zy[(size_t)i] = m_det.y[j];
+        m_has[(size_t)i] = 1;
+        m_detection[(size_t)i] = (int32_t)j;
+        m_yaw[(size_t)i] = m_det.yaw[j];
+        m_length[(size_t)i] = m_det.length[j];
+        m_width[(size_t)i] = m_det.width[j];
+        m_existence[(size_t)i] = m_det.existence[j];
+        m_sensorId[(size_t)i] = m_det.sensorId[j];
+        ++m_stats.assigned;
+    }
+    if (m_stats.assigned > 0) {
+        Simd::kalmanUpdate(arrays(), n, m_zx.data(), m_zy.data(), m_has.data(),
+                           settings.measurementStd * settings.measurementStd);
+    }
+
+    // 4. Track management: confirm, count misses, delete
+    m_remove.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ++m_age[i];
+        if (m_has[i]) {
+            ++m_hits[i];
+            m_misses[i] = 0;
+            if (m_hits[i] >= settings.confirmHits) {
+                m_confirmed[i] = 1;
+            }
+        } else {
+            ++m_misses[i];
+            if (!m_confirmed[i] || m_misses[i] > settings.maxMisses) {
+                m_remove[i] = 1;
+                ++m_stats.deleted;
+            }
+        }
+    }
+    if (m_stats.deleted > 0) {
+        removeTracks();
+    }
+
+    // 5. New tentative tracks for the remaining detections
+    for (size_t j = 0; j < m; ++j) {
+        if (m_trackOf[j] < 0) {
+            createTrack(j);
+            ++m_stats.created;
+        }
+    }
+    m_stats.updateTimeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void ObjectTracker::reset() {
+    m_id.clear();
+    m_x.clear();
+    m_y.clear();
+    m_vx.clear();
+    m_vy.clear();
+    for (std::vector<double>& p : m_p) {
+        p.clear();
+    }
+    m_yaw.clear();
+    m_length.clear();
+    m_width.clear();
+    m_existence.clear();
+    m_sensorId.clear();
+    m_age.clear();
+    m_hits.clear();
+    m_misses.clear();
+    m_confirmed.clear();
+    m_detection.clear();
+    m_nextId = 1;
+    m_time = 0.0;
+    m_hasTime = false;
+    m_global = false;
+    m_stats = TrackerStats();
+}
@@ -0,0 +1,407 @@
+#include "OccupancyGrid.h"
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+using OsiWire::Field;
+using OsiWire::WireType;
+
+constexpr uint32_t LANE_TYPE_DRIVING = 2;
+constexpr uint32_t LANE_TYPE_INTERSECTION = 4;
+constexpr size_t MAX_CELLS = 4096;     // Per side
+constexpr double LINE_SAMPLING = 0.5;  // Polyline samples per cell
+
+const size_t STATIC_CHANNELS[] = { OCCUPANCY_STATIONARY, OCCUPANCY_LANE_BOUNDARY, OCCUPANCY_DRIVABLE };
+const size_t OBJECT_CHANNELS[] = { OCCUPANCY_MOVING, OCCUPANCY_VELOCITY_X, OCCUPANCY_VELOCITY_Y };
+
+// Corners of an oriented rectangle (counter-clockwise)
+void rectangle(double x, double y, double yaw, double length, double width, double cx[4], double cy[4]) {
+    double c = std::cos(yaw);
+    double s = std::sin(yaw);
+    double hl = 0.5 * length;
+    double hw = 0.5 * width;
+    const double sl[4] = { hl, -hl, -hl, hl };
+    const double sw[4] = { hw, hw, -hw, -hw };
+    for (int k = 0; k < 4; ++k) {
+        cx[k] = x + sl[k] * c - sw[k] * s;
+        cy[k] = y + sl[k] * s + sw[k] * c;
+    }
+}
+
+struct ParsedLane {
+    std::vector<uint64_t> left, right;
+};
+
+} // namespace
+
+const char* occupancyChannelName(size_t channel) {
+    switch (channel) {
+        case OCCUPANCY_MOVING: return "moving";
+        case OCCUPANCY_VELOCITY_X: return "velocity_x";
+        case OCCUPANCY_VELOCITY_Y: return "velocity_y";
+        case OCCUPANCY_STATIONARY: return "stationary";
+        case OCCUPANCY_LANE_BOUNDARY: return "lane_boundary";
+        case OCCUPANCY_DRIVABLE: return "drivable";
+        default: return "";
+    }
+}
+
+void OccupancyGrid::Shapes::clear() {
+    x.clear();
+    y.clear();
+    start.assign(1, 0);
+    minX.clear();
+    minY.clear();
+    maxX.clear();
+    maxY.clear();
+}
+
+void OccupancyGrid::Shapes::add(const double* px, const double* py, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    x.insert(x.end(), px, px + count);
+    y.insert(y.end(), py, py + count);
+    start.push_back(x.size());
+    minX.push_back(*std::min_element(px, px + count));
+    maxX.push_back(*std::max_element(px, px + count));
+    minY.push_back(*std::min_element(py, py + count));
+    maxY.push_back(*std::max_element(py, py + count));
+}
+
+OccupancyGrid::OccupancyGrid(double resolution, double size)
+    : m_resolution(resolution > 0.0 ? resolution : 0.2)
+{
+    double cells = std::ceil((size > 0.0 ? size : 80.0) / m_resolution);
+    m_cells = (size_t)std::min((double)MAX_CELLS, std::max(1.0, cells));
+    m_data.assign(OCCUPANCY_CHANNELS * m_cells * m_cells, 0.0f);
+    m_stationary.clear();
+    m_boundaries.clear();
+    m_drivable.clear();
+}
+
+void OccupancyGrid::setMap(unsigned long long version, const std::string& groundTruth) {
+    using namespace OsiFields;
+    m_mapVersion = version;
+    m_mapChanged = true;
+    m_stationary.clear();
+    m_boundaries.clear();
+    m_drivable.clear();
+
+    std::unordered_map<uint64_t, size_t> boundaryIndex;
+    std::vector<ParsedLane> lanes;
+    std::vector<double> px, py;
+    OsiWire::Reader reader(groundTruth.data(), groundTruth.size());
+    Field field;
+    while (reader.next(field)) {
+        if (field.type != WireType::LengthDelimited) {
+            continue;
+        }
+        OsiWire::Reader element(field.data, field.size);
+        Field f;
+        if (field.number == GroundTruth::StationaryObject) {
+            double dimension[3] = {}, position[3] = {}, orientation[3] = {};
+            bool hasPosition = false;
+            while (element.next(f)) {
+                if (f.number != StationaryObject::Base || f.type != WireType::LengthDelimited) {
+                    continue;
+                }
+                OsiWire::Reader base(f.data, f.size);
+                Field b;
+                while (base.next(b)) {
+                    switch (b.number) {
+                        case BaseMoving::Dimension: OsiWire::readVector3d(b, dimension); break;
+                        case BaseMoving::Position:
+                            hasPosition = OsiWire::readVector3d(b, position) && std::isfinite(position[0]) && std::isfinite(position[1]);
+                            break;
+                        case BaseMoving::Orientation: OsiWire::readVector3d(b, orientation); break;
+                        default: break;
+                    }
+                }
+            }
+            if (hasPosition) {
+                double cx[4], cy[4];
+                rectangle(position[0], position[1], orientation[2], dimension[0], dimension[1], cx, cy);
+                m_stationary.add(cx, cy, 4);
+            }
+        } else if (field.number == GroundTruth::LaneBoundary) {
+            uint64_t id = 0;
+            px.clear();
+            py.clear();
+            while (element.next(f)) {
+                if (f.number == LaneBoundary::Id) {
+                    OsiWire::readIdentifier(f, id);
+                } else if (f.number == LaneBoundary::BoundaryLine && f.type == WireType::LengthDelimited) {
+                    OsiWire::Reader point(f.data, f.size);
+                    Field p;
+                    while (point.next(p)) {
+                        double v[3];
+                        if (p.number == BoundaryPoint::Position && OsiWire::readVector3d(p, v) &&
+                            std::isfinite(v[0]) && std::isfinite(v[1])) {
+                            px.push_back(v[0]);
+                            py.push_back(v[1]);
+                        }
+                    }
+                }
+            }
+            if (!px.empty()) {
+                boundaryIndex.emplace(id, m_boundaries.minX.size());
+                m_boundaries.add(px.data(), py.data(), px.size());
+            }
+        } else if (field.number == GroundTruth::Lane) {
+            ParsedLane lane;
+            uint32_t type = 0;
+            uint64_t boundaryId = 0;
+            while (element.next(f)) {
+                if (f.number != Lane::Classification || f.type != WireType::LengthDelimited) {
+                    continue;
+                }
+                OsiWire::Reader classification(f.data, f.size);
+                Field c;
+                while (classification.next(c)) {
+                    if (c.number == LaneClassification::Type && c.type == WireType::Varint) {
+                        type = (uint32_t)c.varint;
+                    } else if (c.number == LaneClassification::LeftLaneBoundaryId) {
+                        OsiWire::readIdentifier(c, boundaryId);
+                        lane.left.push_back(boundaryId);
+                    } else if (c.number == LaneClassification::RightLaneBoundaryId) {
+                        OsiWire::readIdentifier(c, boundaryId);
+                        lane.right.push_back(boundaryId);
+                    }
+                }
+            }
+            if ((type == LANE_TYPE_DRIVING || type == LANE_TYPE_INTERSECTION) && !lane.left.empty() && !lane.right.empty()) {
+                lanes.push_back(std::move(lane));
+            }
+        }
+    }
+
+    // Drivable area: left boundaries, then the right ones back to the start
+    std::vector<double> rx, ry;
+    for (const ParsedLane& lane : lanes) {
+        px.clear();
+        py.clear();
+        rx.clear();
+        ry.clear();
+        auto append = [&](const std::vector<uint64_t>& ids, std::vector<double>& xs, std::vector<double>& ys) {
+            for (uint64_t id : ids) {
+                auto found = boundaryIndex.find(id);
+                if (found != boundaryIndex.end()) {
+                    size_t b = found->second;
+                    size_t begin = m_boundaries.start[b];
+                    size_t end = m_boundaries.start[b + 1];
+                    xs.insert(xs.end(), m_boundaries.x.begin() + begin, m_boundaries.x.begin() + end);
+                    ys.insert(ys.end(), m_boundaries.y.begin() + begin, m_boundaries.y.begin() + end);
+                }
+            }
+        };
+        append(lane.left, px, py);
+        append(lane.right, rx, ry);
+        if (px.empty() || rx.empty()) {
+            continue;
+        }
+        // Boundaries may be defined in either direction
+        double toFirst = std::hypot(rx.front() - px.front(), ry.front() - py.front());
+        double toLast = std::hypot(rx.back() - px.front(), ry.back() - py.front());
+        if (toFirst < toLast) {
+            std::reverse(rx.begin(), rx.end());
+            std::reverse(ry.begin(), ry.end());
+        }
+        px.insert(px.end(), rx.begin(), rx.end());
+        py.insert(py.end(), ry.begin(), ry.end());
+        m_drivable.add(px.data(), py.data(), px.size());
+    }
+}
+
+bool OccupancyGrid::overlaps(const Shapes& shapes, size_t i, const Clip& clip) const {
+    double x0 = (double)(m_originColumn + clip.c0) * m_resolution;
+    double x1 = (double)(m_originColumn + clip.c1) * m_resolution;
+    double y0 = (double)(m_originRow + clip.r0) * m_resolution;
+    double y1 = (double)(m_originRow + clip.r1) * m_resolution;
+    return shapes.maxX[i] >= x0 && shapes.minX[i] <= x1 && shapes.maxY[i] >= y0 && shapes.minY[i] <= y1;
+}
+
+void OccupancyGrid::clearRect(size_t c, const Clip& clip) {
+    float* base = channel(c);
+    for (long long r = clip.r0; r < clip.r1; ++r) {
+        std::fill(base + r * m_cells + clip.c0, base + r * m_cells + clip.c1, 0.0f);
+    }
+}
+
+void OccupancyGrid::fillPolygon(const double* px, const double* py, size_t count, const Clip& clip,
+                                const size_t* channels, const float* values, size_t channelCount) {
+    double minY = *std::min_element(py, py + count);
+    double maxY = *std::max_element(py, py + count);
+    double inv = 1.0 / m_resolution;
+    long long r0 = std::max(clip.r0, (long long)std::ceil(minY * inv - (double)m_originRow - 0.5));
+    long long r1 = std::min(clip.r1, (long long)std::floor(maxY * inv - (double)m_originRow - 0.5) + 1);
+    for (long long r = r0; r < r1; ++r) {
+        double yc = ((double)(m_originRow + r) + 0.5) * m_resolution;
+        m_crossings.clear();
+        for (size_t i = 0, j = count - 1; i < count; j = i++) {
+            if ((py[i] <= yc) != (py[j] <= yc)) {
+                m_crossings.push_back(px[j] + (yc - py[j]) * (px[i] - px[j]) / (py[i] - py[j]));
+            }
+        }
+        std::sort(m_crossings.begin(), m_crossings.end());
+        for (size_t k = 0; k + 1 < m_crossings.size(); k += 2) {
+            long long c0 = std::max(clip.c0, (long long)std::ceil(m_crossings[k] * inv - (double)m_originColumn - 0.5));
+            long long c1 = std::min(clip.c1, (long long)std::floor(m_crossings[k + 1] * inv - (double)m_originColumn - 0.5) + 1);
+            for (size_t ch = 0; ch < channelCount; ++ch) {
+                float* row = channel(channels[ch]) + r * m_cells;
+                for (long long c = c0; c < c1; ++c) {
+                    row[c] = values[ch];
+                }
+            }
+        }
+    }
+}
+
+void OccupancyGrid::drawPolyline(const double* px, const double* py, size_t count, const Clip& clip, size_t c) {
+    float* base = channel(c);
+    double inv = 1.0 / m_resolution;
+    double x0 = (double)(m_originColumn + clip.c0) * m_resolution;
+    double x1 = (double)(m_originColumn + clip.c1) * m_resolution;
+    double y0 = (double)(m_originRow + clip.r0) * m_resolution;
+    double y1 = (double)(m_originRow + clip.r1) * m_resolution;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        if (std::max(px[i], px[i + 1]) < x0 || std::min(px[i], px[i + 1]) > x1 ||
+            std::max(py[i], py[i + 1]) < y0 || std::min(py[i], py[i + 1]) > y1) {
+            continue;
+        }
+        double dx = px[i + 1] - px[i];
+        double dy = py[i + 1] - py[i];
+        size_t samples = (size_t)std::ceil(std::hypot(dx, dy) * inv / LINE_SAMPLING) + 1;
+        for (size_t k = 0; k <= samples; ++k) {
+            double t = (double)k / (double)samples;
+            long long column = (long long)std::floor((px[i] + t * dx) * inv) - m_originColumn;
+            long long row = (long long)std::floor((py[i] + t * dy) * inv) - m_originRow;
+            if (column >= clip.c0 && column < clip.c1 && row >= clip.r0 && row < clip.r1) {
+                base[row * m_cells + column] = 1.0f;
+            }
+        }
+    }
+}
+
+void OccupancyGrid::drawStatic(const Clip& clip) {
+    if (clip.c0 >= clip.c1 || clip.r0 >= clip.r1) {
+        return;
+    }
+    for (size_t c : STATIC_CHANNELS) {
+        clearRect(c, clip);
+    }
+    const size_t drivable = OCCUPANCY_DRIVABLE;
+    const size_t stationary = OCCUPANCY_STATIONARY;
+    const float one = 1.0f;
+    for (size_t i = 0; i < m_drivable.minX.size(); ++i) {
+        if (overlaps(m_drivable, i, clip)) {
+            size_t begin = m_drivable.start[i];
+            fillPolygon(&m_drivable.x[begin], &m_drivable.y[begin], m_drivable.start[i + 1] - begin, clip, &drivable, &one, 1);
+        }
+    }
+    for (size_t i = 0; i < m_boundaries.minX.size(); ++i) {
+        if (overlaps(m_boundaries, i, clip)) {
+            size_t begin = m_boundaries.start[i];
+            drawPolyline(&m_boundaries.x[begin], &m_boundaries.y[begin], m_boundaries.start[i + 1] - begin, clip,
+                         OCCUPANCY_LANE_BOUNDARY);
+        }
+    }
+    for (size_t i = 0; i < m_stationary.minX.size(); ++i) {
+        if (overlaps(m_stationary, i, clip)) {
+            size_t begin = m_stationary.start[i];
+            fillPolygon(&m_stationary.x[begin], &m_stationary.y[begin], 4, clip, &stationary, &one, 1);
+        }
+    }
+}
+
+// Move the static channels by (dc, dr) cells (new origin = old + d) and draw the
+// strips that came into view
+void OccupancyGrid::scroll(long long dc, long long dr) {
+    long long n = (long long)m_cells;
+    long long colBegin = std::max(0LL, -dc);
+    long long colEnd = std::min(n, n - dc);
+    for (size_t c : STATIC_CHANNELS) {
+        float* base = channel(c);
+        for (long long k = 0; k < n; ++k) {
+            long long r = dr >= 0 ? k : n - 1 - k; // Rows in the order that does not overwrite sources
+            long long source = r + dr;
+            if (source < 0 || source >= n) {
+                continue;
+            }
+            std::memmove(base + r * n + colBegin, base + source * n + colBegin + dc,
+                         (size_t)(colEnd - colBegin) * sizeof(float));
+        }
+    }
+    m_originColumn += dc;
+    m_originRow += dr;
+
+    Clip rows = { 0, n, dr >= 0 ? n - dr : 0, dr >= 0 ? n : -dr };
+    Clip columns = { dc >= 0 ? n - dc : 0, dc >= 0 ? n : -dc, dr >= 0 ? 0 : -dr, dr >= 0 ? n - dr : n };
+    drawStatic(rows);
+    drawStatic(columns);
+}
+
+bool OccupancyGrid::update(const MovingObjects& objects) {
+    for (const Clip& clip : m_dirty) {
+        for (size_t c : OBJECT_CHANNELS) {
+            clearRect(c, clip);
+        }
+    }
+    m_dirty.clear();
+    m_hostFound = objects.hostIndex >= 0;
+    if (!m_hostFound) {
+        return false;
+    }
+
+    size_t host = (size_t)objects.hostIndex;
+    long long n = (long long)m_cells;
+    long long column = (long long)std::floor(objects.x[host] / m_resolution) - n / 2;
+    long long row = (long long)std::floor(objects.y[host] / m_resolution) - n / 2;
+    long long dc = column - m_originColumn;
+    long long dr = row - m_originRow;
+    if (!m_placed || m_mapChanged || std::llabs(dc) >= n || std::llabs(dr) >= n) {
+        m_originColumn = column;
+        m_originRow = row;
+        drawStatic({ 0, n, 0, n });
+        m_placed = true;
+        m_mapChanged = false;
+    } else if (dc != 0 || dr != 0) {
+        scroll(dc, dr);
+    }
+
+    Clip all = { 0, n, 0, n };
+    double inv = 1.0 / m_resolution;
+    for (size_t i = 0; i < objects.count; ++i) {
+        if (i == host) {
+            continue;
+        }
+        double cx[4], cy[4];
+        rectangle(objects.x[i], objects.y[i], objects.yaw[i], objects.length[i], objects.width[i], cx, cy);
+        Clip box = {
+            std::max(0LL, (long long)std::floor(*std::min_element(cx, cx + 4) * inv) - m_originColumn),
+            std::min(n, (long long)std::floor(*std::max_element(cx, cx + 4) * inv) - m_originColumn + 1),
+            std::max(0LL, (long long)std::floor(*std::min_element(cy, cy + 4) * inv) - m_originRow),
+            std::min(n, (long long)std::floor(*std::max_element(cy, cy + 4) * inv) - m_originRow + 1)
+        };
+        if (box.c0 >= box.c1 || box.r0 >= box.r1) {
+            continue; // Outside the grid
+        }
+        const float values[3] = { 1.0f, (float)(objects.vx[i] - objects.vx[host]), (float)(objects.vy[i] - objects.vy[host]) };
+        fillPolygon(cx, cy, 4, all, OBJECT_CHANNELS, values, 3);
+        // Objects smaller than a cell still occupy the cell of their centre
+        long long c = (long long)std::floor(objects.x[i] * inv) - m_originColumn;
+        long long r = (long long)std::floor(objects.y[i] * inv) - m_originRow;
+        if (c >= 0 && c < n && r >= 0 && r < n) {
+            for (size_t k = 0; k < 3; ++k) {
+                channel(OBJECT_CHANNELS[k])[r * n + c] = values[k];
+            }
+        }
+        m_dirty.push_back(box);
+    }
+    return true;
+}
@@ -0,0 +1,20 @@
+#include "OsiFingerprint.h"
+#include <cstring>
+
+unsigned long long osiFingerprint(const void* data, size_t size) {
+    // 8 bytes per round with a 64-bit multiply-xorshift mix; reads the input once
+    const unsigned long long K = 0x9E3779B97F4A7C15ULL;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    unsigned long long h = size * K;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long v;
+        std::memcpy(&v, p + i, 8);
+        h = (h ^ (v * K)) * K;
+        h ^= h >> 29;
+    }
+    unsigned long long tail = 0;
+    std::memcpy(&tail, p + i, size - i);
+    h = (h ^ (tail * K)) * K;
+    return h ^ (h >> 32);
+}
@@ -0,0 +1,98 @@
+#include "OsiInputChannel.h"
+#include "OsiFingerprint.h"
+#include <iostream>
+
+OsiInputChannel::OsiInputChannel(const char* key, const char* messageType)
+    : m_key(key), m_messageType(messageType)
+{
+}
+
+void OsiInputChannel::initialize() {
+    if ((OsiDecodeMode)decodeMode != OsiDecodeMode::Native) {
+        return;
+    }
+    auto shared = std::make_unique<SharedOsiMessage>(m_messageType);
+    std::string error;
+    if (!shared->initialize(error)) {
+        std::cerr << "[GT-DriveController] Warning: Native decode of " << m_messageType << " not available ("
+                  << error << "), passing bytes to Python" << std::endl;
+        decodeMode = (fmi2Integer)OsiDecodeMode::Raw;
+        return;
+    }
+    m_shared = std::move(shared);
+    std::cout << "[GT-DriveController] Native OSI decode: " << m_messageType << " parsed in C++ and shared with Python" << std::endl;
+}
+
+bool OsiInputChannel::prepare(const void* data, bool stage) {
+    if (!data) {
+        m_data = nullptr;
+        m_size = 0;
+        m_changed = false;
+        m_lastSize = -1; // Reconnecting counts as a change
+        return false;
+    }
+
+    size_t size = (size_t)pointer.size;
+    unsigned long long fingerprint = osiFingerprint(data, size);
+    m_changed = (long long)size != m_lastSize || fingerprint != m_lastFingerprint;
+    m_lastSize = (long long)size;
+    m_lastFingerprint = fingerprint;
+    if (!m_changed) {
+        return false;
+    }
+
+    if (stage) {
+        m_staging.assign(static_cast<const char*>(data), size);
+        m_data = m_staging.data();
+    } else {
+        m_data = static_cast<const char*>(data);
+    }
+    m_size = size;
+    return true;
+}
+
+bool OsiInputChannel::decode() {
+    if (!m_changed || !m_shared) {
+        return true;
+    }
+    if (!m_shared->parse(m_data, m_size)) {
+        std::cerr << "[GT-DriveController] Warning: Failed to parse " << m_messageType << std::endl;
+        m_changed = false;
+        m_lastSize = -1; // Retry next step
+        return false;
+    }
+    return true;
+}
+
+py::object OsiInputChannel::pythonValue() {
+    if (!m_changed) {
+        return py::none();
+    }
+    switch ((OsiDecodeMode)decodeMode) {
+        case OsiDecodeMode::Native:
+            return m_shared->pythonMessage();
+        case OsiDecodeMode::View:
+            m_view = py::memoryview::from_memory(m_data, (py::ssize_t)m_size, true);
+            return m_view;
+        default:
+            return py::bytes(m_data, m_size);
+    }
+}
+
+void OsiInputChannel::releaseView() {
+    releaseMemoryView(m_view, m_key);
+}
+
+void releaseMemoryView(py::object& view, const char* name) {
+    if (!view) {
+        return;
+    }
+    try {
+        view.attr("release")();
+    }
+    catch (py::error_already_set&) {
+        // Still exported (e.g. numpy.frombuffer kept by the controller)
+        std::cerr << "[GT-DriveController] Warning: " << name << " memoryview still in use after update_control" << std::endl;
+    }
+    view = py::object();
+}
@@ -0,0 +1,211 @@
+#include "OsiPatch.h"
+#include <algorithm>
+
+namespace OsiPatch {
+
+namespace {
+
+bool isTerminal(const Edit& edit, size_t depth) {
+    return edit.path.size() == depth + 1;
+}
+
+// True if edit addresses this occurrence of a field (or a message below it).
+// Appends do not address existing elements.
+bool targets(const Edit& edit, size_t depth, uint32_t number, int occurrence) {
+    const PathElement& element = edit.path[depth];
+    if (element.field != number || (edit.op == Op::Append && isTerminal(edit, depth))) {
+        return false;
+    }
+    return element.index < 0 || element.index == occurrence;
+}
+
+void writeValue(std::string& out, uint32_t number, const Edit& edit) {
+    switch (edit.type) {
+        case OsiWire::WireType::Varint:
+            OsiWire::writeVarintField(out, number, edit.scalar);
+            break;
+        case OsiWire::WireType::Fixed64:
+            OsiWire::writeFixed64Field(out, number, edit.scalar);
+            break;
+        case OsiWire::WireType::Fixed32:
+            OsiWire::writeFixed32Field(out, number, (uint32_t)edit.scalar);
+            break;
+        case OsiWire::WireType::LengthDelimited:
+            OsiWire::writeLengthDelimited(out, number, edit.bytes.data(), edit.bytes.size());
+            break;
+        default:
+            break;
+    }
+}
+
+int nextOccurrence(std::vector<std::pair<uint32_t, int>>& occurrences, uint32_t number) {
+    for (auto& entry : occurrences) {
+        if (entry.first == number) {
+            return ++entry.second;
+        }
+    }
+    occurrences.emplace_back(number, 0);
+    return 0;
+}
+
+} // namespace
+
+// Rewrite one message. All edits have matched the path up to depth.
+bool Patcher::patchMessage(const char* data, size_t size, const std::vector<const Edit*>& edits,
+                           size_t depth, std::string& out, std::string& error) {
+    Level& level = m_levels[depth];
+    std::vector<char>& handled = level.handled;
+    std::vector<std::pair<uint32_t, int>>& occurrences = level.occurrences;
+    std::vector<const Edit*>& nested = level.nested;
+    handled.assign(edits.size(), 0);
+    occurrences.clear();
+
+    OsiWire::Reader reader(data, size);
+    OsiWire::Field field;
+    const char* run = data; // Start of the pending range of unmodified fields
+
+    while (reader.next(field)) {
+        bool referenced = false;
+        for (const Edit* edit : edits) {
+            if (edit->path[depth].field == field.number) {
+                referenced = true;
+                break;
+            }
+        }
+        if (!referenced) {
+            continue;
+        }
+
+        int occurrence = nextOccurrence(occurrences, field.number);
+        const Edit* set = nullptr;
+        bool remove = false;
+        nested.clear();
+        for (size_t i = 0; i < edits.size(); ++i) {
+            const Edit* edit = edits[i];
+            if (!targets(*edit, depth, field.number, occurrence)) {
+                continue;
+            }
+            handled[i] = 1;
+            if (!isTerminal(*edit, depth)) {
+                nested.push_back(edit);
+            } else if (edit->op == Op::Set) {
+                set = edit; // Later edits win
+            } else {
+                remove = true;
+            }
+        }
+        if (!set && !remove && nested.empty()) {
+            continue;
+        }
+
+        out.append(run, field.begin - run);
+        run = field.end;
+
+        if (set) {
+            // Singular field: write the value once and drop repeated occurrences
+            if (set->path[depth].index >= 0 || occurrence == 0) {
+                writeValue(out, field.number, *set);
+            }
+            continue;
+        }
+        if (remove) {
+            continue;
+        }
+
+        if (field.type != OsiWire::WireType::LengthDelimited) {
+            error = "field " + std::to_string(field.number) + " is not a message";
+            return false;
+        }
+        std::string& sub = level.sub;
+        sub.clear();
+        if (!patchMessage(field.data, field.size, nested, depth + 1, sub, error)) {
+            return false;
+        }
+        OsiWire::writeLengthDelimited(out, field.number, sub.data(), sub.size());
+    }
+
+    if (!reader.ok()) {
+        error = "malformed message at depth " + std::to_string(depth);
+        return false;
+    }
+    if (size > 0) {
+        out.append(run, (data + size) - run);
+    }
+
+    // Edits without an existing field: add them at the end of this message.
+    // Parsers concatenate repeated fields in wire order, so appended elements come last.
+    for (size_t i = 0; i < edits.size(); ++i) {
+        if (handled[i]) {
+            continue;
+        }
+        const Edit* edit = edits[i];
+        const PathElement& element = edit->path[depth];
+
+        if (isTerminal(*edit, depth)) {
+            if (edit->op == Op::Remove) {
+                continue;
+            }
+            if (edit->op == Op::Set && element.index >= 0) {
+                error = "field " + std::to_string(element.field) + "[" + std::to_string(element.index) + "] not found";
+                return false;
+            }
+            writeValue(out, element.field, *edit);
+            continue;
+        }
+
+        if (element.index >= 0) {
+            error = "field " + std::to_string(element.field) + "[" + std::to_string(element.index) + "] not found";
+            return false;
+        }
+
+        // Missing singular sub-message: create it from all pending edits below it
+        nested.clear();
+        for (size_t j = i; j < edits.size(); ++j) {
+            const Edit* other = edits[j];
+            if (!handled[j] && !isTerminal(*other, depth) &&
+                other->path[depth].field == element.field && other->path[depth].index < 0) {
+                nested.push_back(other);
+                handled[j] = 1;
+            }
+        }
+        std::string& sub = level.sub;
+        sub.clear();
+        if (!patchMessage(nullptr, 0, nested, depth + 1, sub, error)) {
+            return false;
+        }
+        OsiWire::writeLengthDelimited(out, element.field, sub.data(), sub.size());
+    }
+    return true;
+}
+
+bool Patcher::apply(const char* input, size_t size, const std::vector<Edit>& edits,
+                    std::string& out, std::string& error) {
+    out.clear();
+    if (edits.empty()) {
+        out.assign(input, size);
+        return true;
+    }
+
+    m_topLevel.clear();
+    size_t maxDepth = 0;
+    for (const Edit& edit : edits) {
+        if (edit.path.empty()) {
+            error = "empty edit path";
+            return false;
+        }
+        maxDepth = std::max(maxDepth, edit.path.size());
+        m_topLevel.push_back(&edit);
+    }
+    if (m_levels.size() < maxDepth) {
+        m_levels.resize(maxDepth);
+    }
+    return patchMessage(input, size, m_topLevel, 0, out, error);
+}
+
+bool apply(const char* input, size_t size, const std::vector<Edit>& edits,
+           std::string& out, std::string& error) {
+    Patcher patcher;
+    return patcher.apply(input, size, edits, out, error);
+}
+
+} // namespace OsiPatch
@@ -0,0 +1,196 @@
+#include "OsiWire.h"
+#include "OsiFields.h"
+#include <cstring>
+
+namespace OsiWire {
+
+namespace {
+
+// Tag byte of a double field 1..15
+constexpr char doubleTag(uint32_t number) {
+    return (char)((number << 3) | (uint32_t)WireType::Fixed64);
+}
+
+} // namespace
+
+bool readVarint(const char*& pos, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        uint8_t byte = (uint8_t)*pos++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Reader::Reader(const char* data, size_t size)
+    : m_pos(data), m_end(data + size)
+{
+}
+
+bool Reader::next(Field& field) {
+    if (!m_ok || m_pos >= m_end) {
+        return false;
+    }
+
+    field.begin = m_pos;
+    uint64_t tag = 0;
+    if (!readVarint(m_pos, m_end, tag) || (tag >> 3) == 0) {
+        m_ok = false;
+        return false;
+    }
+    field.number = (uint32_t)(tag >> 3);
+    field.type = (WireType)(tag & 0x7);
+    field.data = nullptr;
+    field.size = 0;
+
+    switch (field.type) {
+        case WireType::Varint:
+            if (!readVarint(m_pos, m_end, field.varint)) {
+                m_ok = false;
+            }
+            break;
+        case WireType::Fixed64:
+            if (m_end - m_pos < 8) {
+                m_ok = false;
+                break;
+            }
+            std::memcpy(&field.varint, m_pos, 8); // Wire format is little-endian, like all targets
+            m_pos += 8;
+            break;
+        case WireType::Fixed32: {
+            if (m_end - m_pos < 4) {
+                m_ok = false;
+                break;
+            }
+            uint32_t value = 0;
+            std::memcpy(&value, m_pos, 4);
+            field.varint = value;
+            m_pos += 4;
+            break;
+        }
+        case WireType::LengthDelimited: {
+            uint64_t length = 0;
+            if (!readVarint(m_pos, m_end, length) || length > (uint64_t)(m_end - m_pos)) {
+                m_ok = false;
+                break;
+            }
+            field.data = m_pos;
+            field.size = (size_t)length;
+            m_pos += length;
+            break;
+        }
+        default:
+            m_ok = false;
+            break;
+    }
+
+    field.end = m_pos;
+    return m_ok;
+}
+
+size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void writeVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back((char)value);
+}
+
+void writeTag(std::string& out, uint32_t number, WireType type) {
+    writeVarint(out, ((uint64_t)number << 3) | (uint64_t)type);
+}
+
+void writeVarintField(std::string& out, uint32_t number, uint64_t value) {
+    writeTag(out, number, WireType::Varint);
+    writeVarint(out, value);
+}
+
+void writeFixed64Field(std::string& out, uint32_t number, uint64_t value) {
+    writeTag(out, number, WireType::Fixed64);
+    out.append(reinterpret_cast<const char*>(&value), 8);
+}
+
+void writeFixed32Field(std::string& out, uint32_t number, uint32_t value) {
+    writeTag(out, number, WireType::Fixed32);
+    out.append(reinterpret_cast<const char*>(&value), 4);
+}
+
+void writeDoubleField(std::string& out, uint32_t number, double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, 8);
+    writeFixed64Field(out, number, bits);
+}
+
+void writeLengthDelimited(std::string& out, uint32_t number, const char* data, size_t size) {
+    writeTag(out, number, WireType::LengthDelimited);
+    writeVarint(out, size);
+    out.append(data, size);
+}
+
+double readDouble(const Field& field) {
+    double value = 0.0;
+    if (field.type == WireType::Fixed64) {
+        std::memcpy(&value, &field.varint, 8);
+    }
+    return value;
+}
+
+bool readIdentifier(const Field& field, uint64_t& value) {
+    value = 0;
+    if (field.type != WireType::LengthDelimited) {
+        return false;
+    }
+    Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.number == OsiFields::Identifier::Value && f.type == WireType::Varint) {
+            value = f.varint;
+        }
+    }
+    if (!reader.ok()) {
+        value = 0;
+        return false;
+    }
+    return true;
+}
+
+bool readVector3d(const Field& field, double v[3]) {
+    v[0] = v[1] = v[2] = 0.0;
+    if (field.type != WireType::LengthDelimited) {
+        return false;
+    }
+    // Fast path for the usual encoding: all three fields in order
+    if (field.size == 27 && field.data[0] == doubleTag(OsiFields::Vector3d::X) &&
+        field.data[9] == doubleTag(OsiFields::Vector3d::Y) && field.data[18] == doubleTag(OsiFields::Vector3d::Z)) {
+        for (int k = 0; k < 3; ++k) {
+            std::memcpy(&v[k], field.data + 9 * k + 1, 8);
+        }
+        return true;
+    }
+    Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.type == WireType::Fixed64 && f.number >= OsiFields::Vector3d::X && f.number <= OsiFields::Vector3d::Z) {
+            v[f.number - OsiFields::Vector3d::X] = readDouble(f);
+        }
+    }
+    if (!reader.ok()) {
+        v[0] = v[1] = v[2] = 0.0;
+        return false;
+    }
+    return true;
+}
+
+} // namespace OsiWire
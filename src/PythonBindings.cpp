@@ -0,0 +1,763 @@
+// Native engines exposed to the Python controller as the embedded module
+// 'gt_drive_native'. Instances are created by OSMPController and set as
+// attributes of the controller (e.g. self.frenet); batched queries take and
+// return NumPy arrays (float64, lane and object ids uint64).
+#include "PythonEmbed.h"
+#include <pybind11/numpy.h>
+#include <algorithm>
+#include <cmath>
+#include "FrenetEngine.h"
+#include "ObjectIndex.h"
+#include "EgoFrame.h"
+#include "TrajectoryPredictor.h"
+#include "QpSolver.h"
+#include "LinearMpc.h"
+#include "MppiPlanner.h"
+#include "OccupancyGrid.h"
+#include "LidarPreprocessor.h"
+#include "CameraImages.h"
+#include "ObjectTracker.h"
+#include "KpiEngine.h"
+#include "SignalLog.h"
+#include "SimdKernels.h"
+
+namespace {
+
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+using IdArray = py::array_t<uint64_t, py::array::c_style | py::array::forcecast>;
+
+void checkSameSize(const py::array& a, const py::array& b, const char* what) {
+    if (a.size() != b.size()) {
+        throw py::value_error(std::string(what) + ": arrays of different length");
+    }
+}
+
+template <typename T>
+py::array_t<T> toArray(const std::vector<T>& values) {
+    py::array_t<T> array(values.size());
+    std::copy(values.begin(), values.end(), array.mutable_data());
+    return array;
+}
+
+PredictionModel predictionModel(const std::string& name) {
+    if (name == "cv") {
+        return PredictionModel::ConstantVelocity;
+    }
+    if (name == "ca") {
+        return PredictionModel::ConstantAcceleration;
+    }
+    if (name == "ctrv") {
+        return PredictionModel::Ctrv;
+    }
+    throw py::value_error("predict: unknown model '" + name + "' (cv, ca or ctrv)");
+}
+
+py::tuple selectionTuple(const ObjectIndex::Selection& selection) {
+    size_t n = selection.id.size();
+    IdArray id(n);
+    DoubleArray longitudinal(n), lateral(n);
+    std::copy(selection.id.begin(), selection.id.end(), id.mutable_data());
+    std::copy(selection.longitudinal.begin(), selection.longitudinal.end(), longitudinal.mutable_data());
+    std::copy(selection.lateral.begin(), selection.lateral.end(), lateral.mutable_data());
+    return py::make_tuple(id, longitudinal, lateral);
+}
+
+void checkShape(const DoubleArray& a, size_t rows, size_t cols, const char* what) {
+    if (a.ndim() != 2 || (size_t)a.shape(0) != rows || (size_t)a.shape(1) != cols) {
+        throw py::value_error(std::string(what) + ": expected shape (" + std::to_string(rows) + ", " +
+                              std::to_string(cols) + ")");
+    }
+}
+
+// None -> null; otherwise a vector of the given length
+const double* optionalVector(const py::object& value, size_t size, const char* what, DoubleArray& holder) {
+    if (value.is_none()) {
+        return nullptr;
+    }
+    holder = value.cast<DoubleArray>();
+    if ((size_t)holder.size() != size) {
+        throw py::value_error(std::string(what) + ": expected " + std::to_string(size) + " values");
+    }
+    return holder.data();
+}
+
+std::vector<double> toVector(const py::object& value) {
+    if (value.is_none()) {
+        return {};
+    }
+    DoubleArray array = value.cast<DoubleArray>();
+    return std::vector<double>(array.data(), array.data() + array.size());
+}
+
+QpSettings qpSettings(double epsAbs, double epsRel, int maxIterations, double rho, double alpha, bool adaptiveRho) {
+    QpSettings settings;
+    settings.epsAbs = epsAbs;
+    settings.epsRel = epsRel;
+    settings.maxIterations = maxIterations;
+    settings.rho = rho;
+    settings.alpha = alpha;
+    settings.adaptiveRho = adaptiveRho;
+    if (!(epsAbs >= 0.0) || !(epsRel >= 0.0) || maxIterations < 1 || !(rho > 0.0) || !(alpha > 0.0 && alpha < 2.0)) {
+        throw py::value_error("QP settings: need eps >= 0, max_iter >= 1, rho > 0 and 0 < alpha < 2");
+    }
+    return settings;
+}
+
+py::dict infoDict(const QpInfo& info) {
+    py::dict result;
+    result["status"] = qpStatusName(info.status);
+    result["iterations"] = info.iterations;
+    result["factorizations"] = info.factorizations;
+    result["solve_time_us"] = info.solveTimeUs;
+    result["primal_residual"] = info.primalResidual;
+    result["dual_residual"] = info.dualResidual;
+    result["objective"] = info.objective;
+    return result;
+}
+
+// A number for every element, or one array of the given length
+std::vector<double> broadcast(const py::object& value, size_t size, const char* what) {
+    DoubleArray array = value.cast<DoubleArray>();
+    if (array.size() == 1) {
+        return std::vector<double>(size, *array.data());
+    }
+    if ((size_t)array.size() != size) {
+        throw py::value_error(std::string(what) + ": expected a number or " + std::to_string(size) + " values");
+    }
+    return std::vector<double>(array.data(), array.data() + size);
+}
+
+CameraColorOrder cameraColorOrder(const std::string& name) {
+    if (name == "rgb") {
+        return CameraColorOrder::Rgb;
+    }
+    if (name == "bgr") {
+        return CameraColorOrder::Bgr;
+    }
+    if (name == "gray") {
+        return CameraColorOrder::Gray;
+    }
+    throw py::value_error("tensor: unknown order '" + name + "' (rgb, bgr or gray)");
+}
+
+// numpy dtype of the samples of a camera image
+const char* cameraDtype(const CameraFrame& frame) {
+    if (frame.isFloat) {
+        return "<f4";
+    }
+    return frame.sampleBytes == 1 ? "u1" : (frame.sampleBytes == 2 ? "<u2" : "<u4");
+}
+
+const CameraFrame& cameraFrame(const CameraImages& camera, size_t index, const char* what) {
+    if (index >= camera.count()) {
+        throw py::value_error(std::string(what) + ": no camera image " + std::to_string(index) + " (" +
+                              std::to_string(camera.count()) + " in this step; only valid during update_control)");
+    }
+    return camera.frame(index);
+}
+
+// numpy dtype names of the signal log column types
+SignalType signalType(const std::string& name) {
+    if (name == "f8") {
+        return SignalType::Float64;
+    }
+    if (name == "f4") {
+        return SignalType::Float32;
+    }
+    if (name == "i4") {
+        return SignalType::Int32;
+    }
+    if (name == "u1") {
+        return SignalType::UInt8;
+    }
+    throw py::value_error("add: unknown type '" + name + "' (f8, f4, i4 or u1)");
+}
+
+size_t signalColumn(const SignalLog& log, const std::string& name) {
+    int column = log.findColumn(name);
+    if (column < 0) {
+        throw py::value_error("signal log: no signal '" + name + "' (add it first)");
+    }
+    return (size_t)column;
+}
+
+} // namespace
+
+PYBIND11_EMBEDDED_MODULE(gt_drive_native, m) {
+    m.attr("simd") = Simd::name();
+
+    py::class_<FrenetEngine, std::shared_ptr<FrenetEngine>>(m, "FrenetEngine")
+        .def("to_frenet", [](FrenetEngine& engine, DoubleArray x, DoubleArray y) {
+            checkSameSize(x, y, "to_frenet");
+            size_t n = (size_t)x.size();
+            DoubleArray s(n), t(n);
+            IdArray lane(n);
+            engine.toFrenet(x.data(), y.data(), n, s.mutable_data(), t.mutable_data(), lane.mutable_data());
+            return py::make_tuple(s, t, lane);
+        }, py::arg("x"), py::arg("y"),
+           "(x, y) -> (s, t, lane_id) on the nearest lane centerline")
+        .def("to_cartesian", [](FrenetEngine& engine, DoubleArray s, DoubleArray t, IdArray lane) {
+            checkSameSize(s, t, "to_cartesian");
+            checkSameSize(s, lane, "to_cartesian");
+            size_t n = (size_t)s.size();
+            DoubleArray x(n), y(n), heading(n);
+            engine.toCartesian(s.data(), t.data(), lane.data(), n, x.mutable_data(), y.mutable_data(), heading.mutable_data());
+            return py::make_tuple(x, y, heading);
+        }, py::arg("s"), py::arg("t"), py::arg("lane_id"),
+           "(s, t, lane_id) -> (x, y, heading) on the given lane")
+        .def_property_readonly("has_map", &FrenetEngine::hasMap);
+
+    py::class_<ObjectIndex, std::shared_ptr<ObjectIndex>>(m, "ObjectIndex")
+        .def("knn", [](ObjectIndex& index, DoubleArray x, DoubleArray y, size_t k, bool excludeHost) {
+            checkSameSize(x, y, "knn");
+            size_t n = (size_t)x.size();
+            ObjectIndex::Neighbours result;
+            index.nearest(x.data(), y.data(), n, k, excludeHost, result);
+            IdArray id({ n, k });
+            DoubleArray distance({ n, k });
+            std::copy(result.id.begin(), result.id.end(), id.mutable_data());
+            std::copy(result.distance.begin(), result.distance.end(), distance.mutable_data());
+            return py::make_tuple(id, distance);
+        }, py::arg("x"), py::arg("y"), py::arg("k"), py::arg("exclude_host") = true,
+           "(x, y) -> (ids, distances) of the k nearest objects per point, shape (n, k); "
+           "padded with id 0 and distance inf")
+        .def("in_lane", [](ObjectIndex& index, uint64_t laneId, double s, double ahead, double behind, bool excludeHost) {
+            ObjectIndex::Selection selection;
+            index.inLane(laneId, s, ahead, behind, excludeHost, selection);
+            return selectionTuple(selection);
+        }, py::arg("lane_id"), py::arg("s"), py::arg("ahead"), py::arg("behind") = 0.0, py::arg("exclude_host") = true,
+           "-> (ids, ds, t) of the objects on the lane and its successors / predecessors "
+           "within [s - behind, s + ahead], sorted by ds")
+        .def("in_corridor", [](ObjectIndex& index, double x, double y, double heading, double front, double rear,
+                               double halfWidth, bool excludeHost) {
+            ObjectIndex::Selection selection;
+            index.inCorridor(x, y, heading, front, rear, halfWidth, excludeHost, selection);
+            return selectionTuple(selection);
+        }, py::arg("x"), py::arg("y"), py::arg("heading"), py::arg("front"), py::arg("rear"), py::arg("half_width"),
+           py::arg("exclude_host") = true,
+           "-> (ids, lon, lat) of the objects whose footprint overlaps the oriented corridor, sorted by lon")
+        .def_property_readonly("count", &ObjectIndex::count)
+        .def_property_readonly("host_id", &ObjectIndex::hostId);
+
+    // Arrays are copies of the result of the current step
+    py::class_<EgoFrame, std::shared_ptr<EgoFrame>>(m, "EgoFrame")
+        .def_property_readonly("host_found", &EgoFrame::hostFound)
+        .def_property_readonly("host_speed", &EgoFrame::hostSpeed)
+        .def_property_readonly("count", &EgoFrame::count)
+        .def_property_readonly("ids", [](const EgoFrame& f) { return toArray(f.id); })
+        .def_property_readonly("x", [](const EgoFrame& f) { return toArray(f.x); })
+        .def_property_readonly("y", [](const EgoFrame& f) { return toArray(f.y); })
+        .def_property_readonly("vx", [](const EgoFrame& f) { return toArray(f.vx); })
+        .def_property_readonly("vy", [](const EgoFrame& f) { return toArray(f.vy); })
+        .def_property_readonly("distance", [](const EgoFrame& f) { return toArray(f.distance); })
+        .def_property_readonly("ttc", [](const EgoFrame& f) { return toArray(f.ttc); })
+        .def_property_readonly("headway", [](const EgoFrame& f) { return toArray(f.headway); });
+
+    py::class_<TrajectoryPredictor, std::shared_ptr<TrajectoryPredictor>>(m, "TrajectoryPredictor")
+        .def("predict", [](TrajectoryPredictor& predictor, double horizon, double dt, const std::string& model,
+                           bool followLanes, bool excludeHost) {
+            if (!(dt > 0.0) || !(horizon >= dt) || horizon / dt > 10000.0) {
+                throw py::value_error("predict: need 0 < dt <= horizon and at most 10000 steps");
+            }
+            PredictionModel kind = predictionModel(model);
+            size_t steps = (size_t)std::llround(horizon / dt);
+            size_t n = predictor.count(excludeHost);
+            IdArray id(n);
+            DoubleArray states({ n, steps, PREDICTION_STATE_SIZE });
+            predictor.ids(excludeHost, id.mutable_data());
+            predictor.predict(kind, dt, steps, followLanes, excludeHost, states.mutable_data());
+            return py::make_tuple(id, states);
+        }, py::arg("horizon") = 4.0, py::arg("dt") = 0.1, py::arg("model") = "cv", py::arg("follow_lanes") = false,
+           py::arg("exclude_host") = true,
+           "-> (ids, states) with states of shape (objects, steps, 4): x, y, yaw, speed at dt, 2 dt, ... horizon");
+
+    // Solvers constructed by the controller itself, e.g. gt_drive_native.LinearMpc(...) in initialize()
+    py::class_<QpSolver, std::shared_ptr<QpSolver>>(m, "QpSolver")
+        .def(py::init([](double epsAbs, double epsRel, int maxIterations, double rho, double alpha, bool adaptiveRho) {
+            auto solver = std::make_shared<QpSolver>();
+            solver->settings = qpSettings(epsAbs, epsRel, maxIterations, rho, alpha, adaptiveRho);
+            return solver;
+        }), py::arg("eps_abs") = 1e-4, py::arg("eps_rel") = 1e-4, py::arg("max_iter") = 4000, py::arg("rho") = 0.1,
+           py::arg("alpha") = 1.6, py::arg("adaptive_rho") = true)
+        .def("setup", [](QpSolver& solver, DoubleArray P, DoubleArray A) {
+            size_t n = P.ndim() == 2 ? (size_t)P.shape(0) : 0;
+            checkShape(P, n, n, "setup: P");
+            size_t rows = A.ndim() == 2 ? (size_t)A.shape(0) : 0;
+            checkShape(A, rows, n, "setup: A");
+            std::string error;
+            if (!solver.setup(n, rows, P.data(), A.data(), error)) {
+                throw py::value_error("setup: " + error);
+            }
+        }, py::arg("P"), py::arg("A"),
+           "Sizes and matrices of 0.5 x'Px + q'x, lb <= x <= ub, lba <= Ax <= uba (A may have shape (0, n))")
+        .def("update_matrices", [](QpSolver& solver, DoubleArray P, DoubleArray A) {
+            checkShape(P, solver.variables(), solver.variables(), "update_matrices: P");
+            checkShape(A, solver.constraints(), solver.variables(), "update_matrices: A");
+            std::string error;
+            if (!solver.updateMatrices(P.data(), A.data(), error)) {
+                throw py::value_error("update_matrices: " + error);
+            }
+        }, py::arg("P"), py::arg("A"))
+        .def("solve", [](QpSolver& solver, const py::object& q, const py::object& lb, const py::object& ub,
+                         const py::object& lba, const py::object& uba) {
+            if (solver.variables() == 0) {
+                throw py::value_error("solve: QP not set up");
+            }
+            size_t n = solver.variables();
+            size_t rows = solver.constraints();
+            DoubleArray hq, hlb, hub, hlba, huba;
+            const QpInfo& info = solver.solve(optionalVector(q, n, "solve: q", hq), optionalVector(lb, n, "solve: lb", hlb),
+                                              optionalVector(ub, n, "solve: ub", hub),
+                                              optionalVector(lba, rows, "solve: lba", hlba),
+                                              optionalVector(uba, rows, "solve: uba", huba));
+            DoubleArray x(n);
+            std::copy(solver.solution(), solver.solution() + n, x.mutable_data());
+            return py::make_tuple(x, infoDict(info));
+        }, py::arg("q") = py::none(), py::arg("lb") = py::none(), py::arg("ub") = py::none(),
+           py::arg("lba") = py::none(), py::arg("uba") = py::none(),
+           "-> (x, info); warm-started from the previous solution, None: q = 0 / unbounded")
+        .def("reset_warm_start", &QpSolver::resetWarmStart);
+
+    py::class_<LinearMpc, std::shared_ptr<LinearMpc>>(m, "LinearMpc")
+        .def(py::init([](DoubleArray A, DoubleArray B, size_t horizon, DoubleArray Q, DoubleArray R, const py::object& P,
+                         const py::object& uMin, const py::object& uMax, const py::object& duMax,
+                         const py::object& xMin, const py::object& xMax, double epsAbs, double epsRel,
+                         int maxIterations) {
+            size_t nx = A.ndim() == 2 ? (size_t)A.shape(0) : 0;
+            size_t nu = B.ndim() == 2 ? (size_t)B.shape(1) : 0;
+            checkShape(A, nx, nx, "LinearMpc: A");
+            checkShape(B, nx, nu, "LinearMpc: B");
+            checkShape(Q, nx, nx, "LinearMpc: Q");
+            checkShape(R, nu, nu, "LinearMpc: R");
+            LinearMpcProblem problem;
+            problem.nx = nx;
+            problem.nu = nu;
+            problem.horizon = horizon;
+            problem.A = toVector(A);
+            problem.B = toVector(B);
+            problem.Q = toVector(Q);
+            problem.R = toVector(R);
+            problem.P = toVector(P);
+            problem.uMin = toVector(uMin);
+            problem.uMax = toVector(uMax);
+            problem.duMax = toVector(duMax);
+            problem.xMin = toVector(xMin);
+            problem.xMax = toVector(xMax);
+            auto mpc = std::make_shared<LinearMpc>();
+            std::string error;
+            if (!mpc->setup(problem, qpSettings(epsAbs, epsRel, maxIterations, 0.1, 1.6, true), error)) {
+                throw py::value_error("LinearMpc: " + error);
+            }
+            return mpc;
+        }), py::arg("A"), py::arg("B"), py::arg("horizon"), py::arg("Q"), py::arg("R"), py::arg("P") = py::none(),
+           py::arg("u_min") = py::none(), py::arg("u_max") = py::none(), py::arg("du_max") = py::none(),
+           py::arg("x_min") = py::none(), py::arg("x_max") = py::none(), py::arg("eps_abs") = 1e-4,
+           py::arg("eps_rel") = 1e-4, py::arg("max_iter") = 4000)
+        .def("solve", [](LinearMpc& mpc, DoubleArray x0, const py::object& reference, const py::object& uPrev) {
+            size_t nx = mpc.states();
+            size_t nu = mpc.inputs();
+            size_t steps = mpc.horizon();
+            if ((size_t)x0.size() != nx) {
+                throw py::value_error("solve: x0 needs " + std::to_string(nx) + " values");
+            }
+            DoubleArray hr, hu;
+            const QpInfo& info = mpc.solve(x0.data(), optionalVector(reference, steps * nx, "solve: xref", hr),
+                                           optionalVector(uPrev, nu, "solve: u_prev", hu));
+            DoubleArray U({ steps, nu });
+            std::copy(mpc.solution(), mpc.solution() + steps * nu, U.mutable_data());
+            return py::make_tuple(U, infoDict(info));
+        }, py::arg("x0"), py::arg("xref") = py::none(), py::arg("u_prev") = py::none(),
+           "-> (U, info) with U of shape (horizon, nu); xref of shape (horizon, nx) for x[1] .. x[N]")
+        .def_property_readonly("horizon", &LinearMpc::horizon);
+
+    py::class_<MppiSettings>(m, "MppiSettings")
+        .def_readwrite("samples", &MppiSettings::samples)
+        .def_readwrite("steps", &MppiSettings::steps)
+        .def_readwrite("dt", &MppiSettings::dt)
+        .def_readwrite("iterations", &MppiSettings::iterations)
+        .def_readwrite("temperature", &MppiSettings::temperature)
+        .def_readwrite("wheelbase", &MppiSettings::wheelbase)
+        .def_readwrite("acceleration_sigma", &MppiSettings::accelerationSigma)
+        .def_readwrite("steering_sigma", &MppiSettings::steeringSigma)
+        .def_readwrite("acceleration_min", &MppiSettings::accelerationMin)
+        .def_readwrite("acceleration_max", &MppiSettings::accelerationMax)
+        .def_readwrite("steering_max", &MppiSettings::steeringMax)
+        .def_readwrite("seed", &MppiSettings::seed)
+        .def_readwrite("lateral_weight", &MppiSettings::lateralWeight)
+        .def_readwrite("heading_weight", &MppiSettings::headingWeight)
+        .def_readwrite("speed_weight", &MppiSettings::speedWeight)
+        .def_readwrite("acceleration_weight", &MppiSettings::accelerationWeight)
+        .def_readwrite("steering_weight", &MppiSettings::steeringWeight)
+        .def_readwrite("ego_radius", &MppiSettings::egoRadius)
+        .def_readwrite("safety_margin", &MppiSettings::safetyMargin)
+        .def_readwrite("proximity_weight", &MppiSettings::proximityWeight)
+        .def_readwrite("collision_cost", &MppiSettings::collisionCost);
+
+    py::class_<MppiPlanner, std::shared_ptr<MppiPlanner>>(m, "MppiPlanner")
+        .def_readwrite("settings", &MppiPlanner::settings)
+        .def("set_reference", [](MppiPlanner& planner, DoubleArray x, DoubleArray y, const py::object& speed) {
+            checkSameSize(x, y, "set_reference");
+            size_t n = (size_t)x.size();
+            std::vector<double> speeds = broadcast(speed, n, "set_reference: speed");
+            std::string error;
+            if (!planner.setReference(x.data(), y.data(), speeds.data(), n, error)) {
+                throw py::value_error("set_reference: " + error);
+            }
+        }, py::arg("x"), py::arg("y"), py::arg("speed"),
+           "Path (e.g. from frenet.to_cartesian) and reference speed per point or for all")
+        .def("plan", [](MppiPlanner& planner, DoubleArray state, const py::object& obstacles, const py::object& radius) {
+            if (state.size() != (py::ssize_t)MPPI_STATE_SIZE) {
+                throw py::value_error("plan: state is x, y, yaw, speed");
+            }
+            DoubleArray predicted;
+            size_t count = 0;
+            size_t steps = 0;
+            if (!obstacles.is_none()) {
+                predicted = obstacles.cast<DoubleArray>();
+                if (predicted.ndim() != 3 || predicted.shape(2) != (py::ssize_t)MPPI_STATE_SIZE) {
+                    throw py::value_error("plan: obstacles need shape (objects, steps, 4) as from predictor.predict()");
+                }
+                count = (size_t)predicted.shape(0);
+                steps = (size_t)predicted.shape(1);
+            }
+            std::vector<double> radii = broadcast(radius, count, "plan: radius");
+            std::string error;
+            bool ok;
+            {
+                py::gil_scoped_release release; // Rollouts only read the arrays held above
+                ok = planner.plan(state.data(), count ? predicted.data() : nullptr, count, steps, radii.data(), error);
+            }
+            if (!ok) {
+                throw py::value_error("plan: " + error);
+            }
+            size_t n = planner.settings.steps;
+            DoubleArray controls({ n, MPPI_CONTROL_SIZE });
+            DoubleArray trajectory({ n, MPPI_STATE_SIZE });
+            std::copy(planner.controls().begin(), planner.controls().end(), controls.mutable_data());
+            std::copy(planner.trajectory().begin(), planner.trajectory().end(), trajectory.mutable_data());
+            const MppiInfo& info = planner.info();
+            py::dict result;
+            result["solve_time_us"] = info.solveTimeUs;
+            result["min_cost"] = info.minCost;
+            result["effective_samples"] = info.effectiveSamples;
+            result["collision_free"] = info.collisionFree;
+            return py::make_tuple(controls, trajectory, result);
+        }, py::arg("state"), py::arg("obstacles") = py::none(), py::arg("radius") = 1.0,
+           "-> (controls, trajectory, info): controls (steps, 2) acceleration, steering angle; trajectory "
+           "(steps, 4) x, y, yaw, speed along them. obstacles at dt, 2 dt, ... with the planner's dt")
+        .def("reset", &MppiPlanner::reset)
+        .def_property_readonly("threads", &MppiPlanner::threads);
+
+    py::class_<OccupancyGrid, std::shared_ptr<OccupancyGrid>>(m, "OccupancyGrid")
+        .def_property_readonly("grid", [](py::object self) {
+            std::shared_ptr<OccupancyGrid> grid = self.cast<std::shared_ptr<OccupancyGrid>>();
+            py::ssize_t n = (py::ssize_t)grid->cells();
+            py::ssize_t cell = sizeof(float);
+            // View of the grid's own buffer, which lives as long as the grid (kept alive as base)
+            std::vector<py::ssize_t> shape = { (py::ssize_t)OCCUPANCY_CHANNELS, n, n };
+            std::vector<py::ssize_t> strides = { n * n * cell, n * cell, cell };
+            py::array_t<float> view(shape, strides, grid->data(), self);
+            view.attr("setflags")(py::arg("write") = false);
+            return view;
+        }, "Read-only float32 view (channels, rows, columns) without copy, updated in place every step; "
+           "row: +y, column: +x from origin")
+        .def_property_readonly("channels", [](const OccupancyGrid&) {
+            py::tuple names(OCCUPANCY_CHANNELS);
+            for (size_t c = 0; c < OCCUPANCY_CHANNELS; ++c) {
+                names[c] = py::str(occupancyChannelName(c));
+            }
+            return names;
+        })
+        .def_property_readonly("origin", [](const OccupancyGrid& grid) {
+            return py::make_tuple(grid.originX(), grid.originY());
+        }, "Global position of the lower left corner of cell (0, 0)")
+        .def_property_readonly("resolution", &OccupancyGrid::resolution)
+        .def_property_readonly("cells", &OccupancyGrid::cells)
+        .def_property_readonly("host_found", &OccupancyGrid::hostFound)
+        .def_property_readonly("map_version", &OccupancyGrid::mapVersion);
+
+    py::class_<LidarSettings>(m, "LidarSettings")
+        .def_readwrite("voxel_size", &LidarSettings::voxelSize)
+        .def_readwrite("min_range", &LidarSettings::minRange)
+        .def_readwrite("max_range", &LidarSettings::maxRange)
+        .def_readwrite("remove_ground", &LidarSettings::removeGround)
+        .def_readwrite("ground_height", &LidarSettings::groundHeight)
+        .def_readwrite("ground_tolerance", &LidarSettings::groundTolerance);
+
+    py::class_<LidarPreprocessor, std::shared_ptr<LidarPreprocessor>>(m, "LidarPreprocessor")
+        .def_readwrite("settings", &LidarPreprocessor::settings)
+        .def_property_readonly("count", &LidarPreprocessor::count)
+        .def_property_readonly("points", [](const LidarPreprocessor& lidar) {
+            size_t n = lidar.count();
+            py::array_t<float> points({ n, (size_t)3 });
+            float* out = points.mutable_data();
+            for (size_t i = 0; i < n; ++i) {
+                out[3 * i] = lidar.x()[i];
+                out[3 * i + 1] = lidar.y()[i];
+                out[3 * i + 2] = lidar.z()[i];
+            }
+            return points;
+        }, "(count, 3) float32 x, y, z in the vehicle frame (rear axle centre), one point per voxel")
+        .def_property_readonly("intensity", [](const LidarPreprocessor& lidar) { return toArray(lidar.intensity()); },
+                               "Mean signal strength [dB] per point")
+        .def_property_readonly("points_per_voxel", [](const LidarPreprocessor& lidar) { return toArray(lidar.pointsPerVoxel()); })
+        .def_property_readonly("stats", [](const LidarPreprocessor& lidar) {
+            const LidarStats& stats = lidar.stats();
+            py::dict result;
+            result["sensors"] = stats.sensors;
+            result["reflections"] = stats.reflections;
+            result["cropped"] = stats.cropped;
+            result["ground"] = stats.ground;
+            result["points"] = stats.points;
+            result["bytes_stripped"] = stats.bytesStripped;
+            result["process_time_us"] = stats.processTimeUs;
+            return result;
+        });
+
+    py::class_<CameraImages, std::shared_ptr<CameraImages>>(m, "CameraImages")
+        .def_property_readonly("count", &CameraImages::count)
+        .def("info", [](const CameraImages& camera, size_t index) {
+            const CameraFrame& frame = cameraFrame(camera, index, "info");
+            py::dict result;
+            result["sensor_id"] = frame.sensorId;
+            result["width"] = frame.width;
+            result["height"] = frame.height;
+            result["channel_format"] = frame.format;
+            result["channels"] = frame.channels;
+            result["dtype"] = cameraDtype(frame);
+            result["bytes"] = frame.size;
+            result["error"] = frame.error;
+            return result;
+        }, py::arg("index") = 0)
+        .def("image", [](CameraImages& camera, size_t index) {
+            const CameraFrame& frame = cameraFrame(camera, index, "image");
+            if (!frame.error.empty()) {
+                throw py::value_error("image: " + frame.error);
+            }
+            // Read-only array on the input buffer; invalid (released) after update_control returns
+            py::object numpy = py::module::import("numpy");
+            py::object array = numpy.attr("frombuffer")(camera.view(index), py::arg("dtype") = cameraDtype(frame));
+            if (frame.channels == 1) {
+                return array.attr("reshape")(frame.height, frame.width);
+            }
+            return array.attr("reshape")(frame.height, frame.width, frame.channels);
+        }, py::arg("index") = 0,
+           "Image of this step without copy: (height, width) or (height, width, 3) in the sensor's sample type; "
+           "copy it to keep it beyond update_control")
+        .def("tensor", [](CameraImages& camera, size_t index, size_t width, size_t height, const std::string& order,
+                          const std::string& layout, const py::object& mean, const py::object& std, const py::object& out) {
+            CameraTensorSettings settings;
+            settings.width = width;
+            settings.height = height;
+            settings.order = cameraColorOrder(order);
+            if (layout != "chw" && layout != "hwc") {
+                throw py::value_error("tensor: unknown layout '" + layout + "' (chw or hwc)");
+            }
+            settings.channelsFirst = layout == "chw";
+            size_t channels = settings.order == CameraColorOrder::Gray ? 1 : 3;
+            if (!mean.is_none()) {
+                std::vector<double> values = broadcast(mean, channels, "tensor: mean");
+                std::copy(values.begin(), values.end(), settings.mean);
+            }
+            if (!std.is_none()) {
+                std::vector<double> values = broadcast(std, channels, "tensor: std");
+                std::copy(values.begin(), values.end(), settings.std);
+            }
+            for (size_t c = 0; c < channels; ++c) {
+                if (!(settings.std[c] > 0.0f)) {
+                    throw py::value_error("tensor: std must be positive");
+                }
+            }
+            std::vector<py::ssize_t> shape = settings.channelsFirst
+                ? std::vector<py::ssize_t>{ (py::ssize_t)channels, (py::ssize_t)height, (py::ssize_t)width }
+                : std::vector<py::ssize_t>{ (py::ssize_t)height, (py::ssize_t)width, (py::ssize_t)channels };
+            py::array_t<float, py::array::c_style> result;
+            if (out.is_none()) {
+                result = py::array_t<float, py::array::c_style>(shape);
+            } else {
+                // Reused output buffer, e.g. the input tensor of an inference session. Written in
+                // place: a cast would silently convert (copy) an array of another dtype or layout.
+                if (py::isinstance<py::array_t<float, py::array::c_style>>(out)) {
+                    result = py::reinterpret_borrow<py::array_t<float, py::array::c_style>>(out);
+                }
+                if (result.ptr() != out.ptr() || result.ndim() != 3 || result.shape(0) != shape[0] ||
+                    result.shape(1) != shape[1] || result.shape(2) != shape[2] || !result.writeable()) {
+                    throw py::value_error("tensor: out must be a writeable C-contiguous float32 array of shape (" +
+                                          std::to_string(shape[0]) + ", " + std::to_string(shape[1]) + ", " +
+                                          std::to_string(shape[2]) + ")");
+                }
+            }
+            cameraFrame(camera, index, "tensor");
+            float* data = result.mutable_data();
+            std::string error;
+            bool ok;
+            {
+                py::gil_scoped_release release; // Reads the input buffer, which stays valid during update_control
+                ok = camera.tensor(index, settings, data, error);
+            }
+            if (!ok) {
+                throw py::value_error("tensor: " + error);
+            }
+            return result;
+        }, py::arg("index") = 0, py::arg("width") = 224, py::arg("height") = 224, py::arg("order") = "rgb",
+           py::arg("layout") = "chw", py::arg("mean") = py::none(), py::arg("std") = py::none(), py::arg("out") = py::none(),
+           "float32 network input in one pass: bilinear resize, colour order and (v / 255 - mean) / std; "
+           "MONO_U8, RGB_U8 and Bayer BGGR / RGGB U8 (combined per 2x2 cell) images");
+
+    py::class_<TrackerSettings>(m, "TrackerSettings")
+        .def_readwrite("acceleration_std", &TrackerSettings::accelerationStd)
+        .def_readwrite("measurement_std", &TrackerSettings::measurementStd)
+        .def_readwrite("velocity_std", &TrackerSettings::velocityStd)
+        .def_readwrite("gate", &TrackerSettings::gate)
+        .def_readwrite("confirm_hits", &TrackerSettings::confirmHits)
+        .def_readwrite("max_misses", &TrackerSettings::maxMisses)
+        .def_readwrite("greedy", &TrackerSettings::greedy);
+
+    py::class_<ObjectTracker, std::shared_ptr<ObjectTracker>>(m, "ObjectTracker")
+        .def_readwrite("settings", &ObjectTracker::settings)
+        .def_property_readonly("count", &ObjectTracker::count)
+        .def_property_readonly("time", &ObjectTracker::time)
+        .def_property_readonly("global_frame", &ObjectTracker::global)
+        .def("tracks", [](const ObjectTracker& tracker, bool confirmedOnly) {
+            std::vector<size_t> rows;
+            for (size_t i = 0; i < tracker.count(); ++i) {
+                if (!confirmedOnly || tracker.confirmed()[i]) {
+                    rows.push_back(i);
+                }
+            }
+            size_t n = rows.size();
+            IdArray id(n), sensorId(n);
+            DoubleArray state({ n, (size_t)4 });
+            DoubleArray covariance({ n, (size_t)4, (size_t)4 });
+            DoubleArray yaw(n), length(n), width(n), existence(n);
+            py::array_t<uint32_t> age(n), hits(n), misses(n);
+            py::array_t<bool> confirmed(n);
+            py::array_t<int32_t> detection(n);
+            // Upper triangle (Simd::KalmanArrays order) -> full symmetric 4x4
+            static const size_t UPPER[4][4] = { { 0, 1, 2, 3 }, { 1, 4, 5, 6 }, { 2, 5, 7, 8 }, { 3, 6, 8, 9 } };
+            for (size_t k = 0; k < n; ++k) {
+                size_t i = rows[k];
+                id.mutable_data()[k] = tracker.id()[i];
+                sensorId.mutable_data()[k] = tracker.sensorId()[i];
+                double* s = state.mutable_data() + 4 * k;
+                s[0] = tracker.x()[i];
+                s[1] = tracker.y()[i];
+                s[2] = tracker.vx()[i];
+                s[3] = tracker.vy()[i];
+                double* p = covariance.mutable_data() + 16 * k;
+                for (size_t r = 0; r < 4; ++r) {
+                    for (size_t c = 0; c < 4; ++c) {
+                        p[4 * r + c] = tracker.covariance(UPPER[r][c])[i];
+                    }
+                }
+                yaw.mutable_data()[k] = tracker.yaw()[i];
+                length.mutable_data()[k] = tracker.length()[i];
+                width.mutable_data()[k] = tracker.width()[i];
+                existence.mutable_data()[k] = tracker.existence()[i];
+                age.mutable_data()[k] = tracker.age()[i];
+                hits.mutable_data()[k] = tracker.hits()[i];
+                misses.mutable_data()[k] = tracker.misses()[i];
+                confirmed.mutable_data()[k] = tracker.confirmed()[i] != 0;
+                detection.mutable_data()[k] = tracker.detection()[i];
+            }
+            py::dict result;
+            result["id"] = id;
+            result["state"] = state;
+            result["covariance"] = covariance;
+            result["yaw"] = yaw;
+            result["length"] = length;
+            result["width"] = width;
+            result["existence"] = existence;
+            result["sensor_id"] = sensorId;
+            result["age"] = age;
+            result["hits"] = hits;
+            result["misses"] = misses;
+            result["confirmed"] = confirmed;
+            result["detection"] = detection;
+            return result;
+        }, py::arg("confirmed_only") = true,
+           "Dict of arrays, one entry per track: id, state (n, 4) x, y, vx, vy, covariance (n, 4, 4), yaw, "
+           "length, width, existence, sensor_id (header.tracking_id), age, hits, misses, confirmed, "
+           "detection (index in the last SensorData, -1: not detected)")
+        .def_property_readonly("stats", [](const ObjectTracker& tracker) {
+            const TrackerStats& stats = tracker.stats();
+            py::dict result;
+            result["detections"] = stats.detections;
+            result["assigned"] = stats.assigned;
+            result["created"] = stats.created;
+            result["deleted"] = stats.deleted;
+            result["update_time_us"] = stats.updateTimeUs;
+            return result;
+        })
+        .def("reset", &ObjectTracker::reset);
+
+    py::class_<KpiSettings>(m, "KpiSettings")
+        .def_readwrite("headway_threshold", &KpiSettings::headwayThreshold)
+        .def_readwrite("max_longitudinal_acceleration", &KpiSettings::maxLongitudinalAcceleration)
+        .def_readwrite("max_lateral_acceleration", &KpiSettings::maxLateralAcceleration)
+        .def_readwrite("max_jerk", &KpiSettings::maxJerk);
+
+    py::class_<KpiEngine, std::shared_ptr<KpiEngine>>(m, "KpiEngine")
+        .def_readwrite("settings", &KpiEngine::settings)
+        .def_property_readonly("values", [](const KpiEngine& kpi) {
+            KpiValues v = kpi.values();
+            py::dict result;
+            result["steps"] = v.steps;
+            result["samples"] = v.samples;
+            result["duration"] = v.duration;
+            result["distance"] = v.distance;
+            result["min_ttc"] = v.minTtc;
+            result["min_ttc_time"] = v.minTtcTime;
+            result["min_headway"] = v.minHeadway;
+            result["headway_violation_time"] = v.headwayViolationTime;
+            result["max_acceleration"] = v.maxAcceleration;
+            result["max_deceleration"] = v.maxDeceleration;
+            result["max_lateral_acceleration"] = v.maxLateralAcceleration;
+            result["max_jerk"] = v.maxJerk;
+            result["jerk_rms"] = v.jerkRms;
+            result["comfort_violation_time"] = v.comfortViolationTime;
+            result["lane_samples"] = v.laneSamples;
+            result["lane_deviation_rms"] = v.laneDeviationRms;
+            result["lane_deviation_max"] = v.laneDeviationMax;
+            result["max_steering_rate"] = v.maxSteeringRate;
+            result["brake_time"] = v.brakeTime;
+            result["throttle_brake_overlap_time"] = v.throttleBrakeOverlapTime;
+            return result;
+        }, "KPIs accumulated up to the end of the previous step")
+        .def("write_summary", [](const KpiEngine& kpi, const std::string& path) {
+            std::string error;
+            if (!kpi.writeSummary(path, error)) {
+                throw std::runtime_error(error);
+            }
+        }, py::arg("path"));
+
+    py::class_<SignalLog, std::shared_ptr<SignalLog>>(m, "SignalLog")
+        .def("add", [](SignalLog& log, const std::string& name, const std::string& type) {
+            std::string error;
+            int column = log.addColumn(name, signalType(type), error);
+            if (column < 0) {
+                throw py::value_error("add: " + error);
+            }
+            return column;
+        }, py::arg("name"), py::arg("type") = "f8",
+           "Add a signal (until the end of the first step); returns its column for set()")
+        .def("set", [](SignalLog& log, size_t column, double value) {
+            if (column == 0 || column >= log.columnCount()) {
+                throw py::value_error("set: no signal column " + std::to_string(column));
+            }
+            log.set(column, value);
+        }, py::arg("column"), py::arg("value"))
+        .def("__setitem__", [](SignalLog& log, const std::string& name, double value) {
+            log.set(signalColumn(log, name), value);
+        })
+        .def_property_readonly("path", &SignalLog::path)
+        .def_property_readonly("signals", [](const SignalLog& log) {
+            py::list names;
+            for (const std::string& name : log.columnNames()) {
+                names.append(name);
+            }
+            return names;
+        })
+        .def_property_readonly("rows", &SignalLog::rows)
+        .def_property_readonly("dropped_rows", &SignalLog::droppedRows);
+}
@@ -0,0 +1,106 @@
+#include "PythonMemoryPolicy.h"
+#include "PythonEmbed.h"
+#include <iostream>
+
+#ifdef GTDC_WITH_MIMALLOC
+#include <mimalloc.h>
+#endif
+
+namespace PythonMemory {
+
+#ifdef GTDC_WITH_MIMALLOC
+static void* miMalloc(void*, size_t size) { return mi_malloc(size); }
+static void* miCalloc(void*, size_t nelem, size_t elsize) { return mi_calloc(nelem, elsize); }
+static void* miRealloc(void*, void* ptr, size_t size) { return mi_realloc(ptr, size); }
+static void miFree(void*, void* ptr) { mi_free(ptr); }
+#endif
+
+bool configureAllocator(AllocatorMode mode) {
+    if (mode == AllocatorMode::Default) {
+        return true;
+    }
+
+    PyPreConfig preconfig;
+    PyPreConfig_InitPythonConfig(&preconfig);
+    preconfig.allocator = PYMEM_ALLOCATOR_MALLOC;
+
+    if (mode == AllocatorMode::Malloc) {
+        PyStatus status = Py_PreInitialize(&preconfig);
+        return !PyStatus_Exception(status);
+    }
+
+#ifdef GTDC_WITH_MIMALLOC
+    PyStatus status = Py_PreInitialize(&preconfig);
+    if (PyStatus_Exception(status)) {
+        return false;
+    }
+    // Allowed between Py_PreInitialize() and interpreter initialization.
+    // The raw domain is left on malloc since pre-initialization already used it.
+    PyMemAllocatorEx alloc = { nullptr, miMalloc, miCalloc, miRealloc, miFree };
+    PyMem_SetAllocator(PYMEM_DOMAIN_MEM, &alloc);
+    PyMem_SetAllocator(PYMEM_DOMAIN_OBJ, &alloc);
+    return true;
+#else
+    return false;
+#endif
+}
+
+// --- GcMonitor ---
+
+GcMonitor& GcMonitor::instance() {
+    static GcMonitor monitor;
+    return monitor;
+}
+
+void GcMonitor::install() {
+    if (m_installed) {
+        return;
+    }
+
+    py::module gc = py::module::import("gc");
+    gc.attr("callbacks").attr("append")(py::cpp_function([](py::str phase, py::dict /*info*/) {
+        if (std::string(phase) == "start") {
+            GcMonitor::instance().onStart();
+        } else {
+            GcMonitor::instance().onStop();
+        }
+    }));
+    m_installed = true;
+}
+
+void GcMonitor::onStart() {
+    m_start = std::chrono::steady_clock::now();
+}
+
+void GcMonitor::onStop() {
+    auto pause = std::chrono::steady_clock::now() - m_start;
+    m_pauseNs.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(pause).count(),
+                        std::memory_order_relaxed);
+    m_collections.fetch_add(1, std::memory_order_relaxed);
+}
+
+// --- GC control ---
+
+void freeze() {
+    py::module gc = py::module::import("gc");
+    gc.attr("collect")();
+    gc.attr("freeze")();
+}
+
+void setAutomaticGc(bool enabled) {
+    py::module gc = py::module::import("gc");
+    gc.attr(enabled ? "enable" : "disable")();
+}
+
+void collectScheduled(unsigned long long& scheduledCount) {
+    ++scheduledCount;
+    int generation = 0;
+    if (scheduledCount % 100 == 0) {
+        generation = 2;
+    } else if (scheduledCount % 10 == 0) {
+        generation = 1;
+    }
+    py::module::import("gc").attr("collect")(generation);
+}
+
+} // namespace PythonMemory
@@ -0,0 +1,78 @@
+#include "PythonStepWorker.h"
+
+PythonStepWorker::PythonStepWorker(std::function<void()> threadInit)
+    : m_threadInit(std::move(threadInit))
+{
+    // Started in the body so that all synchronization members exist first
+    m_thread = std::thread(&PythonStepWorker::run, this);
+}
+
+PythonStepWorker::~PythonStepWorker() {
+    stop();
+}
+
+bool PythonStepWorker::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_busy || m_stop) {
+            return false;
+        }
+        m_job = std::move(job);
+        m_busy = true;
+    }
+    m_cvJob.notify_one();
+    return true;
+}
+
+bool PythonStepWorker::waitFor(std::chrono::microseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_cvDone.wait_for(lock, timeout, [this] { return !m_busy; });
+}
+
+void PythonStepWorker::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cvDone.wait(lock, [this] { return !m_busy; });
+}
+
+bool PythonStepWorker::busy() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_busy;
+}
+
+void PythonStepWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cvJob.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void PythonStepWorker::run() {
+    if (m_threadInit) {
+        m_threadInit();
+    }
+
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cvJob.wait(lock, [this] { return m_stop || m_job; });
+            if (!m_job) {
+                return; // Stop requested and nothing queued
+            }
+            job = std::move(m_job);
+            m_job = nullptr;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busy = false;
+        }
+        m_cvDone.notify_all();
+    }
+}
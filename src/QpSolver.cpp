@@ -0,0 +1,414 @@
+#include "QpSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr double RHO_MIN = 1e-6;
+constexpr double RHO_MAX = 1e6;
+constexpr double RHO_EQUALITY_SCALE = 1e3; // Equality rows converge faster with a larger step
+constexpr int CHECK_INTERVAL = 5;          // Iterations between residual checks
+constexpr int ADAPT_INTERVAL = 25;         // Iterations between rho updates
+constexpr double ADAPT_TOLERANCE = 5.0;    // Refactorize only if rho changes by more than this factor
+constexpr double SCALE_MIN = 1e-4;
+constexpr double SCALE_MAX = 1e4;
+
+// Dot product with independent partial sums (the single accumulator chain is
+// latency bound at these sizes)
+double dot(const double* a, const double* b, size_t n) {
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i + 1] * b[i + 1];
+        s2 += a[i + 2] * b[i + 2];
+        s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; ++i) {
+        s0 += a[i] * b[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+// Ruiz factor for a column / row of infinity norm `norm`
+double scaleFactor(double norm) {
+    return norm < SCALE_MIN ? 1.0 : std::min(SCALE_MAX, std::max(SCALE_MIN, 1.0 / std::sqrt(norm)));
+}
+
+} // namespace
+
+const char* qpStatusName(QpStatus status) {
+    switch (status) {
+        case QpStatus::Solved: return "solved";
+        case QpStatus::MaxIterations: return "max_iterations";
+        case QpStatus::InvalidInput: return "invalid_input";
+        case QpStatus::NotConvex: return "not_convex";
+    }
+    return "unknown";
+}
+
+bool QpSolver::setup(size_t n, size_t m, const double* P, const double* A, std::string& error) {
+    if (n == 0) {
+        error = "QP without variables";
+        return false;
+    }
+    m_n = n;
+    m_m = m;
+    size_t rows = n + m;
+    m_P.assign(n * n, 0.0);
+    m_A.assign(m * n, 0.0);
+    m_K.assign(n * n, 0.0);
+    m_D.assign(n, 1.0);
+    m_E.assign(m, 1.0);
+    m_q.assign(n, 0.0);
+    m_solution.assign(n, 0.0);
+    m_dual.assign(rows, 0.0);
+    m_rho.assign(rows, 0.0);
+    m_rhoFactored.assign(rows, 0.0);
+    m_l.assign(rows, -INF);
+    m_u.assign(rows, INF);
+    m_x.assign(n, 0.0);
+    m_z.assign(rows, 0.0);
+    m_y.assign(rows, 0.0);
+    m_xt.assign(n, 0.0);
+    m_zt.assign(rows, 0.0);
+    m_rhs.assign(n, 0.0);
+    m_Cx.assign(rows, 0.0);
+    m_Px.assign(n, 0.0);
+    m_Cty.assign(n, 0.0);
+    m_rhoBase = settings.rho;
+    m_warm = false;
+    return updateMatrices(P, A, error);
+}
+
+bool QpSolver::updateMatrices(const double* P, const double* A, std::string& error) {
+    if (m_n == 0) {
+        error = "QP not set up";
+        return false;
+    }
+    for (size_t i = 0; i < m_n * m_n; ++i) {
+        if (!std::isfinite(P[i])) {
+            error = "P contains NaN or infinity";
+            return false;
+        }
+    }
+    for (size_t i = 0; i < m_m * m_n; ++i) {
+        if (!std::isfinite(A[i])) {
+            error = "A contains NaN or infinity";
+            return false;
+        }
+    }
+    // Symmetric part of P, so that a triangular input also works as intended
+    for (size_t r = 0; r < m_n; ++r) {
+        for (size_t c = 0; c < m_n; ++c) {
+            m_P[r * m_n + c] = 0.5 * (P[r * m_n + c] + P[c * m_n + r]);
+        }
+    }
+    std::copy(A, A + m_m * m_n, m_A.begin());
+    equilibrate();
+    m_factorValid = false;
+    m_warm = false;
+    return true;
+}
+
+// Ruiz equilibration of the KKT matrix [P A'; A 0], then a cost scale bringing
+// the mean column norm of P to 1. m_Px (columns) and m_Cx (A rows) are scratch.
+void QpSolver::equilibrate() {
+    size_t n = m_n;
+    std::fill(m_D.begin(), m_D.end(), 1.0);
+    std::fill(m_E.begin(), m_E.end(), 1.0);
+    m_cost = 1.0;
+    double* column = m_Px.data();
+    double* row = m_Cx.data();
+    for (int iteration = 0; iteration < settings.scalingIterations; ++iteration) {
+        for (size_t c = 0; c < n; ++c) {
+            column[c] = 0.0;
+        }
+        for (size_t r = 0; r < n; ++r) {
+            for (size_t c = 0; c < n; ++c) {
+                column[c] = std::max(column[c], std::fabs(m_P[r * n + c]));
+            }
+        }
+        for (size_t r = 0; r < m_m; ++r) {
+            row[r] = 0.0;
+            for (size_t c = 0; c < n; ++c) {
+                double a = std::fabs(m_A[r * n + c]);
+                column[c] = std::max(column[c], a);
+                row[r] = std::max(row[r], a);
+            }
+        }
+        for (size_t c = 0; c < n; ++c) {
+            column[c] = scaleFactor(column[c]);
+            m_D[c] *= column[c];
+        }
+        for (size_t r = 0; r < m_m; ++r) {
+            row[r] = scaleFactor(row[r]);
+            m_E[r] *= row[r];
+        }
+        for (size_t r = 0; r < n; ++r) {
+            for (size_t c = 0; c < n; ++c) {
+                m_P[r * n + c] *= column[r] * column[c];
+            }
+        }
+        for (size_t r = 0; r < m_m; ++r) {
+            for (size_t c = 0; c < n; ++c) {
+                m_A[r * n + c] *= row[r] * column[c];
+            }
+        }
+    }
+    if (settings.scalingIterations > 0) {
+        double mean = 0.0;
+        for (size_t c = 0; c < n; ++c) {
+            double norm = 0.0;
+            for (size_t r = 0; r < n; ++r) {
+                norm = std::max(norm, std::fabs(m_P[r * n + c]));
+            }
+            mean += norm;
+        }
+        mean /= (double)n;
+        m_cost = mean < SCALE_MIN ? 1.0 : std::min(SCALE_MAX, 1.0 / mean);
+        for (double& p : m_P) {
+            p *= m_cost;
+        }
+    }
+}
+
+void QpSolver::resetWarmStart() {
+    m_warm = false;
+    m_rhoBase = settings.rho;
+}
+
+void QpSolver::warmStart(const double* x) {
+    if (!m_warm) {
+        std::fill(m_y.begin(), m_y.end(), 0.0);
+    }
+    for (size_t i = 0; i < m_n; ++i) {
+        m_x[i] = x[i] / m_D[i];
+        m_z[i] = m_x[i];
+    }
+    for (size_t r = 0; r < m_m; ++r) {
+        m_z[m_n + r] = dot(&m_A[r * m_n], m_x.data(), m_n);
+    }
+    m_warm = true;
+}
+
+// rho per row: large for equalities, tiny for free rows
+void QpSolver::updateRho() {
+    for (size_t r = 0; r < m_n + m_m; ++r) {
+        bool freeRow = m_l[r] == -INF && m_u[r] == INF;
+        bool equality = m_l[r] == m_u[r];
+        m_rho[r] = freeRow ? RHO_MIN : (equality ? RHO_EQUALITY_SCALE * m_rhoBase : m_rhoBase);
+    }
+}
+
+// Cholesky of K = P + sigma I + diag(rho_box) + A' diag(rho_A) A
+bool QpSolver::factorize() {
+    size_t n = m_n;
+    for (size_t r = 0; r < n; ++r) {
+        for (size_t c = 0; c <= r; ++c) {
+            double sum = m_P[r * n + c];
+            for (size_t k = 0; k < m_m; ++k) {
+                sum += m_A[k * n + r] * m_rho[n + k] * m_A[k * n + c];
+            }
+            if (r == c) {
+                sum += settings.sigma + m_rho[r];
+            }
+            m_K[r * n + c] = sum;
+        }
+    }
+    for (size_t j = 0; j < n; ++j) {
+        double d = m_K[j * n + j] - dot(&m_K[j * n], &m_K[j * n], j);
+        if (!(d > 0.0)) {
+            m_factorValid = false;
+            return false;
+        }
+        d = std::sqrt(d);
+        m_K[j * n + j] = d;
+        for (size_t i = j + 1; i < n; ++i) {
+            m_K[i * n + j] = (m_K[i * n + j] - dot(&m_K[i * n], &m_K[j * n], j)) / d;
+        }
+    }
+    m_rhoFactored = m_rho;
+    m_factorValid = true;
+    ++m_info.factorizations;
+    return true;
+}
+
+// L L' x = b in place: forward substitution by rows, backward by columns of L'
+// (rows of L), so that both passes read contiguous memory
+void QpSolver::solveFactor(double* x) const {
+    size_t n = m_n;
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = (x[i] - dot(&m_K[i * n], x, i)) / m_K[i * n + i];
+    }
+    for (size_t i = n; i-- > 0;) {
+        const double* row = &m_K[i * n];
+        double xi = x[i] / row[i];
+        x[i] = xi;
+        for (size_t k = 0; k < i; ++k) {
+            x[k] -= row[k] * xi;
+        }
+    }
+}
+
+// Residuals of the original problem: rows of C are unscaled by D (box) and
+// E^-1 (A), entries of the dual residual by (c D)^-1
+void QpSolver::residuals(double& primal, double& dual, double& primalScale, double& dualScale) {
+    size_t n = m_n;
+    for (size_t i = 0; i < n; ++i) {
+        m_Cx[i] = m_x[i];
+        m_Px[i] = dot(&m_P[i * n], m_x.data(), n);
+        m_Cty[i] = m_y[i];
+    }
+    for (size_t r = 0; r < m_m; ++r) {
+        const double* row = &m_A[r * n];
+        m_Cx[n + r] = dot(row, m_x.data(), n);
+        double yr = m_y[n + r];
+        for (size_t k = 0; k < n; ++k) {
+            m_Cty[k] += row[k] * yr;
+        }
+    }
+    primal = 0.0;
+    primalScale = 0.0;
+    for (size_t r = 0; r < n + m_m; ++r) {
+        double unscale = r < n ? m_D[r] : 1.0 / m_E[r - n];
+        primal = std::max(primal, unscale * std::fabs(m_Cx[r] - m_z[r]));
+        primalScale = std::max(primalScale, unscale * std::max(std::fabs(m_Cx[r]), std::fabs(m_z[r])));
+    }
+    dual = 0.0;
+    dualScale = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double unscale = 1.0 / (m_cost * m_D[i]);
+        dual = std::max(dual, unscale * std::fabs(m_Px[i] + m_q[i] + m_Cty[i]));
+        double scale = std::max(std::max(std::fabs(m_Px[i]), std::fabs(m_Cty[i])), std::fabs(m_q[i]));
+        dualScale = std::max(dualScale, unscale * scale);
+    }
+}
+
+const QpInfo& QpSolver::solve(const double* q, const double* lb, const double* ub, const double* lbA, const double* ubA) {
+    auto start = std::chrono::steady_clock::now();
+    m_info = QpInfo();
+    size_t n = m_n;
+    size_t rows = n + m_m;
+    auto finish = [&](QpStatus status) -> const QpInfo& {
+        m_info.status = status;
+        m_info.solveTimeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        return m_info;
+    };
+    if (n == 0) {
+        return finish(QpStatus::InvalidInput);
+    }
+
+    // Vectors of the scaled problem: q^ = c D q, box bounds / D, row bounds * E
+    for (size_t i = 0; i < n; ++i) {
+        double qi = q ? q[i] : 0.0;
+        if (!std::isfinite(qi)) {
+            return finish(QpStatus::InvalidInput);
+        }
+        m_q[i] = m_cost * m_D[i] * qi;
+        m_l[i] = lb ? lb[i] / m_D[i] : -INF;
+        m_u[i] = ub ? ub[i] / m_D[i] : INF;
+    }
+    for (size_t r = 0; r < m_m; ++r) {
+        m_l[n + r] = lbA ? lbA[r] * m_E[r] : -INF;
+        m_u[n + r] = ubA ? ubA[r] * m_E[r] : INF;
+    }
+    for (size_t r = 0; r < rows; ++r) {
+        if (std::isnan(m_l[r]) || std::isnan(m_u[r]) || m_l[r] > m_u[r]) {
+            return finish(QpStatus::InvalidInput);
+        }
+    }
+
+    updateRho();
+    if (!m_factorValid || m_rho != m_rhoFactored) {
+        if (!factorize()) {
+            return finish(QpStatus::NotConvex);
+        }
+    }
+    if (!m_warm) {
+        std::fill(m_x.begin(), m_x.end(), 0.0);
+        std::fill(m_z.begin(), m_z.end(), 0.0);
+        std::fill(m_y.begin(), m_y.end(), 0.0);
+    }
+    m_warm = true;
+
+    const double alpha = settings.alpha;
+    QpStatus status = QpStatus::MaxIterations;
+    int iteration = 0;
+    while (iteration < settings.maxIterations) {
+        ++iteration;
+        // 1. x~ = K^-1 (sigma x - q + C'(rho z - y))
+        for (size_t i = 0; i < n; ++i) {
+            m_rhs[i] = settings.sigma * m_x[i] - m_q[i] + (m_rho[i] * m_z[i] - m_y[i]);
+        }
+        for (size_t r = 0; r < m_m; ++r) {
+            double w = m_rho[n + r] * m_z[n + r] - m_y[n + r];
+            const double* row = &m_A[r * n];
+            for (size_t k = 0; k < n; ++k) {
+                m_rhs[k] += row[k] * w;
+            }
+        }
+        std::copy(m_rhs.begin(), m_rhs.end(), m_xt.begin());
+        solveFactor(m_xt.data());
+
+        // 2. z~ = C x~, relaxation, projection onto the bounds, dual update
+        for (size_t i = 0; i < n; ++i) {
+            m_zt[i] = m_xt[i];
+        }
+        for (size_t r = 0; r < m_m; ++r) {
+            m_zt[n + r] = dot(&m_A[r * n], m_xt.data(), n);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            m_x[i] = alpha * m_xt[i] + (1.0 - alpha) * m_x[i];
+        }
+        for (size_t r = 0; r < rows; ++r) {
+            double relaxed = alpha * m_zt[r] + (1.0 - alpha) * m_z[r];
+            double z = std::min(m_u[r], std::max(m_l[r], relaxed + m_y[r] / m_rho[r]));
+            m_y[r] += m_rho[r] * (relaxed - z);
+            m_z[r] = z;
+        }
+
+        // 3. Termination and step size
+        bool check = iteration % CHECK_INTERVAL == 0 || iteration == settings.maxIterations;
+        if (!check) {
+            continue;
+        }
+        double primal, dual, primalScale, dualScale;
+        residuals(primal, dual, primalScale, dualScale);
+        m_info.primalResidual = primal;
+        m_info.dualResidual = dual;
+        if (primal <= settings.epsAbs + settings.epsRel * primalScale &&
+            dual <= settings.epsAbs + settings.epsRel * dualScale) {
+            status = QpStatus::Solved;
+            break;
+        }
+        if (settings.adaptiveRho && iteration % ADAPT_INTERVAL == 0) {
+            double ratio = std::sqrt((primal / (primalScale + 1e-10)) / (dual / (dualScale + 1e-10) + 1e-10));
+            double rho = std::min(RHO_MAX, std::max(RHO_MIN, m_rhoBase * ratio));
+            if (rho > m_rhoBase * ADAPT_TOLERANCE || rho < m_rhoBase / ADAPT_TOLERANCE) {
+                m_rhoBase = rho;
+                updateRho();
+                if (!factorize()) {
+                    return finish(QpStatus::NotConvex);
+                }
+            }
+        }
+    }
+    m_info.iterations = iteration;
+
+    // Back to the original problem: x = D x^, y = y^ / (c D) (box), E y^ / c (rows)
+    double objective = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        objective += m_x[i] * (0.5 * dot(&m_P[i * n], m_x.data(), n) + m_q[i]);
+        m_solution[i] = m_D[i] * m_x[i];
+        m_dual[i] = m_y[i] / (m_cost * m_D[i]);
+    }
+    for (size_t r = 0; r < m_m; ++r) {
+        m_dual[n + r] = m_E[r] * m_y[n + r] / m_cost;
+    }
+    m_info.objective = objective / m_cost;
+    return finish(status);
+}
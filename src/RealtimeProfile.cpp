@@ -0,0 +1,124 @@
+#include "RealtimeProfile.h"
+#include <sstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace Realtime {
+
+std::vector<int> parseCoreList(const std::string& spec) {
+    std::vector<int> cores;
+    std::istringstream is(spec);
+    std::string item;
+    while (std::getline(is, item, ',')) {
+        try {
+            size_t dash = item.find('-');
+            if (dash != std::string::npos) {
+                int first = std::stoi(item.substr(0, dash));
+                int last = std::stoi(item.substr(dash + 1));
+                for (int c = first; c <= last; ++c) {
+                    cores.push_back(c);
+                }
+            } else if (item.find_first_not_of(" \t") != std::string::npos) {
+                cores.push_back(std::stoi(item));
+            }
+        }
+        catch (...) {
+            // Skip invalid entry
+        }
+    }
+    return cores;
+}
+
+bool pinCurrentThread(int core) {
+    if (core < 0 || core >= 64) {
+        return false;
+    }
+#ifdef _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool setRealtimePriority(int priority) {
+#ifdef _WIN32
+    (void)priority;
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    sched_param param{};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#endif
+}
+
+bool prefaultAndLock(void* ptr, size_t size) {
+    if (!ptr || size == 0) {
+        return false;
+    }
+
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    size_t pageSize = info.dwPageSize;
+#else
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+
+    // Write one byte per page so that the pages are actually backed
+    volatile char* bytes = static_cast<volatile char*>(ptr);
+    for (size_t off = 0; off < size; off += pageSize) {
+        bytes[off] = bytes[off];
+    }
+    bytes[size - 1] = bytes[size - 1];
+
+#ifdef _WIN32
+    if (VirtualLock(ptr, size)) {
+        return true;
+    }
+    // The default working set quota is small; grow it and retry once
+    SIZE_T minWs = 0, maxWs = 0;
+    HANDLE process = GetCurrentProcess();
+    if (GetProcessWorkingSetSize(process, &minWs, &maxWs) &&
+        SetProcessWorkingSetSize(process, minWs + size + pageSize * 4, maxWs + size + pageSize * 4)) {
+        return VirtualLock(ptr, size) != 0;
+    }
+    return false;
+#else
+    return mlock(ptr, size) == 0;
+#endif
+}
+
+// --- AllocationProbe ---
+
+std::atomic<size_t> AllocationProbe::s_count{0};
+static thread_local bool t_armed = false;
+
+AllocationProbe::AllocationProbe()
+    : m_wasArmed(t_armed)
+{
+    t_armed = true;
+}
+
+AllocationProbe::~AllocationProbe() {
+    t_armed = m_wasArmed;
+}
+
+void AllocationProbe::onAllocation() {
+    if (t_armed) {
+        s_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace Realtime
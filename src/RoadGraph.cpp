@@ -0,0 +1,543 @@
+#include "RoadGraph.h"
+#include "OsiFields.h"
+#include "OsiFingerprint.h"
+#include "OsiWire.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using OsiWire::Field;
+using OsiWire::WireType;
+
+// Lane.Classification fields not used by the other wire-level modules
+constexpr uint32_t CLASSIFICATION_DRIVING_DIRECTION = 4;
+constexpr uint32_t CLASSIFICATION_LEFT_ADJACENT = 5;
+constexpr uint32_t CLASSIFICATION_RIGHT_ADJACENT = 6;
+constexpr uint32_t CLASSIFICATION_LANE_PAIRING = 7;
+constexpr uint32_t LANE_PAIRING_ANTECESSOR = 1;
+constexpr uint32_t LANE_PAIRING_SUCCESSOR = 2;
+
+constexpr double MIN_CELL_SIZE = 25.0; // [m]
+
+struct ParsedLane {
+    uint64_t id = 0;
+    uint32_t type = 0;
+    uint32_t drivingDirection = 0;
+    uint64_t left = 0;
+    uint64_t right = 0;
+    std::vector<uint64_t> successors;
+    std::vector<uint64_t> predecessors;
+    std::vector<double> x;
+    std::vector<double> y;
+};
+
+void readPairing(const Field& pairing, ParsedLane& lane) {
+    OsiWire::Reader reader(pairing.data, pairing.size);
+    Field f;
+    while (reader.next(f)) {
+        uint64_t id = 0;
+        if (!OsiWire::readIdentifier(f, id) || id == 0) {
+            continue;
+        }
+        if (f.number == LANE_PAIRING_ANTECESSOR) {
+            lane.predecessors.push_back(id);
+        } else if (f.number == LANE_PAIRING_SUCCESSOR) {
+            lane.successors.push_back(id);
+        }
+    }
+}
+
+void readPoint(const Field& point, ParsedLane& lane) {
+    double v[3];
+    if (OsiWire::readVector3d(point, v) && std::isfinite(v[0]) && std::isfinite(v[1])) {
+        lane.x.push_back(v[0]);
+        lane.y.push_back(v[1]);
+    }
+}
+
+void readClassification(const Field& classification, ParsedLane& lane) {
+    OsiWire::Reader reader(classification.data, classification.size);
+    Field f;
+    while (reader.next(f)) {
+        switch (f.number) {
+            case OsiFields::LaneClassification::Type:
+                lane.type = f.type == WireType::Varint ? (uint32_t)f.varint : 0;
+                break;
+            case CLASSIFICATION_DRIVING_DIRECTION:
+                lane.drivingDirection = f.type == WireType::Varint && f.varint != 0;
+                break;
+            case CLASSIFICATION_LEFT_ADJACENT:
+                if (lane.left == 0) {
+                    OsiWire::readIdentifier(f, lane.left);
+                }
+                break;
+            case CLASSIFICATION_RIGHT_ADJACENT:
+                if (lane.right == 0) {
+                    OsiWire::readIdentifier(f, lane.right);
+                }
+                break;
+            case CLASSIFICATION_LANE_PAIRING:
+                if (f.type == WireType::LengthDelimited) {
+                    readPairing(f, lane);
+                }
+                break;
+            case OsiFields::LaneClassification::Centerline:
+                if (f.type == WireType::LengthDelimited) {
+                    readPoint(f, lane);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+std::vector<ParsedLane> readLanes(const std::string& groundTruth) {
+    std::vector<ParsedLane> lanes;
+    OsiWire::Reader reader(groundTruth.data(), groundTruth.size());
+    Field field;
+    while (reader.next(field)) {
+        if (field.number != OsiFields::GroundTruth::Lane || field.type != WireType::LengthDelimited) {
+            continue;
+        }
+        ParsedLane lane;
+        OsiWire::Reader laneReader(field.data, field.size);
+        Field f;
+        while (laneReader.next(f)) {
+            if (f.number == OsiFields::Lane::Id) {
+                OsiWire::readIdentifier(f, lane.id);
+            } else if (f.number == OsiFields::Lane::Classification && f.type == WireType::LengthDelimited) {
+                readClassification(f, lane);
+            }
+        }
+        if (lane.id != 0) {
+            lanes.push_back(std::move(lane));
+        }
+    }
+    // Sorted by id for the binary search in findLane(); the first lane of a duplicated id is kept
+    std::stable_sort(lanes.begin(), lanes.end(), [](const ParsedLane& a, const ParsedLane& b) { return a.id < b.id; });
+    lanes.erase(std::unique(lanes.begin(), lanes.end(), [](const ParsedLane& a, const ParsedLane& b) { return a.id == b.id; }),
+                lanes.end());
+    return lanes;
+}
+
+uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+template <typename T>
+bool arrayInside(uint64_t offset, uint64_t count, uint64_t imageSize) {
+    return offset % 8 == 0 && offset <= imageSize && count <= (imageSize - offset) / sizeof(T);
+}
+
+// Header and arrays consistent with the image size; every index stored in the image
+// (lanes, links, point lanes, grid cells and their segments) within range, so that a
+// corrupted cache file is rejected instead of read out of bounds
+bool validImage(const char* data, size_t size) {
+    const RoadGraphHeader& h = *reinterpret_cast<const RoadGraphHeader*>(data);
+    uint64_t cellCount = (uint64_t)h.gridColumns * h.gridRows;
+    if (h.imageSize != size ||
+        !arrayInside<RoadGraphLane>(h.lanesOffset, h.laneCount, size) ||
+        !arrayInside<uint32_t>(h.linksOffset, h.linkCount, size) ||
+        !arrayInside<double>(h.pointXOffset, h.pointCount, size) ||
+        !arrayInside<double>(h.pointYOffset, h.pointCount, size) ||
+        !arrayInside<double>(h.pointSOffset, h.pointCount, size) ||
+        !arrayInside<uint32_t>(h.pointLaneOffset, h.pointCount, size) ||
+        !arrayInside<uint32_t>(h.cellStartOffset, cellCount + 1, size) ||
+        !arrayInside<uint32_t>(h.cellSegmentsOffset, h.cellEntryCount, size)) {
+        return false;
+    }
+    const RoadGraphLane* lanes = reinterpret_cast<const RoadGraphLane*>(data + h.lanesOffset);
+    for (uint32_t i = 0; i < h.laneCount; ++i) {
+        const RoadGraphLane& lane = lanes[i];
+        if ((uint64_t)lane.firstPoint + lane.pointCount > h.pointCount ||
+            (uint64_t)lane.firstSuccessor + lane.successorCount > h.linkCount ||
+            (uint64_t)lane.firstPredecessor + lane.predecessorCount > h.linkCount ||
+            (lane.left != ROAD_GRAPH_NO_LANE && lane.left >= h.laneCount) ||
+            (lane.right != ROAD_GRAPH_NO_LANE && lane.right >= h.laneCount)) {
+            return false;
+        }
+    }
+    const uint32_t* links = reinterpret_cast<const uint32_t*>(data + h.linksOffset);
+    for (uint32_t i = 0; i < h.linkCount; ++i) {
+        if (links[i] >= h.laneCount) {
+            return false;
+        }
+    }
+    const uint32_t* pointLane = reinterpret_cast<const uint32_t*>(data + h.pointLaneOffset);
+    for (uint32_t p = 0; p < h.pointCount; ++p) {
+        if (pointLane[p] >= h.laneCount) {
+            return false;
+        }
+    }
+    // Cell ranges ascending from 0 to the entry count; a segment p joins the points p and
+    // p + 1 of one lane
+    const uint32_t* cellStart = reinterpret_cast<const uint32_t*>(data + h.cellStartOffset);
+    if (cellStart[0] != 0 || cellStart[cellCount] != h.cellEntryCount) {
+        return false;
+    }
+    for (uint64_t c = 0; c < cellCount; ++c) {
+        if (cellStart[c] > cellStart[c + 1]) {
+            return false;
+        }
+    }
+    const uint32_t* cellSegments = reinterpret_cast<const uint32_t*>(data + h.cellSegmentsOffset);
+    for (uint32_t i = 0; i < h.cellEntryCount; ++i) {
+        uint32_t p = cellSegments[i];
+        if ((uint64_t)p + 1 >= h.pointCount) {
+            return false;
+        }
+        const RoadGraphLane& lane = lanes[pointLane[p]];
+        if (p < lane.firstPoint || (uint64_t)p + 1 >= (uint64_t)lane.firstPoint + lane.pointCount) {
+            return false;
+        }
+    }
+    return cellCount == 0 || (std::isfinite(h.cellSize) && h.cellSize > 0.0);
+}
+
+std::atomic<unsigned> g_tempCounter{ 0 };
+
+} // namespace
+
+// Read-only file mapping of a cache file
+struct RoadGraph::Mapping {
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    void* view = nullptr;
+    size_t size = 0;
+
+    bool open(const std::string& path) {
+#ifdef _WIN32
+        // FILE_SHARE_DELETE: a writer may replace the file while it is mapped here
+        file = CreateFileW(fs::path(path).wstring().c_str(), GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(RoadGraphHeader)) {
+            return false;
+        }
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            return false;
+        }
+        view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        size = (size_t)fileSize.QuadPart;
+        return view != nullptr;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(RoadGraphHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        view = p;
+        size = (size_t)st.st_size;
+        return true;
+#endif
+    }
+
+    ~Mapping() {
+#ifdef _WIN32
+        if (view) {
+            UnmapViewOfFile(view);
+        }
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+#else
+        if (view) {
+            munmap(view, size);
+        }
+#endif
+    }
+};
+
+RoadGraph::~RoadGraph() {
+    delete m_mapping;
+}
+
+std::shared_ptr<const RoadGraph> RoadGraph::build(const std::string& groundTruth, unsigned long long hash) {
+    std::vector<ParsedLane> parsed = readLanes(groundTruth);
+    auto indexOf = [&parsed](uint64_t id) -> uint32_t {
+        auto it = std::lower_bound(parsed.begin(), parsed.end(), id, [](const ParsedLane& lane, uint64_t value) { return lane.id < value; });
+        return it != parsed.end() && it->id == id ? (uint32_t)(it - parsed.begin()) : ROAD_GRAPH_NO_LANE;
+    };
+
+    // 1. Lanes, links and centerline arc-length tables
+    std::vector<RoadGraphLane> lanes(parsed.size());
+    std::vector<uint32_t> links;
+    std::vector<double> px, py, ps;
+    std::vector<uint32_t> pointLane;
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        const ParsedLane& src = parsed[i];
+        RoadGraphLane& lane = lanes[i];
+        std::memset(&lane, 0, sizeof(lane));
+        lane.id = src.id;
+        lane.type = src.type;
+        lane.drivingDirection = src.drivingDirection;
+        lane.left = src.left != 0 ? indexOf(src.left) : ROAD_GRAPH_NO_LANE;
+        lane.right = src.right != 0 ? indexOf(src.right) : ROAD_GRAPH_NO_LANE;
+
+        lane.firstSuccessor = (uint32_t)links.size();
+        for (uint64_t id : src.successors) {
+            uint32_t index = indexOf(id);
+            if (index != ROAD_GRAPH_NO_LANE) {
+                links.push_back(index);
+            }
+        }
+        lane.successorCount = (uint32_t)links.size() - lane.firstSuccessor;
+        lane.firstPredecessor = (uint32_t)links.size();
+        for (uint64_t id : src.predecessors) {
+            uint32_t index = indexOf(id);
+            if (index != ROAD_GRAPH_NO_LANE) {
+                links.push_back(index);
+            }
+        }
+        lane.predecessorCount = (uint32_t)links.size() - lane.firstPredecessor;
+
+        lane.firstPoint = (uint32_t)px.size();
+        lane.pointCount = (uint32_t)src.x.size();
+        double s = 0.0;
+        for (size_t k = 0; k < src.x.size(); ++k) {
+            if (k > 0) {
+                s += std::hypot(src.x[k] - src.x[k - 1], src.y[k] - src.y[k - 1]);
+            }
+            px.push_back(src.x[k]);
+            py.push_back(src.y[k]);
+            ps.push_back(s);
+            pointLane.push_back((uint32_t)i);
+        }
+        lane.length = s;
+    }
+
+    // 2. Uniform grid over the segment bounding boxes, coarsened until the cell count
+    //    is in proportion to the segment count
+    double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+    if (!px.empty()) {
+        minX = *std::min_element(px.begin(), px.end());
+        maxX = *std::max_element(px.begin(), px.end());
+        minY = *std::min_element(py.begin(), py.end());
+        maxY = *std::max_element(py.begin(), py.end());
+    }
+    uint64_t segmentCount = px.size();
+    double cellSize = MIN_CELL_SIZE;
+    uint32_t columns = 0, rows = 0;
+    if (!px.empty()) {
+        for (;;) {
+            columns = (uint32_t)std::floor((maxX - minX) / cellSize) + 1;
+            rows = (uint32_t)std::floor((maxY - minY) / cellSize) + 1;
+            if ((uint64_t)columns * rows <= std::max<uint64_t>(1024, 4 * segmentCount)) {
+                break;
+            }
+            cellSize *= 2.0;
+        }
+    }
+    auto cellRange = [&](uint32_t p, uint32_t& c0, uint32_t& c1, uint32_t& r0, uint32_t& r1) {
+        c0 = (uint32_t)((std::min(px[p], px[p + 1]) - minX) / cellSize);
+        c1 = (uint32_t)((std::max(px[p], px[p + 1]) - minX) / cellSize);
+        r0 = (uint32_t)((std::min(py[p], py[p + 1]) - minY) / cellSize);
+        r1 = (uint32_t)((std::max(py[p], py[p + 1]) - minY) / cellSize);
+    };
+    uint64_t cellCount = (uint64_t)columns * rows;
+    std::vector<uint32_t> cellStart(cellCount + 1, 0);
+    std::vector<uint32_t> cellSegments;
+    std::vector<uint32_t> fill;
+    for (int pass = 0; pass < 2; ++pass) {
+        // Pass 0 counts the segments per cell, pass 1 fills them in
+        if (pass == 1) {
+            for (uint64_t c = 0; c < cellCount; ++c) {
+                cellStart[c + 1] += cellStart[c];
+            }
+            cellSegments.resize(cellStart[cellCount]);
+            fill.assign(cellStart.begin(), cellStart.end() - 1);
+        }
+        for (const RoadGraphLane& lane : lanes) {
+            for (uint32_t p = lane.firstPoint; p + 1 < lane.firstPoint + lane.pointCount; ++p) {
+                uint32_t c0, c1, r0, r1;
+                cellRange(p, c0, c1, r0, r1);
+                for (uint32_t r = r0; r <= r1; ++r) {
+                    for (uint32_t c = c0; c <= c1; ++c) {
+                        uint64_t cell = (uint64_t)r * columns + c;
+                        if (pass == 0) {
+                            ++cellStart[cell + 1];
+                        } else {
+                            cellSegments[fill[cell]++] = p;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // 3. Flat image
+    RoadGraphHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, ROAD_GRAPH_MAGIC, sizeof(h.magic));
+    h.formatVersion = ROAD_GRAPH_FORMAT_VERSION;
+    h.headerSize = sizeof(RoadGraphHeader);
+    h.contentHash = hash;
+    h.contentSize = groundTruth.size();
+    h.contentCheck = osiFingerprint(groundTruth.data(), groundTruth.size());
+    h.laneCount = (uint32_t)lanes.size();
+    h.linkCount = (uint32_t)links.size();
+    h.pointCount = (uint32_t)px.size();
+    h.cellEntryCount = (uint32_t)cellSegments.size();
+    h.gridColumns = columns;
+    h.gridRows = rows;
+    h.gridMinX = minX;
+    h.gridMinY = minY;
+    h.cellSize = cellSize;
+
+    uint64_t offset = align8(sizeof(RoadGraphHeader));
+    auto place = [&offset](uint64_t& field, uint64_t bytes) {
+        field = offset;
+        offset = align8(offset + bytes);
+    };
+    place(h.lanesOffset, lanes.size() * sizeof(RoadGraphLane));
+    place(h.linksOffset, links.size() * sizeof(uint32_t));
+    place(h.pointXOffset, px.size() * sizeof(double));
+    place(h.pointYOffset, py.size() * sizeof(double));
+    place(h.pointSOffset, ps.size() * sizeof(double));
+    place(h.pointLaneOffset, pointLane.size() * sizeof(uint32_t));
+    place(h.cellStartOffset, cellStart.size() * sizeof(uint32_t));
+    place(h.cellSegmentsOffset, cellSegments.size() * sizeof(uint32_t));
+    h.imageSize = offset;
+
+    std::shared_ptr<RoadGraph> graph(new RoadGraph());
+    graph->m_image.assign(offset / 8, 0);
+    char* image = reinterpret_cast<char*>(graph->m_image.data());
+    auto copy = [image](uint64_t at, const void* data, size_t bytes) {
+        if (bytes > 0) {
+            std::memcpy(image + at, data, bytes);
+        }
+    };
+    copy(0, &h, sizeof(h));
+    copy(h.lanesOffset, lanes.data(), lanes.size() * sizeof(RoadGraphLane));
+    copy(h.linksOffset, links.data(), links.size() * sizeof(uint32_t));
+    copy(h.pointXOffset, px.data(), px.size() * sizeof(double));
+    copy(h.pointYOffset, py.data(), py.size() * sizeof(double));
+    copy(h.pointSOffset, ps.data(), ps.size() * sizeof(double));
+    copy(h.pointLaneOffset, pointLane.data(), pointLane.size() * sizeof(uint32_t));
+    copy(h.cellStartOffset, cellStart.data(), cellStart.size() * sizeof(uint32_t));
+    copy(h.cellSegmentsOffset, cellSegments.data(), cellSegments.size() * sizeof(uint32_t));
+    graph->m_data = image;
+    graph->m_size = (size_t)offset;
+    return graph;
+}
+
+std::shared_ptr<const RoadGraph> RoadGraph::load(const std::string& path, const std::string& groundTruth,
+                                                 unsigned long long hash) {
+    std::unique_ptr<Mapping> mapping(new Mapping());
+    if (!mapping->open(path)) {
+        return nullptr;
+    }
+    const char* data = static_cast<const char*>(mapping->view);
+    const RoadGraphHeader& h = *reinterpret_cast<const RoadGraphHeader*>(data);
+    if (std::memcmp(h.magic, ROAD_GRAPH_MAGIC, sizeof(h.magic)) != 0 ||
+        h.formatVersion != ROAD_GRAPH_FORMAT_VERSION || h.headerSize != sizeof(RoadGraphHeader) ||
+        h.contentHash != hash || h.contentSize != groundTruth.size() ||
+        h.contentCheck != osiFingerprint(groundTruth.data(), groundTruth.size()) ||
+        !validImage(data, mapping->size)) {
+        return nullptr;
+    }
+    std::shared_ptr<RoadGraph> graph(new RoadGraph());
+    graph->m_data = data;
+    graph->m_size = mapping->size;
+    graph->m_mapping = mapping.release();
+    return graph;
+}
+
+// Written to a temporary file in the same directory and renamed into place, so
+// readers in other processes only ever see complete files. Published files are
+// never modified; a concurrent writer of the same content may replace it with
+// identical bytes, which leaves existing mappings intact.
+bool RoadGraph::store(const std::string& path) const {
+    std::error_code ec;
+    fs::path target(path);
+    fs::create_directories(target.parent_path(), ec);
+#ifdef _WIN32
+    int pid = _getpid();
+#else
+    int pid = (int)getpid();
+#endif
+    fs::path temp = target;
+    temp += "." + std::to_string(pid) + "." + std::to_string(g_tempCounter++) + ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(m_data, (std::streamsize)m_size);
+        out.close();
+        if (!out) {
+            fs::remove(temp, ec);
+            return false;
+        }
+    }
+    fs::rename(temp, target, ec);
+    if (ec) {
+        // Typically another process published the file first (Windows: target in use)
+        fs::remove(temp, ec);
+        return fs::exists(target, ec);
+    }
+    return true;
+}
+
+std::shared_ptr<const RoadGraph> RoadGraph::open(const std::string& cacheDirectory, const std::string& groundTruth,
+                                                 unsigned long long hash, bool& fromCache) {
+    fromCache = false;
+    if (cacheDirectory.empty()) {
+        return build(groundTruth, hash);
+    }
+    std::string path = cachePath(cacheDirectory, hash);
+    if (std::shared_ptr<const RoadGraph> graph = load(path, groundTruth, hash)) {
+        fromCache = true;
+        return graph;
+    }
+    std::shared_ptr<const RoadGraph> graph = build(groundTruth, hash);
+    graph->store(path);
+    return graph;
+}
+
+std::string RoadGraph::cachePath(const std::string& cacheDirectory, unsigned long long hash) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx.v%u.gtrn", hash, ROAD_GRAPH_FORMAT_VERSION);
+    return (fs::path(cacheDirectory) / name).string();
+}
+
+uint32_t RoadGraph::findLane(uint64_t id) const {
+    const RoadGraphLane* begin = lanes();
+    const RoadGraphLane* end = begin + laneCount();
+    const RoadGraphLane* it = std::lower_bound(begin, end, id, [](const RoadGraphLane& lane, uint64_t value) { return lane.id < value; });
+    return it != end && it->id == id ? (uint32_t)(it - begin) : ROAD_GRAPH_NO_LANE;
+}
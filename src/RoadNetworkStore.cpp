@@ -0,0 +1,75 @@
+#include "RoadNetworkStore.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+RoadNetwork::RoadNetwork(unsigned long long hash, std::vector<uint64_t> ids, std::string bytes)
+    : m_hash(hash), m_ids(std::move(ids)), m_bytes(std::move(bytes))
+{
+}
+
+RoadNetwork::~RoadNetwork() {
+    if (m_view) {
+        py::gil_scoped_acquire acquire;
+        m_view = py::object();
+    }
+}
+
+std::shared_ptr<const RoadGraph> RoadNetwork::graph(const std::string& cacheDirectory) {
+    std::lock_guard<std::mutex> lock(m_graphMutex);
+    if (!m_graph) {
+        auto start = std::chrono::steady_clock::now();
+        bool fromCache = false;
+        m_graph = RoadGraph::open(cacheDirectory, m_bytes, m_hash, fromCache);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[GT-DriveController] Road graph " << (fromCache ? "loaded from cache" : "built") << " in " << ms
+                  << " ms: " << m_graph->laneCount() << " lanes, " << m_graph->pointCount() << " centerline points";
+        if (!cacheDirectory.empty()) {
+            std::cout << " (" << RoadGraph::cachePath(cacheDirectory, m_hash) << ")";
+        }
+        std::cout << std::endl;
+    }
+    return m_graph;
+}
+
+RoadNetworkStore& RoadNetworkStore::instance() {
+    static RoadNetworkStore store;
+    return store;
+}
+
+std::shared_ptr<RoadNetwork> RoadNetworkStore::acquire(unsigned long long hash, const std::vector<uint64_t>& ids,
+                                                       const std::vector<std::pair<const char*, const char*>>& ranges) {
+    // Declared before the lock: a network released here is destroyed after unlocking,
+    // since its destructor may wait for the GIL
+    std::shared_ptr<RoadNetwork> existing;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_networks.find(hash);
+    if (it != m_networks.end() && (existing = it->second.lock()) && existing->ids() == ids) {
+        // Same hash and id set: confirm the content before sharing
+        size_t offset = 0;
+        bool same = true;
+        for (const auto& range : ranges) {
+            size_t size = range.second - range.first;
+            same = same && offset + size <= existing->bytes().size() &&
+                   std::memcmp(existing->bytes().data() + offset, range.first, size) == 0;
+            offset += size;
+        }
+        if (same && offset == existing->bytes().size()) {
+            return existing;
+        }
+    }
+
+    std::string bytes;
+    for (const auto& range : ranges) {
+        bytes.append(range.first, range.second - range.first);
+    }
+    auto network = std::make_shared<RoadNetwork>(hash, ids, std::move(bytes));
+    m_networks[hash] = network;
+
+    // Drop entries whose last instance has gone
+    for (auto entry = m_networks.begin(); entry != m_networks.end();) {
+        entry = entry->second.expired() ? m_networks.erase(entry) : std::next(entry);
+    }
+    return network;
+}
@@ -0,0 +1,142 @@
+#include "SensorViewConfig.h"
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+namespace SensorViewConfig {
+
+namespace {
+
+namespace SVC = OsiFields::SensorViewConfiguration;
+namespace SensorFields = OsiFields::SensorTypeViewConfiguration;
+
+// Order matches the field numbers 1000..1004
+const char* const SENSOR_VIEW_NAMES[] = { "generic", "radar", "lidar", "camera", "ultrasonic" };
+constexpr uint32_t SENSOR_VIEW_COUNT = sizeof(SENSOR_VIEW_NAMES) / sizeof(SENSOR_VIEW_NAMES[0]);
+
+// OSI version of the vendored .proto files
+constexpr uint32_t OSI_VERSION[3] = { 3, 5, 0 };
+
+void writeTimestamp(std::string& out, uint32_t number, double seconds) {
+    double whole = std::floor(seconds);
+    std::string ts;
+    OsiWire::writeVarintField(ts, OsiFields::Timestamp::Seconds, (uint64_t)(int64_t)whole);
+    OsiWire::writeVarintField(ts, OsiFields::Timestamp::Nanos, (uint64_t)std::llround((seconds - whole) * 1e9));
+    OsiWire::writeLengthDelimited(out, number, ts.data(), ts.size());
+}
+
+} // namespace
+
+std::vector<std::string> parseSensorViewList(const std::string& spec) {
+    std::vector<std::string> views;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (item.empty()) {
+            continue;
+        }
+        bool known = false;
+        for (const char* name : SENSOR_VIEW_NAMES) {
+            known |= item == name;
+        }
+        if (known) {
+            views.push_back(item);
+        } else {
+            std::cerr << "[GT-DriveController] Warning: Unknown sensor view type '" << item << "' ignored" << std::endl;
+        }
+    }
+    return views;
+}
+
+void buildRequest(const SensorViewRequest& request, std::string& out) {
+    out.clear();
+
+    std::string version;
+    OsiWire::writeVarintField(version, OsiFields::InterfaceVersion::VersionMajor, OSI_VERSION[0]);
+    OsiWire::writeVarintField(version, OsiFields::InterfaceVersion::VersionMinor, OSI_VERSION[1]);
+    OsiWire::writeVarintField(version, OsiFields::InterfaceVersion::VersionPatch, OSI_VERSION[2]);
+    OsiWire::writeLengthDelimited(out, SVC::Version, version.data(), version.size());
+
+    if (request.fieldOfViewHorizontal > 0.0) {
+        OsiWire::writeDoubleField(out, SVC::FieldOfViewHorizontal, request.fieldOfViewHorizontal);
+    }
+    if (request.fieldOfViewVertical > 0.0) {
+        OsiWire::writeDoubleField(out, SVC::FieldOfViewVertical, request.fieldOfViewVertical);
+    }
+    if (request.range > 0.0) {
+        OsiWire::writeDoubleField(out, SVC::Range, request.range);
+    }
+    if (request.updateCycleTime > 0.0) {
+        writeTimestamp(out, SVC::UpdateCycleTime, request.updateCycleTime);
+    }
+    OsiWire::writeVarintField(out, SVC::OmitStaticInformation, request.omitStaticInformation ? 1 : 0);
+
+    // One entry per requested sensor view, with the same field of view
+    for (const std::string& view : request.sensorViews) {
+        for (uint32_t i = 0; i < SENSOR_VIEW_COUNT; ++i) {
+            if (view != SENSOR_VIEW_NAMES[i]) {
+                continue;
+            }
+            std::string entry;
+            if (request.fieldOfViewHorizontal > 0.0) {
+                OsiWire::writeDoubleField(entry, SensorFields::FieldOfViewHorizontal, request.fieldOfViewHorizontal);
+            }
+            if (request.fieldOfViewVertical > 0.0) {
+                OsiWire::writeDoubleField(entry, SensorFields::FieldOfViewVertical, request.fieldOfViewVertical);
+            }
+            OsiWire::writeLengthDelimited(out, SVC::GenericSensorViewConfiguration + i, entry.data(), entry.size());
+        }
+    }
+}
+
+bool parseResponse(const char* data, size_t size, SensorViewRequest& accepted) {
+    accepted = SensorViewRequest();
+    OsiWire::Reader reader(data, size);
+    OsiWire::Field field;
+    while (reader.next(field)) {
+        switch (field.number) {
+            case SVC::FieldOfViewHorizontal: accepted.fieldOfViewHorizontal = OsiWire::readDouble(field); break;
+            case SVC::FieldOfViewVertical: accepted.fieldOfViewVertical = OsiWire::readDouble(field); break;
+            case SVC::Range: accepted.range = OsiWire::readDouble(field); break;
+            case SVC::OmitStaticInformation: accepted.omitStaticInformation = field.varint != 0; break;
+            case SVC::UpdateCycleTime: {
+                OsiWire::Reader ts(field.data, field.size);
+                OsiWire::Field tsField;
+                while (ts.next(tsField)) {
+                    if (tsField.number == OsiFields::Timestamp::Seconds) {
+                        accepted.updateCycleTime += (double)(int64_t)tsField.varint;
+                    } else if (tsField.number == OsiFields::Timestamp::Nanos) {
+                        accepted.updateCycleTime += tsField.varint * 1e-9;
+                    }
+                }
+                break;
+            }
+            default:
+                if (field.number >= SVC::GenericSensorViewConfiguration && field.number < SVC::GenericSensorViewConfiguration + SENSOR_VIEW_COUNT) {
+                    accepted.sensorViews.push_back(SENSOR_VIEW_NAMES[field.number - SVC::GenericSensorViewConfiguration]);
+                }
+                break;
+        }
+    }
+    return reader.ok();
+}
+
+std::string describe(const SensorViewRequest& config) {
+    std::ostringstream ss;
+    ss << "fov " << config.fieldOfViewHorizontal << " x " << config.fieldOfViewVertical << " rad"
+       << ", range " << config.range << " m"
+       << ", cycle " << config.updateCycleTime << " s"
+       << ", omit static " << (config.omitStaticInformation ? "yes" : "no")
+       << ", sensor views [";
+    for (size_t i = 0; i < config.sensorViews.size(); ++i) {
+        ss << (i ? "," : "") << config.sensorViews[i];
+    }
+    ss << "]";
+    return ss.str();
+}
+
+} // namespace SensorViewConfig
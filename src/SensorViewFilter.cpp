@@ -0,0 +1,571 @@
+#include "SensorViewFilter.h"
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+using OsiWire::Field;
+using OsiWire::WireType;
+
+// Position, yaw and horizontal extent of a BaseMoving / BaseStationary
+struct Footprint {
+    bool valid = false;
+    double x = 0.0;
+    double y = 0.0;
+    double yaw = 0.0;
+    double extent = 0.0; // Half of the larger of length and width
+};
+
+void readBase(const Field& base, Footprint& fp) {
+    if (base.type != WireType::LengthDelimited) {
+        return;
+    }
+    OsiWire::Reader reader(base.data, base.size);
+    Field f;
+    double v[3];
+    while (reader.next(f)) {
+        switch (f.number) {
+            case OsiFields::BaseMoving::Dimension:
+                if (OsiWire::readVector3d(f, v)) {
+                    fp.extent = 0.5 * std::max(v[0], v[1]);
+                }
+                break;
+            case OsiFields::BaseMoving::Position:
+                if (OsiWire::readVector3d(f, v)) {
+                    fp.x = v[0];
+                    fp.y = v[1];
+                    fp.valid = std::isfinite(fp.x) && std::isfinite(fp.y);
+                }
+                break;
+            case OsiFields::BaseMoving::Orientation:
+                if (OsiWire::readVector3d(f, v)) {
+                    fp.yaw = v[2];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    if (!reader.ok()) {
+        fp.valid = false;
+    }
+}
+
+bool typeAllowed(uint32_t mask, uint64_t type) {
+    return type >= 32 || ((mask >> type) & 1u) != 0;
+}
+
+// Filter area in the host vehicle frame
+class Area {
+public:
+    Area(const SensorViewFilterSettings& settings, const Footprint& host)
+        : m_settings(settings), m_x(host.x), m_y(host.y),
+          m_cos(std::cos(host.yaw)), m_sin(std::sin(host.yaw)),
+          m_corridor(settings.corridorLateral > 0.0) {}
+
+    bool containsPoint(double x, double y, double extent) const {
+        double lon, lat;
+        toLocal(x, y, lon, lat);
+        if (m_settings.radius > 0.0 && std::hypot(lon, lat) > m_settings.radius + extent) {
+            return false;
+        }
+        if (m_corridor && (lon > m_settings.corridorFront + extent || lon < -m_settings.corridorRear - extent ||
+                           std::fabs(lat) > m_settings.corridorLateral + extent)) {
+            return false;
+        }
+        return true;
+    }
+
+    // True if the segment a-b passes within the radius and through the corridor
+    bool crossesSegment(double ax, double ay, double bx, double by) const {
+        double a[2], b[2];
+        toLocal(ax, ay, a[0], a[1]);
+        toLocal(bx, by, b[0], b[1]);
+        if (m_settings.radius > 0.0 && distanceToOrigin(a, b) > m_settings.radius) {
+            return false;
+        }
+        return !m_corridor || clipsCorridor(a, b);
+    }
+
+private:
+    void toLocal(double x, double y, double& lon, double& lat) const {
+        double dx = x - m_x;
+        double dy = y - m_y;
+        lon = m_cos * dx + m_sin * dy;
+        lat = -m_sin * dx + m_cos * dy;
+    }
+
+    static double distanceToOrigin(const double a[2], const double b[2]) {
+        double d[2] = { b[0] - a[0], b[1] - a[1] };
+        double len2 = d[0] * d[0] + d[1] * d[1];
+        double t = len2 > 0.0 ? std::clamp(-(a[0] * d[0] + a[1] * d[1]) / len2, 0.0, 1.0) : 0.0;
+        return std::hypot(a[0] + t * d[0], a[1] + t * d[1]);
+    }
+
+    // Liang-Barsky clipping against the corridor rectangle
+    bool clipsCorridor(const double a[2], const double b[2]) const {
+        double dx = b[0] - a[0];
+        double dy = b[1] - a[1];
+        const double p[4] = { -dx, dx, -dy, dy };
+        const double q[4] = { a[0] + m_settings.corridorRear, m_settings.corridorFront - a[0],
+                              a[1] + m_settings.corridorLateral, m_settings.corridorLateral - a[1] };
+        double t0 = 0.0, t1 = 1.0;
+        for (int i = 0; i < 4; ++i) {
+            if (p[i] == 0.0) {
+                if (q[i] < 0.0) {
+                    return false;
+                }
+                continue;
+            }
+            double r = q[i] / p[i];
+            if (p[i] < 0.0) {
+                t0 = std::max(t0, r);
+            } else {
+                t1 = std::min(t1, r);
+            }
+            if (t0 > t1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const SensorViewFilterSettings& m_settings;
+    double m_x, m_y, m_cos, m_sin;
+    bool m_corridor;
+};
+
+// Polyline test: kept if it has no points or any segment crosses the area
+class PolylineTest {
+public:
+    explicit PolylineTest(const Area& area) : m_area(area) {}
+
+    void add(const Field& point) {
+        double v[3];
+        if (m_hit || !OsiWire::readVector3d(point, v)) {
+            return;
+        }
+        m_hit = m_any ? m_area.crossesSegment(m_prev[0], m_prev[1], v[0], v[1])
+                      : m_area.containsPoint(v[0], v[1], 0.0);
+        m_any = true;
+        m_prev[0] = v[0];
+        m_prev[1] = v[1];
+    }
+
+    bool keep() const { return !m_any || m_hit; }
+
+private:
+    const Area& m_area;
+    bool m_any = false;
+    bool m_hit = false;
+    double m_prev[2] = {};
+};
+
+bool keepMovingObject(const Field& field, const Area& area, uint64_t hostId, uint32_t mask) {
+    using namespace OsiFields;
+    uint64_t id = 0;
+    bool hasId = false;
+    uint64_t type = 0;
+    Footprint fp;
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        switch (f.number) {
+            case MovingObject::Id:   hasId = OsiWire::readIdentifier(f, id); break;
+            case MovingObject::Base: readBase(f, fp); break;
+            case MovingObject::Type: type = f.varint; break;
+            default: break;
+        }
+    }
+    if (!reader.ok() || (hasId && id == hostId)) {
+        return true;
+    }
+    if (!typeAllowed(mask, type)) {
+        return false;
+    }
+    return !fp.valid || area.containsPoint(fp.x, fp.y, fp.extent);
+}
+
+bool keepStationaryObject(const Field& field, const Area& area, uint32_t mask) {
+    using namespace OsiFields;
+    uint64_t type = 0;
+    Footprint fp;
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.number == StationaryObject::Base) {
+            readBase(f, fp);
+        } else if (f.number == StationaryObject::Classification && f.type == WireType::LengthDelimited) {
+            OsiWire::Reader classification(f.data, f.size);
+            Field c;
+            while (classification.next(c)) {
+                if (c.number == StationaryObjectClassification::Type && c.type == WireType::Varint) {
+                    type = c.varint;
+                }
+            }
+        }
+    }
+    if (!reader.ok()) {
+        return true;
+    }
+    if (!typeAllowed(mask, type)) {
+        return false;
+    }
+    return !fp.valid || area.containsPoint(fp.x, fp.y, fp.extent);
+}
+
+// Elements with a BaseStationary at baseField (traffic lights, road markings,
+// and the main sign of traffic signs)
+bool keepStationaryBase(const Field& field, uint32_t baseField, const Area& area) {
+    Footprint fp;
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.number == baseField) {
+            readBase(f, fp);
+        }
+    }
+    return !reader.ok() || !fp.valid || area.containsPoint(fp.x, fp.y, fp.extent);
+}
+
+bool keepTrafficSign(const Field& field, const Area& area) {
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.number == OsiFields::TrafficSign::MainSign && f.type == WireType::LengthDelimited) {
+            return keepStationaryBase(f, OsiFields::MainSign::Base, area);
+        }
+    }
+    return true;
+}
+
+bool keepLaneBoundary(const Field& field, const Area& area) {
+    PolylineTest polyline(area);
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.number != OsiFields::LaneBoundary::BoundaryLine || f.type != WireType::LengthDelimited) {
+            continue;
+        }
+        OsiWire::Reader point(f.data, f.size);
+        Field p;
+        while (point.next(p)) {
+            if (p.number == OsiFields::BoundaryPoint::Position) {
+                polyline.add(p);
+            }
+        }
+    }
+    return !reader.ok() || polyline.keep();
+}
+
+bool keepLane(const Field& field, const Area& area) {
+    PolylineTest polyline(area);
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.number != OsiFields::Lane::Classification || f.type != WireType::LengthDelimited) {
+            continue;
+        }
+        OsiWire::Reader classification(f.data, f.size);
+        Field c;
+        while (classification.next(c)) {
+            if (c.number == OsiFields::LaneClassification::Centerline) {
+                polyline.add(c);
+            }
+        }
+    }
+    return !reader.ok() || polyline.keep();
+}
+
+// Lane id of a removed lane, and the lane boundary ids of a kept lane
+void collectLaneReferences(const Field& field, bool keep, std::vector<uint64_t>& removedLanes,
+                           std::vector<uint64_t>& boundaryRefs) {
+    using namespace OsiFields;
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    uint64_t id = 0;
+    while (reader.next(f)) {
+        if (f.number == Lane::Id) {
+            if (!keep && OsiWire::readIdentifier(f, id)) {
+                removedLanes.push_back(id);
+            }
+        } else if (keep && f.number == Lane::Classification && f.type == WireType::LengthDelimited) {
+            OsiWire::Reader classification(f.data, f.size);
+            Field c;
+            while (classification.next(c)) {
+                if ((c.number == LaneClassification::RightLaneBoundaryId ||
+                     c.number == LaneClassification::LeftLaneBoundaryId ||
+                     c.number == LaneClassification::FreeLaneBoundaryId) && OsiWire::readIdentifier(c, id)) {
+                    boundaryRefs.push_back(id);
+                }
+            }
+        }
+    }
+}
+
+bool laneBoundaryId(const Field& field, uint64_t& id) {
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    while (reader.next(f)) {
+        if (f.number == OsiFields::LaneBoundary::Id) {
+            return OsiWire::readIdentifier(f, id);
+        }
+    }
+    return false;
+}
+
+bool isRemoved(const Field& identifier, const std::vector<uint64_t>& removed) {
+    uint64_t id = 0;
+    return OsiWire::readIdentifier(identifier, id) && std::binary_search(removed.begin(), removed.end(), id);
+}
+
+// LanePairing without the removed antecessor / successor. Returns the number of
+// dropped ids; pairing is only written if it is not 0.
+uint32_t stripPairing(const Field& field, const std::vector<uint64_t>& removed, std::string& pairing) {
+    pairing.clear();
+    uint32_t dropped = 0;
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    const char* run = field.data;
+    while (reader.next(f)) {
+        if ((f.number == OsiFields::LanePairing::AntecessorLaneId || f.number == OsiFields::LanePairing::SuccessorLaneId) &&
+            isRemoved(f, removed)) {
+            pairing.append(run, f.begin - run);
+            run = f.end;
+            ++dropped;
+        }
+    }
+    if (!reader.ok()) {
+        return 0;
+    }
+    pairing.append(run, (field.data + field.size) - run);
+    return dropped;
+}
+
+// Kept lane without the adjacent lane and lane pairing ids of removed lanes; a
+// pairing left empty is dropped. Returns the number of dropped ids; lane is only
+// written if it is not 0.
+uint32_t stripLaneReferences(const Field& field, const std::vector<uint64_t>& removed,
+                             std::string& lane, std::string& classification, std::string& pairing) {
+    using namespace OsiFields;
+    lane.clear();
+    uint32_t dropped = 0;
+    OsiWire::Reader reader(field.data, field.size);
+    Field f;
+    const char* run = field.data;
+    while (reader.next(f)) {
+        if (f.number != Lane::Classification || f.type != WireType::LengthDelimited) {
+            continue;
+        }
+        classification.clear();
+        uint32_t droppedHere = 0;
+        OsiWire::Reader references(f.data, f.size);
+        Field c;
+        const char* classificationRun = f.data;
+        while (references.next(c)) {
+            uint32_t n = 0;
+            if (c.number == LaneClassification::LeftAdjacentLaneId || c.number == LaneClassification::RightAdjacentLaneId) {
+                n = isRemoved(c, removed) ? 1 : 0;
+            } else if (c.number == LaneClassification::LanePairing && c.type == WireType::LengthDelimited) {
+                n = stripPairing(c, removed, pairing);
+            }
+            if (n == 0) {
+                continue;
+            }
+            classification.append(classificationRun, c.begin - classificationRun);
+            classificationRun = c.end;
+            if (c.number == LaneClassification::LanePairing && !pairing.empty()) {
+                OsiWire::writeLengthDelimited(classification, LaneClassification::LanePairing, pairing.data(), pairing.size());
+            }
+            droppedHere += n;
+        }
+        if (!references.ok() || droppedHere == 0) {
+            continue;
+        }
+        classification.append(classificationRun, (f.data + f.size) - classificationRun);
+        lane.append(run, f.begin - run);
+        OsiWire::writeLengthDelimited(lane, Lane::Classification, classification.data(), classification.size());
+        run = f.end;
+        dropped += droppedHere;
+    }
+    if (!reader.ok()) {
+        return 0;
+    }
+    if (dropped > 0) {
+        lane.append(run, (field.data + field.size) - run);
+    }
+    return dropped;
+}
+
+} // namespace
+
+bool SensorViewFilter::apply(const char* sensorView, size_t size, std::string& out, std::string& error) {
+    using namespace OsiFields;
+    m_stats = SensorViewFilterStats();
+    m_stats.bytesIn = size;
+    m_removed.clear();
+    out.clear();
+
+    // 1. SensorView top level: global_ground_truth and host_vehicle_id
+    OsiWire::Reader reader(sensorView, size);
+    Field field;
+    Field gt;
+    bool hasGt = false;
+    uint64_t hostId = 0;
+    bool hasHostId = false;
+    while (reader.next(field)) {
+        if (field.number == SensorView::GlobalGroundTruth && field.type == WireType::LengthDelimited && !hasGt) {
+            gt = field;
+            hasGt = true;
+        } else if (field.number == SensorView::HostVehicleId) {
+            hasHostId = OsiWire::readIdentifier(field, hostId);
+        }
+    }
+    if (!reader.ok()) {
+        error = "malformed SensorView";
+        return false;
+    }
+
+    // 2. Host vehicle pose (GroundTruth.host_vehicle_id takes precedence)
+    Footprint host;
+    if (hasGt) {
+        OsiWire::Reader ids(gt.data, gt.size);
+        while (ids.next(field)) {
+            if (field.number == GroundTruth::HostVehicleId) {
+                hasHostId = OsiWire::readIdentifier(field, hostId);
+            }
+        }
+        OsiWire::Reader objects(gt.data, gt.size);
+        while (hasHostId && !host.valid && objects.next(field)) {
+            if (field.number != GroundTruth::MovingObject || field.type != WireType::LengthDelimited) {
+                continue;
+            }
+            OsiWire::Reader object(field.data, field.size);
+            Field f;
+            Field base;
+            uint64_t id = 0;
+            bool isHost = false;
+            while (object.next(f)) {
+                if (f.number == MovingObject::Id) {
+                    isHost = OsiWire::readIdentifier(f, id) && id == hostId;
+                } else if (f.number == MovingObject::Base) {
+                    base = f;
+                }
+            }
+            if (isHost) {
+                readBase(base, host);
+            }
+        }
+    }
+    if (!host.valid) {
+        // No ego reference: pass the SensorView through unchanged
+        out.assign(sensorView, size);
+        m_stats.bytesOut = size;
+        return true;
+    }
+    m_stats.hostFound = true;
+
+    // 3. Decide per element. Lanes also record the ids needed to keep the remaining
+    //    ground truth consistent: their own id if removed, their boundaries if kept.
+    Area area(settings, host);
+    m_keep.clear();
+    m_removedLanes.clear();
+    m_boundaryRefs.clear();
+    OsiWire::Reader elements(gt.data, gt.size);
+    while (elements.next(field)) {
+        bool keep = true;
+        if (field.type == WireType::LengthDelimited) {
+            switch (field.number) {
+                case GroundTruth::MovingObject:
+                    keep = keepMovingObject(field, area, hostId, settings.movingTypeMask);
+                    break;
+                case GroundTruth::StationaryObject:
+                    keep = keepStationaryObject(field, area, settings.stationaryTypeMask);
+                    break;
+                case GroundTruth::TrafficSign:
+                    keep = keepTrafficSign(field, area);
+                    break;
+                case GroundTruth::TrafficLight:
+                case GroundTruth::RoadMarking:
+                    keep = keepStationaryBase(field, TrafficLight::Base, area);
+                    break;
+                case GroundTruth::LaneBoundary:
+                    keep = keepLaneBoundary(field, area);
+                    break;
+                case GroundTruth::Lane:
+                    keep = keepLane(field, area);
+                    collectLaneReferences(field, keep, m_removedLanes, m_boundaryRefs);
+                    break;
+                default:
+                    break;
+            }
+        }
+        m_keep.push_back(keep ? 1 : 0);
+    }
+    if (!elements.ok()) {
+        error = "malformed GroundTruth";
+        return false;
+    }
+    std::sort(m_removedLanes.begin(), m_removedLanes.end());
+    std::sort(m_boundaryRefs.begin(), m_boundaryRefs.end());
+
+    // 4. Rewrite global_ground_truth without the removed elements. Runs of kept
+    //    fields are copied verbatim; only lanes referencing a removed lane are re-encoded.
+    m_groundTruth.clear();
+    int ordinal[32] = {}; // Index of the next element per GroundTruth field number
+    bool changed = false;
+    OsiWire::Reader rewrite(gt.data, gt.size);
+    const char* run = gt.data;
+    for (size_t i = 0; rewrite.next(field); ++i) {
+        int index = field.number < 32 ? ordinal[field.number]++ : 0;
+        bool keep = m_keep[i] != 0;
+        uint64_t id = 0;
+        if (!keep && field.number == GroundTruth::LaneBoundary) {
+            keep = laneBoundaryId(field, id) && std::binary_search(m_boundaryRefs.begin(), m_boundaryRefs.end(), id);
+        }
+        if (keep) {
+            if (field.number != GroundTruth::Lane || field.type != WireType::LengthDelimited || m_removedLanes.empty()) {
+                continue;
+            }
+            uint32_t dropped = stripLaneReferences(field, m_removedLanes, m_lane, m_classification, m_pairing);
+            if (dropped == 0) {
+                continue;
+            }
+            m_groundTruth.append(run, field.begin - run);
+            OsiWire::writeLengthDelimited(m_groundTruth, GroundTruth::Lane, m_lane.data(), m_lane.size());
+            run = field.end;
+            m_stats.referencesRemoved += dropped;
+            changed = true;
+            continue;
+        }
+        m_groundTruth.append(run, field.begin - run);
+        run = field.end;
+        m_removed.push_back({ field.number, index });
+        bool lane = field.number == GroundTruth::Lane || field.number == GroundTruth::LaneBoundary;
+        ++(lane ? m_stats.lanesRemoved : m_stats.objectsRemoved);
+        changed = true;
+    }
+
+    if (!changed) {
+        out.assign(sensorView, size);
+    } else {
+        m_groundTruth.append(run, (gt.data + gt.size) - run);
+        out.append(sensorView, gt.begin - sensorView);
+        OsiWire::writeLengthDelimited(out, SensorView::GlobalGroundTruth, m_groundTruth.data(), m_groundTruth.size());
+        out.append(gt.end, (sensorView + size) - gt.end);
+    }
+    m_stats.bytesOut = out.size();
+    return true;
+}
+
+int SensorViewFilter::originalIndex(uint32_t field, int index) const {
+    // m_removed is in input order, so the indices per field are ascending
+    for (const Removed& removed : m_removed) {
+        if (removed.field == field && removed.index <= index) {
+            ++index;
+        }
+    }
+    return index;
+}
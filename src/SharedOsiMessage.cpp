@@ -0,0 +1,126 @@
+#include "SharedOsiMessage.h"
+
+#ifdef GTDC_WITH_OSI_CPP
+#include "osi_groundtruth.pb.h"
+#include "osi_sensordata.pb.h"
+#include "osi_sensorview.pb.h"
+#include "osi_trafficcommand.pb.h"
+#include "google/protobuf/proto_api.h"
+
+// Message types that can be shared. Referencing the generated classes also keeps
+// their descriptors linked in from the static OSI library.
+static const google::protobuf::Message* findPrototype(const std::string& typeName) {
+    static const google::protobuf::Message* const prototypes[] = {
+        &osi3::SensorView::default_instance(),
+        &osi3::SensorData::default_instance(),
+        &osi3::GroundTruth::default_instance(),
+        &osi3::TrafficCommand::default_instance(),
+    };
+    for (const google::protobuf::Message* prototype : prototypes) {
+        if (prototype->GetDescriptor()->full_name() == typeName) {
+            return prototype;
+        }
+    }
+    return nullptr;
+}
+
+struct SharedOsiMessage::Impl {
+    std::unique_ptr<google::protobuf::Message> message;
+    const google::protobuf::python::PyProto_API* api = nullptr;
+};
+
+SharedOsiMessage::SharedOsiMessage(const std::string& typeName)
+    : m_typeName(typeName), m_impl(std::make_unique<Impl>())
+{
+}
+
+SharedOsiMessage::~SharedOsiMessage() = default;
+
+bool SharedOsiMessage::initialize(std::string& error) {
+    const google::protobuf::Message* prototype = findPrototype(m_typeName);
+    if (!prototype) {
+        error = "no C++ binding for " + m_typeName;
+        return false;
+    }
+
+    // The C++ message can only be shared with the 'cpp' backend; upb and the
+    // pure-Python implementation keep their own message representation
+    std::string backend = py::module::import("google.protobuf.internal.api_implementation")
+                              .attr("Type")().cast<std::string>();
+    if (backend != "cpp") {
+        error = "Python protobuf backend is '" + backend + "', native decode requires 'cpp'";
+        return false;
+    }
+
+    m_impl->api = static_cast<const google::protobuf::python::PyProto_API*>(
+        PyCapsule_Import(google::protobuf::python::PyProtoAPICapsuleName(), 0));
+    if (!m_impl->api) {
+        PyErr_Clear();
+        error = std::string("Capsule ") + google::protobuf::python::PyProtoAPICapsuleName() + " not available";
+        return false;
+    }
+
+    // Python must resolve the type to the descriptor compiled into this library
+    const google::protobuf::DescriptorPool* pool = m_impl->api->GetDefaultDescriptorPool();
+    if (pool->FindMessageTypeByName(m_typeName) != prototype->GetDescriptor()) {
+        error = "Python descriptor pool does not share the C++ generated pool (different libprotobuf?)";
+        return false;
+    }
+
+    m_impl->message.reset(prototype->New());
+    return true;
+}
+
+bool SharedOsiMessage::parse(const void* data, size_t size) {
+    // Clear() inside ParseFromArray keeps allocated repeated fields for reuse
+    return m_impl->message->ParseFromArray(data, (int)size);
+}
+
+py::object SharedOsiMessage::pythonMessage() {
+    PyObject* obj = m_impl->api->NewMessageOwnedExternally(m_impl->message.get(), nullptr);
+    if (!obj) {
+        throw py::error_already_set();
+    }
+    return py::reinterpret_steal<py::object>(obj);
+}
+
+bool SharedOsiMessage::isSharedMessage(const py::handle& obj) const {
+    const google::protobuf::Message* msg = m_impl->api->GetMessagePointer(obj.ptr());
+    if (!msg) {
+        PyErr_Clear();
+        return false;
+    }
+    return msg == m_impl->message.get();
+}
+
+bool SharedOsiMessage::serialize(const py::handle& obj, std::string& out) const {
+    const google::protobuf::Message* msg = m_impl->api->GetMessagePointer(obj.ptr());
+    if (!msg) {
+        PyErr_Clear();
+        return false;
+    }
+    return msg->SerializeToString(&out);
+}
+
+#else // GTDC_WITH_OSI_CPP
+
+struct SharedOsiMessage::Impl {};
+
+SharedOsiMessage::SharedOsiMessage(const std::string& typeName)
+    : m_typeName(typeName)
+{
+}
+
+SharedOsiMessage::~SharedOsiMessage() = default;
+
+bool SharedOsiMessage::initialize(std::string& error) {
+    error = "built without GTDC_WITH_OSI_CPP";
+    return false;
+}
+
+bool SharedOsiMessage::parse(const void*, size_t) { return false; }
+py::object SharedOsiMessage::pythonMessage() { return py::none(); }
+bool SharedOsiMessage::isSharedMessage(const py::handle&) const { return false; }
+bool SharedOsiMessage::serialize(const py::handle&, std::string&) const { return false; }
+
+#endif // GTDC_WITH_OSI_CPP
@@ -0,0 +1,339 @@
+#include "SignalLog.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t BLOCK_POOL_SIZE = 4;
+
+size_t align8(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+uint32_t widthOf(SignalType type) {
+    switch (type) {
+        case SignalType::Float64: return 8;
+        case SignalType::Float32: return 4;
+        case SignalType::Int32:   return 4;
+        case SignalType::UInt8:   return 1;
+    }
+    return 0;
+}
+
+// Integer columns: rounded and saturated, NaN as 0
+void store(uint8_t* out, SignalType type, double value) {
+    switch (type) {
+        case SignalType::Float64:
+            std::memcpy(out, &value, 8);
+            break;
+        case SignalType::Float32: {
+            float v = (float)value;
+            std::memcpy(out, &v, 4);
+            break;
+        }
+        case SignalType::Int32: {
+            double r = std::isnan(value) ? 0.0 : std::fmin(2147483647.0, std::fmax(-2147483648.0, std::round(value)));
+            int32_t v = (int32_t)r;
+            std::memcpy(out, &v, 4);
+            break;
+        }
+        case SignalType::UInt8: {
+            double r = std::isnan(value) ? 0.0 : std::fmin(255.0, std::fmax(0.0, std::round(value)));
+            *out = (uint8_t)r;
+            break;
+        }
+    }
+}
+
+bool writeAll(FILE* file, const void* data, size_t size) {
+    return size == 0 || std::fwrite(data, 1, size, file) == size;
+}
+
+} // namespace
+
+SignalLog::SignalLog() {
+    std::string error;
+    addColumn("time", SignalType::Float64, error);
+}
+
+SignalLog::~SignalLog() {
+    std::string error;
+    close(error);
+}
+
+int SignalLog::addColumn(const std::string& name, SignalType type, std::string& error) {
+    std::lock_guard<std::mutex> lock(m_rowMutex);
+    if (m_frozen) {
+        error = "signal log columns are fixed after the first row";
+        return -1;
+    }
+    if (name.empty() || name.size() >= SIGNAL_LOG_NAME_SIZE) {
+        error = "signal name must have 1 to " + std::to_string(SIGNAL_LOG_NAME_SIZE - 1) + " characters";
+        return -1;
+    }
+    if (widthOf(type) == 0) {
+        error = "unknown signal type";
+        return -1;
+    }
+    for (const SignalLogColumn& column : m_columns) {
+        if (name == column.name) {
+            error = "signal '" + name + "' already exists";
+            return -1;
+        }
+    }
+    SignalLogColumn column = {};
+    std::memcpy(column.name, name.data(), name.size());
+    column.type = (uint32_t)type;
+    column.width = widthOf(type);
+    m_columns.push_back(column);
+    m_row.push_back(std::numeric_limits<double>::quiet_NaN());
+    return (int)m_columns.size() - 1;
+}
+
+int SignalLog::findColumn(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(m_rowMutex);
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        if (name == m_columns[c].name) {
+            return (int)c;
+        }
+    }
+    return -1;
+}
+
+std::vector<std::string> SignalLog::columnNames() const {
+    std::lock_guard<std::mutex> lock(m_rowMutex);
+    std::vector<std::string> names;
+    for (const SignalLogColumn& column : m_columns) {
+        names.push_back(column.name);
+    }
+    return names;
+}
+
+size_t SignalLog::columnCount() const {
+    std::lock_guard<std::mutex> lock(m_rowMutex);
+    return m_columns.size();
+}
+
+bool SignalLog::frozen() const {
+    std::lock_guard<std::mutex> lock(m_rowMutex);
+    return m_frozen;
+}
+
+unsigned long long SignalLog::blocks() const {
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    return m_index.size();
+}
+
+bool SignalLog::open(const std::string& path, size_t blockRows, std::string& error) {
+    if (m_file) {
+        error = "signal log already open";
+        return false;
+    }
+    if (blockRows == 0) {
+        error = "block size must be at least one row";
+        return false;
+    }
+#ifdef _WIN32
+    m_file = _wfopen(fs::path(path).wstring().c_str(), L"wb");
+#else
+    m_file = std::fopen(path.c_str(), "wb");
+#endif
+    if (!m_file) {
+        error = "cannot create " + path;
+        return false;
+    }
+    m_path = path;
+    m_blockRows = blockRows;
+    m_thread = std::thread(&SignalLog::run, this);
+    return true;
+}
+
+void SignalLog::set(size_t column, double value) {
+    std::lock_guard<std::mutex> lock(m_rowMutex);
+    if (column < m_row.size()) {
+        m_row[column] = value;
+    }
+}
+
+void SignalLog::set(size_t firstColumn, const double* values, size_t count) {
+    std::lock_guard<std::mutex> lock(m_rowMutex);
+    for (size_t i = 0; i < count && firstColumn + i < m_row.size(); ++i) {
+        m_row[firstColumn + i] = values[i];
+    }
+}
+
+// First row: column layout of the blocks, block pool and file header.
+// The writer thread has nothing to write yet, so the file is still ours.
+void SignalLog::freeze() {
+    m_frozen = true;
+    m_columnOffset.resize(m_columns.size());
+    m_blockBytes = 0;
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        m_columnOffset[c] = m_blockBytes;
+        m_blockBytes += align8(m_blockRows * m_columns[c].width);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_pool.resize(BLOCK_POOL_SIZE);
+        m_free.reserve(BLOCK_POOL_SIZE);
+        m_full.reserve(BLOCK_POOL_SIZE);
+        for (Block& block : m_pool) {
+            block.data.assign(m_blockBytes, 0);
+            m_free.push_back(&block);
+        }
+        m_current = m_free.back();
+        m_free.pop_back();
+    }
+
+    SignalLogHeader header = {};
+    std::memcpy(header.magic, SIGNAL_LOG_MAGIC, sizeof(header.magic));
+    header.formatVersion = SIGNAL_LOG_FORMAT_VERSION;
+    header.headerSize = (uint32_t)(sizeof(SignalLogHeader) + m_columns.size() * sizeof(SignalLogColumn));
+    header.columnCount = (uint32_t)m_columns.size();
+    header.blockRows = (uint32_t)m_blockRows;
+    if (!writeAll(m_file, &header, sizeof(header)) ||
+        !writeAll(m_file, m_columns.data(), m_columns.size() * sizeof(SignalLogColumn))) {
+        m_writeFailed = true;
+    }
+    m_offset = header.headerSize;
+}
+
+void SignalLog::append(double time) {
+    if (!m_file) {
+        return;
+    }
+    std::lock_guard<std::mutex> rowLock(m_rowMutex);
+    if (!m_frozen) {
+        freeze();
+    }
+    if (!m_current) {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (!m_free.empty()) {
+            m_current = m_free.back();
+            m_free.pop_back();
+        }
+    }
+    if (!m_current) {
+        ++m_dropped;
+        return;
+    }
+
+    m_row[0] = time;
+    Block& block = *m_current;
+    if (block.rows == 0) {
+        block.firstRow = m_rows;
+        block.firstTime = time;
+    }
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        SignalType type = (SignalType)m_columns[c].type;
+        store(&block.data[m_columnOffset[c] + block.rows * m_columns[c].width], type, m_row[c]);
+    }
+    block.lastTime = time;
+    ++block.rows;
+    ++m_rows;
+
+    if (block.rows == m_blockRows) {
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            m_full.push_back(m_current);
+            m_current = nullptr;
+            if (!m_free.empty()) {
+                m_current = m_free.back();
+                m_free.pop_back();
+            }
+        }
+        m_cvFull.notify_one();
+    }
+}
+
+// Writer thread
+void SignalLog::writeBlock(const Block& block) {
+    static const uint8_t PADDING[8] = {};
+    SignalLogBlockHeader header = {};
+    std::memcpy(header.magic, SIGNAL_LOG_BLOCK_MAGIC, sizeof(header.magic));
+    header.rows = (uint32_t)block.rows;
+    header.firstRow = block.firstRow;
+    bool ok = writeAll(m_file, &header, sizeof(header));
+    uint64_t size = sizeof(header);
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        size_t bytes = block.rows * m_columns[c].width;
+        ok = ok && writeAll(m_file, &block.data[m_columnOffset[c]], bytes)
+                && writeAll(m_file, PADDING, align8(bytes) - bytes);
+        size += align8(bytes);
+    }
+    ok = ok && std::fflush(m_file) == 0;
+
+    SignalLogBlock entry = {};
+    entry.offset = m_offset;
+    entry.firstRow = block.firstRow;
+    entry.rows = (uint32_t)block.rows;
+    entry.firstTime = block.firstTime;
+    entry.lastTime = block.lastTime;
+    m_offset += size;
+    std::lock_guard<std::mutex> lock(m_queueMutex);
+    m_index.push_back(entry);
+    m_writeFailed = m_writeFailed || !ok;
+}
+
+void SignalLog::run() {
+    for (;;) {
+        Block* block;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_cvFull.wait(lock, [this] { return m_stop || !m_full.empty(); });
+            if (m_full.empty()) {
+                return; // Stop requested and everything written
+            }
+            block = m_full.front();
+        }
+
+        writeBlock(*block);
+
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_full.erase(m_full.begin());
+        block->rows = 0;
+        m_free.push_back(block);
+    }
+}
+
+bool SignalLog::close(std::string& error) {
+    if (!m_file) {
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> rowLock(m_rowMutex);
+        if (!m_frozen) {
+            freeze(); // No rows: a valid empty log
+        }
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (m_current && m_current->rows > 0) {
+            m_full.push_back(m_current);
+        }
+        m_current = nullptr;
+        m_stop = true;
+    }
+    m_cvFull.notify_one();
+    m_thread.join();
+
+    SignalLogFooter footer = {};
+    std::memcpy(footer.magic, SIGNAL_LOG_FOOTER_MAGIC, sizeof(footer.magic));
+    footer.rowCount = m_rows;
+    footer.blockCount = m_index.size();
+    SignalLogTrailer trailer = {};
+    trailer.footerOffset = m_offset;
+    std::memcpy(trailer.magic, SIGNAL_LOG_MAGIC, sizeof(trailer.magic));
+    bool ok = !m_writeFailed
+        && writeAll(m_file, &footer, sizeof(footer))
+        && writeAll(m_file, m_index.data(), m_index.size() * sizeof(SignalLogBlock))
+        && writeAll(m_file, &trailer, sizeof(trailer));
+    ok = std::fclose(m_file) == 0 && ok;
+    m_file = nullptr;
+    if (!ok) {
+        error = "write to " + m_path + " failed";
+    }
+    return ok;
+}
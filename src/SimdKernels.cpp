@@ -0,0 +1,639 @@
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(GTDC_WITH_AVX2) && (defined(__x86_64__) || defined(_M_X64))
+#define SIMD_HAS_AVX2 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SIMD_TARGET_AVX2   // MSVC accepts AVX2 intrinsics without /arch:AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace Simd {
+
+namespace {
+
+#ifdef SIMD_HAS_AVX2
+bool detectAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false; // YMM state not saved by the OS
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+const bool g_avx2 =
+#ifdef SIMD_HAS_AVX2
+    detectAvx2();
+#else
+    false;
+#endif
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr double MIN_HEADWAY_SPEED = 0.1; // [m/s], no headway for a standing host vehicle
+
+inline bool closer(double d2, uint32_t index, double bestD2, uint32_t bestIndex) {
+    return d2 < bestD2 || (d2 == bestD2 && index < bestIndex);
+}
+
+void nearestSegmentScalar(const SegmentTable& t, const uint32_t* index, size_t count,
+                          double px, double py, double& bestD2, uint32_t& bestIndex) {
+    for (size_t k = 0; k < count; ++k) {
+        uint32_t i = index[k];
+        double rx = px - t.x[i];
+        double ry = py - t.y[i];
+        double u = std::min(1.0, std::max(0.0, (rx * t.dx[i] + ry * t.dy[i]) * t.invLength2[i]));
+        double ex = u * t.dx[i] - rx;
+        double ey = u * t.dy[i] - ry;
+        double d2 = ex * ex + ey * ey;
+        if (closer(d2, i, bestD2, bestIndex)) {
+            bestD2 = d2;
+            bestIndex = i;
+        }
+    }
+}
+
+// Written as the AVX2 path below operation by operation, so that both give the same results
+void egoFrameScalar(const EgoPose& ego, const ObjectArrays& o, size_t begin, size_t count, const EgoFrameArrays& out) {
+    bool moving = ego.speed > MIN_HEADWAY_SPEED;
+    for (size_t i = begin; i < count; ++i) {
+        double dx = o.x[i] - ego.x;
+        double dy = o.y[i] - ego.y;
+        double lx = ego.cosYaw * dx + ego.sinYaw * dy;
+        double ly = ego.cosYaw * dy - ego.sinYaw * dx;
+        double ux = o.vx[i] - ego.vx;
+        double uy = o.vy[i] - ego.vy;
+        double rvx = ego.cosYaw * ux + ego.sinYaw * uy;
+        double rvy = ego.cosYaw * uy - ego.sinYaw * ux;
+
+        // Extent of the object footprint along the ego axes, plus the host's own
+        double cr = std::fabs(ego.cosYaw * o.cosYaw[i] + ego.sinYaw * o.sinYaw[i]);
+        double sr = std::fabs(ego.cosYaw * o.sinYaw[i] - ego.sinYaw * o.cosYaw[i]);
+        double halfLength = 0.5 * o.length[i];
+        double halfWidth = 0.5 * o.width[i];
+        double gapX = std::fabs(lx) - (ego.halfLength + (halfLength * cr + halfWidth * sr));
+        double gapY = std::fabs(ly) - (ego.halfWidth + (halfLength * sr + halfWidth * cr));
+        double gx = gapX > 0.0 ? gapX : 0.0;
+        double gy = gapY > 0.0 ? gapY : 0.0;
+        double distance = std::sqrt(gx * gx + gy * gy);
+        double closing = -(lx * rvx + ly * rvy) / std::sqrt(lx * lx + ly * ly);
+
+        out.x[i] = lx;
+        out.y[i] = ly;
+        out.vx[i] = rvx;
+        out.vy[i] = rvy;
+        out.distance[i] = distance;
+        out.ttc[i] = closing > 0.0 ? distance / closing : INF;
+        out.headway[i] = moving && lx > 0.0 && gapY <= 0.0 ? gx / ego.speed : INF;
+    }
+}
+
+// Same operation order as the AVX2 path
+size_t lidarPointsScalar(const LidarTransform& tf, const float* dx, const float* dy, const float* dz,
+                         const float* range, size_t begin, size_t count, float minRange, float maxRange, float minZ,
+                         float* x, float* y, float* z, uint8_t* keep) {
+    size_t kept = 0;
+    for (size_t i = begin; i < count; ++i) {
+        float px = dx[i] * range[i];
+        float py = dy[i] * range[i];
+        float pz = dz[i] * range[i];
+        float vx = ((tf.r[0] * px + tf.r[1] * py) + tf.r[2] * pz) + tf.t[0];
+        float vy = ((tf.r[3] * px + tf.r[4] * py) + tf.r[5] * pz) + tf.t[1];
+        float vz = ((tf.r[6] * px + tf.r[7] * py) + tf.r[8] * pz) + tf.t[2];
+        x[i] = vx;
+        y[i] = vy;
+        z[i] = vz;
+        bool k = range[i] >= minRange && range[i] <= maxRange && vz >= minZ;
+        keep[i] = k ? 1 : 0;
+        kept += k ? 1 : 0;
+    }
+    return kept;
+}
+
+void lerpRowsU8Scalar(const uint8_t* a, const uint8_t* b, float w, size_t begin, size_t count, float* out) {
+    for (size_t i = begin; i < count; ++i) {
+        float va = (float)a[i];
+        out[i] = va + w * ((float)b[i] - va);
+    }
+}
+
+void resampleRowScalar(const float* row, size_t channels, const int32_t* x0, const float* w, size_t begin, size_t count,
+                       const float* matrix, const float* bias, size_t outChannels, float* const* out) {
+    float v[3];
+    for (size_t i = begin; i < count; ++i) {
+        for (size_t c = 0; c < channels; ++c) {
+            float left = row[x0[i] + (int32_t)c];
+            v[c] = left + w[i] * (row[x0[i] + (int32_t)(channels + c)] - left);
+        }
+        for (size_t o = 0; o < outChannels; ++o) {
+            float acc = bias[o];
+            for (size_t c = 0; c < channels; ++c) {
+                acc = acc + matrix[o * channels + c] * v[c];
+            }
+            out[o][i] = acc;
+        }
+    }
+}
+
+// Transition terms of kalmanPredict(): F P F^T + Q with F = [[I, dt I], [0, I]]
+struct KalmanStep {
+    double dt;
+    double dt2;
+    double qa; // q dt^4 / 4 (position)
+    double qb; // q dt^3 / 2 (position-velocity)
+    double qc; // q dt^2 (velocity)
+};
+
+KalmanStep kalmanStep(double dt, double q) {
+    KalmanStep k;
+    k.dt = dt;
+    k.dt2 = dt * dt;
+    k.qa = q * k.dt2 * k.dt2 * 0.25;
+    k.qb = q * k.dt2 * dt * 0.5;
+    k.qc = q * k.dt2;
+    return k;
+}
+
+// Same operation order as the AVX2 path
+void kalmanPredictScalar(const KalmanArrays& f, size_t begin, size_t count, const KalmanStep& k) {
+    for (size_t i = begin; i < count; ++i) {
+        double xx = f.p[0][i], xy = f.p[1][i], xvx = f.p[2][i], xvy = f.p[3][i], yy = f.p[4][i];
+        double yvx = f.p[5][i], yvy = f.p[6][i], vxvx = f.p[7][i], vxvy = f.p[8][i], vyvy = f.p[9][i];
+        f.x[i] = f.x[i] + k.dt * f.vx[i];
+        f.y[i] = f.y[i] + k.dt * f.vy[i];
+        f.p[0][i] = ((xx + k.dt * (xvx + xvx)) + k.dt2 * vxvx) + k.qa;
+        f.p[1][i] = (xy + k.dt * (xvy + yvx)) + k.dt2 * vxvy;
+        f.p[2][i] = (xvx + k.dt * vxvx) + k.qb;
+        f.p[3][i] = xvy + k.dt * vxvy;
+        f.p[4][i] = ((yy + k.dt * (yvy + yvy)) + k.dt2 * vyvy) + k.qa;
+        f.p[5][i] = yvx + k.dt * vxvy;
+        f.p[6][i] = (yvy + k.dt * vyvy) + k.qb;
+        f.p[7][i] = vxvx + k.qc;
+        f.p[9][i] = vyvy + k.qc;
+    }
+}
+
+// Gain G = M S^-1 with M = P H^T (rows m0..m3), then x += G e and P -= G M^T.
+// Same operation order as the AVX2 path.
+void kalmanUpdateScalar(const KalmanArrays& f, size_t begin, size_t count, const double* zx, const double* zy,
+                        const uint8_t* has, double r) {
+    for (size_t i = begin; i < count; ++i) {
+        if (!has[i]) {
+            continue;
+        }
+        double xx = f.p[0][i], xy = f.p[1][i], xvx = f.p[2][i], xvy = f.p[3][i], yy = f.p[4][i];
+        double yvx = f.p[5][i], yvy = f.p[6][i];
+        double s00 = xx + r;
+        double s11 = yy + r;
+        double inv = 1.0 / (s00 * s11 - xy * xy);
+        double i00 = s11 * inv;
+        double i01 = -(xy * inv);
+        double i11 = s00 * inv;
+        double g0a = xx * i00 + xy * i01, g0b = xx * i01 + xy * i11;
+        double g1a = xy * i00 + yy * i01, g1b = xy * i01 + yy * i11;
+        double g2a = xvx * i00 + yvx * i01, g2b = xvx * i01 + yvx * i11;
+        double g3a = xvy * i00 + yvy * i01, g3b = xvy * i01 + yvy * i11;
+        double ex = zx[i] - f.x[i];
+        double ey = zy[i] - f.y[i];
+        f.x[i] = f.x[i] + (g0a * ex + g0b * ey);
+        f.y[i] = f.y[i] + (g1a * ex + g1b * ey);
+        f.vx[i] = f.vx[i] + (g2a * ex + g2b * ey);
+        f.vy[i] = f.vy[i] + (g3a * ex + g3b * ey);
+        f.p[0][i] = xx - (g0a * xx + g0b * xy);
+        f.p[1][i] = xy - (g0a * xy + g0b * yy);
+        f.p[2][i] = xvx - (g0a * xvx + g0b * yvx);
+        f.p[3][i] = xvy - (g0a * xvy + g0b * yvy);
+        f.p[4][i] = yy - (g1a * xy + g1b * yy);
+        f.p[5][i] = yvx - (g1a * xvx + g1b * yvx);
+        f.p[6][i] = yvy - (g1a * xvy + g1b * yvy);
+        f.p[7][i] = f.p[7][i] - (g2a * xvx + g2b * yvx);
+        f.p[8][i] = f.p[8][i] - (g2a * xvy + g2b * yvy);
+        f.p[9][i] = f.p[9][i] - (g3a * xvy + g3b * yvy);
+    }
+}
+
+void mahalanobis2Scalar(double px, double py, double i00, double i01, double i11, const double* zx, const double* zy,
+                        size_t begin, size_t count, double* out) {
+    double cross = i01 + i01;
+    for (size_t j = begin; j < count; ++j) {
+        double dx = zx[j] - px;
+        double dy = zy[j] - py;
+        out[j] = ((i00 * dx) * dx + (cross * dx) * dy) + (i11 * dy) * dy;
+    }
+}
+
+#ifdef SIMD_HAS_AVX2
+// Four segments per iteration, gathered by index; the remainder runs scalar.
+// No FMA, so that the results match the scalar path bit for bit.
+SIMD_TARGET_AVX2
+void nearestSegmentAvx2(const SegmentTable& t, const uint32_t* index, size_t count,
+                        double px, double py, double& bestD2, uint32_t& bestIndex) {
+    const __m256d vpx = _mm256_set1_pd(px);
+    const __m256d vpy = _mm256_set1_pd(py);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256d best = _mm256_set1_pd(bestD2);
+    __m256d bestId = _mm256_set1_pd((double)bestIndex); // Indices are exact as double
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(index + k));
+        __m256d ax = _mm256_i32gather_pd(t.x, vi, 8);
+        __m256d ay = _mm256_i32gather_pd(t.y, vi, 8);
+        __m256d dx = _mm256_i32gather_pd(t.dx, vi, 8);
+        __m256d dy = _mm256_i32gather_pd(t.dy, vi, 8);
+        __m256d inv = _mm256_i32gather_pd(t.invLength2, vi, 8);
+        __m256d rx = _mm256_sub_pd(vpx, ax);
+        __m256d ry = _mm256_sub_pd(vpy, ay);
+        __m256d u = _mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(rx, dx), _mm256_mul_pd(ry, dy)), inv);
+        u = _mm256_min_pd(one, _mm256_max_pd(zero, u));
+        __m256d ex = _mm256_sub_pd(_mm256_mul_pd(u, dx), rx);
+        __m256d ey = _mm256_sub_pd(_mm256_mul_pd(u, dy), ry);
+        __m256d d2 = _mm256_add_pd(_mm256_mul_pd(ex, ex), _mm256_mul_pd(ey, ey));
+        __m256d id = _mm256_cvtepi32_pd(vi);
+        __m256d mask = _mm256_or_pd(_mm256_cmp_pd(d2, best, _CMP_LT_OQ),
+                                    _mm256_and_pd(_mm256_cmp_pd(d2, best, _CMP_EQ_OQ), _mm256_cmp_pd(id, bestId, _CMP_LT_OQ)));
+        best = _mm256_blendv_pd(best, d2, mask);
+        bestId = _mm256_blendv_pd(bestId, id, mask);
+    }
+    alignas(32) double lanes[4];
+    alignas(32) double ids[4];
+    _mm256_store_pd(lanes, best);
+    _mm256_store_pd(ids, bestId);
+    for (int l = 0; l < 4; ++l) {
+        if (closer(lanes[l], (uint32_t)ids[l], bestD2, bestIndex)) {
+            bestD2 = lanes[l];
+            bestIndex = (uint32_t)ids[l];
+        }
+    }
+    nearestSegmentScalar(t, index + k, count - k, px, py, bestD2, bestIndex);
+}
+
+// Four objects per iteration; the remainder runs scalar. No FMA, as above.
+SIMD_TARGET_AVX2
+void egoFrameAvx2(const EgoPose& ego, const ObjectArrays& o, size_t count, const EgoFrameArrays& out) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    const __m256d inf = _mm256_set1_pd(INF);
+    const __m256d ex = _mm256_set1_pd(ego.x);
+    const __m256d ey = _mm256_set1_pd(ego.y);
+    const __m256d c = _mm256_set1_pd(ego.cosYaw);
+    const __m256d s = _mm256_set1_pd(ego.sinYaw);
+    const __m256d evx = _mm256_set1_pd(ego.vx);
+    const __m256d evy = _mm256_set1_pd(ego.vy);
+    const __m256d ehl = _mm256_set1_pd(ego.halfLength);
+    const __m256d ehw = _mm256_set1_pd(ego.halfWidth);
+    const __m256d speed = _mm256_set1_pd(ego.speed);
+    const __m256d moving = ego.speed > MIN_HEADWAY_SPEED ? _mm256_castsi256_pd(_mm256_set1_epi64x(-1)) : zero;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(o.x + i), ex);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(o.y + i), ey);
+        __m256d lx = _mm256_add_pd(_mm256_mul_pd(c, dx), _mm256_mul_pd(s, dy));
+        __m256d ly = _mm256_sub_pd(_mm256_mul_pd(c, dy), _mm256_mul_pd(s, dx));
+        __m256d ux = _mm256_sub_pd(_mm256_loadu_pd(o.vx + i), evx);
+        __m256d uy = _mm256_sub_pd(_mm256_loadu_pd(o.vy + i), evy);
+        __m256d rvx = _mm256_add_pd(_mm256_mul_pd(c, ux), _mm256_mul_pd(s, uy));
+        __m256d rvy = _mm256_sub_pd(_mm256_mul_pd(c, uy), _mm256_mul_pd(s, ux));
+
+        __m256d oc = _mm256_loadu_pd(o.cosYaw + i);
+        __m256d os = _mm256_loadu_pd(o.sinYaw + i);
+        __m256d cr = _mm256_andnot_pd(signBit, _mm256_add_pd(_mm256_mul_pd(c, oc), _mm256_mul_pd(s, os)));
+        __m256d sr = _mm256_andnot_pd(signBit, _mm256_sub_pd(_mm256_mul_pd(c, os), _mm256_mul_pd(s, oc)));
+        __m256d hl = _mm256_mul_pd(half, _mm256_loadu_pd(o.length + i));
+        __m256d hw = _mm256_mul_pd(half, _mm256_loadu_pd(o.width + i));
+        __m256d gapX = _mm256_sub_pd(_mm256_andnot_pd(signBit, lx),
+                                     _mm256_add_pd(ehl, _mm256_add_pd(_mm256_mul_pd(hl, cr), _mm256_mul_pd(hw, sr))));
+        __m256d gapY = _mm256_sub_pd(_mm256_andnot_pd(signBit, ly),
+                                     _mm256_add_pd(ehw, _mm256_add_pd(_mm256_mul_pd(hl, sr), _mm256_mul_pd(hw, cr))));
+        __m256d gx = _mm256_and_pd(_mm256_cmp_pd(gapX, zero, _CMP_GT_OQ), gapX);
+        __m256d gy = _mm256_and_pd(_mm256_cmp_pd(gapY, zero, _CMP_GT_OQ), gapY);
+        __m256d distance = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(gx, gx), _mm256_mul_pd(gy, gy)));
+        __m256d range = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(lx, lx), _mm256_mul_pd(ly, ly)));
+        __m256d closing = _mm256_div_pd(_mm256_xor_pd(signBit, _mm256_add_pd(_mm256_mul_pd(lx, rvx), _mm256_mul_pd(ly, rvy))), range);
+        __m256d ttc = _mm256_blendv_pd(inf, _mm256_div_pd(distance, closing), _mm256_cmp_pd(closing, zero, _CMP_GT_OQ));
+        __m256d ahead = _mm256_and_pd(moving, _mm256_and_pd(_mm256_cmp_pd(lx, zero, _CMP_GT_OQ), _mm256_cmp_pd(gapY, zero, _CMP_LE_OQ)));
+        __m256d headway = _mm256_blendv_pd(inf, _mm256_div_pd(gx, speed), ahead);
+
+        _mm256_storeu_pd(out.x + i, lx);
+        _mm256_storeu_pd(out.y + i, ly);
+        _mm256_storeu_pd(out.vx + i, rvx);
+        _mm256_storeu_pd(out.vy + i, rvy);
+        _mm256_storeu_pd(out.distance + i, distance);
+        _mm256_storeu_pd(out.ttc + i, ttc);
+        _mm256_storeu_pd(out.headway + i, headway);
+    }
+    egoFrameScalar(ego, o, i, count, out);
+}
+
+// Eight reflections per iteration; the remainder runs scalar. No FMA, as above.
+SIMD_TARGET_AVX2
+size_t lidarPointsAvx2(const LidarTransform& tf, const float* dx, const float* dy, const float* dz,
+                       const float* range, size_t count, float minRange, float maxRange, float minZ,
+                       float* x, float* y, float* z, uint8_t* keep) {
+    __m256 r[9];
+    for (int k = 0; k < 9; ++k) {
+        r[k] = _mm256_set1_ps(tf.r[k]);
+    }
+    const __m256 tx = _mm256_set1_ps(tf.t[0]);
+    const __m256 ty = _mm256_set1_ps(tf.t[1]);
+    const __m256 tz = _mm256_set1_ps(tf.t[2]);
+    const __m256 lo = _mm256_set1_ps(minRange);
+    const __m256 hi = _mm256_set1_ps(maxRange);
+    const __m256 floorZ = _mm256_set1_ps(minZ);
+    size_t kept = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 rg = _mm256_loadu_ps(range + i);
+        __m256 px = _mm256_mul_ps(_mm256_loadu_ps(dx + i), rg);
+        __m256 py = _mm256_mul_ps(_mm256_loadu_ps(dy + i), rg);
+        __m256 pz = _mm256_mul_ps(_mm256_loadu_ps(dz + i), rg);
+        __m256 vx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], px), _mm256_mul_ps(r[1], py)),
+                                                _mm256_mul_ps(r[2], pz)), tx);
+        __m256 vy = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[3], px), _mm256_mul_ps(r[4], py)),
+                                                _mm256_mul_ps(r[5], pz)), ty);
+        __m256 vz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[6], px), _mm256_mul_ps(r[7], py)),
+                                                _mm256_mul_ps(r[8], pz)), tz);
+        _mm256_storeu_ps(x + i, vx);
+        _mm256_storeu_ps(y + i, vy);
+        _mm256_storeu_ps(z + i, vz);
+        __m256 mask = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(rg, lo, _CMP_GE_OQ), _mm256_cmp_ps(rg, hi, _CMP_LE_OQ)),
+                                    _mm256_cmp_ps(vz, floorZ, _CMP_GE_OQ));
+        int bits = _mm256_movemask_ps(mask);
+        for (int l = 0; l < 8; ++l) {
+            uint8_t k = (uint8_t)((bits >> l) & 1);
+            keep[i + l] = k;
+            kept += k;
+        }
+    }
+    return kept + lidarPointsScalar(tf, dx, dy, dz, range, i, count, minRange, maxRange, minZ, x, y, z, keep);
+}
+
+// Eight bytes per iteration; the remainder runs scalar. No FMA, as above.
+SIMD_TARGET_AVX2
+void lerpRowsU8Avx2(const uint8_t* a, const uint8_t* b, float w, size_t count, float* out) {
+    const __m256 vw = _mm256_set1_ps(w);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 va = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i))));
+        __m256 vb = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i))));
+        _mm256_storeu_ps(out + i, _mm256_add_ps(va, _mm256_mul_ps(vw, _mm256_sub_ps(vb, va))));
+    }
+    lerpRowsU8Scalar(a, b, w, i, count, out);
+}
+
+// Eight output pixels per iteration, source pixels gathered by index
+SIMD_TARGET_AVX2
+void resampleRowAvx2(const float* row, size_t channels, const int32_t* x0, const float* w, size_t count,
+                     const float* matrix, const float* bias, size_t outChannels, float* const* out) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x0 + i));
+        __m256 vw = _mm256_loadu_ps(w + i);
+        __m256 v[3];
+        for (size_t c = 0; c < channels; ++c) {
+            __m256 l = _mm256_i32gather_ps(row, _mm256_add_epi32(left, _mm256_set1_epi32((int)c)), 4);
+            __m256 r = _mm256_i32gather_ps(row, _mm256_add_epi32(left, _mm256_set1_epi32((int)(channels + c))), 4);
+            v[c] = _mm256_add_ps(l, _mm256_mul_ps(vw, _mm256_sub_ps(r, l)));
+        }
+        for (size_t o = 0; o < outChannels; ++o) {
+            __m256 acc = _mm256_set1_ps(bias[o]);
+            for (size_t c = 0; c < channels; ++c) {
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(matrix[o * channels + c]), v[c]));
+            }
+            _mm256_storeu_ps(out[o] + i, acc);
+        }
+    }
+    resampleRowScalar(row, channels, x0, w, i, count, matrix, bias, outChannels, out);
+}
+
+// Four filters per iteration; the remainder runs scalar. No FMA, as above.
+SIMD_TARGET_AVX2
+void kalmanPredictAvx2(const KalmanArrays& f, size_t count, const KalmanStep& k) {
+    const __m256d dt = _mm256_set1_pd(k.dt);
+    const __m256d dt2 = _mm256_set1_pd(k.dt2);
+    const __m256d qa = _mm256_set1_pd(k.qa);
+    const __m256d qb = _mm256_set1_pd(k.qb);
+    const __m256d qc = _mm256_set1_pd(k.qc);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d xx = _mm256_loadu_pd(f.p[0] + i), xy = _mm256_loadu_pd(f.p[1] + i);
+        __m256d xvx = _mm256_loadu_pd(f.p[2] + i), xvy = _mm256_loadu_pd(f.p[3] + i);
+        __m256d yy = _mm256_loadu_pd(f.p[4] + i), yvx = _mm256_loadu_pd(f.p[5] + i);
+        __m256d yvy = _mm256_loadu_pd(f.p[6] + i), vxvx = _mm256_loadu_pd(f.p[7] + i);
+        __m256d vxvy = _mm256_loadu_pd(f.p[8] + i), vyvy = _mm256_loadu_pd(f.p[9] + i);
+        _mm256_storeu_pd(f.x + i, _mm256_add_pd(_mm256_loadu_pd(f.x + i), _mm256_mul_pd(dt, _mm256_loadu_pd(f.vx + i))));
+        _mm256_storeu_pd(f.y + i, _mm256_add_pd(_mm256_loadu_pd(f.y + i), _mm256_mul_pd(dt, _mm256_loadu_pd(f.vy + i))));
+        _mm256_storeu_pd(f.p[0] + i, _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(xx, _mm256_mul_pd(dt, _mm256_add_pd(xvx, xvx))),
+                                                                 _mm256_mul_pd(dt2, vxvx)), qa));
+        _mm256_storeu_pd(f.p[1] + i, _mm256_add_pd(_mm256_add_pd(xy, _mm256_mul_pd(dt, _mm256_add_pd(xvy, yvx))),
+                                                   _mm256_mul_pd(dt2, vxvy)));
+        _mm256_storeu_pd(f.p[2] + i, _mm256_add_pd(_mm256_add_pd(xvx, _mm256_mul_pd(dt, vxvx)), qb));
+        _mm256_storeu_pd(f.p[3] + i, _mm256_add_pd(xvy, _mm256_mul_pd(dt, vxvy)));
+        _mm256_storeu_pd(f.p[4] + i, _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(yy, _mm256_mul_pd(dt, _mm256_add_pd(yvy, yvy))),
+                                                                 _mm256_mul_pd(dt2, vyvy)), qa));
+        _mm256_storeu_pd(f.p[5] + i, _mm256_add_pd(yvx, _mm256_mul_pd(dt, vxvy)));
+        _mm256_storeu_pd(f.p[6] + i, _mm256_add_pd(_mm256_add_pd(yvy, _mm256_mul_pd(dt, vyvy)), qb));
+        _mm256_storeu_pd(f.p[7] + i, _mm256_add_pd(vxvx, qc));
+        _mm256_storeu_pd(f.p[9] + i, _mm256_add_pd(vyvy, qc));
+    }
+    kalmanPredictScalar(f, i, count, k);
+}
+
+// a0 * b0 + a1 * b1
+SIMD_TARGET_AVX2
+inline __m256d dot2(__m256d a0, __m256d a1, __m256d b0, __m256d b1) {
+    return _mm256_add_pd(_mm256_mul_pd(a0, b0), _mm256_mul_pd(a1, b1));
+}
+
+SIMD_TARGET_AVX2
+inline void storeMasked(double* target, __m256d value, __m256d mask) {
+    _mm256_storeu_pd(target, _mm256_blendv_pd(_mm256_loadu_pd(target), value, mask));
+}
+
+// Four filters per iteration, computed for all and blended by has[]
+SIMD_TARGET_AVX2
+void kalmanUpdateAvx2(const KalmanArrays& f, size_t count, const double* zx, const double* zy, const uint8_t* has,
+                      double r) {
+    const __m256d vr = _mm256_set1_pd(r);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d signBit = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        int32_t flags;
+        std::memcpy(&flags, has + i, 4);
+        if (flags == 0) {
+            continue;
+        }
+        __m256d mask = _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_cvtepu8_epi64(_mm_cvtsi32_si128(flags)),
+                                                              _mm256_setzero_si256()));
+        __m256d xx = _mm256_loadu_pd(f.p[0] + i), xy = _mm256_loadu_pd(f.p[1] + i);
+        __m256d xvx = _mm256_loadu_pd(f.p[2] + i), xvy = _mm256_loadu_pd(f.p[3] + i);
+        __m256d yy = _mm256_loadu_pd(f.p[4] + i), yvx = _mm256_loadu_pd(f.p[5] + i);
+        __m256d yvy = _mm256_loadu_pd(f.p[6] + i), vxvx = _mm256_loadu_pd(f.p[7] + i);
+        __m256d vxvy = _mm256_loadu_pd(f.p[8] + i), vyvy = _mm256_loadu_pd(f.p[9] + i);
+        __m256d s00 = _mm256_add_pd(xx, vr);
+        __m256d s11 = _mm256_add_pd(yy, vr);
+        __m256d inv = _mm256_div_pd(one, _mm256_sub_pd(_mm256_mul_pd(s00, s11), _mm256_mul_pd(xy, xy)));
+        __m256d i00 = _mm256_mul_pd(s11, inv);
+        __m256d i01 = _mm256_xor_pd(signBit, _mm256_mul_pd(xy, inv));
+        __m256d i11 = _mm256_mul_pd(s00, inv);
+        __m256d g0a = dot2(xx, xy, i00, i01), g0b = dot2(xx, xy, i01, i11);
+        __m256d g1a = dot2(xy, yy, i00, i01), g1b = dot2(xy, yy, i01, i11);
+        __m256d g2a = dot2(xvx, yvx, i00, i01), g2b = dot2(xvx, yvx, i01, i11);
+        __m256d g3a = dot2(xvy, yvy, i00, i01), g3b = dot2(xvy, yvy, i01, i11);
+        __m256d x = _mm256_loadu_pd(f.x + i);
+        __m256d y = _mm256_loadu_pd(f.y + i);
+        __m256d ex = _mm256_sub_pd(_mm256_loadu_pd(zx + i), x);
+        __m256d ey = _mm256_sub_pd(_mm256_loadu_pd(zy + i), y);
+        storeMasked(f.x + i, _mm256_add_pd(x, dot2(g0a, g0b, ex, ey)), mask);
+        storeMasked(f.y + i, _mm256_add_pd(y, dot2(g1a, g1b, ex, ey)), mask);
+        storeMasked(f.vx + i, _mm256_add_pd(_mm256_loadu_pd(f.vx + i), dot2(g2a, g2b, ex, ey)), mask);
+        storeMasked(f.vy + i, _mm256_add_pd(_mm256_loadu_pd(f.vy + i), dot2(g3a, g3b, ex, ey)), mask);
+        storeMasked(f.p[0] + i, _mm256_sub_pd(xx, dot2(g0a, g0b, xx, xy)), mask);
+        storeMasked(f.p[1] + i, _mm256_sub_pd(xy, dot2(g0a, g0b, xy, yy)), mask);
+        storeMasked(f.p[2] + i, _mm256_sub_pd(xvx, dot2(g0a, g0b, xvx, yvx)), mask);
+        storeMasked(f.p[3] + i, _mm256_sub_pd(xvy, dot2(g0a, g0b, xvy, yvy)), mask);
+        storeMasked(f.p[4] + i, _mm256_sub_pd(yy, dot2(g1a, g1b, xy, yy)), mask);
+        storeMasked(f.p[5] + i, _mm256_sub_pd(yvx, dot2(g1a, g1b, xvx, yvx)), mask);
+        storeMasked(f.p[6] + i, _mm256_sub_pd(yvy, dot2(g1a, g1b, xvy, yvy)), mask);
+        storeMasked(f.p[7] + i, _mm256_sub_pd(vxvx, dot2(g2a, g2b, xvx, yvx)), mask);
+        storeMasked(f.p[8] + i, _mm256_sub_pd(vxvy, dot2(g2a, g2b, xvy, yvy)), mask);
+        storeMasked(f.p[9] + i, _mm256_sub_pd(vyvy, dot2(g3a, g3b, xvy, yvy)), mask);
+    }
+    kalmanUpdateScalar(f, i, count, zx, zy, has, r);
+}
+
+SIMD_TARGET_AVX2
+void mahalanobis2Avx2(double px, double py, double i00, double i01, double i11, const double* zx, const double* zy,
+                      size_t count, double* out) {
+    const __m256d vpx = _mm256_set1_pd(px);
+    const __m256d vpy = _mm256_set1_pd(py);
+    const __m256d a = _mm256_set1_pd(i00);
+    const __m256d cross = _mm256_set1_pd(i01 + i01);
+    const __m256d b = _mm256_set1_pd(i11);
+    size_t j = 0;
+    for (; j + 4 <= count; j += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(zx + j), vpx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(zy + j), vpy);
+        __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(a, dx), dx),
+                                                 _mm256_mul_pd(_mm256_mul_pd(cross, dx), dy)),
+                                   _mm256_mul_pd(_mm256_mul_pd(b, dy), dy));
+        _mm256_storeu_pd(out + j, d2);
+    }
+    mahalanobis2Scalar(px, py, i00, i01, i11, zx, zy, j, count, out);
+}
+#endif
+
+} // namespace
+
+bool avx2Enabled() {
+    return g_avx2;
+}
+
+const char* name() {
+    return g_avx2 ? "avx2" : "scalar";
+}
+
+void nearestSegment(const SegmentTable& table, const uint32_t* index, size_t count,
+                    double px, double py, double& bestD2, uint32_t& bestIndex) {
+#ifdef SIMD_HAS_AVX2
+    if (g_avx2) {
+        nearestSegmentAvx2(table, index, count, px, py, bestD2, bestIndex);
+        return;
+    }
+#endif
+    nearestSegmentScalar(table, index, count, px, py, bestD2, bestIndex);
+}
+
+void egoFrame(const EgoPose& ego, const ObjectArrays& objects, size_t count, const EgoFrameArrays& out) {
+#ifdef SIMD_HAS_AVX2
+    if (g_avx2) {
+        egoFrameAvx2(ego, objects, count, out);
+        return;
+    }
+#endif
+    egoFrameScalar(ego, objects, 0, count, out);
+}
+
+size_t lidarPoints(const LidarTransform& transform, const float* dx, const float* dy, const float* dz,
+                   const float* range, size_t count, float minRange, float maxRange, float minZ,
+                   float* x, float* y, float* z, uint8_t* keep) {
+#ifdef SIMD_HAS_AVX2
+    if (g_avx2) {
+        return lidarPointsAvx2(transform, dx, dy, dz, range, count, minRange, maxRange, minZ, x, y, z, keep);
+    }
+#endif
+    return lidarPointsScalar(transform, dx, dy, dz, range, 0, count, minRange, maxRange, minZ, x, y, z, keep);
+}
+
+void lerpRowsU8(const uint8_t* a, const uint8_t* b, float w, size_t count, float* out) {
+#ifdef SIMD_HAS_AVX2
+    if (g_avx2) {
+        lerpRowsU8Avx2(a, b, w, count, out);
+        return;
+    }
+#endif
+    lerpRowsU8Scalar(a, b, w, 0, count, out);
+}
+
+void resampleRow(const float* row, size_t channels, const int32_t* x0, const float* w, size_t count,
+                 const float* matrix, const float* bias, size_t outChannels, float* const* out) {
+#ifdef SIMD_HAS_AVX2
+    if (g_avx2) {
+        resampleRowAvx2(row, channels, x0, w, count, matrix, bias, outChannels, out);
+        return;
+    }
+#endif
+    resampleRowScalar(row, channels, x0, w, 0, count, matrix, bias, outChannels, out);
+}
+
+void kalmanPredict(const KalmanArrays& filters, size_t count, double dt, double q) {
+    KalmanStep step = kalmanStep(dt, q);
+#ifdef SIMD_HAS_AVX2
+    if (g_avx2) {
+        kalmanPredictAvx2(filters, count, step);
+        return;
+    }
+#endif
+    kalmanPredictScalar(filters, 0, count, step);
+}
+
+void kalmanUpdate(const KalmanArrays& filters, size_t count, const double* zx, const double* zy, const uint8_t* has,
+                  double r) {
+#ifdef SIMD_HAS_AVX2
+    if (g_avx2) {
+        kalmanUpdateAvx2(filters, count, zx, zy, has, r);
+        return;
+    }
+#endif
+    kalmanUpdateScalar(filters, 0, count, zx, zy, has, r);
+}
+
+void mahalanobis2(double px, double py, double i00, double i01, double i11, const double* zx, const double* zy,
+                  size_t count, double* out) {
+#ifdef SIMD_HAS_AVX2
+    if (g_avx2) {
+        mahalanobis2Avx2(px, py, i00, i01, i11, zx, zy, count, out);
+        return;
+    }
+#endif
+    mahalanobis2Scalar(px, py, i00, i01, i11, zx, zy, 0, count, out);
+}
+
+} // namespace Simd
@@ -0,0 +1,223 @@
+#include "StaticMapCache.h"
+#include "OsiFields.h"
+#include "OsiFingerprint.h"
+#include "OsiWire.h"
+
+namespace {
+
+// Repeated static fields with an Identifier id = 1, indexed in the Python handle
+struct IndexedField {
+    uint32_t number;
+    const char* field; // GroundTruth field name
+    const char* key;   // Attribute of the handle
+};
+
+const IndexedField INDEXED_FIELDS[] = {
+    { OsiFields::GroundTruth::StationaryObject,    "stationary_object",     "stationary_objects" },
+    { OsiFields::GroundTruth::TrafficSign,         "traffic_sign",          "traffic_signs" },
+    { OsiFields::GroundTruth::RoadMarking,         "road_marking",          "road_markings" },
+    { OsiFields::GroundTruth::LaneBoundary,        "lane_boundary",         "lane_boundaries" },
+    { OsiFields::GroundTruth::Lane,                "lane",                  "lanes" },
+    { OsiFields::GroundTruth::ReferenceLine,       "reference_line",        "reference_lines" },
+    { OsiFields::GroundTruth::LogicalLaneBoundary, "logical_lane_boundary", "logical_lane_boundaries" },
+    { OsiFields::GroundTruth::LogicalLane,         "logical_lane",          "logical_lanes" },
+};
+
+bool isIndexed(uint32_t number) {
+    for (const IndexedField& field : INDEXED_FIELDS) {
+        if (field.number == number) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isStatic(uint32_t number) {
+    using namespace OsiFields;
+    switch (number) {
+        case GroundTruth::CountryCode:
+        case GroundTruth::ProjString:
+        case GroundTruth::MapReference:
+        case GroundTruth::ModelReference:
+            return true;
+        default:
+            return isIndexed(number);
+    }
+}
+
+// All indexed messages carry their Identifier in field 1
+constexpr uint32_t ELEMENT_ID = 1;
+
+uint64_t readElementId(const OsiWire::Field& element) {
+    OsiWire::Reader reader(element.data, element.size);
+    OsiWire::Field f;
+    uint64_t id = 0;
+    while (reader.next(f)) {
+        if (f.number == ELEMENT_ID && OsiWire::readIdentifier(f, id)) {
+            return id;
+        }
+    }
+    return 0;
+}
+
+// lane id -> SimpleNamespace(length, type, successors, predecessors, left, right);
+// neighbours as lane ids (None if there is no adjacent lane)
+py::dict laneGraphIndex(const RoadGraph& graph) {
+    py::object makeLane = py::module::import("types").attr("SimpleNamespace");
+    const RoadGraphLane* lanes = graph.lanes();
+    const uint32_t* links = graph.links();
+    auto ids = [&](uint32_t first, uint32_t count) {
+        py::tuple result(count);
+        for (uint32_t k = 0; k < count; ++k) {
+            result[k] = py::int_(lanes[links[first + k]].id);
+        }
+        return result;
+    };
+    auto neighbour = [&](uint32_t index) -> py::object {
+        return index == ROAD_GRAPH_NO_LANE ? py::object(py::none()) : py::object(py::int_(lanes[index].id));
+    };
+    py::dict index;
+    for (uint32_t i = 0; i < graph.laneCount(); ++i) {
+        const RoadGraphLane& lane = lanes[i];
+        index[py::int_(lane.id)] = makeLane(
+            py::arg("length") = lane.length,
+            py::arg("type") = lane.type,
+            py::arg("successors") = ids(lane.firstSuccessor, lane.successorCount),
+            py::arg("predecessors") = ids(lane.firstPredecessor, lane.predecessorCount),
+            py::arg("left") = neighbour(lane.left),
+            py::arg("right") = neighbour(lane.right));
+    }
+    return index;
+}
+
+} // namespace
+
+bool StaticMapCache::split(const char* sensorView, size_t size, std::string& out, std::string& error) {
+    using namespace OsiFields;
+    out.clear();
+    m_strippedBytes = 0;
+
+    // 1. SensorView top level: global_ground_truth
+    OsiWire::Reader reader(sensorView, size);
+    OsiWire::Field field;
+    OsiWire::Field gt;
+    bool hasGt = false;
+    while (reader.next(field)) {
+        if (field.number == SensorView::GlobalGroundTruth && field.type == OsiWire::WireType::LengthDelimited && !hasGt) {
+            gt = field;
+            hasGt = true;
+        }
+    }
+    if (!reader.ok()) {
+        error = "malformed SensorView";
+        return false;
+    }
+    if (!hasGt) {
+        out.assign(sensorView, size);
+        return true;
+    }
+
+    // 2. Static elements: id set and hash. Runs of dynamic fields are copied verbatim.
+    m_stepIds.clear();
+    m_staticRanges.clear();
+    m_dynamic.clear();
+    const unsigned long long K = 0x9E3779B97F4A7C15ULL;
+    unsigned long long hash = 0;
+    OsiWire::Reader elements(gt.data, gt.size);
+    const char* run = gt.data;
+    while (elements.next(field)) {
+        if (!isStatic(field.number)) {
+            continue;
+        }
+        m_dynamic.append(run, field.begin - run);
+        run = field.end;
+        m_staticRanges.emplace_back(field.begin, field.end);
+        m_strippedBytes += field.end - field.begin;
+
+        bool indexed = field.type == OsiWire::WireType::LengthDelimited && isIndexed(field.number);
+        m_stepIds.push_back(field.number);
+        m_stepIds.push_back(indexed ? readElementId(field) : 0);
+        hash = (hash ^ osiFingerprint(field.begin, field.end - field.begin)) * K;
+        hash ^= hash >> 29;
+    }
+    if (!elements.ok()) {
+        error = "malformed GroundTruth";
+        return false;
+    }
+    if (m_staticRanges.empty()) {
+        // No static content in this SensorView (omit_static_information): keep the cached map
+        out.assign(sensorView, size);
+        return true;
+    }
+    m_dynamic.append(run, (gt.data + gt.size) - run);
+
+    // 3. Replace the map only if the static content changed
+    if (!m_network || hash != m_network->hash() || m_stepIds != m_network->ids()) {
+        m_network = RoadNetworkStore::instance().acquire(hash, m_stepIds, m_staticRanges);
+        m_graph = m_network->graph(graphCacheDirectory);
+        ++m_version;
+    }
+
+    out.append(sensorView, gt.begin - sensorView);
+    OsiWire::writeLengthDelimited(out, SensorView::GlobalGroundTruth, m_dynamic.data(), m_dynamic.size());
+    out.append(gt.end, (sensorView + size) - gt.end);
+    return true;
+}
+
+py::object StaticMapCache::handle() {
+    if (!m_handle) {
+        m_handle = py::module::import("types").attr("SimpleNamespace")();
+        m_handle.attr("version") = py::int_(0);
+        m_handle.attr("ground_truth") = py::none();
+        for (const IndexedField& field : INDEXED_FIELDS) {
+            m_handle.attr(field.key) = py::dict();
+        }
+        m_handle.attr("lane_graph") = py::dict();
+    }
+    return m_handle;
+}
+
+void StaticMapCache::updateHandle() {
+    if (m_handleVersion == m_version) {
+        return;
+    }
+    py::object map = handle();
+
+    py::object view = m_network->view();
+    if (!view) {
+        // First instance on this map: decode and index once for the process.
+        // Flat import, as used by the generated OSI modules (see doInit)
+        const std::string& bytes = m_network->bytes();
+        py::object gt = py::module::import("osi_groundtruth_pb2").attr("GroundTruth")();
+        gt.attr("ParseFromString")(py::bytes(bytes.data(), bytes.size()));
+
+        py::object mappingProxy = py::module::import("types").attr("MappingProxyType");
+        view = py::module::import("types").attr("SimpleNamespace")();
+        view.attr("ground_truth") = gt;
+        for (const IndexedField& field : INDEXED_FIELDS) {
+            py::dict index;
+            py::sequence items = gt.attr(field.field).cast<py::sequence>();
+            for (size_t i = 0; i < items.size(); ++i) {
+                py::object item = items[i];
+                index[py::object(item.attr("id").attr("value"))] = item;
+            }
+            view.attr(field.key) = mappingProxy(index);
+        }
+        view.attr("lane_graph") = mappingProxy(laneGraphIndex(*m_graph));
+        m_network->setView(view);
+    }
+
+    map.attr("ground_truth") = view.attr("ground_truth");
+    for (const IndexedField& field : INDEXED_FIELDS) {
+        map.attr(field.key) = view.attr(field.key);
+    }
+    map.attr("lane_graph") = view.attr("lane_graph");
+    map.attr("version") = py::int_((long long)m_version);
+    m_handleVersion = m_version;
+}
+
+void StaticMapCache::release() {
+    m_handle = py::object();
+    m_graph.reset();
+    m_network.reset();
+}
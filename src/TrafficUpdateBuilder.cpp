@@ -0,0 +1,148 @@
+#include "TrafficUpdateBuilder.h"
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include <cstring>
+
+namespace {
+
+uint64_t doubleBits(double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, 8);
+    return bits;
+}
+
+// Next entry of a reused edit list; count is the number of entries in use
+OsiPatch::Edit& addSet(std::vector<OsiPatch::Edit>& edits, size_t& count,
+                       std::initializer_list<uint32_t> path, OsiWire::WireType type, uint64_t scalar) {
+    if (count == edits.size()) {
+        edits.emplace_back();
+    }
+    OsiPatch::Edit& edit = edits[count++];
+    edit.op = OsiPatch::Op::Set;
+    edit.path.clear();
+    for (uint32_t field : path) {
+        edit.path.push_back({ field, -1 });
+    }
+    edit.type = type;
+    edit.scalar = scalar;
+    edit.bytes.clear();
+    return edit;
+}
+
+} // namespace
+
+bool TrafficUpdateBuilder::build(const char* sensorView, size_t size, const ControlCommand& cmd,
+                                 const EgoStateOverride& ego, std::string& out, std::string& error) {
+    using namespace OsiFields;
+    out.clear();
+
+    // 1. SensorView top level: version and timestamp have the same field numbers in
+    //    TrafficUpdate and are copied verbatim
+    OsiWire::Reader reader(sensorView, size);
+    OsiWire::Field field;
+    const char* gtData = nullptr;
+    size_t gtSize = 0;
+    uint64_t hostId = 0;
+    bool hasHostId = false;
+    while (reader.next(field)) {
+        switch (field.number) {
+            case SensorView::Version:
+            case SensorView::Timestamp:
+                out.append(field.begin, field.end - field.begin);
+                break;
+            case SensorView::GlobalGroundTruth:
+                if (field.type == OsiWire::WireType::LengthDelimited) {
+                    gtData = field.data;
+                    gtSize = field.size;
+                }
+                break;
+            case SensorView::HostVehicleId:
+                hasHostId = OsiWire::readIdentifier(field, hostId);
+                break;
+            default:
+                break;
+        }
+    }
+    if (!reader.ok()) {
+        error = "malformed SensorView";
+        return false;
+    }
+
+    // 2. Host vehicle MovingObject in the ground truth
+    const char* egoData = nullptr;
+    size_t egoSize = 0;
+    if (gtData) {
+        if (!hasHostId) {
+            OsiWire::Reader gtReader(gtData, gtSize);
+            while (gtReader.next(field)) {
+                if (field.number == GroundTruth::HostVehicleId) {
+                    hasHostId = OsiWire::readIdentifier(field, hostId);
+                }
+            }
+        }
+        OsiWire::Reader gtReader(gtData, gtSize);
+        while (hasHostId && !egoData && gtReader.next(field)) {
+            if (field.number != GroundTruth::MovingObject || field.type != OsiWire::WireType::LengthDelimited) {
+                continue;
+            }
+            OsiWire::Reader objReader(field.data, field.size);
+            OsiWire::Field objField;
+            while (objReader.next(objField)) {
+                uint64_t id = 0;
+                if (objField.number == MovingObject::Id && OsiWire::readIdentifier(objField, id) && id == hostId) {
+                    egoData = field.data;
+                    egoSize = field.size;
+                    break;
+                }
+            }
+        }
+    }
+
+    // 3. update: the host vehicle with the state returned by Python
+    bool hasOverride = false;
+    for (bool h : ego.has) {
+        hasOverride |= h;
+    }
+    if (hasOverride) {
+        static const uint32_t baseFields[EgoStateOverride::Count] = {
+            BaseMoving::Position, BaseMoving::Orientation, BaseMoving::Velocity, BaseMoving::Acceleration
+        };
+        size_t count = 0;
+        if (!egoData && hasHostId) {
+            addSet(m_egoEdits, count, { MovingObject::Id, Identifier::Value }, OsiWire::WireType::Varint, hostId);
+        }
+        for (int i = 0; i < EgoStateOverride::Count; ++i) {
+            if (!ego.has[i]) {
+                continue;
+            }
+            // Vector3d x/y/z and Orientation3d roll/pitch/yaw are fields 1..3
+            for (uint32_t axis = 0; axis < 3; ++axis) {
+                addSet(m_egoEdits, count, { MovingObject::Base, baseFields[i], axis + 1 },
+                       OsiWire::WireType::Fixed64, doubleBits(ego.value[i][axis]));
+            }
+        }
+        m_egoEdits.resize(count);
+        if (!m_patcher.apply(egoData, egoSize, m_egoEdits, m_ego, error)) {
+            return false;
+        }
+        OsiWire::writeLengthDelimited(out, TrafficUpdate::Update, m_ego.data(), m_ego.size());
+    } else if (egoData) {
+        OsiWire::writeLengthDelimited(out, TrafficUpdate::Update, egoData, egoSize);
+    }
+
+    // 4. internal_state: HostVehicleData with the control command
+    size_t count = 0;
+    if (hasHostId) {
+        addSet(m_edits, count, { HostVehicleData::HostVehicleId, Identifier::Value }, OsiWire::WireType::Varint, hostId);
+    }
+    addSet(m_edits, count, { HostVehicleData::VehiclePowertrain, 1 }, OsiWire::WireType::Fixed64, doubleBits(cmd.throttle));
+    addSet(m_edits, count, { HostVehicleData::VehiclePowertrain, 3 }, OsiWire::WireType::Varint, (uint64_t)(int64_t)cmd.driveMode);
+    addSet(m_edits, count, { HostVehicleData::VehicleBrakeSystem, 1 }, OsiWire::WireType::Fixed64, doubleBits(cmd.brake));
+    addSet(m_edits, count, { HostVehicleData::VehicleSteering, 1, 1 }, OsiWire::WireType::Fixed64, doubleBits(cmd.steering * maxSteeringWheelAngle));
+    m_edits.resize(count);
+    if (!m_patcher.apply(nullptr, 0, m_edits, m_internalState, error)) {
+        return false;
+    }
+    OsiWire::writeLengthDelimited(out, TrafficUpdate::InternalState, m_internalState.data(), m_internalState.size());
+    return true;
+}
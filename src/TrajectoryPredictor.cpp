@@ -0,0 +1,253 @@
+#include "TrajectoryPredictor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double MIN_MOTION_SPEED = 0.1;  // [m/s], below: direction of motion = heading
+constexpr double MIN_TURN_RATE = 1e-6;    // [rad/s], below: CTRV is a straight line
+constexpr double MAX_LANE_OFFSET = 3.0;   // [m], farther from the centerline: no lane following
+constexpr double MIN_LANE_ALIGNMENT = 0.7; // cos of the angle between motion and lane (about 45 deg)
+constexpr double PI = 3.14159265358979323846;
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+TrajectoryPredictor::TrajectoryPredictor(std::shared_ptr<FrenetEngine> frenet)
+    : m_frenet(std::move(frenet)) {
+}
+
+void TrajectoryPredictor::update(const MovingObjects& objects) {
+    size_t n = objects.count;
+    m_id.assign(objects.id.begin(), objects.id.begin() + n);
+    m_x.assign(objects.x.begin(), objects.x.begin() + n);
+    m_y.assign(objects.y.begin(), objects.y.begin() + n);
+    m_yaw.assign(objects.yaw.begin(), objects.yaw.begin() + n);
+    m_yawRate.assign(objects.yawRate.begin(), objects.yawRate.begin() + n);
+    m_speed.resize(n);
+    m_acceleration.resize(n);
+    m_cosDirection.resize(n);
+    m_sinDirection.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        double speed = std::hypot(objects.vx[i], objects.vy[i]);
+        bool moving = speed > MIN_MOTION_SPEED;
+        m_speed[i] = moving ? speed : 0.0;
+        m_cosDirection[i] = moving ? objects.vx[i] / speed : objects.cosYaw[i];
+        m_sinDirection[i] = moving ? objects.vy[i] / speed : objects.sinYaw[i];
+        m_acceleration[i] = objects.ax[i] * m_cosDirection[i] + objects.ay[i] * m_sinDirection[i];
+    }
+    m_hostIndex = objects.hostIndex;
+
+    // Warm starts of the lane projections follow the objects by id; entries of
+    // objects that left are dropped once they outnumber the current ones
+    if (m_warm.size() > 2 * n + 64) {
+        std::unordered_map<uint64_t, uint32_t> kept;
+        for (uint64_t id : m_id) {
+            auto found = m_warm.find(id);
+            if (found != m_warm.end()) {
+                kept.insert(*found);
+            }
+        }
+        m_warm.swap(kept);
+    }
+    m_segment.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto found = m_warm.find(m_id[i]);
+        m_segment[i] = found != m_warm.end() ? found->second : FRENET_NO_SEGMENT;
+    }
+}
+
+size_t TrajectoryPredictor::count(bool excludeHost) const {
+    return m_id.size() - (excludeHost && m_hostIndex >= 0 ? 1 : 0);
+}
+
+void TrajectoryPredictor::ids(bool excludeHost, uint64_t* out) const {
+    for (size_t i = 0; i < m_id.size(); ++i) {
+        if (!excludeHost || (long long)i != m_hostIndex) {
+            *out++ = m_id[i];
+        }
+    }
+}
+
+void TrajectoryPredictor::speedProfile(PredictionModel model, size_t i, size_t steps) {
+    double v = m_speed[i];
+    double a = model == PredictionModel::ConstantAcceleration ? m_acceleration[i] : 0.0;
+    // With deceleration the object stops at tStop and stays there
+    double tStop = a < 0.0 ? v / -a : INF;
+    double dStop = a < 0.0 ? 0.5 * v * tStop : INF;
+    for (size_t k = 0; k < steps; ++k) {
+        double t = m_times[k];
+        bool stopped = t >= tStop;
+        m_profileSpeed[k] = stopped ? 0.0 : v + a * t;
+        m_profileDistance[k] = stopped ? dStop : (v + 0.5 * a * t) * t;
+    }
+}
+
+// Straight line (CV, CA) or circular arc (CTRV) from the current state
+void TrajectoryPredictor::rollout(PredictionModel model, size_t i, size_t steps, double* out) const {
+    double x = m_x[i];
+    double y = m_y[i];
+    double c = m_cosDirection[i];
+    double s = m_sinDirection[i];
+    double yaw = m_yaw[i];
+    double w = m_yawRate[i];
+    if (model != PredictionModel::Ctrv || std::fabs(w) < MIN_TURN_RATE || m_speed[i] == 0.0) {
+        for (size_t k = 0; k < steps; ++k) {
+            double* state = out + k * PREDICTION_STATE_SIZE;
+            state[0] = x + m_profileDistance[k] * c;
+            state[1] = y + m_profileDistance[k] * s;
+            state[2] = yaw;
+            state[3] = m_profileSpeed[k];
+        }
+        return;
+    }
+
+    // Direction after each step by rotation, without trigonometry in the loop
+    double radius = m_speed[i] / w;
+    double dt = m_times[0];
+    double stepCos = std::cos(w * dt);
+    double stepSin = std::sin(w * dt);
+    double ck = c;
+    double sk = s;
+    double yawStep = w * dt;
+    double yawK = yaw;
+    for (size_t k = 0; k < steps; ++k) {
+        double cNext = ck * stepCos - sk * stepSin;
+        double sNext = sk * stepCos + ck * stepSin;
+        ck = cNext;
+        sk = sNext;
+        double* state = out + k * PREDICTION_STATE_SIZE;
+        state[0] = x + radius * (sk - s);
+        state[1] = y + radius * (c - ck);
+        yawK += yawStep;
+        yawK += yawK > PI ? -2.0 * PI : (yawK < -PI ? 2.0 * PI : 0.0);
+        state[2] = yawK;
+        state[3] = m_speed[i];
+    }
+}
+
+// Travel along the lane graph with the speed profile. Returns false if the object
+// is not on a lane or not moving along it; warm is the segment for the projection.
+bool TrajectoryPredictor::followLane(size_t i, size_t steps, uint32_t& warm, double* out) const {
+    double s0, t0;
+    uint64_t laneId;
+    if (!m_frenet->project(m_x[i], m_y[i], warm, s0, t0, laneId) || std::fabs(t0) > MAX_LANE_OFFSET) {
+        return false;
+    }
+    const RoadGraph* graph = m_frenet->graph();
+    const RoadGraphLane* lanes = graph->lanes();
+    const uint32_t* links = graph->links();
+    const double* px = graph->pointX();
+    const double* py = graph->pointY();
+    const double* ps = graph->pointS();
+    uint32_t p = warm;
+    uint32_t l = graph->pointLane()[p];
+    double dx = px[p + 1] - px[p];
+    double dy = py[p + 1] - py[p];
+    double length = std::hypot(dx, dy);
+    if (length == 0.0) {
+        return false;
+    }
+    double alignment = (dx * m_cosDirection[i] + dy * m_sinDirection[i]) / length;
+    if (std::fabs(alignment) < MIN_LANE_ALIGNMENT) {
+        return false;
+    }
+    bool forward = alignment > 0.0;
+
+    double s = s0;
+    double travelled = 0.0;
+    uint32_t headingSegment = 0xFFFFFFFF;
+    double heading = 0.0, nx = 0.0, ny = 0.0, u0 = 0.0, ux = 0.0, uy = 0.0;
+    for (size_t k = 0; k < steps; ++k) {
+        double delta = m_profileDistance[k] - travelled;
+        travelled = m_profileDistance[k];
+        if (forward) {
+            s += delta;
+            // Into the first successor at the end of the lane (if it has a centerline)
+            while (s > lanes[l].length && lanes[l].successorCount > 0 && lanes[links[lanes[l].firstSuccessor]].pointCount >= 2) {
+                s -= lanes[l].length;
+                l = links[lanes[l].firstSuccessor];
+                p = lanes[l].firstPoint;
+            }
+            uint32_t last = lanes[l].firstPoint + lanes[l].pointCount - 2;
+            while (p < last && ps[p + 1] <= s) {
+                ++p;
+            }
+        } else {
+            s -= delta;
+            while (s < 0.0 && lanes[l].predecessorCount > 0 && lanes[links[lanes[l].firstPredecessor]].pointCount >= 2) {
+                l = links[lanes[l].firstPredecessor];
+                s += lanes[l].length;
+                p = lanes[l].firstPoint + lanes[l].pointCount - 2;
+            }
+            while (p > lanes[l].firstPoint && ps[p] > s) {
+                --p;
+            }
+        }
+
+        // Segment geometry only changes when the segment does
+        if (p != headingSegment) {
+            headingSegment = p;
+            dx = px[p + 1] - px[p];
+            dy = py[p + 1] - py[p];
+            length = ps[p + 1] - ps[p];
+            double norm = std::hypot(dx, dy);
+            if (norm > 0.0) {
+                heading = forward ? std::atan2(dy, dx) : std::atan2(-dy, -dx);
+                ux = dx / norm;
+                uy = dy / norm;
+                nx = -uy;
+                ny = ux;
+            }
+            u0 = ps[p];
+        }
+        double along = length > 0.0 ? s - u0 : 0.0;
+        double* state = out + k * PREDICTION_STATE_SIZE;
+        state[0] = px[p] + along * ux + t0 * nx;
+        state[1] = py[p] + along * uy + t0 * ny;
+        state[2] = heading;
+        state[3] = m_profileSpeed[k];
+    }
+    return true;
+}
+
+void TrajectoryPredictor::predict(PredictionModel model, double dt, size_t steps, bool followLanes, bool excludeHost,
+                                  double* states) {
+    if (steps == 0) {
+        return;
+    }
+    m_times.resize(steps);
+    m_profileSpeed.resize(steps);
+    m_profileDistance.resize(steps);
+    for (size_t k = 0; k < steps; ++k) {
+        m_times[k] = (double)(k + 1) * dt;
+    }
+
+    bool lanes = followLanes && m_frenet && m_frenet->hasMap();
+    if (lanes && m_frenet->graph() != m_warmGraph) {
+        m_warmGraph = m_frenet->graph();
+        m_warm.clear();
+        std::fill(m_segment.begin(), m_segment.end(), FRENET_NO_SEGMENT);
+    }
+
+    double* out = states;
+    for (size_t i = 0; i < m_id.size(); ++i) {
+        if (excludeHost && (long long)i == m_hostIndex) {
+            continue;
+        }
+        speedProfile(model, i, steps);
+        bool onLane = false;
+        if (lanes && m_speed[i] > 0.0) {
+            uint32_t previous = m_segment[i];
+            onLane = followLane(i, steps, m_segment[i], out);
+            if (m_segment[i] != previous) {
+                m_warm[m_id[i]] = m_segment[i];
+            }
+        }
+        if (!onLane) {
+            rollout(model, i, steps, out);
+        }
+        out += steps * PREDICTION_STATE_SIZE;
+    }
+}
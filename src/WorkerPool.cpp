@@ -0,0 +1,102 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(size_t threads, std::function<void(size_t)> threadInit)
+    : m_ranges(std::max<size_t>(threads, 1)), m_threadInit(std::move(threadInit))
+{
+    for (size_t worker = 1; worker < m_ranges.size(); ++worker) {
+        m_threads.emplace_back(&WorkerPool::run, this, worker);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cvJob.notify_all();
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    size_t n = m_ranges.size();
+    if (n == 1 || chunks == 1) {
+        body(0, count, 0);
+        return;
+    }
+
+    // Equal shares of the chunks; the first ones get one more if not divisible
+    size_t first = 0;
+    for (size_t worker = 0; worker < n; ++worker) {
+        size_t share = chunks / n + (worker < chunks % n ? 1 : 0);
+        m_ranges[worker].next.store(first, std::memory_order_relaxed);
+        m_ranges[worker].end = first + share;
+        first += share;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_count = count;
+        m_grain = grain;
+        m_running = m_threads.size();
+        ++m_generation;
+    }
+    m_cvJob.notify_all();
+
+    work(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cvDone.wait(lock, [this] { return m_running == 0; });
+    m_body = nullptr;
+}
+
+// Own range first, then the others starting with the next worker
+void WorkerPool::work(size_t worker) {
+    size_t n = m_ranges.size();
+    for (size_t k = 0; k < n; ++k) {
+        Range& range = m_ranges[(worker + k) % n];
+        for (;;) {
+            size_t chunk = range.next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= range.end) {
+                break;
+            }
+            size_t begin = chunk * m_grain;
+            (*m_body)(begin, std::min(begin + m_grain, m_count), worker);
+        }
+    }
+}
+
+void WorkerPool::run(size_t worker) {
+    if (m_threadInit) {
+        m_threadInit(worker);
+    }
+    unsigned long long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cvJob.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_generation;
+        }
+
+        work(worker);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            last = --m_running == 0;
+        }
+        if (last) {
+            m_cvDone.notify_one();
+        }
+    }
+}
@@ -71,6 +71,10 @@ FMI2_Export fmi2Status fmi2EnterInitializationMode(fmi2Component c) {
 }
 
 FMI2_Export fmi2Status fmi2ExitInitializationMode(fmi2Component c) {
+    // OSMP: read the SensorViewConfiguration the host has accepted
+    if (c) {
+        return ((OSMPController*)c)->exitInit();
+    }
     return fmi2OK;
 }
 
@@ -113,7 +117,8 @@ FMI2_Export fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference
 }
 
 FMI2_Export fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]) {
-    return fmi2OK;
+    if (c) return ((OSMPController*)c)->getBoolean(vr, nvr, value);
+    return fmi2Error;
 }
 
 FMI2_Export fmi2Status fmi2GetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String value[]) {
@@ -122,8 +127,8 @@ FMI2_Export fmi2Status fmi2GetString(fmi2Component c, const fmi2ValueReference v
 }
 
 FMI2_Export fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]) {
-    // No real inputs defined currently (only outputs), but if needed:
-    return fmi2OK;
+    if (c) return ((OSMPController*)c)->setReal(vr, nvr, value);
+    return fmi2Error;
 }
 
 FMI2_Export fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]) {
@@ -132,7 +137,8 @@ FMI2_Export fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference
 }
 
 FMI2_Export fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]) {
-    return fmi2OK;
+    if (c) return ((OSMPController*)c)->setBoolean(vr, nvr, value);
+    return fmi2Error;
 }
 
 FMI2_Export fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String value[]) {
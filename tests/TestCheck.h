@@ -0,0 +1,38 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cmath>
+#include <iostream>
+
+// Minimal checks for the native unit tests (ctest). Unlike assert they stay
+// active in Release builds and do not stop at the first failure.
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "[Test] FAILED: " << what << std::endl;
+        ++testFailures();
+    }
+}
+
+inline void checkNear(double value, double expected, double tolerance, const char* what) {
+    if (!(std::fabs(value - expected) <= tolerance)) {
+        std::cerr << "[Test] FAILED: " << what << " (" << value << ", expected " << expected << ")" << std::endl;
+        ++testFailures();
+    }
+}
+
+// Exit code of main()
+inline int testResult(const char* name) {
+    if (testFailures() > 0) {
+        std::cerr << "[Test] " << name << ": " << testFailures() << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "[Test] " << name << ": passed" << std::endl;
+    return 0;
+}
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,169 @@
+"""
+Compare SensorView parse/serialize throughput of the protobuf backends.
+
+Each backend runs in its own subprocess, since the backend is selected once
+per process through PROTOCOL_BUFFERS_PYTHON_IMPLEMENTATION.
+
+Usage:
+    python tests/bench_protobuf_backend.py [--objects 10 50 200] [--lanes 50] [--points 200] [--seconds 2]
+
+The vendored runtime in python/ is used; the upb backend is only available
+after running setup_protobuf_upb.ps1 (python/google/_upb/_message.pyd).
+"""
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PYTHON_DIR = os.path.join(REPO_ROOT, "python")
+OSI_DIR = os.path.join(PYTHON_DIR, "osi")
+BACKENDS = ["upb", "python"]
+
+
+def build_sensor_view(osi_sv, num_objects, num_lanes, num_points):
+    """Build a SensorView resembling esmini output: host vehicle, moving objects and lane geometry."""
+    sv = osi_sv.SensorView()
+    sv.version.version_major = 3
+    sv.version.version_minor = 5
+    sv.timestamp.seconds = 12
+    sv.timestamp.nanos = 340000000
+    sv.host_vehicle_id.value = 0
+
+    gt = sv.global_ground_truth
+    gt.timestamp.CopyFrom(sv.timestamp)
+    gt.host_vehicle_id.value = 0
+
+    for i in range(num_objects):
+        obj = gt.moving_object.add()
+        obj.id.value = i
+        obj.type = 2  # TYPE_VEHICLE
+        obj.base.dimension.length = 4.5
+        obj.base.dimension.width = 1.8
+        obj.base.dimension.height = 1.5
+        obj.base.position.x = 10.0 * i
+        obj.base.position.y = 3.5 * (i % 3)
+        obj.base.position.z = 0.0
+        obj.base.orientation.yaw = 0.01 * i
+        obj.base.velocity.x = 20.0 + 0.1 * i
+        obj.base.acceleration.x = 0.2
+        obj.assigned_lane_id.add().value = 100 + (i % num_lanes if num_lanes else 0)
+        obj.vehicle_classification.type = 4  # TYPE_MEDIUM_CAR
+
+    for l in range(num_lanes):
+        lane = gt.lane.add()
+        lane.id.value = 100 + l
+        lane.classification.type = 2  # TYPE_DRIVING
+        for p in range(num_points):
+            pt = lane.classification.centerline.add()
+            pt.x = 1.0 * p
+            pt.y = 3.5 * l
+            pt.z = 0.0
+        for side in range(2):
+            boundary = gt.lane_boundary.add()
+            boundary.id.value = 1000 + 2 * l + side
+            ids = lane.classification.right_lane_boundary_id if side else lane.classification.left_lane_boundary_id
+            ids.add().value = boundary.id.value
+            for p in range(num_points):
+                bp = boundary.boundary_line.add()
+                bp.position.x = 1.0 * p
+                bp.position.y = 3.5 * l + (1.75 if side else -1.75)
+                bp.width = 0.15
+
+    return sv
+
+
+def measure(fn, seconds):
+    count = 0
+    start = time.perf_counter()
+    end = start + seconds
+    while True:
+        fn()
+        count += 1
+        now = time.perf_counter()
+        if now >= end:
+            return count, now - start
+
+
+def run_worker(args):
+    # PROTOCOL_BUFFERS_PYTHON_IMPLEMENTATION is set by the parent before startup
+    sys.path.insert(0, OSI_DIR)
+    sys.path.insert(0, PYTHON_DIR)
+    from google.protobuf.internal import api_implementation
+    import osi_sensorview_pb2 as osi_sv
+
+    results = {"backend": api_implementation.Type(), "sizes": []}
+    for num_objects in args.objects:
+        sv = build_sensor_view(osi_sv, num_objects, args.lanes, args.points)
+        data = sv.SerializeToString()
+
+        parsed = osi_sv.SensorView()
+        n_parse, t_parse = measure(lambda: parsed.ParseFromString(data), args.seconds)
+        n_ser, t_ser = measure(sv.SerializeToString, args.seconds)
+
+        mb = len(data) / 1e6
+        results["sizes"].append({
+            "objects": num_objects,
+            "bytes": len(data),
+            "parse_per_s": n_parse / t_parse,
+            "parse_mb_s": n_parse * mb / t_parse,
+            "serialize_per_s": n_ser / t_ser,
+            "serialize_mb_s": n_ser * mb / t_ser,
+        })
+    print(json.dumps(results))
+
+
+def run_backend(backend, args):
+    env = dict(os.environ)
+    env["PROTOCOL_BUFFERS_PYTHON_IMPLEMENTATION"] = backend
+    cmd = [sys.executable, os.path.abspath(__file__), "--worker",
+           "--lanes", str(args.lanes), "--points", str(args.points),
+           "--seconds", str(args.seconds), "--objects"] + [str(o) for o in args.objects]
+    proc = subprocess.run(cmd, env=env, capture_output=True, text=True)
+    if proc.returncode != 0:
+        return None
+    result = json.loads(proc.stdout.strip().splitlines()[-1])
+    # api_implementation falls back to 'python' when the requested backend is missing
+    if result["backend"] != backend:
+        return None
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--objects", type=int, nargs="+", default=[10, 50, 200])
+    parser.add_argument("--lanes", type=int, default=50)
+    parser.add_argument("--points", type=int, default=200)
+    parser.add_argument("--seconds", type=float, default=2.0)
+    parser.add_argument("--worker", action="store_true", help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.worker:
+        run_worker(args)
+        return
+
+    results = {}
+    for backend in BACKENDS:
+        results[backend] = run_backend(backend, args)
+        if results[backend] is None:
+            print(f"[Bench] Backend '{backend}' not available")
+
+    print(f"\n{'backend':<8} {'objects':>8} {'bytes':>10} {'parse/s':>10} {'parse MB/s':>11} {'ser/s':>10} {'ser MB/s':>9}")
+    for backend in BACKENDS:
+        if not results[backend]:
+            continue
+        for r in results[backend]["sizes"]:
+            print(f"{backend:<8} {r['objects']:>8} {r['bytes']:>10} {r['parse_per_s']:>10.1f} "
+                  f"{r['parse_mb_s']:>11.2f} {r['serialize_per_s']:>10.1f} {r['serialize_mb_s']:>9.2f}")
+
+    if results["upb"] and results["python"]:
+        print()
+        for fast, slow in zip(results["upb"]["sizes"], results["python"]["sizes"]):
+            print(f"[Bench] {fast['objects']} objects: upb parse x{fast['parse_per_s'] / slow['parse_per_s']:.1f}, "
+                  f"serialize x{fast['serialize_per_s'] / slow['serialize_per_s']:.1f}")
+
+
+if __name__ == "__main__":
+    main()
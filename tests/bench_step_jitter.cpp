@@ -0,0 +1,163 @@
+// Step jitter benchmark for the real-time profile.
+// Usage: bench_step_jitter.exe [steps] [payload_bytes] [cpu_affinity] [deadline_ms]
+// Reports mean, p99, p99.99 and max fmi2DoStep wall-clock times.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "fmi2Functions.h"
+
+#include <windows.h>
+
+typedef fmi2Component (*fmi2Instantiate_t)(fmi2String, fmi2Type, fmi2String, fmi2String, const fmi2CallbackFunctions*, fmi2Boolean, fmi2Boolean);
+typedef void (*fmi2FreeInstance_t)(fmi2Component);
+typedef fmi2Status (*fmi2EnterInitializationMode_t)(fmi2Component);
+typedef fmi2Status (*fmi2ExitInitializationMode_t)(fmi2Component);
+typedef fmi2Status (*fmi2DoStep_t)(fmi2Component, fmi2Real, fmi2Real, fmi2Boolean);
+typedef fmi2Status (*fmi2SetInteger_t)(fmi2Component, const fmi2ValueReference[], size_t, const fmi2Integer[]);
+typedef fmi2Status (*fmi2GetInteger_t)(fmi2Component, const fmi2ValueReference[], size_t, fmi2Integer[]);
+typedef fmi2Status (*fmi2SetReal_t)(fmi2Component, const fmi2ValueReference[], size_t, const fmi2Real[]);
+typedef fmi2Status (*fmi2SetBoolean_t)(fmi2Component, const fmi2ValueReference[], size_t, const fmi2Boolean[]);
+typedef fmi2Status (*fmi2SetString_t)(fmi2Component, const fmi2ValueReference[], size_t, const fmi2String[]);
+
+void cb_logger(fmi2ComponentEnvironment c, fmi2String instanceName, fmi2Status status, fmi2String category, fmi2String message, ...) {
+    printf("[FMU Log] %s: %s\n", category, message);
+}
+
+// Build a parseable SensorView of the requested size: the payload is carried
+// in an unknown length-delimited field (number 1000), which protobuf keeps as-is.
+static std::string makePayload(size_t bytes) {
+    std::string msg;
+    msg.push_back((char)0xC2); // Tag: field 1000, wire type 2
+    msg.push_back((char)0x3E);
+    size_t len = bytes > 16 ? bytes - 16 : 0;
+    size_t v = len;
+    do {
+        unsigned char b = v & 0x7F;
+        v >>= 7;
+        msg.push_back((char)(v ? (b | 0x80) : b));
+    } while (v);
+    msg.append(len, 'x');
+    return msg;
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t idx = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+int main(int argc, char** argv) {
+    size_t steps = argc > 1 ? (size_t)std::atoll(argv[1]) : 100000;
+    size_t payloadBytes = argc > 2 ? (size_t)std::atoll(argv[2]) : 64 * 1024;
+    std::string affinity = argc > 3 ? argv[3] : "";
+    double deadlineMs = argc > 4 ? std::atof(argv[4]) : 0.0;
+    const size_t WARMUP_STEPS = 100;
+
+    HMODULE hLib = LoadLibraryA("GT-DriveController.dll");
+    if (!hLib) {
+        std::cerr << "[Bench] Failed to load DLL. Error: " << GetLastError() << std::endl;
+        return 1;
+    }
+
+    auto f_instantiate = (fmi2Instantiate_t)GetProcAddress(hLib, "fmi2Instantiate");
+    auto f_free = (fmi2FreeInstance_t)GetProcAddress(hLib, "fmi2FreeInstance");
+    auto f_enterInitMode = (fmi2EnterInitializationMode_t)GetProcAddress(hLib, "fmi2EnterInitializationMode");
+    auto f_exitInitMode = (fmi2ExitInitializationMode_t)GetProcAddress(hLib, "fmi2ExitInitializationMode");
+    auto f_doStep = (fmi2DoStep_t)GetProcAddress(hLib, "fmi2DoStep");
+    auto f_setInteger = (fmi2SetInteger_t)GetProcAddress(hLib, "fmi2SetInteger");
+    auto f_getInteger = (fmi2GetInteger_t)GetProcAddress(hLib, "fmi2GetInteger");
+    auto f_setReal = (fmi2SetReal_t)GetProcAddress(hLib, "fmi2SetReal");
+    auto f_setBoolean = (fmi2SetBoolean_t)GetProcAddress(hLib, "fmi2SetBoolean");
+    auto f_setString = (fmi2SetString_t)GetProcAddress(hLib, "fmi2SetString");
+
+    if (!f_instantiate || !f_free || !f_enterInitMode || !f_exitInitMode || !f_doStep || !f_setInteger ||
+        !f_getInteger || !f_setReal || !f_setBoolean || !f_setString) {
+        std::cerr << "[Bench] Failed to load FMI functions." << std::endl;
+        return 1;
+    }
+
+    fmi2CallbackFunctions callbacks = { cb_logger, NULL, NULL, NULL, NULL };
+
+    char buffer[MAX_PATH];
+    GetCurrentDirectoryA(MAX_PATH, buffer);
+    std::string resPath = "file:///" + std::string(buffer) + "/resources";
+    for (auto& c : resPath) if (c == '\\') c = '/';
+
+    fmi2Component c = f_instantiate("JitterBench", fmi2CoSimulation, "{guid}", resPath.c_str(), &callbacks, fmi2False, fmi2False);
+    if (!c) {
+        std::cerr << "[Bench] Instantiation failed." << std::endl;
+        return 1;
+    }
+
+    // Real-time profile parameters
+    {
+        fmi2ValueReference vr_profile = 17; // RealtimeProfile
+        fmi2Boolean val_profile = fmi2True;
+        f_setBoolean(c, &vr_profile, 1, &val_profile);
+
+        fmi2ValueReference vr_affinity = 18; // RealtimeCpuAffinity
+        fmi2String val_affinity = affinity.c_str();
+        f_setString(c, &vr_affinity, 1, &val_affinity);
+
+        fmi2ValueReference vr_bytes = 20; // RealtimeBufferBytes
+        fmi2Integer val_bytes = (fmi2Integer)(payloadBytes * 2);
+        f_setInteger(c, &vr_bytes, 1, &val_bytes);
+
+        fmi2ValueReference vr_deadline = 13; // StepDeadlineMs
+        f_setReal(c, &vr_deadline, 1, &deadlineMs);
+    }
+
+    if (f_enterInitMode(c) != fmi2OK) {
+        std::cerr << "[Bench] EnterInitializationMode failed." << std::endl;
+        f_free(c);
+        return 1;
+    }
+    f_exitInitMode(c);
+
+    std::string payload = makePayload(payloadBytes);
+    uintptr_t ptrVal = (uintptr_t)payload.data();
+    fmi2ValueReference vrs[] = { 0, 1, 2 }; // BaseLo, BaseHi, Size
+    fmi2Integer vals[] = {
+        (fmi2Integer)(ptrVal & 0xFFFFFFFF),
+        (fmi2Integer)((ptrVal >> 32) & 0xFFFFFFFF),
+        (fmi2Integer)payload.size()
+    };
+    f_setInteger(c, vrs, 3, vals);
+
+    std::vector<double> samples;
+    samples.reserve(steps);
+
+    const double dt = 0.01;
+    for (size_t i = 0; i < WARMUP_STEPS + steps; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        f_doStep(c, i * dt, dt, fmi2True);
+        auto t1 = std::chrono::steady_clock::now();
+        if (i >= WARMUP_STEPS) {
+            samples.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        }
+    }
+
+    fmi2ValueReference vr_counts[] = { 16, 21 }; // DeadlineMissCount, RealtimeStepAllocCount
+    fmi2Integer counts[2] = { 0, 0 };
+    f_getInteger(c, vr_counts, 2, counts);
+
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    std::sort(samples.begin(), samples.end());
+
+    printf("[Bench] steps=%zu payload=%zu bytes affinity='%s' deadline=%.3f ms\n",
+           samples.size(), payload.size(), affinity.c_str(), deadlineMs);
+    printf("[Bench] mean=%.2f us  p50=%.2f us  p99=%.2f us  p99.99=%.2f us  max=%.2f us\n",
+           samples.empty() ? 0.0 : sum / samples.size(),
+           percentile(samples, 50.0), percentile(samples, 99.0),
+           percentile(samples, 99.99), samples.empty() ? 0.0 : samples.back());
+    printf("[Bench] deadline misses=%d  steady-state C++ allocations=%d\n", counts[0], counts[1]);
+
+    f_free(c);
+    return 0;
+}
@@ -19,6 +19,7 @@ typedef fmi2Status (*fmi2DoStep_t)(fmi2Component, fmi2Real, fmi2Real, fmi2Boolea
 typedef fmi2Status (*fmi2SetInteger_t)(fmi2Component, const fmi2ValueReference[], size_t, const fmi2Integer[]);
 typedef fmi2Status (*fmi2GetInteger_t)(fmi2Component, const fmi2ValueReference[], size_t, fmi2Integer[]);
 typedef fmi2Status (*fmi2GetReal_t)(fmi2Component, const fmi2ValueReference[], size_t, fmi2Real[]);
+typedef fmi2Status (*fmi2GetBoolean_t)(fmi2Component, const fmi2ValueReference[], size_t, fmi2Boolean[]);
 typedef fmi2Status (*fmi2SetString_t)(fmi2Component, const fmi2ValueReference[], size_t, const fmi2String[]);
 
 // Dummy Logger
@@ -43,9 +44,10 @@ int main() {
     auto f_setInteger = (fmi2SetInteger_t)GetProcAddress(hLib, "fmi2SetInteger");
     auto f_getInteger = (fmi2GetInteger_t)GetProcAddress(hLib, "fmi2GetInteger");
     auto f_getReal = (fmi2GetReal_t)GetProcAddress(hLib, "fmi2GetReal");
+    auto f_getBoolean = (fmi2GetBoolean_t)GetProcAddress(hLib, "fmi2GetBoolean");
     auto f_setString = (fmi2SetString_t)GetProcAddress(hLib, "fmi2SetString");
 
-    if (!f_instantiate || !f_enterInitMode || !f_exitInitMode || !f_doStep || !f_setInteger || !f_getInteger || !f_getReal || !f_setString) {
+    if (!f_instantiate || !f_enterInitMode || !f_exitInitMode || !f_doStep || !f_setInteger || !f_getInteger || !f_getReal || !f_getBoolean || !f_setString) {
         std::cerr << "[Test] Failed to load FMI functions." << std::endl;
         return 1;
     }
@@ -89,6 +91,15 @@ int main() {
         return 1;
     }
 
+    // Verify the SensorViewConfiguration request is published in initialization mode
+    {
+        fmi2ValueReference vr_req_size = 50; // OSI_SensorViewInConfigRequest_Size
+        fmi2Integer val_req_size = 0;
+        f_getInteger(c, &vr_req_size, 1, &val_req_size);
+        std::cout << "[Test] SensorViewConfiguration request size: " << val_req_size << std::endl;
+        assert(val_req_size > 0);
+    }
+
     // 1d. Exit Initialization Mode
     f_exitInitMode(c);
     std::cout << "[Test] Ready for simulation." << std::endl;
@@ -137,6 +148,13 @@ int main() {
         assert(val_int[3] == 1);
         // Verify OSI_Out_Size matches input (since passthrough)
         assert(val_int[2] == size);
+
+        // Verify outputs came from Python, not from the fallback controller
+        fmi2ValueReference vr_valid = 6;
+        fmi2Boolean val_valid = fmi2False;
+        f_getBoolean(c, &vr_valid, 1, &val_valid);
+        std::cout << "[Test] Outputs: valid=" << val_valid << std::endl;
+        assert(val_valid == fmi2True);
     }
 
     f_free(c);
@@ -0,0 +1,182 @@
+// Unit tests of the multi-object tracker (ObjectTracker): assignment against known
+// optimal matchings, Kalman estimates and the track life cycle
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "ObjectTracker.h"
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include "TestCheck.h"
+
+using namespace OsiFields;
+
+namespace {
+
+const double DT = 0.1;
+
+struct Detection {
+    double x;
+    double y;
+    uint64_t sensorId;
+};
+
+void writeMessage(std::string& out, uint32_t number, const std::string& message) {
+    OsiWire::writeLengthDelimited(out, number, message.data(), message.size());
+}
+
+std::string vector3d(double x, double y) {
+    std::string message;
+    OsiWire::writeDoubleField(message, Vector3d::X, x);
+    OsiWire::writeDoubleField(message, Vector3d::Y, y);
+    OsiWire::writeDoubleField(message, Vector3d::Z, 0.0);
+    return message;
+}
+
+// SensorData without timestamp and host vehicle location: detections stay in their frame
+std::string sensorData(const std::vector<Detection>& detections) {
+    std::string message;
+    for (const Detection& d : detections) {
+        std::string id, header, base, object;
+        OsiWire::writeVarintField(id, Identifier::Value, d.sensorId);
+        writeMessage(header, DetectedItemHeader::TrackingId, id);
+        writeMessage(base, BaseMoving::Dimension, vector3d(4.5, 1.8));
+        writeMessage(base, BaseMoving::Position, vector3d(d.x, d.y));
+        writeMessage(object, DetectedMovingObject::Header, header);
+        writeMessage(object, DetectedMovingObject::Base, base);
+        writeMessage(message, SensorData::MovingObject, object);
+    }
+    return message;
+}
+
+bool update(ObjectTracker& tracker, const std::vector<Detection>& detections, double time) {
+    std::string message = sensorData(detections);
+    std::string error;
+    return tracker.update(message.data(), message.size(), time, error);
+}
+
+// Tracks of equal age have the same isotropic covariance, so the gated cost is
+// proportional to the squared distance and the optimum follows by enumeration
+std::vector<int> bruteForceAssignment(const std::vector<Detection>& tracks, const std::vector<Detection>& detections,
+                                      double& best, double& secondBest) {
+    std::vector<int> permutation(detections.size());
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::vector<int> result;
+    best = secondBest = INFINITY;
+    do {
+        double cost = 0.0;
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            const Detection& d = detections[permutation[i]];
+            cost += (tracks[i].x - d.x) * (tracks[i].x - d.x) + (tracks[i].y - d.y) * (tracks[i].y - d.y);
+        }
+        if (cost < best) {
+            secondBest = best;
+            best = cost;
+            result = permutation;
+        } else if (cost < secondBest) {
+            secondBest = cost;
+        }
+    } while (std::next_permutation(permutation.begin(), permutation.end()));
+    return result;
+}
+
+void testGreedyCounterexample() {
+    // Costs (squared distances): A-d0 0.64, A-d1 1.28, B-d0 1.28, B-d1 outside the gate.
+    // Greedy takes A-d0 and leaves B unassigned; the optimum is A-d1, B-d0.
+    const std::vector<Detection> tracks = { { 0.0, 0.0, 1 }, { 1.931, 0.0, 2 } };
+    const std::vector<Detection> detections = { { 0.8, 0.0, 3 }, { -1.131, 0.0, 4 } };
+
+    ObjectTracker hungarian;
+    check(update(hungarian, tracks, 0.0) && hungarian.count() == 2, "hungarian: tracks created");
+    check(update(hungarian, detections, DT), "hungarian: update");
+    check(hungarian.count() == 2 && hungarian.stats().assigned == 2 && hungarian.stats().created == 0,
+          "hungarian: both detections assigned");
+    if (hungarian.count() == 2) {
+        check(hungarian.detection()[0] == 1 && hungarian.detection()[1] == 0, "hungarian: optimal matching");
+    }
+
+    ObjectTracker greedy;
+    greedy.settings.greedy = true;
+    check(update(greedy, tracks, 0.0), "greedy: tracks created");
+    check(update(greedy, detections, DT), "greedy: update");
+    check(greedy.stats().assigned == 1 && greedy.stats().created == 1, "greedy: nearest pair first");
+    check(!greedy.detection().empty() && greedy.detection()[0] == 0, "greedy: A takes d0");
+}
+
+void testOptimalMatching() {
+    // Four tracks in a tight cluster, detections permuted and displaced; all pairs in the gate
+    const std::vector<Detection> tracks = { { 0.0, 0.0, 1 }, { 1.0, 0.2, 2 }, { 0.3, 1.1, 3 }, { 1.2, 1.0, 4 } };
+    const std::vector<Detection> detections = { { 0.9, 0.6, 5 }, { 0.1, 0.6, 6 }, { 1.5, 0.4, 7 }, { 0.6, 1.3, 8 } };
+    double best = 0.0, secondBest = 0.0;
+    std::vector<int> expected = bruteForceAssignment(tracks, detections, best, secondBest);
+    check(secondBest - best > 0.05, "matching: unique optimum in the test data");
+
+    ObjectTracker tracker;
+    check(update(tracker, tracks, 0.0) && tracker.count() == 4, "matching: tracks created");
+    check(update(tracker, detections, DT), "matching: update");
+    check(tracker.count() == 4 && tracker.stats().assigned == 4, "matching: all assigned");
+    if (tracker.count() == 4) {
+        for (size_t i = 0; i < 4; ++i) {
+            check(tracker.detection()[i] == expected[i], "matching: minimum total cost");
+        }
+    }
+}
+
+void testKalman() {
+    // Constant velocity target: the estimate converges to the true state
+    const double vx = 8.0, vy = -2.0;
+    ObjectTracker tracker;
+    bool ok = true;
+    for (int k = 0; k < 50; ++k) {
+        double t = k * DT;
+        ok &= update(tracker, { { 10.0 + vx * t, 5.0 + vy * t, 1 } }, t);
+    }
+    check(ok && tracker.count() == 1, "kalman: one track");
+    if (tracker.count() == 1) {
+        double t = 49 * DT;
+        checkNear(tracker.x()[0], 10.0 + vx * t, 1e-3, "kalman: x");
+        checkNear(tracker.y()[0], 5.0 + vy * t, 1e-3, "kalman: y");
+        checkNear(tracker.vx()[0], vx, 1e-2, "kalman: vx");
+        checkNear(tracker.vy()[0], vy, 1e-2, "kalman: vy");
+        double r = tracker.settings.measurementStd * tracker.settings.measurementStd;
+        check(tracker.covariance(0)[0] < r && tracker.covariance(0)[0] > 0.0, "kalman: position variance below the measurement's");
+        check(tracker.confirmed()[0] && tracker.hits()[0] == 50, "kalman: confirmed");
+    }
+}
+
+void testLifeCycle() {
+    ObjectTracker tracker;
+    tracker.settings.confirmHits = 3;
+    tracker.settings.maxMisses = 2;
+    const std::vector<Detection> target = { { 0.0, 0.0, 1 } };
+    update(tracker, target, 0.0);
+    update(tracker, target, DT);
+    check(tracker.count() == 1 && !tracker.confirmed()[0], "life cycle: tentative before confirmHits");
+    update(tracker, target, 2 * DT);
+    check(tracker.count() == 1 && tracker.confirmed()[0], "life cycle: confirmed");
+    update(tracker, {}, 3 * DT);
+    update(tracker, {}, 4 * DT);
+    check(tracker.count() == 1 && tracker.misses()[0] == 2, "life cycle: kept up to maxMisses");
+    update(tracker, {}, 5 * DT);
+    check(tracker.count() == 0 && tracker.stats().deleted == 1, "life cycle: deleted after maxMisses");
+
+    // Tentative tracks go on their first miss
+    update(tracker, target, 6 * DT);
+    update(tracker, {}, 7 * DT);
+    check(tracker.count() == 0, "life cycle: tentative track deleted on a miss");
+
+    std::string error;
+    const char truncated[] = { 0x6a, 0x10, 0x01 }; // moving_object claiming 16 bytes
+    check(!tracker.update(truncated, sizeof(truncated), 8 * DT, error) && !error.empty(), "malformed: rejected");
+}
+
+} // namespace
+
+int main() {
+    testGreedyCounterexample();
+    testOptimalMatching();
+    testKalman();
+    testLifeCycle();
+    return testResult("test_object_tracker");
+}
@@ -0,0 +1,267 @@
+// Unit tests of the wire-level OSI output edits (OsiPatch / OsiWire)
+#include <cstring>
+#include <string>
+#include <vector>
+#include "OsiPatch.h"
+#include "TestCheck.h"
+
+using OsiPatch::Edit;
+using OsiPatch::Op;
+
+namespace {
+
+// Field numbers of the messages used below (osi_sensorview.proto, osi_object.proto)
+const uint32_t GT = 7;        // SensorView.global_ground_truth
+const uint32_t TIMESTAMP = 2; // SensorView.timestamp (stands in for any untouched field)
+const uint32_t MOVING = 5;    // GroundTruth.moving_object
+const uint32_t ID = 1;        // MovingObject.id (Identifier, value = 1)
+const uint32_t BASE = 2;      // MovingObject.base
+const uint32_t POSITION = 2;  // BaseMoving.position
+
+std::string makeObject(uint64_t id, double x, double y) {
+    std::string identifier, position, base, object;
+    OsiWire::writeVarintField(identifier, 1, id);
+    OsiWire::writeDoubleField(position, 1, x);
+    OsiWire::writeDoubleField(position, 2, y);
+    OsiWire::writeLengthDelimited(base, POSITION, position.data(), position.size());
+    OsiWire::writeLengthDelimited(object, ID, identifier.data(), identifier.size());
+    OsiWire::writeLengthDelimited(object, BASE, base.data(), base.size());
+    return object;
+}
+
+// SensorView with a timestamp and three moving objects (ids 10, 11, 12)
+std::string makeSensorView() {
+    std::string timestamp, gt, view;
+    OsiWire::writeVarintField(timestamp, 1, 42);
+    for (uint64_t i = 0; i < 3; ++i) {
+        std::string object = makeObject(10 + i, (double)i, -(double)i);
+        OsiWire::writeLengthDelimited(gt, MOVING, object.data(), object.size());
+    }
+    OsiWire::writeLengthDelimited(view, TIMESTAMP, timestamp.data(), timestamp.size());
+    OsiWire::writeLengthDelimited(view, GT, gt.data(), gt.size());
+    return view;
+}
+
+// All occurrences of a field of a message; they point into message
+std::vector<OsiWire::Field> fields(const std::string& message, uint32_t number) {
+    std::vector<OsiWire::Field> result;
+    OsiWire::Reader reader(message.data(), message.size());
+    OsiWire::Field field;
+    while (reader.next(field)) {
+        if (field.number == number) {
+            result.push_back(field);
+        }
+    }
+    return result;
+}
+
+std::string payload(const OsiWire::Field& field) {
+    return std::string(field.data, field.size);
+}
+
+// Moving objects of a SensorView, serialized
+std::vector<std::string> movingObjects(const std::string& view) {
+    std::vector<std::string> objects;
+    std::vector<OsiWire::Field> gt = fields(view, GT);
+    if (gt.size() == 1) {
+        const std::string ground = payload(gt[0]);
+        for (const OsiWire::Field& field : fields(ground, MOVING)) {
+            objects.push_back(payload(field));
+        }
+    }
+    return objects;
+}
+
+uint64_t objectId(const std::string& object) {
+    std::vector<OsiWire::Field> id = fields(object, ID);
+    if (id.size() != 1) {
+        return 0;
+    }
+    const std::string identifier = payload(id[0]);
+    std::vector<OsiWire::Field> value = fields(identifier, 1);
+    return value.size() == 1 ? value[0].varint : 0;
+}
+
+double positionX(const std::string& object) {
+    std::vector<OsiWire::Field> base = fields(object, BASE);
+    if (base.size() != 1) {
+        return -1e9;
+    }
+    const std::string baseMoving = payload(base[0]);
+    std::vector<OsiWire::Field> position = fields(baseMoving, POSITION);
+    if (position.size() != 1) {
+        return -1e9;
+    }
+    const std::string vector3d = payload(position[0]);
+    std::vector<OsiWire::Field> x = fields(vector3d, 1);
+    double value = -1e9;
+    if (x.size() == 1) {
+        std::memcpy(&value, &x[0].varint, 8);
+    }
+    return value;
+}
+
+Edit setDouble(std::vector<OsiPatch::PathElement> path, double value) {
+    Edit edit;
+    edit.op = Op::Set;
+    edit.path = path;
+    edit.type = OsiWire::WireType::Fixed64;
+    std::memcpy(&edit.scalar, &value, 8);
+    return edit;
+}
+
+void testSetRoundTrip() {
+    std::string view = makeSensorView();
+    std::vector<Edit> edits = { setDouble({ { GT, -1 }, { MOVING, 1 }, { BASE, -1 }, { POSITION, -1 }, { 1, -1 } }, 12.5) };
+    std::string out, error;
+    check(OsiPatch::apply(view.data(), view.size(), edits, out, error), "set: apply");
+
+    std::vector<std::string> objects = movingObjects(out);
+    check(objects.size() == 3, "set: object count");
+    if (objects.size() == 3) {
+        checkNear(positionX(objects[1]), 12.5, 0.0, "set: patched field");
+        checkNear(positionX(objects[0]), 0.0, 0.0, "set: other object unchanged");
+        check(objects[0] == movingObjects(view)[0], "set: other object copied verbatim");
+        check(objectId(objects[1]) == 11, "set: sibling field of the patched message");
+    }
+    std::vector<OsiWire::Field> timestamp = fields(out, TIMESTAMP);
+    check(timestamp.size() == 1 && payload(timestamp[0]) == payload(fields(view, TIMESTAMP)[0]),
+          "set: untouched top-level field copied verbatim");
+}
+
+void testRemoveAndAppend() {
+    std::string view = makeSensorView();
+    std::string extra = makeObject(99, 7.0, 8.0);
+    std::vector<Edit> edits(2);
+    edits[0].op = Op::Remove;
+    edits[0].path = { { GT, -1 }, { MOVING, 0 } };
+    edits[1].op = Op::Append;
+    edits[1].path = { { GT, -1 }, { MOVING, -1 } };
+    edits[1].type = OsiWire::WireType::LengthDelimited;
+    edits[1].bytes = extra;
+    std::string out, error;
+    check(OsiPatch::apply(view.data(), view.size(), edits, out, error), "remove/append: apply");
+
+    std::vector<std::string> objects = movingObjects(out);
+    check(objects.size() == 3, "remove/append: object count");
+    if (objects.size() == 3) {
+        check(objectId(objects[0]) == 11 && objectId(objects[1]) == 12, "remove/append: remaining order");
+        check(objects[2] == extra, "remove/append: appended element last");
+    }
+
+    // Remove without an index drops all occurrences
+    std::vector<Edit> removeAll(1);
+    removeAll[0].op = Op::Remove;
+    removeAll[0].path = { { GT, -1 }, { MOVING, -1 } };
+    check(OsiPatch::apply(view.data(), view.size(), removeAll, out, error), "remove all: apply");
+    check(movingObjects(out).empty(), "remove all: no objects left");
+}
+
+void testMissingFields() {
+    // A missing singular sub-message is created from the edits below it
+    std::string view = makeSensorView();
+    Edit version;
+    version.op = Op::Set;
+    version.path = { { 1, -1 }, { 1, -1 } }; // SensorView.version.version_major
+    version.scalar = 3;
+    std::string out, error;
+    check(OsiPatch::apply(view.data(), view.size(), { version }, out, error), "missing: apply");
+    std::vector<OsiWire::Field> created = fields(out, 1);
+    check(created.size() == 1, "missing: sub-message added");
+    if (created.size() == 1) {
+        const std::string versionMessage = payload(created[0]);
+        std::vector<OsiWire::Field> major = fields(versionMessage, 1);
+        check(major.size() == 1 && major[0].varint == 3, "missing: value in the new sub-message");
+    }
+    check(out.compare(0, view.size(), view) == 0, "missing: input copied before the new field");
+
+    // An indexed element that does not exist is an error
+    std::vector<Edit> edits = { setDouble({ { GT, -1 }, { MOVING, 5 }, { BASE, -1 } }, 1.0) };
+    check(!OsiPatch::apply(view.data(), view.size(), edits, out, error), "missing index: rejected");
+    check(!error.empty(), "missing index: error message");
+}
+
+void testMalformedInput() {
+    std::string view = makeSensorView();
+    std::string truncated = view.substr(0, view.size() - 5);
+    std::vector<Edit> edits = { setDouble({ { GT, -1 }, { MOVING, 0 }, { BASE, -1 } }, 1.0) };
+    std::string out, error;
+    check(!OsiPatch::apply(truncated.data(), truncated.size(), edits, out, error), "malformed: rejected");
+
+    // A scalar on the path cannot be descended into
+    Edit intoScalar = setDouble({ { TIMESTAMP, -1 }, { 1, -1 }, { 1, -1 } }, 1.0);
+    check(!OsiPatch::apply(view.data(), view.size(), { intoScalar }, out, error), "scalar on path: rejected");
+
+    Edit emptyPath;
+    check(!OsiPatch::apply(view.data(), view.size(), { emptyPath }, out, error), "empty path: rejected");
+}
+
+void testPatcherReuse() {
+    // The same Patcher gives the same output across calls with different depths
+    std::string view = makeSensorView();
+    std::vector<Edit> deep = { setDouble({ { GT, -1 }, { MOVING, 2 }, { BASE, -1 }, { POSITION, -1 }, { 2, -1 } }, -4.0) };
+    std::vector<Edit> shallow(1);
+    shallow[0].op = Op::Remove;
+    shallow[0].path = { { TIMESTAMP, -1 } };
+
+    OsiPatch::Patcher patcher;
+    std::string first, second, reference, error;
+    check(patcher.apply(view.data(), view.size(), deep, first, error), "reuse: first call");
+    check(patcher.apply(view.data(), view.size(), shallow, second, error), "reuse: shallow call");
+    check(fields(second, TIMESTAMP).empty() && movingObjects(second) == movingObjects(view), "reuse: shallow result");
+    check(patcher.apply(view.data(), view.size(), deep, second, error), "reuse: repeated call");
+    check(OsiPatch::apply(view.data(), view.size(), deep, reference, error), "reuse: reference");
+    check(first == second && second == reference, "reuse: identical output");
+
+    // No edits: the input is copied
+    check(patcher.apply(view.data(), view.size(), {}, second, error) && second == view, "no edits: copy");
+}
+
+// Contracts of the shared readers of Identifier, Vector3d and double fields
+void testWireReaders() {
+    std::string identifier, ordered, partial, message;
+    OsiWire::writeVarintField(identifier, 1, 77);
+    for (uint32_t k = 1; k <= 3; ++k) {
+        OsiWire::writeDoubleField(ordered, k, 0.5 * k);
+    }
+    OsiWire::writeDoubleField(partial, 3, -2.0);
+    OsiWire::writeDoubleField(partial, 1, 4.0);
+    OsiWire::writeLengthDelimited(message, 1, identifier.data(), identifier.size());
+    OsiWire::writeLengthDelimited(message, 2, ordered.data(), ordered.size());
+    OsiWire::writeLengthDelimited(message, 3, partial.data(), partial.size());
+    OsiWire::writeLengthDelimited(message, 4, "\x09\x00", 2); // Double field cut short
+    OsiWire::writeVarintField(message, 5, 9);
+    std::vector<OsiWire::Field> f;
+    for (uint32_t number = 1; number <= 5; ++number) {
+        f.push_back(fields(message, number).at(0));
+    }
+
+    uint64_t id = 1;
+    check(OsiWire::readIdentifier(f[0], id) && id == 77, "identifier: value");
+    check(OsiWire::readIdentifier(f[2], id) && id == 0, "identifier: unset value is 0");
+    check(!OsiWire::readIdentifier(f[3], id) && id == 0, "identifier: malformed");
+    check(!OsiWire::readIdentifier(f[4], id) && id == 0, "identifier: not a message");
+
+    double v[3] = { 9.0, 9.0, 9.0 };
+    check(OsiWire::readVector3d(f[1], v) && v[0] == 0.5 && v[1] == 1.0 && v[2] == 1.5, "vector: in order");
+    check(OsiWire::readVector3d(f[2], v) && v[0] == 4.0 && v[1] == 0.0 && v[2] == -2.0, "vector: unordered, partial");
+    v[0] = 9.0;
+    check(!OsiWire::readVector3d(f[3], v) && v[0] == 0.0, "vector: malformed");
+    check(!OsiWire::readVector3d(f[4], v), "vector: not a message");
+
+    std::vector<OsiWire::Field> x = fields(ordered, 1);
+    check(OsiWire::readDouble(x.at(0)) == 0.5, "double: value");
+    check(OsiWire::readDouble(f[4]) == 0.0, "double: other wire type");
+}
+
+} // namespace
+
+int main() {
+    testSetRoundTrip();
+    testRemoveAndAppend();
+    testMissingFields();
+    testMalformedInput();
+    testPatcherReuse();
+    testWireReaders();
+    return testResult("test_osi_patch");
+}
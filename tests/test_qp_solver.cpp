@@ -0,0 +1,217 @@
+// Unit tests of the dense ADMM QP solver and the condensed linear MPC (QpSolver / LinearMpc)
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "LinearMpc.h"
+#include "QpSolver.h"
+#include "TestCheck.h"
+
+namespace {
+
+const double TOL = 1e-4;
+
+void tighten(QpSettings& settings) {
+    settings.epsAbs = 1e-8;
+    settings.epsRel = 1e-8;
+}
+
+void testUnconstrained() {
+    // x* = -P^-1 q = -(1/7) [1, 3], objective -0.5 q'P^-1 q = -2/7
+    const double P[4] = { 4.0, 1.0, 1.0, 2.0 };
+    const double q[2] = { 1.0, 1.0 };
+    QpSolver qp;
+    tighten(qp.settings);
+    std::string error;
+    check(qp.setup(2, 0, P, nullptr, error), "unconstrained: setup");
+    const QpInfo& info = qp.solve(q, nullptr, nullptr, nullptr, nullptr);
+    check(info.status == QpStatus::Solved, "unconstrained: solved");
+    checkNear(qp.solution()[0], -1.0 / 7.0, TOL, "unconstrained: x0");
+    checkNear(qp.solution()[1], -3.0 / 7.0, TOL, "unconstrained: x1");
+    checkNear(info.objective, -2.0 / 7.0, TOL, "unconstrained: objective");
+}
+
+void testBox() {
+    // min 0.5 |x - c|^2 within [-1, 1]: x* = clip(c)
+    const size_t n = 5;
+    const double c[n] = { -3.0, -0.5, 0.0, 0.25, 2.0 };
+    std::vector<double> P(n * n, 0.0), q(n), lb(n, -1.0), ub(n, 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        P[i * n + i] = 1.0;
+        q[i] = -c[i];
+    }
+    QpSolver qp;
+    tighten(qp.settings);
+    std::string error;
+    check(qp.setup(n, 0, P.data(), nullptr, error), "box: setup");
+    check(qp.solve(q.data(), lb.data(), ub.data(), nullptr, nullptr).status == QpStatus::Solved, "box: solved");
+    for (size_t i = 0; i < n; ++i) {
+        checkNear(qp.solution()[i], std::clamp(c[i], -1.0, 1.0), TOL, "box: clipped");
+    }
+    // Multipliers of the active bounds: |y| = |c - clip(c)|, inactive ones 0
+    checkNear(std::fabs(qp.dual()[0]), 2.0, TOL, "box: dual of an active bound");
+    checkNear(qp.dual()[2], 0.0, TOL, "box: dual of an inactive bound");
+}
+
+void testEquality() {
+    // min 0.5 |x|^2 s.t. sum x = 1: x* = 1/n
+    const size_t n = 8;
+    std::vector<double> P(n * n, 0.0), A(n, 1.0);
+    for (size_t i = 0; i < n; ++i) {
+        P[i * n + i] = 1.0;
+    }
+    const double one = 1.0;
+    QpSolver qp;
+    tighten(qp.settings);
+    std::string error;
+    check(qp.setup(n, 1, P.data(), A.data(), error), "equality: setup");
+    check(qp.solve(nullptr, nullptr, nullptr, &one, &one).status == QpStatus::Solved, "equality: solved");
+    for (size_t i = 0; i < n; ++i) {
+        checkNear(qp.solution()[i], 1.0 / n, TOL, "equality: x");
+    }
+    checkNear(std::fabs(qp.dual()[n]), 1.0 / n, TOL, "equality: dual of the constraint row");
+}
+
+void testActiveInequality() {
+    // Projection of (1, 2) onto x0 + x1 <= 1: (0, 1)
+    const double P[4] = { 2.0, 0.0, 0.0, 2.0 };
+    const double q[2] = { -2.0, -4.0 };
+    const double A[2] = { 1.0, 1.0 };
+    const double lbA = -INFINITY;
+    const double ubA = 1.0;
+    QpSolver qp;
+    tighten(qp.settings);
+    std::string error;
+    check(qp.setup(2, 1, P, A, error), "inequality: setup");
+    const QpInfo& info = qp.solve(q, nullptr, nullptr, &lbA, &ubA);
+    check(info.status == QpStatus::Solved, "inequality: solved");
+    checkNear(qp.solution()[0], 0.0, TOL, "inequality: x0");
+    checkNear(qp.solution()[1], 1.0, TOL, "inequality: x1");
+    checkNear(info.objective, -3.0, TOL, "inequality: objective");
+
+    // Warm start from the previous solution: same problem again converges at least as fast
+    int iterations = info.iterations;
+    check(qp.solve(q, nullptr, nullptr, &lbA, &ubA).iterations <= iterations, "inequality: warm start");
+}
+
+void testInvalidInput() {
+    const double P[4] = { 1.0, 0.0, 0.0, 1.0 };
+    const double lb[2] = { 1.0, 0.0 };
+    const double ub[2] = { 0.0, 1.0 }; // lb > ub in the first component
+    QpSolver qp;
+    std::string error;
+    check(qp.setup(2, 0, P, nullptr, error), "invalid: setup");
+    check(qp.solve(nullptr, lb, ub, nullptr, nullptr).status == QpStatus::InvalidInput, "invalid: crossed bounds");
+    const double q[2] = { NAN, 0.0 };
+    check(qp.solve(q, nullptr, nullptr, nullptr, nullptr).status == QpStatus::InvalidInput, "invalid: NaN cost");
+
+    QpSolver none;
+    check(none.solve(nullptr, nullptr, nullptr, nullptr, nullptr).status == QpStatus::InvalidInput, "invalid: no setup");
+
+    const double negative[4] = { -1.0, 0.0, 0.0, -1.0 };
+    QpSolver concave;
+    concave.setup(2, 0, negative, nullptr, error);
+    check(concave.solve(nullptr, nullptr, nullptr, nullptr, nullptr).status == QpStatus::NotConvex, "invalid: not convex");
+}
+
+// Integrator x[k+1] = x[k] + u[k] over one step: cost p (x1 - r)^2 + r u^2, so
+// u* = p (r - x0) / (p + r) before the input and rate bounds
+LinearMpcProblem integrator() {
+    LinearMpcProblem problem;
+    problem.nx = 1;
+    problem.nu = 1;
+    problem.horizon = 1;
+    problem.A = { 1.0 };
+    problem.B = { 1.0 };
+    problem.Q = { 1.0 };
+    problem.P = { 3.0 };
+    problem.R = { 1.0 };
+    return problem;
+}
+
+void testMpcAnalytic() {
+    QpSettings settings;
+    tighten(settings);
+    std::string error;
+    const double x0 = 0.0;
+    const double reference = 2.0;
+
+    LinearMpc mpc;
+    check(mpc.setup(integrator(), settings, error), "mpc: setup");
+    check(mpc.solve(&x0, &reference, nullptr).status == QpStatus::Solved, "mpc: solved");
+    checkNear(mpc.solution()[0], 1.5, TOL, "mpc: unconstrained optimum");
+
+    LinearMpcProblem bounded = integrator();
+    bounded.uMin = { -1.0 };
+    bounded.uMax = { 1.0 };
+    LinearMpc clipped;
+    check(clipped.setup(bounded, settings, error), "mpc bounds: setup");
+    clipped.solve(&x0, &reference, nullptr);
+    checkNear(clipped.solution()[0], 1.0, TOL, "mpc bounds: input bound active");
+
+    bounded.duMax = { 0.25 };
+    LinearMpc rate;
+    check(rate.setup(bounded, settings, error), "mpc rate: setup");
+    const double uPrev = 0.5;
+    rate.solve(&x0, &reference, &uPrev);
+    checkNear(rate.solution()[0], 0.75, TOL, "mpc rate: rate bound active");
+    rate.solve(&x0, &reference, nullptr);
+    checkNear(rate.solution()[0], 1.0, TOL, "mpc rate: no rate bound without uPrev");
+}
+
+void testMpcConstraints() {
+    // Double integrator driven to 10 m with |u| <= 3, |du| <= 1 and v <= 5 (closed loop)
+    const double dt = 0.1;
+    LinearMpcProblem problem;
+    problem.nx = 2;
+    problem.nu = 1;
+    problem.horizon = 30;
+    problem.A = { 1.0, dt, 0.0, 1.0 };
+    problem.B = { 0.5 * dt * dt, dt };
+    problem.Q = { 10.0, 0.0, 0.0, 1.0 };
+    problem.R = { 0.1 };
+    problem.uMin = { -3.0 };
+    problem.uMax = { 3.0 };
+    problem.duMax = { 1.0 };
+    problem.xMin = { -INFINITY, -INFINITY };
+    problem.xMax = { INFINITY, 5.0 };
+    LinearMpc mpc;
+    std::string error;
+    check(mpc.setup(problem, QpSettings(), error), "mpc loop: setup");
+
+    std::vector<double> reference(2 * problem.horizon, 0.0);
+    for (size_t k = 0; k < problem.horizon; ++k) {
+        reference[2 * k] = 10.0;
+    }
+    double x[2] = { 0.0, 0.0 };
+    double u = 0.0;
+    bool solved = true, inputs = true;
+    double vMax = 0.0;
+    for (int step = 0; step < 150; ++step) {
+        solved &= mpc.solve(x, reference.data(), &u).status == QpStatus::Solved;
+        double next = mpc.solution()[0];
+        inputs &= std::fabs(next) <= 3.0 + 1e-3 && std::fabs(next - u) <= 1.0 + 1e-3;
+        u = next;
+        x[0] += dt * x[1] + 0.5 * dt * dt * u;
+        x[1] += dt * u;
+        vMax = std::max(vMax, x[1]);
+    }
+    check(solved, "mpc loop: every step solved");
+    check(inputs, "mpc loop: input and rate bounds");
+    check(vMax <= 5.0 + 1e-2, "mpc loop: state bound");
+    checkNear(x[0], 10.0, 0.05, "mpc loop: reference reached");
+    checkNear(x[1], 0.0, 0.05, "mpc loop: at rest");
+}
+
+} // namespace
+
+int main() {
+    testUnconstrained();
+    testBox();
+    testEquality();
+    testActiveInequality();
+    testInvalidInput();
+    testMpcAnalytic();
+    testMpcConstraints();
+    return testResult("test_qp_solver");
+}
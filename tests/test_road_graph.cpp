@@ -0,0 +1,183 @@
+// Unit tests of the preprocessed road graph and its on-disk cache (RoadGraph)
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include "RoadGraph.h"
+#include "TestCheck.h"
+
+using namespace OsiFields;
+namespace fs = std::filesystem;
+
+namespace {
+
+const unsigned long long HASH = 0x1234abcdULL;
+
+void writeMessage(std::string& out, uint32_t number, const std::string& message) {
+    OsiWire::writeLengthDelimited(out, number, message.data(), message.size());
+}
+
+std::string identifier(uint64_t id) {
+    std::string message;
+    OsiWire::writeVarintField(message, Identifier::Value, id);
+    return message;
+}
+
+std::string lane(uint64_t id, double x0, double x1, double y, uint64_t successor, uint64_t left) {
+    std::string classification, message;
+    for (double x : { x0, 0.5 * (x0 + x1), x1 }) {
+        std::string point;
+        OsiWire::writeDoubleField(point, Vector3d::X, x);
+        OsiWire::writeDoubleField(point, Vector3d::Y, y);
+        writeMessage(classification, LaneClassification::Centerline, point);
+    }
+    if (left != 0) {
+        writeMessage(classification, LaneClassification::LeftAdjacentLaneId, identifier(left));
+    }
+    if (successor != 0) {
+        std::string pairing;
+        writeMessage(pairing, LanePairing::SuccessorLaneId, identifier(successor));
+        writeMessage(classification, LaneClassification::LanePairing, pairing);
+    }
+    writeMessage(message, Lane::Id, identifier(id));
+    writeMessage(message, Lane::Classification, classification);
+    return message;
+}
+
+// Lane 10 (0..100 m) continues in lane 11 (100..300 m); lane 12 runs left of lane 10
+std::string makeGroundTruth() {
+    std::string gt;
+    writeMessage(gt, GroundTruth::Lane, lane(11, 100.0, 300.0, 0.0, 0, 0));
+    writeMessage(gt, GroundTruth::Lane, lane(10, 0.0, 100.0, 0.0, 11, 12));
+    writeMessage(gt, GroundTruth::Lane, lane(12, 0.0, 100.0, 3.5, 0, 0));
+    return gt;
+}
+
+std::string imageBytes(const RoadGraph& graph) {
+    return std::string(reinterpret_cast<const char*>(&graph.header()), graph.header().imageSize);
+}
+
+void writeFile(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), (std::streamsize)bytes.size());
+}
+
+void testBuild() {
+    std::shared_ptr<const RoadGraph> graph = RoadGraph::build(makeGroundTruth(), HASH);
+    check(graph && graph->laneCount() == 3 && graph->pointCount() == 9, "build: counts");
+    if (!graph || graph->laneCount() != 3) {
+        return;
+    }
+    const RoadGraphLane* lanes = graph->lanes();
+    check(lanes[0].id == 10 && lanes[1].id == 11 && lanes[2].id == 12, "build: lanes sorted by id");
+    check(graph->findLane(11) == 1 && graph->findLane(13) == ROAD_GRAPH_NO_LANE, "build: findLane");
+    checkNear(lanes[1].length, 200.0, 1e-9, "build: lane length");
+    check(lanes[0].successorCount == 1 && graph->links()[lanes[0].firstSuccessor] == 1, "build: successor link");
+    check(lanes[1].predecessorCount == 0, "build: antecessor only where given");
+    check(lanes[0].left == 2 && lanes[0].right == ROAD_GRAPH_NO_LANE, "build: adjacent lanes");
+    checkNear(graph->pointS()[lanes[1].firstPoint + 2], 200.0, 1e-9, "build: arc length table");
+}
+
+void testCache(const std::string& directory) {
+    std::string gt = makeGroundTruth();
+    bool fromCache = true;
+    std::shared_ptr<const RoadGraph> built = RoadGraph::open(directory, gt, HASH, fromCache);
+    check(built && !fromCache, "cache: first open builds");
+    check(fs::exists(RoadGraph::cachePath(directory, HASH)), "cache: file stored");
+
+    std::shared_ptr<const RoadGraph> mapped = RoadGraph::open(directory, gt, HASH, fromCache);
+    check(mapped && fromCache && mapped->mapped(), "cache: second open maps the file");
+    if (built && mapped) {
+        check(imageBytes(*built) == imageBytes(*mapped), "cache: identical image");
+    }
+
+    // Different content under the same hash is not taken from the cache
+    std::string other = gt;
+    writeMessage(other, GroundTruth::Lane, lane(13, 0.0, 50.0, -3.5, 0, 0));
+    std::shared_ptr<const RoadGraph> rebuilt = RoadGraph::open(directory, other, HASH, fromCache);
+    check(rebuilt && !fromCache && rebuilt->laneCount() == 4, "cache: content check");
+}
+
+// A valid image with one corruption is rejected, rebuilt and stored again
+void checkCorruption(const std::string& directory, const char* what, const std::function<void(std::string&)>& corrupt) {
+    std::string gt = makeGroundTruth();
+    std::shared_ptr<const RoadGraph> graph = RoadGraph::build(gt, HASH);
+    std::string image = imageBytes(*graph);
+    corrupt(image);
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    writeFile(RoadGraph::cachePath(directory, HASH), image);
+
+    bool fromCache = true;
+    std::shared_ptr<const RoadGraph> opened = RoadGraph::open(directory, gt, HASH, fromCache);
+    check(opened && !fromCache && opened->laneCount() == 3, what);
+    opened.reset();
+    RoadGraph::open(directory, gt, HASH, fromCache);
+    check(fromCache, "corruption: valid file stored again");
+}
+
+template <typename T>
+T* at(std::string& image, uint64_t offset) {
+    return reinterpret_cast<T*>(&image[0] + offset);
+}
+
+RoadGraphHeader& header(std::string& image) {
+    return *at<RoadGraphHeader>(image, 0);
+}
+
+void testCorruptedCache(const std::string& directory) {
+    checkCorruption(directory, "corrupt: truncated", [](std::string& image) { image.resize(image.size() - 8); });
+    checkCorruption(directory, "corrupt: cell segment past the points", [](std::string& image) {
+        RoadGraphHeader& h = header(image);
+        *at<uint32_t>(image, h.cellSegmentsOffset) = h.pointCount;
+    });
+    checkCorruption(directory, "corrupt: cell segment at the last point of a lane", [](std::string& image) {
+        RoadGraphHeader& h = header(image);
+        const RoadGraphLane& first = *at<RoadGraphLane>(image, h.lanesOffset);
+        *at<uint32_t>(image, h.cellSegmentsOffset) = first.firstPoint + first.pointCount - 1;
+    });
+    checkCorruption(directory, "corrupt: cell start not ascending", [](std::string& image) {
+        RoadGraphHeader& h = header(image);
+        uint64_t cellCount = (uint64_t)h.gridColumns * h.gridRows;
+        uint32_t* cellStart = at<uint32_t>(image, h.cellStartOffset);
+        if (cellCount >= 2) {
+            cellStart[1] = h.cellEntryCount + 1;
+        }
+    });
+    checkCorruption(directory, "corrupt: cell start not ending at the entry count", [](std::string& image) {
+        RoadGraphHeader& h = header(image);
+        uint64_t cellCount = (uint64_t)h.gridColumns * h.gridRows;
+        at<uint32_t>(image, h.cellStartOffset)[cellCount] = h.cellEntryCount - 1;
+    });
+    checkCorruption(directory, "corrupt: point lane out of range", [](std::string& image) {
+        RoadGraphHeader& h = header(image);
+        at<uint32_t>(image, h.pointLaneOffset)[0] = h.laneCount;
+    });
+    checkCorruption(directory, "corrupt: adjacent lane out of range", [](std::string& image) {
+        RoadGraphHeader& h = header(image);
+        at<RoadGraphLane>(image, h.lanesOffset)[0].left = h.laneCount;
+    });
+    checkCorruption(directory, "corrupt: link out of range", [](std::string& image) {
+        RoadGraphHeader& h = header(image);
+        at<uint32_t>(image, h.linksOffset)[0] = h.laneCount;
+    });
+}
+
+} // namespace
+
+int main() {
+    std::error_code ec;
+    fs::path directory = fs::temp_directory_path(ec) / "gtdc_test_road_graph";
+    fs::remove_all(directory, ec);
+
+    testBuild();
+    testCache(directory.string());
+    fs::remove_all(directory, ec);
+    testCorruptedCache(directory.string());
+
+    fs::remove_all(directory, ec);
+    return testResult("test_road_graph");
+}
@@ -0,0 +1,297 @@
+// Unit tests of the ego-centric SensorView pre-filter (SensorViewFilter)
+#include <string>
+#include <vector>
+#include "OsiFields.h"
+#include "OsiWire.h"
+#include "SensorViewFilter.h"
+#include "TestCheck.h"
+
+using namespace OsiFields;
+
+namespace {
+
+struct Point {
+    double x;
+    double y;
+};
+
+void writeMessage(std::string& out, uint32_t number, const std::string& message) {
+    OsiWire::writeLengthDelimited(out, number, message.data(), message.size());
+}
+
+std::string identifier(uint64_t id) {
+    std::string message;
+    OsiWire::writeVarintField(message, Identifier::Value, id);
+    return message;
+}
+
+std::string vector3d(double x, double y) {
+    std::string message;
+    OsiWire::writeDoubleField(message, Vector3d::X, x);
+    OsiWire::writeDoubleField(message, Vector3d::Y, y);
+    return message;
+}
+
+std::string movingObject(uint64_t id, double x, double y) {
+    std::string base, object;
+    writeMessage(base, BaseMoving::Position, vector3d(x, y));
+    writeMessage(object, MovingObject::Id, identifier(id));
+    writeMessage(object, MovingObject::Base, base);
+    return object;
+}
+
+struct LaneSpec {
+    uint64_t id = 0;
+    std::vector<Point> centerline;
+    std::vector<uint64_t> leftAdjacent;
+    std::vector<uint64_t> rightBoundaries;
+    std::vector<uint64_t> leftBoundaries;
+    uint64_t antecessor = 0; // 0: none
+    uint64_t successor = 0;
+};
+
+std::string lane(const LaneSpec& spec) {
+    std::string classification, message;
+    for (const Point& p : spec.centerline) {
+        writeMessage(classification, LaneClassification::Centerline, vector3d(p.x, p.y));
+    }
+    for (uint64_t id : spec.leftAdjacent) {
+        writeMessage(classification, LaneClassification::LeftAdjacentLaneId, identifier(id));
+    }
+    if (spec.antecessor != 0 || spec.successor != 0) {
+        std::string pairing;
+        if (spec.antecessor != 0) {
+            writeMessage(pairing, LanePairing::AntecessorLaneId, identifier(spec.antecessor));
+        }
+        if (spec.successor != 0) {
+            writeMessage(pairing, LanePairing::SuccessorLaneId, identifier(spec.successor));
+        }
+        writeMessage(classification, LaneClassification::LanePairing, pairing);
+    }
+    for (uint64_t id : spec.rightBoundaries) {
+        writeMessage(classification, LaneClassification::RightLaneBoundaryId, identifier(id));
+    }
+    for (uint64_t id : spec.leftBoundaries) {
+        writeMessage(classification, LaneClassification::LeftLaneBoundaryId, identifier(id));
+    }
+    writeMessage(message, Lane::Id, identifier(spec.id));
+    writeMessage(message, Lane::Classification, classification);
+    return message;
+}
+
+std::string laneBoundary(uint64_t id, Point a, Point b) {
+    std::string message;
+    writeMessage(message, LaneBoundary::Id, identifier(id));
+    for (const Point& p : { a, b }) {
+        std::string point;
+        writeMessage(point, BoundaryPoint::Position, vector3d(p.x, p.y));
+        writeMessage(message, LaneBoundary::BoundaryLine, point);
+    }
+    return message;
+}
+
+// Host 1 at the origin; objects 2 and 4 near, 3 far. Lanes 100 and 102 near, 101 far;
+// lane 100 references the far lane 101 and the far boundary 200. Boundary 202 is far
+// and unreferenced.
+std::string makeSensorView(bool withHost) {
+    std::string gt, view;
+    writeMessage(gt, GroundTruth::HostVehicleId, identifier(withHost ? 1 : 99));
+    writeMessage(gt, GroundTruth::MovingObject, movingObject(1, 0.0, 0.0));
+    writeMessage(gt, GroundTruth::MovingObject, movingObject(2, 10.0, 0.0));
+    writeMessage(gt, GroundTruth::MovingObject, movingObject(3, 500.0, 0.0));
+    writeMessage(gt, GroundTruth::MovingObject, movingObject(4, 20.0, 3.0));
+
+    LaneSpec near;
+    near.id = 100;
+    near.centerline = { { -10.0, 0.0 }, { 40.0, 0.0 } };
+    near.leftAdjacent = { 101, 102 };
+    near.antecessor = 102;
+    near.successor = 101;
+    near.rightBoundaries = { 200 };
+    near.leftBoundaries = { 201 };
+    writeMessage(gt, GroundTruth::Lane, lane(near));
+
+    LaneSpec far;
+    far.id = 101;
+    far.centerline = { { 300.0, 300.0 }, { 400.0, 300.0 } };
+    far.leftAdjacent = { 100 };
+    writeMessage(gt, GroundTruth::Lane, lane(far));
+
+    LaneSpec other;
+    other.id = 102;
+    other.centerline = { { -40.0, 3.5 }, { -10.0, 3.5 } };
+    other.successor = 101; // Only pairing entry: the pairing is dropped
+    writeMessage(gt, GroundTruth::Lane, lane(other));
+
+    writeMessage(gt, GroundTruth::LaneBoundary, laneBoundary(200, { 600.0, 0.0 }, { 700.0, 0.0 }));
+    writeMessage(gt, GroundTruth::LaneBoundary, laneBoundary(201, { -10.0, 1.75 }, { 40.0, 1.75 }));
+    writeMessage(gt, GroundTruth::LaneBoundary, laneBoundary(202, { 600.0, 9.0 }, { 700.0, 9.0 }));
+
+    writeMessage(view, SensorView::GlobalGroundTruth, gt);
+    return view;
+}
+
+// Sub-messages with the given field number; the strings are copies
+std::vector<std::string> messages(const std::string& message, uint32_t number) {
+    std::vector<std::string> result;
+    OsiWire::Reader reader(message.data(), message.size());
+    OsiWire::Field field;
+    while (reader.next(field)) {
+        if (field.number == number && field.type == OsiWire::WireType::LengthDelimited) {
+            result.emplace_back(field.data, field.size);
+        }
+    }
+    return result;
+}
+
+uint64_t idOf(const std::string& identifierMessage) {
+    OsiWire::Reader reader(identifierMessage.data(), identifierMessage.size());
+    OsiWire::Field field;
+    while (reader.next(field)) {
+        if (field.number == Identifier::Value) {
+            return field.varint;
+        }
+    }
+    return 0;
+}
+
+// Identifier values of the sub-messages with the given field number
+std::vector<uint64_t> ids(const std::string& message, uint32_t number) {
+    std::vector<uint64_t> result;
+    for (const std::string& id : messages(message, number)) {
+        result.push_back(idOf(id));
+    }
+    return result;
+}
+
+std::vector<uint64_t> elementIds(const std::string& view, uint32_t element, uint32_t idField) {
+    std::vector<uint64_t> result;
+    std::vector<std::string> gt = messages(view, SensorView::GlobalGroundTruth);
+    if (gt.size() == 1) {
+        for (const std::string& message : messages(gt[0], element)) {
+            std::vector<uint64_t> id = ids(message, idField);
+            result.push_back(id.size() == 1 ? id[0] : 0);
+        }
+    }
+    return result;
+}
+
+std::string laneClassification(const std::string& view, uint64_t laneId) {
+    std::vector<std::string> gt = messages(view, SensorView::GlobalGroundTruth);
+    if (gt.size() == 1) {
+        for (const std::string& message : messages(gt[0], GroundTruth::Lane)) {
+            std::vector<uint64_t> id = ids(message, Lane::Id);
+            std::vector<std::string> classification = messages(message, Lane::Classification);
+            if (id.size() == 1 && id[0] == laneId && classification.size() == 1) {
+                return classification[0];
+            }
+        }
+    }
+    return std::string();
+}
+
+SensorViewFilterSettings radiusSettings() {
+    SensorViewFilterSettings settings;
+    settings.radius = 50.0;
+    return settings;
+}
+
+void testObjectsAndLanes() {
+    std::string view = makeSensorView(true);
+    SensorViewFilter filter;
+    filter.settings = radiusSettings();
+    std::string out, error;
+    check(filter.apply(view.data(), view.size(), out, error), "filter: apply");
+    check(filter.stats().hostFound, "filter: host found");
+
+    check(elementIds(out, GroundTruth::MovingObject, MovingObject::Id) == std::vector<uint64_t>({ 1, 2, 4 }),
+          "filter: far object removed");
+    check(elementIds(out, GroundTruth::Lane, Lane::Id) == std::vector<uint64_t>({ 100, 102 }), "filter: far lane removed");
+    check(elementIds(out, GroundTruth::LaneBoundary, LaneBoundary::Id) == std::vector<uint64_t>({ 200, 201 }),
+          "filter: boundary of a kept lane kept, unreferenced far boundary removed");
+    check(filter.stats().objectsRemoved == 1, "filter: objectsRemoved");
+    check(filter.stats().lanesRemoved == 2, "filter: lanesRemoved");
+    check(filter.stats().bytesOut == out.size() && out.size() < view.size(), "filter: bytes");
+}
+
+void testNoDanglingLaneIds() {
+    std::string view = makeSensorView(true);
+    SensorViewFilter filter;
+    filter.settings = radiusSettings();
+    std::string out, error;
+    check(filter.apply(view.data(), view.size(), out, error), "references: apply");
+
+    std::string near = laneClassification(out, 100);
+    check(ids(near, LaneClassification::LeftAdjacentLaneId) == std::vector<uint64_t>({ 102 }),
+          "references: removed adjacent lane dropped, kept one kept");
+    std::vector<std::string> pairing = messages(near, LaneClassification::LanePairing);
+    check(pairing.size() == 1, "references: pairing with a kept lane kept");
+    if (pairing.size() == 1) {
+        check(ids(pairing[0], LanePairing::AntecessorLaneId) == std::vector<uint64_t>({ 102 }), "references: kept antecessor");
+        check(ids(pairing[0], LanePairing::SuccessorLaneId).empty(), "references: removed successor dropped");
+    }
+    check(ids(near, LaneClassification::RightLaneBoundaryId) == std::vector<uint64_t>({ 200 }) &&
+          ids(near, LaneClassification::LeftLaneBoundaryId) == std::vector<uint64_t>({ 201 }),
+          "references: boundary ids unchanged");
+    check(messages(near, LaneClassification::Centerline).size() == 2, "references: centerline unchanged");
+
+    std::string other = laneClassification(out, 102);
+    check(!other.empty() && messages(other, LaneClassification::LanePairing).empty(), "references: empty pairing dropped");
+    check(filter.stats().referencesRemoved == 3, "references: count");
+}
+
+void testOriginalIndex() {
+    std::string view = makeSensorView(true);
+    SensorViewFilter filter;
+    filter.settings = radiusSettings();
+    std::string out, error;
+    check(filter.apply(view.data(), view.size(), out, error), "index: apply");
+    // Moving objects 1, 2, (3), 4 and lanes 100, (101), 102
+    check(filter.originalIndex(GroundTruth::MovingObject, 0) == 0, "index: before the removed object");
+    check(filter.originalIndex(GroundTruth::MovingObject, 1) == 1, "index: before the removed object (2)");
+    check(filter.originalIndex(GroundTruth::MovingObject, 2) == 3, "index: after the removed object");
+    check(filter.originalIndex(GroundTruth::Lane, 1) == 2, "index: after the removed lane");
+    check(filter.originalIndex(GroundTruth::TrafficSign, 0) == 0, "index: field without removed elements");
+}
+
+void testPassThrough() {
+    // Without the host vehicle the SensorView is handed on unchanged
+    std::string view = makeSensorView(false);
+    SensorViewFilter filter;
+    filter.settings = radiusSettings();
+    std::string out, error;
+    check(filter.apply(view.data(), view.size(), out, error), "no host: apply");
+    check(!filter.stats().hostFound && out == view, "no host: unchanged");
+    check(filter.originalIndex(GroundTruth::MovingObject, 2) == 2, "no host: identity index");
+
+    // Everything inside the area: copied as is
+    SensorViewFilter wide;
+    wide.settings.radius = 10000.0;
+    check(wide.apply(view.data(), view.size(), out, error), "wide: apply");
+    std::string withHost = makeSensorView(true);
+    check(wide.apply(withHost.data(), withHost.size(), out, error) && out == withHost, "wide: unchanged");
+
+    std::string truncated = withHost.substr(0, withHost.size() - 3);
+    check(!filter.apply(truncated.data(), truncated.size(), out, error) && !error.empty(), "malformed: rejected");
+}
+
+void testTypeMask() {
+    std::string view = makeSensorView(true);
+    SensorViewFilter filter;
+    filter.settings = radiusSettings();
+    filter.settings.movingTypeMask = 0; // Type 0 (unknown) masked: only the host is kept
+    std::string out, error;
+    check(filter.apply(view.data(), view.size(), out, error), "mask: apply");
+    check(elementIds(out, GroundTruth::MovingObject, MovingObject::Id) == std::vector<uint64_t>({ 1 }), "mask: host kept");
+}
+
+} // namespace
+
+int main() {
+    testObjectsAndLanes();
+    testNoDanglingLaneIds();
+    testOriginalIndex();
+    testPassThrough();
+    testTypeMask();
+    return testResult("test_sensor_view_filter");
+}